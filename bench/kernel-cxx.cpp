@@ -0,0 +1,163 @@
+/*
+ * This file is part of the LAIK library.
+ * Copyright (c) 2020 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+ *
+ * LAIK is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3 or later.
+ *
+ * LAIK is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Kernel benchmark for the C++ API (laik.hpp)
+ *
+ * Runs a 2d Jacobi sweep on own mappings, accessed
+ * (1) via hand-written pointer arithmetic (as in examples/jac2d.c),
+ * (2) via typed laik::View with global indexes,
+ * (3) via laik_get_map_addr per element (generic layout interface).
+ * Prints the minimal time per sweep, results must be the same.
+ */
+
+#include <laik.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+
+// sweep timed with minimum over <iters> runs
+template<typename F>
+static double minTime(int iters, F sweep)
+{
+    double best = 1e30;
+    for(int i = 0; i < iters; i++) {
+        double t = laik_wtime();
+        sweep();
+        t = laik_wtime() - t;
+        if (t < best) best = t;
+    }
+    return best;
+}
+
+static void clear(const laik::View<double, 2>& w, int64_t x1, int64_t x2,
+                  int64_t y1, int64_t y2)
+{
+    for(int64_t y = y1; y < y2; y++)
+        for(int64_t x = x1; x < x2; x++)
+            w(x, y) = 0.0;
+}
+
+static double checksum(const laik::View<double, 2>& w, int64_t x1, int64_t x2,
+                       int64_t y1, int64_t y2)
+{
+    double sum = 0.0;
+    for(int64_t y = y1; y < y2; y++)
+        for(int64_t x = x1; x < x2; x++)
+            sum += w(x, y) * (double) ((x + y) % 7);
+    return sum;
+}
+
+int main(int argc, char* argv[])
+{
+    laik::Instance inst(&argc, &argv);
+
+    int size = (argc > 1) ? atoi(argv[1]) : 0;
+    int iters = (argc > 2) ? atoi(argv[2]) : 0;
+    if (size <= 0) size = 2000;
+    if (iters <= 0) iters = 10;
+
+    laik::Space<2> space(inst, size, size);
+    laik::Data<double, 2> dRead(space, "read"), dWrite(space, "write");
+    laik::Partitioning<2> pWrite(laik_new_bisection_partitioner(),
+                                 inst.world(), space, nullptr, "pWrite");
+    laik::Partitioning<2> pRead(laik_new_cornerhalo_partitioner(1),
+                                inst.world(), space, &pWrite, "pRead");
+
+    // initialize
+    dRead.switchTo(pWrite, LAIK_DF_None);
+    for(auto r: pWrite.ranges()) {
+        auto v = dRead.map();
+        for(int64_t y = r.from(1); y < r.to(1); y++)
+            for(int64_t x = r.from(0); x < r.to(0); x++)
+                v(x, y) = (double) ((x + 2 * y) & 7);
+    }
+    dRead.switchTo(pRead, LAIK_DF_Preserve);
+    dWrite.switchTo(pWrite, LAIK_DF_None);
+
+    // own range without global boundary
+    laik::Range<2> r = *pWrite.ranges().begin();
+    int64_t x1 = (r.from(0) == 0) ? 1 : r.from(0);
+    int64_t y1 = (r.from(1) == 0) ? 1 : r.from(1);
+    int64_t x2 = (r.to(0) == size) ? size - 1 : r.to(0);
+    int64_t y2 = (r.to(1) == size) ? size - 1 : r.to(1);
+
+    laik::View<double, 2> vR = dRead.map();
+    laik::View<double, 2> vW = dWrite.map();
+
+    // (1) hand-written: relocate base pointers to global index (x1/y1)
+    double tHand = minTime(iters, [&]() {
+        double* baseR = vR.data() + (y1 - vR.from(1)) * vR.ystride() + (x1 - vR.from(0));
+        double* baseW = vW.data() + (y1 - vW.from(1)) * vW.ystride() + (x1 - vW.from(0));
+        uint64_t ysR = vR.ystride(), ysW = vW.ystride();
+        for(int64_t y = 0; y < y2 - y1; y++)
+            for(int64_t x = 0; x < x2 - x1; x++)
+                baseW[y * ysW + x] = 0.25 * (baseR[y * ysR + x - 1] +
+                                             baseR[y * ysR + x + 1] +
+                                             baseR[(y - 1) * ysR + x] +
+                                             baseR[(y + 1) * ysR + x]);
+    });
+    double sumHand = checksum(vW, x1, x2, y1, y2);
+
+    // (2) typed views with global indexes
+    clear(vW, x1, x2, y1, y2);
+    double tView = minTime(iters, [&]() {
+        for(int64_t y = y1; y < y2; y++)
+            for(int64_t x = x1; x < x2; x++)
+                vW(x, y) = 0.25 * (vR(x - 1, y) + vR(x + 1, y) +
+                                   vR(x, y - 1) + vR(x, y + 1));
+    });
+    double sumView = checksum(vW, x1, x2, y1, y2);
+
+    // (3) address calculation via layout interface for each element
+    clear(vW, x1, x2, y1, y2);
+    double tGen = minTime(iters, [&]() {
+        Laik_Index i;
+        for(int64_t y = y1; y < y2; y++)
+            for(int64_t x = x1; x < x2; x++) {
+                double v = 0.0;
+                laik_index_init(&i, x - 1, y, 0);
+                v += *(double*) laik_get_map_addr(dRead, 0, &i);
+                laik_index_init(&i, x + 1, y, 0);
+                v += *(double*) laik_get_map_addr(dRead, 0, &i);
+                laik_index_init(&i, x, y - 1, 0);
+                v += *(double*) laik_get_map_addr(dRead, 0, &i);
+                laik_index_init(&i, x, y + 1, 0);
+                v += *(double*) laik_get_map_addr(dRead, 0, &i);
+                laik_index_init(&i, x, y, 0);
+                *(double*) laik_get_map_addr(dWrite, 0, &i) = 0.25 * v;
+            }
+    });
+    double sumGen = checksum(vW, x1, x2, y1, y2);
+
+    if (inst.myid() == 0) {
+        double mupd = 1e-6 * (double) (x2 - x1) * (double) (y2 - y1);
+        printf("2d jacobi sweep, %d x %d, %d tasks (task 0: %.2f MUpd)\n",
+               size, size, inst.size(), mupd);
+        printf("  hand-written: %8.3f ms (%7.1f MUpd/s)\n",
+               1e3 * tHand, mupd / tHand);
+        printf("  laik::View  : %8.3f ms (%7.1f MUpd/s), %.2fx\n",
+               1e3 * tView, mupd / tView, tView / tHand);
+        printf("  map_addr    : %8.3f ms (%7.1f MUpd/s), %.2fx\n",
+               1e3 * tGen, mupd / tGen, tGen / tHand);
+    }
+    if ((sumView != sumHand) || (sumGen != sumHand)) {
+        printf("ERROR: results differ (%f / %f / %f)\n", sumHand, sumView, sumGen);
+        return 1;
+    }
+    return 0;
+}
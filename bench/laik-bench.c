@@ -0,0 +1,643 @@
+/*
+ * This file is part of the LAIK library.
+ * Copyright (c) 2020 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+ *
+ * LAIK is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3 or later.
+ *
+ * LAIK is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * LAIK micro-benchmark suite
+ *
+ * Runs parametrized benchmarks with the backend selected via LAIK_BACKEND,
+ * and writes statistics of time per iteration (measured by task 0) as JSON.
+ * With "-c", two result files are compared to detect regressions.
+ */
+
+#include <laik.h>
+
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// command line options
+static int iters = 20, warmup = 2;
+static bool quick = false;
+static const char* selection = 0;
+
+static Laik_Instance* inst;
+static Laik_Group* world;
+static int myid;
+
+// tiny container for synchronizing tasks between iterations
+static Laik_Data* syncD;
+
+// results collected by task 0
+#define MAX_RESULTS 100
+
+typedef struct {
+    char name[32];
+    char params[64];
+    int iters;
+    double min, mean, p50, p90, p99, max;
+} Result;
+
+static Result result[MAX_RESULTS];
+static int resultCount = 0;
+
+// time samples of currently running benchmark
+static double* sample;
+static int sampleCount;
+
+
+// all tasks: allreduce on a single value, used as barrier
+static void sync_tasks(void)
+{
+    laik_switchto_flow(syncD, LAIK_DF_Preserve, LAIK_RO_Sum);
+}
+
+static int cmp_double(const void* p1, const void* p2)
+{
+    double d1 = *(const double*) p1;
+    double d2 = *(const double*) p2;
+    return (d1 < d2) ? -1 : (d1 > d2) ? 1 : 0;
+}
+
+// nearest-rank percentile of sorted samples
+static double percentile(double* s, int n, double p)
+{
+    int idx = (int) ceil(p / 100.0 * n) - 1;
+    if (idx < 0) idx = 0;
+    if (idx >= n) idx = n - 1;
+    return s[idx];
+}
+
+// is benchmark <name> selected? Selection is a comma-separated list of
+// substrings, a benchmark is selected if its name contains one of them
+static bool selected(const char* name)
+{
+    if (!selection) return true;
+
+    char token[64];
+    const char* s = selection;
+    while(*s) {
+        const char* e = strchr(s, ',');
+        size_t len = e ? (size_t) (e - s) : strlen(s);
+        if ((len > 0) && (len < sizeof(token))) {
+            memcpy(token, s, len);
+            token[len] = 0;
+            if (strstr(name, token)) return true;
+        }
+        if (!e) break;
+        s = e + 1;
+    }
+    return false;
+}
+
+// start/end of a benchmark with given name and parameters
+static void bench_start(void)
+{
+    sampleCount = 0;
+}
+
+static void bench_end(const char* name, const char* params)
+{
+    if ((myid != 0) || (sampleCount == 0)) return;
+    assert(resultCount < MAX_RESULTS);
+    Result* r = &(result[resultCount++]);
+
+    qsort(sample, sampleCount, sizeof(double), cmp_double);
+    snprintf(r->name, sizeof(r->name), "%s", name);
+    snprintf(r->params, sizeof(r->params), "%s", params);
+    r->iters = sampleCount;
+    r->min = sample[0];
+    r->max = sample[sampleCount - 1];
+    r->mean = 0.0;
+    for(int i = 0; i < sampleCount; i++)
+        r->mean += sample[i];
+    r->mean /= sampleCount;
+    r->p50 = percentile(sample, sampleCount, 50);
+    r->p90 = percentile(sample, sampleCount, 90);
+    r->p99 = percentile(sample, sampleCount, 99);
+
+    // progress goes to stderr, stdout may get JSON results
+    fprintf(stderr, "%-12s %-28s p50 %10.3f ms  p90 %10.3f ms  max %10.3f ms\n",
+           name, params, 1000.0 * r->p50, 1000.0 * r->p90, 1000.0 * r->max);
+}
+
+// add a sample if not in warmup phase
+static void add_sample(int iter, double t)
+{
+    if (iter < warmup) return;
+    sample[sampleCount++] = t;
+}
+
+
+//--------------------------------------------------------------
+// benchmarks
+
+// halo exchange: switch from exclusive to halo partitioning and back
+static void bench_halo(int dims, int64_t size, int depth)
+{
+    char name[20], params[64];
+    sprintf(name, "halo%dd", dims);
+    if (!selected(name)) return;
+    sprintf(params, "size=%ld,depth=%d", (long) size, depth);
+
+    Laik_Space* space;
+    Laik_Partitioner* prWrite;
+    if (dims == 1) {
+        space = laik_new_space_1d(inst, size);
+        prWrite = laik_new_block_partitioner1();
+    }
+    else {
+        if (dims == 2)
+            space = laik_new_space_2d(inst, size, size);
+        else
+            space = laik_new_space_3d(inst, size, size, size);
+        prWrite = laik_new_bisection_partitioner();
+    }
+    // halo partitioner needs tagged ranges, not set by 1d block partitioner
+    Laik_Partitioner* prRead = (dims == 1) ? laik_new_cornerhalo_partitioner(depth) :
+                                             laik_new_halo_partitioner(depth);
+    Laik_Partitioning* pWrite = laik_new_partitioning(prWrite, world, space, 0);
+    Laik_Partitioning* pRead = laik_new_partitioning(prRead, world, space, pWrite);
+    Laik_Data* d = laik_new_data(space, laik_Double);
+    laik_switchto_partitioning(d, pWrite, LAIK_DF_None, LAIK_RO_None);
+
+    bench_start();
+    for(int it = 0; it < warmup + iters; it++) {
+        sync_tasks();
+        double t = laik_wtime();
+        laik_switchto_partitioning(d, pRead, LAIK_DF_Preserve, LAIK_RO_None);
+        laik_switchto_partitioning(d, pWrite, LAIK_DF_None, LAIK_RO_None);
+        add_sample(it, laik_wtime() - t);
+    }
+    bench_end(name, params);
+
+    laik_free(d);
+    laik_free_partitioning(pRead);
+    laik_free_partitioning(pWrite);
+}
+
+// all-reduce on a vector of doubles
+static void bench_allreduce(int64_t count)
+{
+    char params[64];
+    if (!selected("allreduce")) return;
+    sprintf(params, "count=%ld", (long) count);
+
+    Laik_Space* space = laik_new_space_1d(inst, count);
+    Laik_Data* d = laik_new_data(space, laik_Double);
+    laik_switchto_new_partitioning(d, world, laik_All, LAIK_DF_None, LAIK_RO_None);
+
+    bench_start();
+    for(int it = 0; it < warmup + iters; it++) {
+        sync_tasks();
+        double t = laik_wtime();
+        laik_switchto_flow(d, LAIK_DF_Preserve, LAIK_RO_Sum);
+        add_sample(it, laik_wtime() - t);
+    }
+    bench_end("allreduce", params);
+
+    laik_free(d);
+}
+
+// reduction of a vector of doubles to the master task
+static void bench_groupreduce(int64_t count)
+{
+    char params[64];
+    if (!selected("groupreduce")) return;
+    sprintf(params, "count=%ld", (long) count);
+
+    Laik_Space* space = laik_new_space_1d(inst, count);
+    Laik_Partitioning* pAll = laik_new_partitioning(laik_All, world, space, 0);
+    Laik_Partitioning* pMaster = laik_new_partitioning(laik_Master, world, space, 0);
+    Laik_Data* d = laik_new_data(space, laik_Double);
+    laik_switchto_partitioning(d, pAll, LAIK_DF_None, LAIK_RO_None);
+
+    bench_start();
+    for(int it = 0; it < warmup + iters; it++) {
+        sync_tasks();
+        double t = laik_wtime();
+        laik_switchto_partitioning(d, pMaster, LAIK_DF_Preserve, LAIK_RO_Sum);
+        add_sample(it, laik_wtime() - t);
+        laik_switchto_partitioning(d, pAll, LAIK_DF_Preserve, LAIK_RO_None);
+    }
+    bench_end("groupreduce", params);
+
+    laik_free(d);
+    laik_free_partitioning(pAll);
+    laik_free_partitioning(pMaster);
+}
+
+// task weight for repartitioning: higher task IDs get more work
+static double getTaskWeight(int rank, const void* userData)
+{
+    (void) userData;
+    return (double) (rank + 1);
+}
+
+// switch between equal block partitioning and weighted one
+static void bench_repartition(int64_t size)
+{
+    char params[64];
+    if (!selected("repartition")) return;
+    sprintf(params, "size=%ld", (long) size);
+
+    Laik_Space* space = laik_new_space_1d(inst, size);
+    Laik_Partitioning* p1;
+    Laik_Partitioning* p2;
+    p1 = laik_new_partitioning(laik_new_block_partitioner1(), world, space, 0);
+    p2 = laik_new_partitioning(laik_new_block_partitioner_tw1(getTaskWeight, 0),
+                               world, space, 0);
+    Laik_Data* d = laik_new_data(space, laik_Double);
+    laik_switchto_partitioning(d, p1, LAIK_DF_None, LAIK_RO_None);
+
+    bench_start();
+    for(int it = 0; it < warmup + iters; it++) {
+        sync_tasks();
+        double t = laik_wtime();
+        laik_switchto_partitioning(d, (it & 1) ? p1 : p2, LAIK_DF_Preserve, LAIK_RO_None);
+        add_sample(it, laik_wtime() - t);
+    }
+    bench_end("repartition", params);
+
+    laik_free(d);
+    laik_free_partitioning(p1);
+    laik_free_partitioning(p2);
+}
+
+// remove last task: calculate reassign partitioning and switch to it
+static void bench_reassign(int64_t size)
+{
+    char params[64];
+    if (!selected("reassign")) return;
+    int size0 = laik_size(world);
+    if (size0 < 2) return; // needs task to remove
+    sprintf(params, "size=%ld", (long) size);
+
+    Laik_Space* space = laik_new_space_1d(inst, size);
+    Laik_Partitioning* p;
+    p = laik_new_partitioning(laik_new_block_partitioner1(), world, space, 0);
+    int removeList[1] = { size0 - 1 };
+    Laik_Group* g2 = laik_new_shrinked_group(world, 1, removeList);
+    Laik_Data* d = laik_new_data(space, laik_Double);
+    laik_switchto_partitioning(d, p, LAIK_DF_None, LAIK_RO_None);
+
+    bench_start();
+    for(int it = 0; it < warmup + iters; it++) {
+        sync_tasks();
+        double t = laik_wtime();
+        Laik_Partitioner* pr = laik_new_reassign_partitioner(g2, 0, 0);
+        Laik_Partitioning* p2 = laik_new_partitioning(pr, world, space, p);
+        laik_partitioning_migrate(p2, g2);
+        laik_switchto_partitioning(d, p2, LAIK_DF_Preserve, LAIK_RO_None);
+        add_sample(it, laik_wtime() - t);
+
+        // back to original partitioning
+        laik_switchto_partitioning(d, p, LAIK_DF_Preserve, LAIK_RO_None);
+        laik_free_partitioning(p2);
+    }
+    bench_end("reassign", params);
+
+    laik_free(d);
+    laik_free_partitioning(p);
+}
+
+// every task changes <n> entries in a KV store, then sync
+static void bench_kvs(int n)
+{
+    char params[64], key[40], value[40];
+    if (!selected("kvs")) return;
+    sprintf(params, "entries=%d", n);
+
+    Laik_KVStore* kvs = laik_kvs_new("bench", inst);
+
+    bench_start();
+    for(int it = 0; it < warmup + iters; it++) {
+        sync_tasks();
+        double t = laik_wtime();
+        for(int i = 0; i < n; i++) {
+            sprintf(key, "%d-%d", myid, i);
+            sprintf(value, "%d", it);
+            laik_kvs_sets(kvs, key, value);
+        }
+        laik_kvs_sync(kvs);
+        add_sample(it, laik_wtime() - t);
+    }
+    bench_end("kvs", params);
+
+    laik_kvs_free(kvs);
+}
+
+// calculation of halo transition only, no communication
+static void bench_transcalc(int dims, int64_t size)
+{
+    char name[20], params[64];
+    sprintf(name, "transcalc%dd", dims);
+    if (!selected(name)) return;
+    sprintf(params, "size=%ld", (long) size);
+
+    Laik_Space* space;
+    if (dims == 1)
+        space = laik_new_space_1d(inst, size);
+    else if (dims == 2)
+        space = laik_new_space_2d(inst, size, size);
+    else
+        space = laik_new_space_3d(inst, size, size, size);
+    Laik_Partitioner* prWrite = (dims == 1) ? laik_new_block_partitioner1() :
+                                              laik_new_bisection_partitioner();
+    Laik_Partitioning* pWrite = laik_new_partitioning(prWrite, world, space, 0);
+    Laik_Partitioner* prRead = (dims == 1) ? laik_new_cornerhalo_partitioner(1) :
+                                             laik_new_halo_partitioner(1);
+    Laik_Partitioning* pRead = laik_new_partitioning(prRead, world, space, pWrite);
+
+    bench_start();
+    for(int it = 0; it < warmup + iters; it++) {
+        double t = laik_wtime();
+        Laik_Transition* tr = laik_calc_transition(space, pWrite, pRead,
+                                                   LAIK_DF_Preserve, LAIK_RO_None);
+        add_sample(it, laik_wtime() - t);
+        laik_free_transition(tr);
+    }
+    bench_end(name, params);
+
+    laik_free_partitioning(pRead);
+    laik_free_partitioning(pWrite);
+}
+
+
+// overhead of LAIK in a compute loop: axpy on own range and sum over all
+// tasks per iteration, compared to a plain C loop on arrays of same size.
+// With the single backend, both variants should take the same time
+static void bench_loop(int64_t size)
+{
+    char params[64];
+    if (!selected("loop")) return;
+    sprintf(params, "size=%ld", (long) size);
+
+    // plain C loop, each task working on full arrays
+    double* x = (double*) malloc(size * sizeof(double));
+    double* y = (double*) malloc(size * sizeof(double));
+    for(int64_t i = 0; i < size; i++) {
+        x[i] = (double) (i & 7);
+        y[i] = 0.0;
+    }
+    double sumC = 0.0;
+    bench_start();
+    for(int it = 0; it < warmup + iters; it++) {
+        double t = laik_wtime();
+        double sum = 0.0;
+        for(int64_t i = 0; i < size; i++) {
+            y[i] += 0.5 * x[i];
+            sum += y[i];
+        }
+        sumC += sum;
+        add_sample(it, laik_wtime() - t);
+    }
+    bench_end("loop-c", params);
+    free(x);
+    free(y);
+
+    // same loop with LAIK containers: switch to same partitioning (no-op)
+    // and all-reduce of partial sums in each iteration
+    Laik_Space* space = laik_new_space_1d(inst, size);
+    Laik_Partitioning* p = laik_new_partitioning(laik_new_block_partitioner1(),
+                                                 world, space, 0);
+    Laik_Data* dx = laik_new_data(space, laik_Double);
+    Laik_Data* dy = laik_new_data(space, laik_Double);
+    laik_switchto_partitioning(dx, p, LAIK_DF_None, LAIK_RO_None);
+    laik_switchto_partitioning(dy, p, LAIK_DF_None, LAIK_RO_None);
+    double *bx, *by, *bsum;
+    uint64_t count, off;
+    laik_get_map_1d(dx, 0, (void**) &bx, &count);
+    laik_get_map_1d(dy, 0, (void**) &by, &count);
+    off = (uint64_t) laik_local2global_1d(dx, 0);
+    for(uint64_t i = 0; i < count; i++) {
+        bx[i] = (double) ((off + i) & 7);
+        by[i] = 0.0;
+    }
+    Laik_Space* sumS = laik_new_space_1d(inst, 1);
+    Laik_Data* dsum = laik_new_data(sumS, laik_Double);
+    laik_switchto_new_partitioning(dsum, world, laik_All, LAIK_DF_None, LAIK_RO_None);
+
+    double sumLaik = 0.0;
+    bench_start();
+    for(int it = 0; it < warmup + iters; it++) {
+        sync_tasks();
+        double t = laik_wtime();
+        laik_switchto_partitioning(dy, p, LAIK_DF_Preserve, LAIK_RO_None);
+        laik_get_map_1d(dx, 0, (void**) &bx, &count);
+        laik_get_map_1d(dy, 0, (void**) &by, &count);
+        double sum = 0.0;
+        for(uint64_t i = 0; i < count; i++) {
+            by[i] += 0.5 * bx[i];
+            sum += by[i];
+        }
+        laik_get_map_1d(dsum, 0, (void**) &bsum, 0);
+        *bsum = sum;
+        laik_switchto_flow(dsum, LAIK_DF_Preserve, LAIK_RO_Sum);
+        laik_get_map_1d(dsum, 0, (void**) &bsum, 0);
+        sumLaik += *bsum;
+        add_sample(it, laik_wtime() - t);
+    }
+    bench_end("loop-laik", params);
+
+    if ((myid == 0) && (sumC != sumLaik))
+        fprintf(stderr, "loop: ERROR: sums differ (%f / %f)\n", sumC, sumLaik);
+
+    laik_free(dx);
+    laik_free(dy);
+    laik_free(dsum);
+    laik_free_partitioning(p);
+}
+
+//--------------------------------------------------------------
+// JSON output and comparison
+
+static void write_results(FILE* f, const char* backend)
+{
+    fprintf(f, "{\"backend\": \"%s\", \"tasks\": %d, \"iters\": %d,\n",
+            backend, laik_size(world), iters);
+    fprintf(f, " \"results\": [\n");
+    for(int i = 0; i < resultCount; i++) {
+        Result* r = &(result[i]);
+        // one result per line, parsed in compare mode
+        fprintf(f, "  {\"name\": \"%s\", \"params\": \"%s\", \"iters\": %d, "
+                "\"min\": %.9f, \"mean\": %.9f, \"p50\": %.9f, \"p90\": %.9f, "
+                "\"p99\": %.9f, \"max\": %.9f}%s\n",
+                r->name, r->params, r->iters,
+                r->min, r->mean, r->p50, r->p90, r->p99, r->max,
+                (i + 1 < resultCount) ? "," : "");
+    }
+    fprintf(f, "]}\n");
+}
+
+// read results from a file written by write_results, returns count
+static int read_results(const char* filename, Result* res)
+{
+    FILE* f = fopen(filename, "r");
+    if (!f) {
+        fprintf(stderr, "Cannot open '%s'\n", filename);
+        exit(1);
+    }
+    char line[500];
+    int count = 0;
+    while(fgets(line, sizeof(line), f)) {
+        Result* r = &(res[count]);
+        int n = sscanf(line, " {\"name\": \"%31[^\"]\", \"params\": \"%63[^\"]\", "
+                       "\"iters\": %d, \"min\": %lf, \"mean\": %lf, \"p50\": %lf, "
+                       "\"p90\": %lf, \"p99\": %lf, \"max\": %lf",
+                       r->name, r->params, &(r->iters), &(r->min), &(r->mean),
+                       &(r->p50), &(r->p90), &(r->p99), &(r->max));
+        if (n != 9) continue;
+        if (++count == MAX_RESULTS) break;
+    }
+    fclose(f);
+    return count;
+}
+
+// compare median times of matching benchmarks, returns number of regressions
+static int compare_results(const char* oldFile, const char* newFile,
+                           double threshold)
+{
+    static Result oldRes[MAX_RESULTS], newRes[MAX_RESULTS];
+    int oldCount = read_results(oldFile, oldRes);
+    int newCount = read_results(newFile, newRes);
+    int regressions = 0;
+
+    printf("%-12s %-28s %12s %12s %8s\n",
+           "benchmark", "parameters", "old p50 ms", "new p50 ms", "change");
+    for(int i = 0; i < newCount; i++) {
+        Result* n = &(newRes[i]);
+        Result* o = 0;
+        for(int j = 0; j < oldCount; j++) {
+            if ((strcmp(oldRes[j].name, n->name) == 0) &&
+                (strcmp(oldRes[j].params, n->params) == 0)) {
+                o = &(oldRes[j]);
+                break;
+            }
+        }
+        if (!o) {
+            printf("%-12s %-28s %12s %12.3f      new\n",
+                   n->name, n->params, "-", 1000.0 * n->p50);
+            continue;
+        }
+        double change = (o->p50 > 0.0) ? 100.0 * (n->p50 - o->p50) / o->p50 : 0.0;
+        bool regression = change > threshold;
+        if (regression) regressions++;
+        printf("%-12s %-28s %12.3f %12.3f %+7.1f%%%s\n",
+               n->name, n->params, 1000.0 * o->p50, 1000.0 * n->p50,
+               change, regression ? "  REGRESSION" : "");
+    }
+    printf("%d regression(s) with threshold %.1f%%\n", regressions, threshold);
+    return regressions;
+}
+
+
+static void usage(char* prog)
+{
+    printf("Usage: %s [options]\n"
+           "       %s -c <old.json> <new.json> [<threshold %%>]\n\n"
+           "Options:\n"
+           " -n <iters>   iterations per benchmark (default: %d)\n"
+           " -w <iters>   warmup iterations, not measured (default: %d)\n"
+           " -b <list>    run only benchmarks with names containing one of the\n"
+           "              comma-separated substrings, e.g. 'halo,kvs'\n"
+           " -q           quick run with small sizes\n"
+           " -o <file>    write JSON results to file (default: stdout)\n"
+           " -c           compare results: exit code 1 if median time of a\n"
+           "              benchmark got slower by more than threshold (default 10%%)\n",
+           prog, prog, iters, warmup);
+}
+
+int main(int argc, char* argv[])
+{
+    // compare mode: no LAIK initialization needed
+    if ((argc > 1) && (strcmp(argv[1], "-c") == 0)) {
+        if (argc < 4) {
+            usage(argv[0]);
+            exit(1);
+        }
+        double threshold = (argc > 4) ? atof(argv[4]) : 10.0;
+        return (compare_results(argv[2], argv[3], threshold) > 0) ? 1 : 0;
+    }
+
+    inst = laik_init(&argc, &argv);
+    world = laik_world(inst);
+    myid = laik_myid(world);
+
+    const char* outFile = 0;
+    int arg = 1;
+    while((arg < argc) && (argv[arg][0] == '-')) {
+        if ((argv[arg][1] == 'n') && (arg + 1 < argc)) iters = atoi(argv[++arg]);
+        else if ((argv[arg][1] == 'w') && (arg + 1 < argc)) warmup = atoi(argv[++arg]);
+        else if ((argv[arg][1] == 'b') && (arg + 1 < argc)) selection = argv[++arg];
+        else if ((argv[arg][1] == 'o') && (arg + 1 < argc)) outFile = argv[++arg];
+        else if (argv[arg][1] == 'q') quick = true;
+        else {
+            if (myid == 0) usage(argv[0]);
+            laik_finalize(inst);
+            exit(1);
+        }
+        arg++;
+    }
+    if (iters < 1) iters = 1;
+    if (warmup < 0) warmup = 0;
+    sample = (double*) malloc((warmup + iters) * sizeof(double));
+
+    Laik_Space* syncS = laik_new_space_1d(inst, 1);
+    syncD = laik_new_data(syncS, laik_Double);
+    laik_switchto_new_partitioning(syncD, world, laik_All, LAIK_DF_None, LAIK_RO_None);
+
+    const char* backend = getenv("LAIK_BACKEND");
+    if (!backend) backend = "default";
+    if (myid == 0)
+        fprintf(stderr, "LAIK benchmarks, backend '%s', %d tasks, %d iterations\n",
+               backend, laik_size(world), iters);
+
+    int s = quick ? 1 : 4;
+    for(int depth = 1; depth <= 2; depth++) {
+        bench_halo(1, 250000 * s, depth);
+        bench_halo(2, 250 * s, depth);
+        bench_halo(3, 25 * s, depth);
+    }
+    bench_allreduce(1);
+    bench_allreduce(25000 * s);
+    bench_groupreduce(25000 * s);
+    bench_repartition(250000 * s);
+    bench_reassign(250000 * s);
+    bench_kvs(250 * s);
+    bench_transcalc(1, 250000 * s);
+    bench_transcalc(2, 250 * s);
+    bench_transcalc(3, 25 * s);
+    bench_loop(250000 * s);
+
+    if (myid == 0) {
+        FILE* f = stdout;
+        if (outFile) {
+            f = fopen(outFile, "w");
+            if (!f) {
+                fprintf(stderr, "Cannot write '%s'\n", outFile);
+                f = stdout;
+            }
+        }
+        write_results(f, backend);
+        if (f != stdout) fclose(f);
+    }
+
+    laik_finalize(inst);
+    return 0;
+}
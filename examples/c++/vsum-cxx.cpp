@@ -0,0 +1,74 @@
+/*
+ * This file is part of the LAIK library.
+ * Copyright (c) 2020 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+ *
+ * LAIK is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3 or later.
+ *
+ * LAIK is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Vector sum example using the header-only C++ API (laik.hpp).
+ *
+ * Initializes a 1d array at master, distributes it in blocks among
+ * all tasks and reduces the partial sums into a total.
+ */
+
+#include <laik.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char* argv[])
+{
+    laik::Instance inst(&argc, &argv);
+
+    int64_t size = (argc > 1) ? atol(argv[1]) : 0;
+    if (size <= 0) size = 1000000;
+
+    laik::Space<1> space(inst, size);
+    laik::Data<double, 1> array(space, "array");
+
+    // initialize at master (others have empty partition)
+    laik::Partitioning<1> pMaster(laik_Master, inst.world(), space);
+    array.switchTo(pMaster, LAIK_DF_None);
+    for(auto r: pMaster.ranges()) {
+        auto v = array.map();
+        for(int64_t x = r.from(0); x < r.to(0); x++)
+            v(x) = (double) x;
+    }
+
+    // distribute equally among all tasks and sum up own part
+    laik::Partitioning<1> pBlock(laik_new_block_partitioner1(),
+                                 inst.world(), space, nullptr, "block");
+    array.switchTo(pBlock);
+    double mysum = 0.0;
+    for(auto r: pBlock.ranges()) {
+        auto v = array.map();
+        for(int64_t x = r.from(0); x < r.to(0); x++)
+            mysum += v(x);
+    }
+
+    // reduce partial sums at master
+    laik::Space<1> sumSpace(inst, 1);
+    laik::Data<double, 1> sum(sumSpace, "sum");
+    laik::Partitioning<1> pAll(laik_All, inst.world(), sumSpace);
+    sum.switchTo(pAll, LAIK_DF_None);
+    sum.map()(0) = mysum;
+    laik::Partitioning<1> pSumMaster(laik_Master, inst.world(), sumSpace);
+    sum.switchTo(pSumMaster, LAIK_DF_Preserve, LAIK_RO_Sum);
+
+    if (inst.myid() == 0)
+        printf("Result: %.0f (expected %.0f)\n",
+               sum.map()(0), 0.5 * (double) size * (double) (size - 1));
+
+    return 0;
+}
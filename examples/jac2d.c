@@ -88,6 +88,7 @@ int main(int argc, char* argv[])
     bool do_reservation = false;
     bool do_exec = false;
     bool do_actions = false;
+    int steps = 1; // iterations per halo exchange, using deep halos if > 1
 
     int arg = 1;
     while ((argc > arg) && (argv[arg][0] == '-')) {
@@ -97,6 +98,7 @@ int main(int argc, char* argv[])
         if (argv[arg][1] == 'r') do_reservation = true;
         if (argv[arg][1] == 'e') do_exec = true;
         if (argv[arg][1] == 'a') do_actions = true;
+        if (argv[arg][1] == 'k' && argc > arg+1) { steps = atoi(argv[++arg]); }
         if (argv[arg][1] == 'h') {
             printf("Usage: %s [options] <side width> <maxiter> <repart>\n\n"
                    "Options:\n"
@@ -106,6 +108,7 @@ int main(int argc, char* argv[])
                    " -r        : do space reservation before iteration loop\n"
                    " -e        : pre-calculate transitions to exec in iteration loop\n"
                    " -a        : pre-calculate action sequence to exec (includes -e)\n"
+                   " -k <steps>: deep halos, exchange only every <steps> iterations\n"
                    " -h : print this help text and exit\n",
                    argv[0]);
             exit(1);
@@ -118,12 +121,20 @@ int main(int argc, char* argv[])
 
     if (size == 0) size = 2500; // 6.25 mio entries
     if (maxiter == 0) maxiter = 50;
+    if (steps < 1) steps = 1;
+    if (steps > 1) {
+        // pre-calculated transitions assume halo exchange in every iteration
+        do_exec = false;
+        do_actions = false;
+    }
 
     if (laik_myid(world) == 0) {
         printf("%d x %d cells (mem %.1f MB), running %d iterations with %d tasks",
                size, size, .000016 * size * size, maxiter, laik_size(world));
         if (!use_cornerhalo)
             printf(" (halo without corners)");
+        if (steps > 1)
+            printf(" (deep halo, exchange every %d iterations)", steps);
         if (repart > 0)
             printf("\n  with repartitioning every %d iterations\n", repart);
         printf("\n");
@@ -150,10 +161,16 @@ int main(int argc, char* argv[])
     // we use two types of partitioners algorithms:
     // - prWrite: cells to update (disjunctive partitioning)
     // - prRead : extends partitionings by haloes, to read neighbor values
+    // with deep halos, prRead extends by <steps> cells. Then, both containers
+    // use pRead for <steps> iterations, updating shrinking ranges, and only
+    // the last iteration writes to pWrite, followed by a halo exchange
     Laik_Partitioner *prWrite, *prRead;
     prWrite = laik_new_bisection_partitioner();
-    prRead = use_cornerhalo ? laik_new_cornerhalo_partitioner(1) :
-                              laik_new_halo_partitioner(1);
+    if (steps > 1)
+        prRead = laik_new_deephalo_partitioner(1, steps);
+    else
+        prRead = use_cornerhalo ? laik_new_cornerhalo_partitioner(1) :
+                                  laik_new_halo_partitioner(1);
 
     // run partitioners to get partitionings over 2d space and <world> group
     // data1/2 are then alternately accessed using pRead/pWrite
@@ -251,6 +268,10 @@ int main(int argc, char* argv[])
         if (dRead == data1) { dRead = data2; dWrite = data1; }
         else                { dRead = data1; dWrite = data2; }
 
+        // with deep halos, only last step before exchange writes to pWrite
+        int step = iter % steps;
+        Laik_Partitioning* pW = (step == steps - 1) ? pWrite : pRead;
+
         // we show 3 different ways of switching containers among partitionings
         // (1) no preparation: directly switch to another partitioning
         // (2) with pre-calculated transitions between partitiongs: execute it
@@ -277,30 +298,59 @@ int main(int argc, char* argv[])
         }
         else {
             // case (1): no pre-calculation: switch to partitionings
+            // (with deep halos, dRead only needs an exchange at step 0,
+            //  otherwise it already is in pRead: switching is a no-op)
             laik_switchto_partitioning(dRead,  pRead,  LAIK_DF_Preserve, LAIK_RO_None);
-            laik_switchto_partitioning(dWrite, pWrite, LAIK_DF_None, LAIK_RO_None);
+            laik_switchto_partitioning(dWrite, pW, LAIK_DF_None, LAIK_RO_None);
         }
 
         laik_get_map_2d(dRead,  0, (void**) &baseR, &ysizeR, &ystrideR, &xsizeR);
         laik_get_map_2d(dWrite, 0, (void**) &baseW, &ysizeW, &ystrideW, &xsizeW);
 
-        setBoundary(size, pWrite, dWrite);
+        setBoundary(size, pW, dWrite);
 
         // local range for which to do 2d stencil, without global edges
-        laik_my_range_2d(pWrite, 0, &gx1, &gx2, &gy1, &gy2);
+        laik_my_range_2d(pW, 0, &gx1, &gx2, &gy1, &gy2);
         y1 = (gy1 == 0)    ? 1 : 0;
         x1 = (gx1 == 0)    ? 1 : 0;
         y2 = (gy2 == size) ? (ysizeW - 1) : ysizeW;
         x2 = (gx2 == size) ? (xsizeW - 1) : xsizeW;
 
-        // relocate baseR to be able to use same indexing as with baseW
-        if (gx1 > 0) {
-            // ghost cells from left neighbor at x=0, move that to -1
-            baseR++;
+        // own range for residuum: with deep halos, values of neighbors
+        // are updated redundantly
+        int64_t ox1 = x1, ox2 = x2, oy1 = y1, oy2 = y2;
+
+        if (steps > 1) {
+            // deep halos: restrict update to range still valid at this step
+            Laik_Range valid;
+            laik_deephalo_range(pRead, 0, step, &valid);
+            if (valid.from.i[0] - gx1 > x1) x1 = valid.from.i[0] - gx1;
+            if (valid.to.i[0]   - gx1 < x2) x2 = valid.to.i[0]   - gx1;
+            if (valid.from.i[1] - gy1 > y1) y1 = valid.from.i[1] - gy1;
+            if (valid.to.i[1]   - gy1 < y2) y2 = valid.to.i[1]   - gy1;
+
+            int64_t wx1, wx2, wy1, wy2;
+            laik_my_range_2d(pWrite, 0, &wx1, &wx2, &wy1, &wy2);
+            if (wx1 - gx1 > ox1)    ox1 = wx1 - gx1;
+            if (wx2 - gx1 < ox2)    ox2 = wx2 - gx1;
+            if (wy1 - gy1 > oy1)    oy1 = wy1 - gy1;
+            if (wy2 - gy1 < oy2)    oy2 = wy2 - gy1;
+
+            // deep halo mapping of dRead starts at (rx1,ry1)
+            int64_t rx1, ry1;
+            laik_my_range_2d(pRead, 0, &rx1, 0, &ry1, 0);
+            baseR += (gy1 - ry1) * ystrideR + (gx1 - rx1);
         }
-        if (gy1 > 0) {
-            // ghost cells from top neighbor at y=0, move that to -1
-            baseR += ystrideR;
+        else {
+            // relocate baseR to be able to use same indexing as with baseW
+            if (gx1 > 0) {
+                // ghost cells from left neighbor at x=0, move that to -1
+                baseR++;
+            }
+            if (gy1 > 0) {
+                // ghost cells from top neighbor at y=0, move that to -1
+                baseR += ystrideR;
+            }
         }
         // instead of relocating baseR, we can query address via index g1
         // check this (addr is zero if range is empty - this can happen!)
@@ -310,7 +360,7 @@ int main(int argc, char* argv[])
         if (baseR2) assert(baseR == baseR2);
 
         // for reservation API test: check that write pointer stay the same
-        if (do_reservation) {
+        if (do_reservation && (pW == pWrite)) {
             if (dWrite == data2) {
                 if (data2BaseW == 0) data2BaseW = baseW;
                 assert(data2BaseW == baseW);
@@ -334,7 +384,8 @@ int main(int argc, char* argv[])
                                         baseR[  y    * ystrideR + x + 1] +
                                         baseR[ (y+1) * ystrideR + x    ] );
                     diff = baseR[y * ystrideR + x] - newValue;
-                    res += diff * diff;
+                    if ((y >= oy1) && (y < oy2) && (x >= ox1) && (x < ox2))
+                        res += diff * diff;
                     baseW[y * ystrideW + x] = newValue;
                 }
             }
@@ -386,6 +437,22 @@ int main(int argc, char* argv[])
         // TODO: allow repartitioning
     }
 
+    if (laik_data_get_partitioning(dWrite) != pWrite) {
+        // stopped within deep-halo steps: values in halos of dWrite may
+        // be stale, copy own values to other container using pWrite
+        Laik_Data* dOwn = (dWrite == data1) ? data2 : data1;
+        laik_switchto_partitioning(dOwn, pWrite, LAIK_DF_None, LAIK_RO_None);
+        laik_get_map_2d(dWrite, 0, (void**) &baseR, &ysizeR, &ystrideR, &xsizeR);
+        laik_get_map_2d(dOwn, 0, (void**) &baseW, &ysizeW, &ystrideW, &xsizeW);
+        laik_my_range_2d(pRead, 0, &gx1, 0, &gy1, 0);
+        laik_my_range_2d(pWrite, 0, &x1, 0, &y1, 0);
+        baseR += (y1 - gy1) * ystrideR + (x1 - gx1);
+        for(uint64_t y = 0; y < ysizeW; y++)
+            for(uint64_t x = 0; x < xsizeW; x++)
+                baseW[y * ystrideW + x] = baseR[y * ystrideR + x];
+        dWrite = dOwn;
+    }
+
     // statistics for all iterations and reductions
     // using work load in all tasks
     if (laik_log_shown(2)) {
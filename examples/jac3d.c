@@ -92,6 +92,172 @@ static Laik_Layout* mylayout_new(int n, Laik_Range* range)
 }
 
 
+//--------------------------------------------------------------
+// tile-based access (used with '-t'/'-z'/'-k'): works with any layout
+// providing tiles (lex layout: one tile per mapping)
+
+// address of element (x,y,z) in tile <t>
+static inline double* tileAddr(Laik_Tile* t, int64_t x, int64_t y, int64_t z)
+{
+    return (double*) t->base + (x - t->range.from.i[0]) +
+           (y - t->range.from.i[1]) * t->stride[1] +
+           (z - t->range.from.i[2]) * t->stride[2];
+}
+
+typedef void (*tileFunc_t)(Laik_Tile* t, int64_t* from, int64_t* to, void* arg);
+
+// call <f> for all tiles of mapping <m> cut to global box [from;to[
+static void forTiles(Laik_Mapping* m, int64_t* from, int64_t* to,
+                     tileFunc_t f, void* arg)
+{
+    Laik_Index idx;
+    Laik_Tile t;
+    int64_t tf[3], tt[3];
+
+    // tile borders are the same for all tiles in a row/plane
+    for(int64_t z = from[2], zn; z < to[2]; z = zn) {
+        for(int64_t y = from[1], yn; y < to[1]; y = yn) {
+            for(int64_t x = from[0]; x < to[0]; x = t.range.to.i[0]) {
+                laik_index_init(&idx, x, y, z);
+                if (!laik_map_get_tile(m, &idx, &t)) {
+                    laik_log(LAIK_LL_Panic, "jac3d: layout does not provide tiles");
+                    exit(1);
+                }
+                for(int d = 0; d < 3; d++) {
+                    tf[d] = (from[d] > t.range.from.i[d]) ? from[d] : t.range.from.i[d];
+                    tt[d] = (to[d] < t.range.to.i[d]) ? to[d] : t.range.to.i[d];
+                }
+                (f)(&t, tf, tt, arg);
+            }
+            yn = t.range.to.i[1];
+        }
+        zn = t.range.to.i[2];
+    }
+}
+
+static void fillTile(Laik_Tile* t, int64_t* from, int64_t* to, void* arg)
+{
+    double v = *(double*) arg;
+    for(int64_t z = from[2]; z < to[2]; z++)
+        for(int64_t y = from[1]; y < to[1]; y++) {
+            double* p = tileAddr(t, from[0], y, z);
+            for(int64_t x = 0; x < to[0] - from[0]; x++)
+                p[x] = v;
+        }
+}
+
+static void initTile(Laik_Tile* t, int64_t* from, int64_t* to, void* arg)
+{
+    (void) arg;
+    for(int64_t z = from[2]; z < to[2]; z++)
+        for(int64_t y = from[1]; y < to[1]; y++) {
+            double* p = tileAddr(t, from[0], y, z);
+            for(int64_t x = from[0]; x < to[0]; x++)
+                p[x - from[0]] = (double) ((x + y + z) & 6);
+        }
+}
+
+// fill global box [x1;x2[ x [y1;y2[ x [z1;z2[ of own mapping with <v>
+static void fillBox(Laik_Mapping* m, int64_t x1, int64_t x2, int64_t y1,
+                    int64_t y2, int64_t z1, int64_t z2, double v)
+{
+    int64_t from[3] = {x1, y1, z1}, to[3] = {x2, y2, z2};
+    forTiles(m, from, to, fillTile, &v);
+}
+
+// same as setBoundary, using tiles
+void setBoundaryTiled(int size, Laik_Partitioning *pWrite, Laik_Data* dWrite)
+{
+    int64_t gx1, gx2, gy1, gy2, gz1, gz2;
+    laik_my_range_3d(pWrite, 0, &gx1, &gx2, &gy1, &gy2, &gz1, &gz2);
+    Laik_Mapping* m = laik_get_map(dWrite, 0);
+    if (!m) return;
+
+    if (gz1 == 0)    fillBox(m, gx1, gx2, gy1, gy2, 0, 1, loPlaneValue);
+    if (gz2 == size) fillBox(m, gx1, gx2, gy1, gy2, size - 1, size, hiPlaneValue);
+    if (gy1 == 0)    fillBox(m, gx1, gx2, 0, 1, gz1, gz2, loRowValue);
+    if (gy2 == size) fillBox(m, gx1, gx2, size - 1, size, gz1, gz2, hiRowValue);
+    if (gx1 == 0)    fillBox(m, 0, 1, gy1, gy2, gz1, gz2, loColValue);
+    if (gx2 == size) fillBox(m, size - 1, size, gy1, gy2, gz1, gz2, hiColValue);
+}
+
+typedef struct {
+    Laik_Mapping* mR;
+    bool do_res;
+    double res;
+} JacobiArg;
+
+// read tile of mapping <m> containing (x,y,z)
+static void readTile(Laik_Mapping* m, int64_t x, int64_t y, int64_t z,
+                     Laik_Tile* t)
+{
+    Laik_Index idx;
+    laik_index_init(&idx, x, y, z);
+    bool ok = laik_map_get_tile(m, &idx, t);
+    assert(ok);
+}
+
+// jacobi update for part [from;to[ of write tile <tW>. The corresponding
+// read tile covers this part; neighbor tiles are needed at tile borders
+static void jacobiTile(Laik_Tile* tW, int64_t* from, int64_t* to, void* arg)
+{
+    JacobiArg* a = (JacobiArg*) arg;
+    Laik_Tile tR, txm, txp, tym, typ, tzm, tzp;
+    double coeff = 1.0 / 6.0;
+    double res = 0.0;
+
+    readTile(a->mR, from[0], from[1], from[2], &tR);
+    int64_t* rf = tR.range.from.i;
+    int64_t* rt = tR.range.to.i;
+    if (from[0] == rf[0]) readTile(a->mR, from[0] - 1, from[1], from[2], &txm);
+    if (to[0] == rt[0])   readTile(a->mR, to[0], from[1], from[2], &txp);
+    if (from[1] == rf[1]) readTile(a->mR, from[0], from[1] - 1, from[2], &tym);
+    if (to[1] == rt[1])   readTile(a->mR, from[0], to[1], from[2], &typ);
+    if (from[2] == rf[2]) readTile(a->mR, from[0], from[1], from[2] - 1, &tzm);
+    if (to[2] == rt[2])   readTile(a->mR, from[0], from[1], to[2], &tzp);
+
+    int64_t n = to[0] - from[0];
+    for(int64_t z = from[2]; z < to[2]; z++) {
+        for(int64_t y = from[1]; y < to[1]; y++) {
+            double* c = tileAddr(&tR, from[0], y, z);
+            double* ym = (y > rf[1]) ? c - tR.stride[1] : tileAddr(&tym, from[0], y - 1, z);
+            double* yp = (y < rt[1] - 1) ? c + tR.stride[1] : tileAddr(&typ, from[0], y + 1, z);
+            double* zm = (z > rf[2]) ? c - tR.stride[2] : tileAddr(&tzm, from[0], y, z - 1);
+            double* zp = (z < rt[2] - 1) ? c + tR.stride[2] : tileAddr(&tzp, from[0], y, z + 1);
+            double left = (from[0] > rf[0]) ? c[-1] : *tileAddr(&txm, from[0] - 1, y, z);
+            double right = (to[0] < rt[0]) ? c[n] : *tileAddr(&txp, to[0], y, z);
+            double* w = tileAddr(tW, from[0], y, z);
+
+            // x neighbors in row, with left/right values at row ends
+            // (first and last element peeled off for a branch-free loop)
+            double vNew;
+            vNew = coeff * (zm[0] + zp[0] + ym[0] + yp[0] + left +
+                            ((n > 1) ? c[1] : right));
+            if (a->do_res) res += (c[0] - vNew) * (c[0] - vNew);
+            w[0] = vNew;
+            if (a->do_res) {
+                for(int64_t x = 1; x < n - 1; x++) {
+                    vNew = coeff * (zm[x] + zp[x] + ym[x] + yp[x] + c[x-1] + c[x+1]);
+                    res += (c[x] - vNew) * (c[x] - vNew);
+                    w[x] = vNew;
+                }
+            }
+            else {
+                for(int64_t x = 1; x < n - 1; x++)
+                    w[x] = coeff * (zm[x] + zp[x] + ym[x] + yp[x] + c[x-1] + c[x+1]);
+            }
+            if (n > 1) {
+                vNew = coeff * (zm[n-1] + zp[n-1] + ym[n-1] + yp[n-1] +
+                                c[n-2] + right);
+                if (a->do_res) res += (c[n-1] - vNew) * (c[n-1] - vNew);
+                w[n-1] = vNew;
+            }
+        }
+    }
+    a->res += res;
+}
+
+
 //--------------------------------------------------------------
 // main function
 int main(int argc, char* argv[])
@@ -109,6 +275,7 @@ int main(int argc, char* argv[])
     bool do_actions = false;
     bool do_grid = false;
     bool use_own_layout = false;
+    int use_tiles = 0; // 1: tile kernel, 2: tiled layout, 3: morton layout
     int xblocks = 0, yblocks = 0, zblocks = 0; // for grid partitioner
     int iter_shrink = 0; // number iterations between shrinks (0: disable)
     int shrink_count = 1;
@@ -123,6 +290,9 @@ int main(int argc, char* argv[])
         if (argv[arg][1] == 'a') do_actions = true;
         if (argv[arg][1] == 'g') do_grid = true;
         if (argv[arg][1] == 'l') use_own_layout = true;
+        if (argv[arg][1] == 'k') use_tiles = 1;
+        if (argv[arg][1] == 't') use_tiles = 2;
+        if (argv[arg][1] == 'z') use_tiles = 3;
         if (argv[arg][1] == 'x' && argc > arg+1) {
             xblocks = atoi(argv[++arg]);
             do_grid = true;
@@ -143,6 +313,9 @@ int main(int argc, char* argv[])
                    " -i <iter> : remove master every <iter> iterations (0: disable)\n"
                    " -c <count>: remove <count> first processes (requires -i)\n"
                    " -l        : test layouts: use own minimal custom layout\n"
+                   " -t        : use tiled layout (tile size: LAIK_LAYOUT_TILE)\n"
+                   " -z        : use tiled layout with tiles in Z-order (morton)\n"
+                   " -k        : use tile-based kernel with default layout\n"
                    " -h        : print this help text and exit\n",
                    argv[0]);
             exit(1);
@@ -184,6 +357,8 @@ int main(int argc, char* argv[])
             printf(" (halo without corners)");
         if (iter_shrink > 0)
             printf(" (shrink every %d iterations by %d)", iter_shrink, shrink_count);
+        if (use_tiles > 1)
+            printf(" (%s layout)", (use_tiles == 2) ? "tiled" : "morton");
         printf("\n");
     }
 
@@ -209,6 +384,12 @@ int main(int argc, char* argv[])
         laik_data_set_layout_factory(data1, mylayout_new);
         laik_data_set_layout_factory(data2, mylayout_new);
     }
+    if (use_tiles > 1) {
+        laik_layout_factory_t lf = (use_tiles == 2) ? laik_new_layout_tiled :
+                                                      laik_new_layout_morton;
+        laik_data_set_layout_factory(data1, lf);
+        laik_data_set_layout_factory(data2, lf);
+    }
 
     // we use two types of partitioners algorithms:
     // - prWrite: cells to update (disjunctive partitioning)
@@ -284,22 +465,30 @@ int main(int argc, char* argv[])
     laik_switchto_partitioning(dWrite, pWrite, LAIK_DF_None, LAIK_RO_None);
     laik_my_range_3d(pWrite, 0, &gx1, &gx2, &gy1, &gy2, &gz1, &gz2);
 
-    // default mapping order for 3d:
-    //   with z in [0;zsize[, y in [0;ysize[, x in [0;xsize[
-    //   base[z][y][x] is at (base + z * zstride + y * ystride + x)
-    laik_get_map_3d(dWrite, 0, (void**) &baseW,
-                    &zsizeW, &zstrideW, &ysizeW, &ystrideW, &xsizeW);
-    // arbitrary non-zero values based on global indexes to detect bugs
-    for(uint64_t z = 0; z < zsizeW; z++)
-        for(uint64_t y = 0; y < ysizeW; y++)
-            for(uint64_t x = 0; x < xsizeW; x++)
-                baseW[z * zstrideW + y * ystrideW + x] =
-                        (double) ((gx1 + x + gy1 + y + gz1 + z) & 6);
+    if (use_tiles) {
+        Laik_Mapping* m = laik_get_map(dWrite, 0);
+        int64_t from[3] = {gx1, gy1, gz1}, to[3] = {gx2, gy2, gz2};
+        if (m) forTiles(m, from, to, initTile, 0);
+        setBoundaryTiled(size, pWrite, dWrite);
+    }
+    else {
+        // default mapping order for 3d:
+        //   with z in [0;zsize[, y in [0;ysize[, x in [0;xsize[
+        //   base[z][y][x] is at (base + z * zstride + y * ystride + x)
+        laik_get_map_3d(dWrite, 0, (void**) &baseW,
+                        &zsizeW, &zstrideW, &ysizeW, &ystrideW, &xsizeW);
+        // arbitrary non-zero values based on global indexes to detect bugs
+        for(uint64_t z = 0; z < zsizeW; z++)
+            for(uint64_t y = 0; y < ysizeW; y++)
+                for(uint64_t x = 0; x < xsizeW; x++)
+                    baseW[z * zstrideW + y * ystrideW + x] =
+                            (double) ((gx1 + x + gy1 + y + gz1 + z) & 6);
 
-    // for reservation API test
-    data1BaseW = baseW;
+        // for reservation API test
+        data1BaseW = baseW;
 
-    setBoundary(size, pWrite, dWrite);
+        setBoundary(size, pWrite, dWrite);
+    }
     laik_log(2, "Init done\n");
 
     // set data2 to pRead to make exec_transition happy (this is a no-op)
@@ -352,6 +541,47 @@ int main(int argc, char* argv[])
             laik_switchto_partitioning(dWrite, pWrite, LAIK_DF_None, LAIK_RO_None);
         }
 
+        if (use_tiles) {
+            // tile-based variant of jacobi, with residuum every 10 iterations
+            setBoundaryTiled(size, pWrite, dWrite);
+
+            laik_my_range_3d(pWrite, 0, &gx1, &gx2, &gy1, &gy2, &gz1, &gz2);
+            int64_t from[3], to[3];
+            from[0] = (gx1 == 0) ? 1 : gx1;
+            from[1] = (gy1 == 0) ? 1 : gy1;
+            from[2] = (gz1 == 0) ? 1 : gz1;
+            to[0] = (gx2 == size) ? size - 1 : gx2;
+            to[1] = (gy2 == size) ? size - 1 : gy2;
+            to[2] = (gz2 == size) ? size - 1 : gz2;
+
+            JacobiArg a;
+            a.mR = laik_get_map(dRead, 0);
+            a.do_res = ((iter % 10) == 0);
+            a.res = 0.0;
+            Laik_Mapping* mW = laik_get_map(dWrite, 0);
+            if (mW && (gx1 < gx2) && (gy1 < gy2) && (gz1 < gz2))
+                forTiles(mW, from, to, jacobiTile, &a);
+
+            if (a.do_res) {
+                res_iters++;
+
+                // calculate global residuum
+                double res = a.res;
+                laik_switchto_flow(dSum, LAIK_DF_None, LAIK_RO_None);
+                laik_get_map_1d(dSum, 0, (void**) &sumPtr, 0);
+                *sumPtr = res;
+                laik_switchto_flow(dSum, LAIK_DF_Preserve, LAIK_RO_Sum);
+                laik_get_map_1d(dSum, 0, (void**) &sumPtr, 0);
+                res = *sumPtr;
+
+                if (laik_myid(world) == 0) {
+                    printf("Residuum after %2d iters: %f\n", iter+1, res);
+                }
+                if (res < .001) break;
+            }
+            goto iter_done;
+        }
+
         laik_get_map_3d(dRead,  0, (void**) &baseR,
                         &zsizeR, &zstrideR, &ysizeR, &ystrideR, &xsizeR);
         laik_get_map_3d(dWrite, 0, (void**) &baseW,
@@ -474,6 +704,7 @@ int main(int argc, char* argv[])
             }
         }
 
+iter_done:
         laik_profile_user_stop(inst);
         laik_writeout_profile();
 
@@ -555,7 +786,7 @@ int main(int argc, char* argv[])
 
                 // for reservation API test: update saved pointer
                 data1BaseW = data2BaseW = 0;
-                if (laik_myid(newWorld) >=0) {
+                if ((laik_myid(newWorld) >=0) && !use_tiles) {
                     laik_get_map_3d(dWrite, 0, (void**) &baseW, 0,0,0,0,0);
                     if (dWrite == data1) data1BaseW = baseW; else data2BaseW = baseW;
                 }
@@ -592,7 +823,20 @@ int main(int argc, char* argv[])
         pMaster = laik_new_partitioning(laik_Master, world, space, 0);
         laik_switchto_partitioning(dWrite, pMaster, LAIK_DF_Preserve, LAIK_RO_None);
 
-        if (laik_myid(world) == 0) {
+        if ((laik_myid(world) == 0) && use_tiles) {
+            // sum up in same order as with default layout
+            double sum = 0.0;
+            Laik_Index idx;
+            for(int64_t z = 0; z < size; z++)
+                for(int64_t y = 0; y < size; y++)
+                    for(int64_t x = 0; x < size; x++) {
+                        laik_index_init(&idx, x, y, z);
+                        sum += *(double*) laik_get_map_addr(dWrite, 0, &idx);
+                    }
+            printf("Global value sum after %d iterations: %f\n",
+                   iter, sum);
+        }
+        else if (laik_myid(world) == 0) {
             double sum = 0.0;
             laik_get_map_3d(dWrite, 0, (void**) &baseW,
                             &zsizeW, &zstrideW, &ysizeW, &ystrideW, &xsizeW);
@@ -81,7 +81,7 @@ void print(MGraph* mg)
     double* pm = mg->pm;
 
     for(int i = 0; i < n; i++) {
-        laik_log_begin(2);
+        (void) laik_log_begin(2);
         laik_log_append("State %2d: stay %.3f ", i, pm[i * (out + 1)]);
         for(int j = 1; j <= out; j++)
             laik_log_append("=(%.3f)=>%-2d  ",
@@ -148,7 +148,7 @@ Laik_Data* runSparse(MGraph* mg, int miter,
         dstFrom = (srcCount > 0) ? laik_local2global_1d(dWrite, 0) : 0;
 
         if (doPrint) {
-            laik_log_begin(2);
+            (void) laik_log_begin(2);
             laik_log_append("Src values before iter %d:\n", iter);
             for(int i = srcFrom; i < srcTo; i++)
                 laik_log_append("  %d: %f", i, src[i - srcFrom]);
@@ -171,7 +171,7 @@ Laik_Data* runSparse(MGraph* mg, int miter,
         }
 
         if (doPrint) {
-            laik_log_begin(2);
+            (void) laik_log_begin(2);
             laik_log_append("Src values after after %d:\n", iter);
             for(int64_t i = srcFrom; i < srcTo; i++)
                 laik_log_append("  %d: %f", i, dst[i - dstFrom]);
@@ -226,7 +226,7 @@ Laik_Data* runIndirection(MGraph* mg, int miter,
         laik_get_map_1d(dWrite, 0, (void**) &dst, &dstCount);
 
         if (doPrint) {
-            laik_log_begin(2);
+            (void) laik_log_begin(2);
             laik_log_append("Src values at iter %d:\n", iter);
             for(int i = srcFrom; i < srcTo; i++)
                 laik_log_append("  %d: %f", i, src[i - srcFrom]);
@@ -444,7 +444,7 @@ int main(int argc, char* argv[])
         assert((int)count == n);
 
         if (doPrint) {
-            laik_log_begin(2);
+            (void) laik_log_begin(2);
             laik_log_append("Result values:\n");
             for(int i = 0; i < n; i++)
                 laik_log_append("  %d: %f", i, v[i]);
@@ -0,0 +1,133 @@
+/* This file is part of the LAIK parallel container library.
+ * Copyright (c) 2020 Josef Weidendorfer
+ *
+ * LAIK is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3.
+ *
+ * LAIK is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Particle example for compound types (struct of arrays).
+ *
+ * Particles have fields position, velocity and mass, each stored in its
+ * own array. Particles are moved in parallel (block partitioning).
+ * Every few steps, statistics are calculated at master, which only
+ * needs some of the fields: switching to master is restricted to these
+ * fields by setting a field mask, so other fields are not transferred.
+ */
+
+#include <laik.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+    Laik_Group* world = laik_world(inst);
+
+    bool all_fields = false; // transfer all fields (for comparison)
+    int arg = 1;
+    while ((argc > arg) && (argv[arg][0] == '-')) {
+        if (argv[arg][1] == 'a') all_fields = true;
+        if (argv[arg][1] == 'h') {
+            printf("Usage: %s [options] <count> <steps>\n\n"
+                   "Options:\n"
+                   " -a : always transfer all fields\n"
+                   " -h : print this help text and exit\n",
+                   argv[0]);
+            exit(1);
+        }
+        arg++;
+    }
+    int size = (argc > arg) ? atoi(argv[arg]) : 0;
+    int steps = (argc > arg + 1) ? atoi(argv[arg + 1]) : 0;
+    if (size == 0) size = 100000;
+    if (steps == 0) steps = 20;
+
+    // compound type with 3 fields
+    Laik_Type* particle = laik_type_new_compound("particle");
+    int fPos = laik_type_add_field(particle, "pos", laik_Double);
+    int fVel = laik_type_add_field(particle, "vel", laik_Double);
+    int fMass = laik_type_add_field(particle, "mass", laik_Double);
+    uint64_t maskPos = 1ull << fPos;
+    uint64_t maskEnergy = (1ull << fVel) | (1ull << fMass);
+
+    Laik_Space* space = laik_new_space_1d(inst, size);
+    Laik_Data* p = laik_new_data(space, particle);
+    laik_data_set_name(p, "particles");
+    Laik_Data* dPos = laik_data_get_field(p, fPos);
+    Laik_Data* dVel = laik_data_get_field(p, fVel);
+    Laik_Data* dMass = laik_data_get_field(p, fMass);
+
+    Laik_Partitioning* pBlock = laik_new_partitioning(laik_new_block_partitioner1(),
+                                                      world, space, 0);
+    Laik_Partitioning* pMaster = laik_new_partitioning(laik_Master,
+                                                       world, space, 0);
+
+    double *pos, *vel, *mass;
+    uint64_t count;
+    int64_t from, to;
+
+    // initialization of all fields
+    laik_switchto_partitioning(p, pBlock, LAIK_DF_None, LAIK_RO_None);
+    laik_my_range_1d(pBlock, 0, &from, &to);
+    laik_get_map_1d(dPos, 0, (void**) &pos, &count);
+    laik_get_map_1d(dVel, 0, (void**) &vel, 0);
+    laik_get_map_1d(dMass, 0, (void**) &mass, 0);
+    for(uint64_t i = 0; i < count; i++) {
+        int64_t gi = from + (int64_t) i;
+        pos[i] = (double) gi;
+        vel[i] = (double) ((gi % 7) - 3);
+        mass[i] = 1.0 + (double) (gi % 3);
+    }
+
+    for(int step = 1; step <= steps; step++) {
+        // move particles: reads velocity, updates position
+        laik_get_map_1d(dPos, 0, (void**) &pos, &count);
+        laik_get_map_1d(dVel, 0, (void**) &vel, 0);
+        for(uint64_t i = 0; i < count; i++) {
+            pos[i] += 0.1 * vel[i];
+            // reflect at borders
+            if ((pos[i] < 0.0) || (pos[i] > (double) size)) vel[i] = -vel[i];
+        }
+
+        if ((step % 10) != 0) continue;
+
+        // statistics at master: center of particles (only positions needed)
+        if (!all_fields) laik_data_set_fieldmask(p, maskPos);
+        laik_switchto_partitioning(p, pMaster, LAIK_DF_Preserve, LAIK_RO_None);
+        if (laik_myid(world) == 0) {
+            double sum = 0.0;
+            laik_get_map_1d(dPos, 0, (void**) &pos, &count);
+            for(uint64_t i = 0; i < count; i++) sum += pos[i];
+            printf("Step %2d: center %.6f", step, sum / size);
+        }
+        laik_switchto_partitioning(p, pBlock, LAIK_DF_Preserve, LAIK_RO_None);
+
+        // kinetic energy (only velocity and mass needed)
+        if (!all_fields) laik_data_set_fieldmask(p, maskEnergy);
+        laik_switchto_partitioning(p, pMaster, LAIK_DF_Preserve, LAIK_RO_None);
+        if (laik_myid(world) == 0) {
+            double e = 0.0;
+            laik_get_map_1d(dVel, 0, (void**) &vel, &count);
+            laik_get_map_1d(dMass, 0, (void**) &mass, 0);
+            for(uint64_t i = 0; i < count; i++)
+                e += 0.5 * mass[i] * vel[i] * vel[i];
+            printf(", energy %.3f\n", e);
+        }
+        laik_switchto_partitioning(p, pBlock, LAIK_DF_Preserve, LAIK_RO_None);
+        laik_data_set_fieldmask(p, LAIK_FIELDS_ALL);
+    }
+
+    laik_finalize(inst);
+    return 0;
+}
@@ -195,7 +195,7 @@ void print_data(Laik_Data* d, Laik_Partitioning* p)
     int nRanges = laik_my_rangecount(p);
     for (int s = 0; s < nRanges; s++) {
         laik_get_map_1d(d, s, (void**) &base, &count);
-        laik_log_begin(1);
+        (void) laik_log_begin(1);
         for (uint64_t i = 0; i < count; i++) {
             laik_log_append(" %f", base[i]);
         }
@@ -106,6 +106,7 @@ void help(char* err)
            " -s <iter>       iterations after which to shrink by removing task 0\n"
            " -t <task>       on shrinking, remove task with ID <task> (default 0)\n"
            " -i              use incremental partitioner on shrinking\n"
+           " -a              with -i: merge into adjacent ranges (def: spread)\n"
            " -v              make LAIK verbose (same as LAIK_LOG=1)\n");
     exit(1);
 }
@@ -119,6 +120,7 @@ int main(int argc, char* argv[])
     int maxiter = 0, size = 0, nextshrink = -1, shrink = -1, removeTask = 0;
     bool useReduction = false;
     bool useIncremental = false;
+    bool useAdjacent = false;
 
     // timing: t1 raw computation, t2: everything without init
     double t1 = 0.0, t2 = 0.0, tt1, tt2, tt;
@@ -133,6 +135,8 @@ int main(int argc, char* argv[])
                 useReduction = true;
             else if (argv[arg][1] == 'i')
                 useIncremental = true;
+            else if (argv[arg][1] == 'a')
+                useAdjacent = true;
             else if (argv[arg][1] == 'v')
                 laik_set_loglevel(1);
             else if (argv[arg][1] == 's') {
@@ -336,6 +340,7 @@ int main(int argc, char* argv[])
 
             if (useIncremental) {
                 pr = laik_new_reassign_partitioner(g2, getEW, m);
+                laik_set_reassign_adjacent(pr, useAdjacent);
                 // this still generates a partitioning on <g>, which...
                 p2 = laik_new_partitioning(pr, g, s, p);
                 // ... can be migrated to be valid for <g2>
@@ -0,0 +1,369 @@
+/*
+ * This file is part of the LAIK library.
+ * Copyright (c) 2017-2020 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+ *
+ * LAIK is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3 or later.
+ *
+ * LAIK is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * Header-only C++ API for LAIK (C++11)
+ *
+ * - RAII wrappers for instance, spaces, partitionings and containers
+ * - typed containers laik::Data<T, Dims> with element type derived from T
+ * - typed views on own mappings, indexed with global indexes (x, y, z).
+ *   Index-to-address arithmetic is inlined (lexicographical layout, the
+ *   x stride is the compile-time constant 1), allowing compilers to
+ *   vectorize loops over x as with hand-written pointer code
+ * - range-based for loops over own ranges of a partitioning
+ *
+ * Objects are not copyable, but movable (moved-from objects hold null and
+ * do not free anything on destruction). The underlying C objects can be
+ * accessed via implicit conversion to use all of the C API.
+ */
+
+#ifndef LAIK_HPP
+#define LAIK_HPP
+
+extern "C" {
+#include "laik.h"
+}
+
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+namespace laik {
+
+// LAIK element type for C++ type T
+template<typename T> struct TypeOf;
+template<> struct TypeOf<double>   { static Laik_Type* get() { return laik_Double; } };
+template<> struct TypeOf<float>    { static Laik_Type* get() { return laik_Float; } };
+template<> struct TypeOf<int32_t>  { static Laik_Type* get() { return laik_Int32; } };
+template<> struct TypeOf<int64_t>  { static Laik_Type* get() { return laik_Int64; } };
+template<> struct TypeOf<uint32_t> { static Laik_Type* get() { return laik_UInt32; } };
+template<> struct TypeOf<uint64_t> { static Laik_Type* get() { return laik_UInt64; } };
+template<> struct TypeOf<char>     { static Laik_Type* get() { return laik_Char; } };
+template<> struct TypeOf<unsigned char> { static Laik_Type* get() { return laik_UChar; } };
+
+
+// LAIK instance, finalized on destruction
+class Instance {
+public:
+    Instance(int* argc, char*** argv) : _inst(laik_init(argc, argv)) {}
+    ~Instance() { if (_inst) laik_finalize(_inst); }
+
+    Instance(const Instance&) = delete;
+    Instance& operator=(const Instance&) = delete;
+    Instance(Instance&& o) : _inst(o._inst) { o._inst = nullptr; }
+    Instance& operator=(Instance&& o) {
+        if (this != &o) {
+            if (_inst) laik_finalize(_inst);
+            _inst = o._inst;
+            o._inst = nullptr;
+        }
+        return *this;
+    }
+
+    operator Laik_Instance*() const { return _inst; }
+    Laik_Group* world() const { return laik_world(_inst); }
+    int myid() const { return laik_myid(world()); }
+    int size() const { return laik_size(world()); }
+
+private:
+    Laik_Instance* _inst;
+};
+
+
+// index space with dimensionality <Dims>
+template<int Dims>
+class Space {
+    static_assert((Dims >= 1) && (Dims <= 3), "LAIK supports 1 to 3 dimensions");
+public:
+    Space(Laik_Instance* i, int64_t s1) : _s(laik_new_space_1d(i, s1))
+    { static_assert(Dims == 1, "size given for each dimension required"); }
+    Space(Laik_Instance* i, int64_t s1, int64_t s2) : _s(laik_new_space_2d(i, s1, s2))
+    { static_assert(Dims == 2, "size given for each dimension required"); }
+    Space(Laik_Instance* i, int64_t s1, int64_t s2, int64_t s3)
+        : _s(laik_new_space_3d(i, s1, s2, s3))
+    { static_assert(Dims == 3, "size given for each dimension required"); }
+    ~Space() { if (_s) laik_free_space(_s); }
+
+    Space(const Space&) = delete;
+    Space& operator=(const Space&) = delete;
+    Space(Space&& o) : _s(o._s) { o._s = nullptr; }
+    Space& operator=(Space&& o) {
+        if (this != &o) {
+            if (_s) laik_free_space(_s);
+            _s = o._s;
+            o._s = nullptr;
+        }
+        return *this;
+    }
+
+    operator Laik_Space*() const { return _s; }
+
+private:
+    Laik_Space* _s;
+};
+
+
+// a range of global indexes
+template<int Dims>
+class Range {
+public:
+    explicit Range(const Laik_Range* r) : _r(r) {}
+
+    int64_t from(int d) const { return _r->from.i[d]; }
+    int64_t to(int d) const { return _r->to.i[d]; }
+    uint64_t size() const { return laik_range_size(_r); }
+    operator const Laik_Range*() const { return _r; }
+
+private:
+    const Laik_Range* _r;
+};
+
+
+// partitioning of a space, freed on destruction
+template<int Dims>
+class Partitioning {
+public:
+    // run partitioner <pr> for <g> on space <s>, optionally based on <other>
+    Partitioning(Laik_Partitioner* pr, Laik_Group* g, Space<Dims>& s,
+                 const Partitioning* other = nullptr, const char* name = nullptr)
+        : _p(laik_new_partitioning(pr, g, s, other ? other->_p : nullptr))
+    { if (name) laik_partitioning_set_name(_p, (char*) name); }
+    ~Partitioning() { if (_p) laik_free_partitioning(_p); }
+
+    Partitioning(const Partitioning&) = delete;
+    Partitioning& operator=(const Partitioning&) = delete;
+    Partitioning(Partitioning&& o) : _p(o._p) { o._p = nullptr; }
+    Partitioning& operator=(Partitioning&& o) {
+        if (this != &o) {
+            if (_p) laik_free_partitioning(_p);
+            _p = o._p;
+            o._p = nullptr;
+        }
+        return *this;
+    }
+
+    operator Laik_Partitioning*() const { return _p; }
+
+    // iteration over own ranges: for(auto r: p.ranges()) ...
+    class RangeIterator {
+    public:
+        RangeIterator(Laik_Partitioning* p, int n) : _p(p), _n(n) {}
+        Range<Dims> operator*() const
+        { return Range<Dims>(laik_taskrange_get_range(laik_my_range(_p, _n))); }
+        RangeIterator& operator++() { _n++; return *this; }
+        bool operator!=(const RangeIterator& o) const { return _n != o._n; }
+    private:
+        Laik_Partitioning* _p;
+        int _n;
+    };
+    class Ranges {
+    public:
+        explicit Ranges(Laik_Partitioning* p) : _p(p) {}
+        RangeIterator begin() const { return RangeIterator(_p, 0); }
+        RangeIterator end() const { return RangeIterator(_p, laik_my_rangecount(_p)); }
+    private:
+        Laik_Partitioning* _p;
+    };
+    Ranges ranges() const { return Ranges(_p); }
+    int rangeCount() const { return laik_my_rangecount(_p); }
+
+private:
+    Laik_Partitioning* _p;
+};
+
+
+// typed view on a mapping, indexed with global indexes.
+// Only valid until the container switches to another partitioning
+template<typename T, int Dims> class View;
+
+template<typename T>
+class View<T, 1> {
+public:
+    static constexpr uint64_t xstride = 1;
+
+    View() : _base(nullptr), _x0(0), _xsize(0) {}
+    View(T* base, int64_t x0, uint64_t xsize)
+        : _base(base), _x0(x0), _xsize(xsize) {}
+
+    T& operator()(int64_t x) const { return _base[x - _x0]; }
+
+    T* data() const { return _base; }
+    int64_t from(int d) const { (void) d; return _x0; }
+    int64_t to(int d) const { (void) d; return _x0 + (int64_t) _xsize; }
+    bool empty() const { return _xsize == 0; }
+
+private:
+    T* _base;
+    int64_t _x0;
+    uint64_t _xsize;
+};
+
+template<typename T>
+class View<T, 2> {
+public:
+    static constexpr uint64_t xstride = 1;
+
+    View() : _base(nullptr), _x0(0), _y0(0), _xsize(0), _ysize(0), _ystride(0) {}
+    View(T* base, int64_t x0, int64_t y0,
+         uint64_t xsize, uint64_t ysize, uint64_t ystride)
+        : _base(base), _x0(x0), _y0(y0),
+          _xsize(xsize), _ysize(ysize), _ystride(ystride) {}
+
+    T& operator()(int64_t x, int64_t y) const
+    { return _base[(y - _y0) * (int64_t) _ystride + (x - _x0)]; }
+
+    T* data() const { return _base; }
+    uint64_t ystride() const { return _ystride; }
+    int64_t from(int d) const { return (d == 0) ? _x0 : _y0; }
+    int64_t to(int d) const
+    { return (d == 0) ? _x0 + (int64_t) _xsize : _y0 + (int64_t) _ysize; }
+    bool empty() const { return (_xsize == 0) || (_ysize == 0); }
+
+private:
+    T* _base;
+    int64_t _x0, _y0;
+    uint64_t _xsize, _ysize, _ystride;
+};
+
+template<typename T>
+class View<T, 3> {
+public:
+    static constexpr uint64_t xstride = 1;
+
+    View() : _base(nullptr), _x0(0), _y0(0), _z0(0),
+             _xsize(0), _ysize(0), _zsize(0), _ystride(0), _zstride(0) {}
+    View(T* base, int64_t x0, int64_t y0, int64_t z0,
+         uint64_t xsize, uint64_t ysize, uint64_t zsize,
+         uint64_t ystride, uint64_t zstride)
+        : _base(base), _x0(x0), _y0(y0), _z0(z0),
+          _xsize(xsize), _ysize(ysize), _zsize(zsize),
+          _ystride(ystride), _zstride(zstride) {}
+
+    T& operator()(int64_t x, int64_t y, int64_t z) const
+    { return _base[(z - _z0) * (int64_t) _zstride +
+                   (y - _y0) * (int64_t) _ystride + (x - _x0)]; }
+
+    T* data() const { return _base; }
+    uint64_t ystride() const { return _ystride; }
+    uint64_t zstride() const { return _zstride; }
+    int64_t from(int d) const { return (d == 0) ? _x0 : (d == 1) ? _y0 : _z0; }
+    int64_t to(int d) const
+    { return from(d) + (int64_t) ((d == 0) ? _xsize : (d == 1) ? _ysize : _zsize); }
+    bool empty() const { return (_xsize == 0) || (_ysize == 0) || (_zsize == 0); }
+
+private:
+    T* _base;
+    int64_t _x0, _y0, _z0;
+    uint64_t _xsize, _ysize, _zsize, _ystride, _zstride;
+};
+
+namespace detail {
+
+// create view for mapping <n> of container <d>.
+// Views use inlined index arithmetic, requiring the lexicographical layout
+template<typename T, int Dims> struct MapView;
+
+template<typename T> struct MapView<T, 1> {
+    static View<T, 1> get(Laik_Data* d, int n) {
+        void* base;
+        uint64_t xsize;
+        Laik_Mapping* m = laik_get_map_1d(d, n, &base, &xsize);
+        if (!m) return View<T, 1>();
+        assert(laik_layout_is_lex(laik_map_get_layout(m)));
+        const Laik_Range* r = laik_map_get_range(m);
+        return View<T, 1>((T*) base, r->from.i[0], xsize);
+    }
+};
+
+template<typename T> struct MapView<T, 2> {
+    static View<T, 2> get(Laik_Data* d, int n) {
+        void* base;
+        uint64_t xsize, ysize, ystride;
+        Laik_Mapping* m = laik_get_map_2d(d, n, &base, &ysize, &ystride, &xsize);
+        if (!m) return View<T, 2>();
+        assert(laik_layout_is_lex(laik_map_get_layout(m)));
+        const Laik_Range* r = laik_map_get_range(m);
+        return View<T, 2>((T*) base, r->from.i[0], r->from.i[1],
+                          xsize, ysize, ystride);
+    }
+};
+
+template<typename T> struct MapView<T, 3> {
+    static View<T, 3> get(Laik_Data* d, int n) {
+        void* base;
+        uint64_t xsize, ysize, zsize, ystride, zstride;
+        Laik_Mapping* m = laik_get_map_3d(d, n, &base, &zsize, &zstride,
+                                          &ysize, &ystride, &xsize);
+        if (!m) return View<T, 3>();
+        assert(laik_layout_is_lex(laik_map_get_layout(m)));
+        const Laik_Range* r = laik_map_get_range(m);
+        return View<T, 3>((T*) base, r->from.i[0], r->from.i[1], r->from.i[2],
+                          xsize, ysize, zsize, ystride, zstride);
+    }
+};
+
+} // namespace detail
+
+
+// container with elements of type T over a <Dims>-dimensional space
+template<typename T, int Dims>
+class Data {
+public:
+    explicit Data(Space<Dims>& s, const char* name = nullptr)
+        : _d(laik_new_data(s, TypeOf<T>::get()))
+    { if (name) laik_data_set_name(_d, (char*) name); }
+    ~Data() { if (_d) laik_free(_d); }
+
+    Data(const Data&) = delete;
+    Data& operator=(const Data&) = delete;
+    Data(Data&& o) : _d(o._d) { o._d = nullptr; }
+    Data& operator=(Data&& o) {
+        if (this != &o) {
+            if (_d) laik_free(_d);
+            _d = o._d;
+            o._d = nullptr;
+        }
+        return *this;
+    }
+
+    operator Laik_Data*() const { return _d; }
+
+    // switch to partitioning <p> with given data flow
+    void switchTo(const Partitioning<Dims>& p,
+                  Laik_DataFlow flow = LAIK_DF_Preserve,
+                  Laik_ReductionOperation redOp = LAIK_RO_None)
+    { laik_switchto_partitioning(_d, p, flow, redOp); }
+
+    // keep partitioning, switch data flow (e.g. for reductions)
+    void switchTo(Laik_DataFlow flow,
+                  Laik_ReductionOperation redOp = LAIK_RO_None)
+    { laik_switchto_flow(_d, flow, redOp); }
+
+    int mapCount() const
+    { return laik_my_mapcount(laik_data_get_partitioning(_d)); }
+
+    // typed view on own mapping <n>, empty if not existing
+    View<T, Dims> map(int n = 0) const
+    { return detail::MapView<T, Dims>::get(_d, n); }
+
+private:
+    Laik_Data* _d;
+};
+
+} // namespace laik
+
+#endif // LAIK_HPP
@@ -478,10 +478,19 @@ void laik_aseq_copySeq(Laik_ActionSeq* as);
 // merge send/recv actions from oldAS into as
 bool laik_aseq_combineActions(Laik_ActionSeq* as);
 
+// is <a> a backend-independent send/recv action, and its peer rank
+bool laik_action_isSend(Laik_Action* a);
+bool laik_action_isRecv(Laik_Action* a);
+int laik_action_getPeer(Laik_Action* a);
+
 // add sorted send/recv actions from as into as2 to avoid deadlocks
 bool laik_aseq_sort_2phases(Laik_ActionSeq* as);
 bool laik_aseq_sort_rankdigits(Laik_ActionSeq* as);
 
+// sort send/recv actions by edge coloring of the communication graph,
+// resulting in rounds of disjoint pairwise exchanges
+bool laik_aseq_sort_edgecolor(Laik_ActionSeq* as);
+
 // sort actions according to their rounds, and compress rounds
 bool laik_aseq_sort_rounds(Laik_ActionSeq* as);
 
@@ -507,6 +516,10 @@ int laik_aseq_calc_stats(Laik_ActionSeq* as);
 void laik_exec_pack(Laik_BackendAction* a, Laik_Mapping* map);
 // exec action LAIK_AT_UnpackFromBuf
 void laik_exec_unpack(Laik_BackendAction* a, Laik_Mapping* map);
+// exec action LAIK_AT_CopyToBuf (gather)
+void laik_exec_copyToBuf(Laik_BackendAction* a);
+// exec action LAIK_AT_CopyFromBuf (scatter)
+void laik_exec_copyFromBuf(Laik_BackendAction* a);
 
 
 #endif // LAIK_ACTION_INTERNAL_H
@@ -64,6 +64,10 @@ struct _Laik_Backend {
   // sync of key-value store
   void (*sync)(Laik_KVStore* kvs);
 
+  // start non-blocking sync of key-value store, can be NULL.
+  // Finished by calling sync() on same KVS
+  void (*sync_start)(Laik_KVStore* kvs);
+
   // log backend-specific action, return true if handled (see laik_log_Action)
   bool (*log_action)(Laik_Action* a);
 
@@ -88,5 +92,16 @@ struct _Laik_Backend {
 };
 
 
+// optional wire compression for backends, see compress.c
+// byte shuffle for elements of <width> bytes, then LZ-style compression.
+// Returns compressed size written to <out> (capacity <outcap> bytes),
+// or 0 if data is not compressible into less than <len> bytes: send raw
+int laik_compress(const char* in, int len, int width, char* out, int outcap);
+
+// decompress <clen> bytes from <in> into <len> bytes at <out>
+// Returns false on corrupted input
+bool laik_decompress(const char* in, int clen, int width, char* out, int len);
+
+
 
 #endif // LAIK_BACKEND_H
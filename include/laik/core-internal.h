@@ -80,6 +80,7 @@ struct _Laik_Instance {
 
     // KV stores for LAIK objects
     Laik_KVStore* spaceStore;
+    Laik_KVStore* partitioningStore; // serialized range lists, by name
 
     // for time logging
     struct timeval init_time;
@@ -157,6 +158,7 @@ struct _Laik_KVS_Entry {
     char* key;
     char* value;
     unsigned int vlen;
+    unsigned int vcap; // capacity of value slot (see LAIK_KVS_SLOTCLASSES)
     bool updated;
 
     void* data; // custom user data attached to this entry
@@ -173,6 +175,18 @@ struct _Laik_KVS_Changes {
     Laik_KVS_Entry* entry;
 };
 
+// growable arena for keys/values of a KV store (chained blocks,
+// never moved to keep pointers in entries valid, freed with the store).
+// Slots are power-of-2 sized from 8 bytes up to 8 << (CLASSES-1) bytes,
+// freed slots are reused via per-class free lists; larger ones use malloc
+#define LAIK_KVS_SLOTCLASSES 14
+typedef struct _Laik_KVS_Arena Laik_KVS_Arena;
+struct _Laik_KVS_Arena {
+    Laik_KVS_Arena* next;
+    size_t size, used;
+    char data[];
+};
+
 struct _Laik_KVStore {
     Laik_Instance* inst;
     const char* name;
@@ -180,9 +194,17 @@ struct _Laik_KVStore {
     // KV array
     Laik_KVS_Entry* entry;
     unsigned int size, used;
-    // new entries are unsorted, call laik_kvs_sort to enable binary search
+    // new entries are appended, laik_kvs_sort sorts by key if requested
     unsigned int sorted_upto;
 
+    // open-addressing hash index into KV array (entry index + 1, 0: empty)
+    unsigned int* hindex;
+    unsigned int hsize; // power of 2
+
+    // storage for keys and values
+    Laik_KVS_Arena* arena;
+    char* freeSlot[LAIK_KVS_SLOTCLASSES]; // next pointer stored in slot
+
     laik_kvs_created_func created_func;
     laik_kvs_changed_func changed_func;
     laik_kvs_removed_func removed_func;
@@ -192,6 +214,10 @@ struct _Laik_KVStore {
 
     // if true, setting values will not be propagated for next sync
     bool in_sync;
+
+    // true between laik_kvs_sync_start() and laik_kvs_sync_wait():
+    // no local changes allowed
+    bool sync_pending;
 };
 
 // internal API for KVS change journal
@@ -209,4 +235,10 @@ void laik_kvs_changes_merge(Laik_KVS_Changes* dst,
                             Laik_KVS_Changes* src1, Laik_KVS_Changes* src2);
 void laik_kvs_changes_apply(Laik_KVS_Changes* c, Laik_KVStore* kvs);
 
+// binomial tree with root 0 used by backends for KVS sync among <size>
+// processes: returns number of children of <id>, written to <child>
+// in order of increasing sub-tree size. Parent (-1 for root) in <parent>
+#define LAIK_KVS_TREE_MAXCHILDREN 32
+int laik_kvs_tree(int id, int size, int* parent, int* child);
+
 #endif // LAIK_CORE_INTERNAL_H
@@ -268,6 +268,28 @@ void laik_log_append(const char* msg, ...);
 // finalize the log message build with laik_log_begin/append and print it
 void laik_log_flush(const char* msg, ...);
 
+// compile-time elimination of log levels: define LAIK_LOG_MINLEVEL (e.g.
+// via "configure --log-minlevel=2") to remove all logging code for levels
+// below it, so that disabled logging has no runtime cost at all.
+// Warnings/errors/panics can not be removed.
+#ifndef LAIK_LOG_MINLEVEL
+#define LAIK_LOG_MINLEVEL 0
+#endif
+#if LAIK_LOG_MINLEVEL > 3
+#error "LAIK_LOG_MINLEVEL must not be larger than LAIK_LL_Warning (3)"
+#endif
+
+// without LAIK_LOG_MINLEVEL, no wrappers: calls go to the functions directly.
+// Cast laik_log_begin to void if its result is not used.
+#if LAIK_LOG_MINLEVEL > 0
+#define laik_log(l, ...) \
+    do { if ((l) >= LAIK_LOG_MINLEVEL) (laik_log)(l, __VA_ARGS__); } while(0)
+#define laik_log_shown(l) \
+    (((l) >= LAIK_LOG_MINLEVEL) && (laik_log_shown)(l))
+#define laik_log_begin(l) \
+    (((l) >= LAIK_LOG_MINLEVEL) && (laik_log_begin)(l))
+#endif
+
 
 /*********************************************************************/
 /* KV Store
@@ -313,6 +335,14 @@ bool laik_kvs_remove(Laik_KVStore* kvs, char* key);
 // synchronize KV store
 void laik_kvs_sync(Laik_KVStore* kvs);
 
+// start synchronization of KV store, to be finished with laik_kvs_sync_wait.
+// In-between, communication can be overlapped with computation.
+// The KV store must not be modified until laik_kvs_sync_wait returns
+void laik_kvs_sync_start(Laik_KVStore* kvs);
+
+// wait for synchronization of KV store started with laik_kvs_sync_start
+void laik_kvs_sync_wait(Laik_KVStore* kvs);
+
 // get data and size via *psize (warning: may get invalid on updates)
 char* laik_kvs_get(Laik_KVStore* kvs, char* key, unsigned int *psize);
 
@@ -337,7 +367,7 @@ char* laik_kvs_data(Laik_KVS_Entry* e, unsigned int *psize);
 // deep copy of entry data, at most <size> bytes, returns bytes copied
 unsigned int laik_kvs_copy(Laik_KVS_Entry* e, char* mem, unsigned int size);
 
-// sort KVS entries for faster access (done after sync)
+// sort KVS entries by key (for ordered iteration via laik_kvs_getn)
 void laik_kvs_sort(Laik_KVStore* kvs);
 
 // register functions to be called when entries are created/changed/removed in sync
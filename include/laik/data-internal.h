@@ -25,16 +25,27 @@
 // kinds of data types supported by Laik
 typedef enum _Laik_TypeKind {
     LAIK_TK_None = 0,
-    LAIK_TK_POD       // "Plain Old Data", just a sequence of bytes
+    LAIK_TK_POD,      // "Plain Old Data", just a sequence of bytes
+    LAIK_TK_Compound  // named fields of POD types, stored as struct of arrays
 } Laik_TypeKind;
 
+// field of a compound type
+typedef struct _Laik_TypeField {
+    char* name;
+    Laik_Type* type;
+} Laik_TypeField;
+
 // a data type
 struct _Laik_Type {
     char* name;
     int id;
 
     Laik_TypeKind kind;
-    int size;      // in bytes (for POD)
+    int size;      // in bytes (for POD), sum of field sizes (for compound)
+
+    // fields of compound type (allocated only for compound types)
+    int fieldCount, fieldCapacity;
+    Laik_TypeField* field;
 
     // callbacks for reductions
     // initialize values of this type with neutral element
@@ -63,7 +74,8 @@ struct _Laik_SwitchStat
     uint64_t elemSendCount, elemRecvCount, elemReduceCount;
     uint64_t byteSendCount, byteRecvCount, byteReduceCount;
     uint64_t initOpCount, reduceOpCount, byteBufCopyCount;
-
+    // data received for indexes not held before a switch (without reductions)
+    uint64_t migratedBytes;
 };
 
 Laik_SwitchStat* laik_newSwitchStat(void);
@@ -119,9 +131,21 @@ struct _Laik_Data {
     // layout factory for generating layouts to use with mappings
     laik_layout_factory_t layout_factory;
 
+    // for compound type: one container per field (struct of arrays),
+    // data is transferred in transitions only for fields in <fieldMask>
+    Laik_Data** field;
+    uint64_t fieldMask;
+
     // can be set by backend
     void* backend_data;
 
+    // prefetch for later switch to <prefetchPartitioning> (0 if none)
+    Laik_Partitioning* prefetchPartitioning;
+    Laik_MappingList* prefetchMappings;
+    Laik_Transition* prefetchTransition;
+    int prefetchSteps, prefetchStepsDone;
+    bool* prefetchDirty; // per step: sent data changed afterwards
+
     // statistics
     Laik_SwitchStat* stat;
 };
@@ -60,6 +60,22 @@ void laik_type_set_init(Laik_Type* type, laik_init_t init);
 // provide a reduction function for this type
 void laik_type_set_reduce(Laik_Type* type, laik_reduce_t reduce);
 
+// compound type consisting of named fields, stored as struct of arrays:
+// containers of this type keep each field in its own field container
+// (see laik_data_get_field). Fields are added with laik_type_add_field
+#define LAIK_MAX_FIELDS 64
+Laik_Type* laik_type_new_compound(char* name);
+
+// add field <name> of POD type <ft> to compound type, return field number.
+// Must be done before creating containers with this type
+int laik_type_add_field(Laik_Type* t, char* name, Laik_Type* ft);
+
+// number of fields of a compound type (0 for other types)
+int laik_type_get_fieldcount(Laik_Type* t);
+
+// return number of field named <name> in compound type, -1 if not found
+int laik_type_get_field(Laik_Type* t, char* name);
+
 
 //----------------------------------
 // LAIK data container
@@ -91,12 +107,23 @@ Laik_Group* laik_data_get_group(Laik_Data* d);
 // get instance managing data
 Laik_Instance* laik_data_get_inst(Laik_Data* d);
 
-// get active partitioning of data container
+// get active partitioning of data container. For compound containers,
+// this is 0 if fields use different partitionings (see fieldmask below)
 Laik_Partitioning* laik_data_get_partitioning(Laik_Data* d);
 
 // free resources for a data container
 void laik_free(Laik_Data*);
 
+// for container of compound type: return container for field <f>,
+// to be used for accessing mappings of this field
+Laik_Data* laik_data_get_field(Laik_Data* d, int f);
+
+// for container of compound type: restrict following switches/transitions
+// to fields with bit set in <mask> (bit f for field f). Other fields keep
+// their current partitioning and values. Default: all fields
+#define LAIK_FIELDS_ALL (~((uint64_t) 0))
+void laik_data_set_fieldmask(Laik_Data* d, uint64_t mask);
+
 // type for layout factory: create new layout, given <n> ranges to cover
 typedef Laik_Layout* (*laik_layout_factory_t)(int n, Laik_Range*);
 
@@ -156,6 +183,72 @@ Laik_TaskRange* laik_data_range(Laik_Data* d, int n);
 // - by providing direct memory resources, see laik_data_provide_memory()
 void laik_set_initial_partitioning(Laik_Data* d, Laik_Partitioning* p);
 
+// prefetch data for a later switch to partitioning <toP> (with preserve
+// flow), in <steps> collective steps (slabs in 1st dimension) done by
+// laik_data_prefetch_step(). Meanwhile, the active partitioning stays
+// usable, e.g. for old processes to continue working after world growth
+// while new processes get their data. The final switch to <toP> only
+// transfers what is left, copies data kept locally, and sends again the
+// slabs with data changed after being sent (see below)
+void laik_data_prefetch_start(Laik_Data* d, Laik_Partitioning* toP, int steps);
+
+// do next prefetch step. Returns false if all steps are done
+bool laik_data_prefetch_step(Laik_Data* d);
+
+// tell a running prefetch that own data in range <r> was changed. Slabs
+// already sent which overlap <r> get sent again on the final switch.
+// Without this, other processes get old values for changed data
+void laik_data_prefetch_invalidate(Laik_Data* d, const Laik_Range* r);
+
+
+// In-memory buddy checkpointing (diskless), see checkpoint.c
+typedef struct _Laik_Checkpoint Laik_Checkpoint;
+
+// create checkpoint object for container <d>, keeping copies of own
+// ranges at <redundancy> (1 or 2) buddy processes, on other nodes if
+// possible. Memory for 2 checkpoints is used, to always keep a valid one.
+// Collective among all processes in current world
+Laik_Checkpoint* laik_checkpoint_new(Laik_Data* d, int redundancy);
+
+// start a checkpoint of the current values of own ranges. Copies are
+// distributed in <steps> collective steps done by laik_checkpoint_step()
+// (0: immediately), allowing to go on working on the container meanwhile
+void laik_checkpoint_start(Laik_Checkpoint* c, int steps);
+
+// do next distribution step. Returns false if all steps are done
+bool laik_checkpoint_step(Laik_Checkpoint* c);
+
+// complete distribution of copies started with laik_checkpoint_start()
+void laik_checkpoint_finish(Laik_Checkpoint* c);
+
+// is there a completed checkpoint to restore from?
+bool laik_checkpoint_valid(Laik_Checkpoint* c);
+
+// restore containers of <count> checkpoints after tasks in list <failed>
+// of the containers' group failed (e.g. as reported by laik_get_failed).
+// Returns shrinked group without failed tasks, with the containers
+// switched to partitionings of that group: lost ranges are taken over by
+// buddies, with values from the last completed checkpoint. Only local
+// copies are done. Returns 0 if data of a failed task cannot be restored
+Laik_Group* laik_checkpoint_restore(int count, Laik_Checkpoint** list,
+                                    int failedCount, int* failed);
+
+void laik_checkpoint_free(Laik_Checkpoint* c);
+
+
+// Parallel file I/O, see io.c
+
+// collectively write values of container <d> into file <path>. Each
+// process writes the own ranges of the active partitioning at their
+// global offsets. Returns true if successful on all processes
+bool laik_data_write(Laik_Data* d, const char* path);
+
+// collectively read values of container <d> from file <path> written by
+// laik_data_write(), into the own ranges of the active partitioning (which
+// may differ from the one used for writing). Returns false if the file
+// does not match space/type of <d> or on errors
+bool laik_data_read(Laik_Data* d, const char* path);
+
 
 // convenience functions
 
@@ -254,6 +347,25 @@ int64_t laik_maplocal2global_1d(Laik_Data* d, int mapNo, uint64_t li);
 // return the mapping number of a <map> in the MappingList
 int laik_map_get_mapNo(const Laik_Mapping* map);
 
+// return the range of global indexes covered by mapping <map>
+const Laik_Range* laik_map_get_range(const Laik_Mapping* map);
+
+// return the memory layout used by mapping <map>
+Laik_Layout* laik_map_get_layout(const Laik_Mapping* map);
+
+// lexicographically ordered block of a mapping, for direct access
+// element (x,y,z) is at base + (x - from.x) + (y - from.y) * stride[1]
+//                         + (z - from.z) * stride[2]
+typedef struct _Laik_Tile {
+    Laik_Range range;    // global indexes covered (within allocation)
+    char* base;          // address of element at range.from
+    uint64_t stride[3];  // stride[0] is always 1
+} Laik_Tile;
+
+// get tile of mapping <map> containing index <idx> into <t>.
+// Returns false if the layout of the mapping does not provide tiles
+bool laik_map_get_tile(Laik_Mapping* map, Laik_Index* idx, Laik_Tile* t);
+
 // 2d global to 2d local
 // if global coordinate (gx/gy) is in local mapping, set output parameters
 //  (lx/ly) and return mapping, otherwise return false
@@ -330,6 +442,16 @@ typedef unsigned int (*laik_layout_unpack_t)(
 // return string describing the layout (for debug output)
 typedef char* (*laik_layout_describe_t)(Laik_Layout*);
 
+// optional: for index <idx> in section <n>, return the range of the
+// lexicographically ordered block (tile) containing it, the offset of
+// the block start and the strides within the block
+typedef bool (*laik_layout_tile_t)(Laik_Layout*, int n, Laik_Index* idx,
+                                   Laik_Range* range, int64_t* off,
+                                   uint64_t* stride);
+
+// optional: free resources of layout beside the layout object itself
+typedef void (*laik_layout_release_t)(Laik_Layout*);
+
 // public as it is the header of custom layouts
 struct _Laik_Layout {
     int dims;
@@ -344,6 +466,10 @@ struct _Laik_Layout {
     laik_layout_pack_t pack;
     laik_layout_unpack_t unpack;
     laik_layout_copy_t copy;
+
+    // optional, set to 0 by laik_init_layout
+    laik_layout_tile_t tile;
+    laik_layout_release_t release;
 };
 
 void laik_init_layout(Laik_Layout* l, int dims, int map_count, uint64_t count,
@@ -360,6 +486,9 @@ void laik_init_layout(Laik_Layout* l, int dims, int map_count, uint64_t count,
 void laik_layout_copy_gen(Laik_Range* range,
                           Laik_Mapping* from, Laik_Mapping* to);
 
+// free a layout object, calling its release function if set
+void laik_free_layout(Laik_Layout* l);
+
 
 // lexicographical layout covering one 1d, 2d, 3d range
 
@@ -368,10 +497,29 @@ void laik_layout_copy_gen(Laik_Range* range,
 // with innermost dim x, then y, z, fully covering given ranges
 Laik_Layout* laik_new_layout_lex(int n, Laik_Range* ranges);
 
+// is <l> a lexicographical layout?
+bool laik_layout_is_lex(Laik_Layout* l);
+
 // return stride for dimension <d> in lex layout mapping <n>
 uint64_t laik_layout_lex_stride(Laik_Layout* l, int n, int d);
 
 
+// tiled layouts for 2d/3d ranges (1d falls back to lex layout)
+// - tiles are aligned to multiples of the tile size in the global index
+//   space, tiles at range borders are cut (no padding)
+// - elements within a tile are stored in lexicographical order
+// - tiled: tiles ordered lexicographically
+// - morton: tiles ordered along a Z-order (Morton) curve;
+//   with tile size 1, this is the element-wise Z-order layout
+Laik_Layout* laik_new_layout_tiled(int n, Laik_Range* ranges);
+Laik_Layout* laik_new_layout_morton(int n, Laik_Range* ranges);
+
+// set tile size for tiled/morton layouts created afterwards.
+// Default is 32x32 for 2d, 16x8x8 for 3d, or as given in env var
+// LAIK_LAYOUT_TILE (format "<x>x<y>[x<z>]")
+void laik_layout_set_tilesize(int64_t x, int64_t y, int64_t z);
+
+
 //----------------------------------
 // Allocator interface
 //
@@ -404,10 +552,15 @@ struct _Laik_Allocator {
     Laik_free_t free;
     Laik_realloc_t realloc;
 
-    // notification to allocator that a part of the data is about to be
-    // transfered by the communication backend and should be made consistent
-    // (used with LAIK_MP_NotifyOnChange)
+    // notification to allocator that a part of the data is not used
+    // anymore, after it was transfered by the communication backend
+    // (used with LAIK_MP_NotifyOnChange, may be 0)
     void (*unmap)(Laik_Data* d, void* ptr, size_t length);
+
+    // notification to allocator that memory of a mapping is used in the
+    // new partitioning, before data is transfered by the communication
+    // backend (used with LAIK_MP_NotifyOnChange, may be 0)
+    void (*map)(Laik_Data* d, void* ptr, size_t length);
 };
 
 Laik_Allocator* laik_new_allocator(Laik_malloc_t, Laik_free_t, Laik_realloc_t);
@@ -419,5 +572,14 @@ Laik_Allocator* laik_new_allocator_def();
 // predefined allocator
 extern Laik_Allocator *laik_allocator_def;
 
+// allocator for out-of-core containers, see allocator_mmap.c:
+// mappings are slices of a scratch file <path>.<pid> (file is unlinked
+// on creation, so no data is left over). With policy
+// LAIK_MP_NotifyOnChange, memory of mappings in the active partitioning
+// is prefetched (madvise WILLNEED) on a switch, memory of mappings not
+// used anymore is released (madvise DONTNEED). If <path> is 0, path
+// from env var LAIK_MMAP_PATH is used, default is "/tmp/laik-mmap"
+Laik_Allocator* laik_new_allocator_mmap(const char* path);
+
 
 #endif // LAIK_DATA_H
@@ -20,20 +20,98 @@
 #define LAIK_PROFILING_INTERNAL
 
 #include <stdbool.h>      // for bool
+#include <stdint.h>       // for uint64_t
 #include "definitions.h"  // for MAX_FILENAME_LENGTH
+#include "action.h"       // for Laik_Action
+#include "core.h"         // for Laik_Instance
+
+// number of hardware counters sampled if LAIK_PERF_COUNTERS is set
+#define LAIK_PERF_COUNTERS 4
 
 struct _Laik_Profiling_Controller
 {
     // is profiling currently active?
     bool do_profiling;
     bool user_timer_active;
+    // nesting depth of laik_profile_laik_start calls
+    int laik_timer_depth;
 
     double timer_total, timer_backend, timer_user;
     double time_total, time_backend, time_user;
 
+    // hardware counters: values at start of LAIK/user time span and
+    // sums since last laik_writeout_profile
+    uint64_t perf_start_laik[LAIK_PERF_COUNTERS];
+    uint64_t perf_start_user[LAIK_PERF_COUNTERS];
+    uint64_t perf_laik[LAIK_PERF_COUNTERS];
+    uint64_t perf_user[LAIK_PERF_COUNTERS];
+
     char filename[MAX_FILENAME_LENGTH];
     // to avoid including <stdio.h> here: use void* instead of FILE*
     void* profile_file;
 };
 
+// mark begin/end of time spent in LAIK (calls may be nested), to measure
+// LAIK total time and attribute hardware counter values
+void laik_profile_laik_start(Laik_Instance* i);
+void laik_profile_laik_stop(Laik_Instance* i);
+
+//
+// hardware counters, enabled by setting LAIK_PERF_COUNTERS=1
+//
+// Cycles, instructions, last-level cache misses and backend stall cycles
+// of the calling thread (user-level only) are read via perf_event_open at
+// begin/end of LAIK and user time spans of the instance with profiling
+// enabled. laik_writeout_profile appends the sums since the previous
+// writeout (LAIK time first, then user time) to its line, so each line
+// covers the phase/iteration given in it. Counters not supported by the
+// CPU are reported as 0.
+
+//
+// event tracing, enabled by setting LAIK_TRACE=<file prefix>
+//
+// Time spans of transitions, backend prepare steps, action rounds and
+// individual actions are recorded into a per-process ring buffer (only
+// written by the LAIK thread, no locking), overwriting oldest events if
+// full (size: LAIK_TRACE_SIZE events). At laik_finalize, the buffer is
+// written as Chrome trace JSON to <prefix>-<location id>.json, with one
+// process per LAIK location. Use tools/trace/laik-trace-merge.sh to merge files
+// of all processes into one timeline (chrome://tracing, Perfetto).
+
+extern bool laik_trace_enabled;
+
+// called by laik_init_profiling
+void laik_trace_init(void);
+// start time of next prepare step recorded via laik_trace_step
+void laik_trace_mark(void);
+// record event with time span from <start> to now. <name> must be static,
+// <detail> (may be 0) is copied. Use -1 for unknown <round>/<peer>
+void laik_trace_event(const char* cat, const char* name, const char* detail,
+                      double start, int round, int peer);
+// record prepare step <name> with time span since last mark/event
+void laik_trace_step(const char* name);
+// record execution of backend-independent action <a>, started at <start>
+void laik_trace_action(Laik_Action* a, double start);
+// write out trace, called by laik_finalize
+void laik_trace_writeout(Laik_Instance* inst);
+
+//
+// communication matrix, enabled by setting LAIK_COMM_MATRIX=<file prefix>
+//
+// Backends report messages, bytes and time blocked in send/recv per peer
+// location. Counters are kept per program phase (see laik_set_phase).
+// At laik_finalize, counters of all processes are collected via a KV store
+// and written by task 0 as <prefix>.csv and <prefix>.json
+
+extern bool laik_commstat_enabled;
+
+// called by laik_init_profiling
+void laik_commstat_init(void);
+// account <msgs> messages with <bytes> sent to (<isSend>) or received from
+// location <lid>, and <waitTime> seconds blocked in the backend
+void laik_commstat_add(Laik_Instance* inst, int lid, bool isSend,
+                       int msgs, uint64_t bytes, double waitTime);
+// collect matrix and write files, called by laik_finalize (collective)
+void laik_commstat_writeout(Laik_Instance* inst);
+
 #endif // LAIK_PROFILING_INTERNAL
@@ -51,13 +51,26 @@ struct _Laik_Partitioner {
     laik_run_partitioner_t run;
     Laik_PartitionerFlag flags;
     void* data; // partitioner specific data
+    uint64_t cacheKey; // user-provided key for parameters, 0 if not set
 };
 
+// internal: FNV-1a hash over <len> bytes at <d>, continuing from <h>
+uint64_t laik_hash64(uint64_t h, const void* d, size_t len);
+#define LAIK_HASH64_INIT 14695981039346656037ULL
+
+// internal: key for parameters of partitioner <pr> (including user-provided
+// key), false if parameters not known (i.e. not allowed to be cached)
+bool laik_partitioner_paramkey(Laik_Partitioner* pr, uint64_t* key);
+
 // context during a partitioner run, to filter and forward ranges
 struct _Laik_RangeReceiver {
     Laik_RangeList* list;
     Laik_RangeFilter* filter;
     Laik_PartitionerParams* params;
+
+    // ranges of base partitioning calculated for this run, if
+    // base partitioning only stores a subset (see laik_partitioner_otherranges)
+    Laik_RangeList* otherList;
 };
 
 
@@ -77,11 +90,28 @@ typedef struct _Laik_TaskRange_Gen {
     int mapNo;
 } Laik_TaskRange_Gen;
 
-// for single-index ranges in 1d
-typedef struct _Laik_TaskRange_Single1d {
-    int task;
-    int64_t idx;
-} Laik_TaskRange_Single1d;
+// compressed set of single 1d indexes (see indexset.c), used for
+// indexes added with laik_append_index_1d
+typedef struct _Laik_IndexSet Laik_IndexSet;
+
+Laik_IndexSet* laik_indexset_new(void);
+void laik_indexset_free(Laik_IndexSet* s);
+void laik_indexset_add(Laik_IndexSet* s, int64_t idx);
+
+// call <f> for each maximal run [from;to[ of indexes in order, return count
+typedef void (*laik_indexset_run_t)(void* ctx, int64_t from, int64_t to);
+unsigned int laik_indexset_runs(Laik_IndexSet* s,
+                                laik_indexset_run_t f, void* ctx);
+// same, only for indexes within [from;to[
+unsigned int laik_indexset_runs_in(Laik_IndexSet* s, int64_t from, int64_t to,
+                                   laik_indexset_run_t f, void* ctx);
+// same, for indexes in both <s1> and <s2>
+unsigned int laik_indexset_intersect(Laik_IndexSet* s1, Laik_IndexSet* s2,
+                                     laik_indexset_run_t f, void* ctx);
+// is any index of <s> within [from;to[ ?
+bool laik_indexset_intersects(Laik_IndexSet* s, int64_t from, int64_t to);
+// set [from;to[ to smallest range covering all indexes, false if empty
+bool laik_indexset_bounds(Laik_IndexSet* s, int64_t* from, int64_t* to);
 
 // generic reference to a task range by indexing into a range list
 struct _Laik_TaskRange {
@@ -94,15 +124,25 @@ struct _Laik_TaskRange {
 // ordered by task id, then mapping id, then index ordering
 struct _Laik_RangeList {
     Laik_Space* space;
-    unsigned int tid_count; // size of <off> array
+    unsigned int tid_count; // number of task ids
 
     unsigned int capacity;   // ranges allocated
     unsigned int count;      // ranges used
 
     Laik_TaskRange_Gen* trange; // range array
-    Laik_TaskRange_Single1d* tss1d; // specific array used during collection
 
-    // calculated on freezing
+    // single index format: indexes per task, also kept after freezing.
+    // Then <count>/<off> refer to runs of indexes, which only get
+    // converted into generic ranges of a task on access (<siRange>).
+    // After freezing, both are indexed like <off>
+    Laik_IndexSet** iset;
+    Laik_TaskRange_Gen** siRange;
+
+    // calculated on freezing: ranges of i-th task are at [off[i];off[i+1][.
+    // If only few tasks have ranges, just these are stored (sorted ids in
+    // <tasks>), otherwise all (<tasks> is 0). Use laik_rangelist_off()
+    unsigned int taskCount;  // number of tasks in <off>
+    int* tasks;
     unsigned int* off;       // offsets into ranges, ordered by task id
 
     // for fast access to ranges within mappings from a task with given id
@@ -118,11 +158,15 @@ struct _Laik_RangeList {
 typedef bool
     (*laik_filterFunc_t)(Laik_RangeFilter*, int task, const Laik_Range* r);
 
-// for intersection partitioning filter
+// for intersection partitioning filter: copy of ranges to check against.
+// in 1d, ranges are sorted and merged, allowing for binary search.
+// For ranges in single index format, their index set is used instead
 typedef struct {
-    int64_t from, to;
-    Laik_TaskRange_Gen* ts;
+    Laik_Range bbox; // bounding box of all ranges
+    Laik_Range* range;
     unsigned int len;
+    Laik_IndexSet* iset; // if set: indexes enlarged by <reach>, not owned
+    int reach;
 } PFilterPar;
 
 // parameters for filtering ranges on a partitioner run
@@ -140,6 +184,23 @@ struct _Laik_RangeFilter {
     PFilterPar *pfilter1, *pfilter2;
 };
 
+// internal: run partitioner of <p> with filter, without storing ranges
+Laik_RangeList* laik_partitioning_calc_ranges(Laik_Partitioning* p,
+                                              Laik_RangeFilter* sf);
+
+// internal: ranges of <p> required for a transition between <p> and <p2>,
+// calculated on demand if not all ranges are stored
+Laik_RangeList* laik_partitioning_transranges(Laik_Partitioning* p,
+                                              Laik_Partitioning* p2);
+
+// internal: copy of filter with regions of intersection filters
+// enlarged by <reach> in each dimension
+Laik_RangeFilter* laik_rangefilter_enlarged(Laik_RangeFilter* sf, int reach);
+
+// internal: may ranges of tasks [fromTask;toTask[ within <r> pass filter?
+bool laik_rangefilter_check(Laik_RangeFilter* sf,
+                            int fromTask, int toTask, const Laik_Range* r);
+
 // meta info about range lists stored with partitionings (RI = range info)
 // this gets set when running partitioner with specific filter
 typedef enum _RangeInfo {
@@ -171,6 +232,7 @@ struct _Laik_Partitioning {
 
     // optional: partitioner to be called
     Laik_Partitioner* partitioner; // if set: creating partitioner
+    Laik_Group* pgroup; // group to run partitioner for (before migrations)
 
     // base partitioning, used with partitioner or chained partitionings
     Laik_Partitioning* other;
@@ -179,6 +241,17 @@ struct _Laik_Partitioning {
 void laik_free_partitioning(Laik_Partitioning* p);
 void laik_updateMapOffsets(Laik_RangeList* list, int tid);
 
+// internal: generic task range number <o> of frozen <list>. In single
+// index format, ranges of a task are converted on first access
+Laik_TaskRange_Gen* laik_rangelist_trange(Laik_RangeList* list, unsigned int o);
+
+// internal: offset of first range of task <tid> in frozen <list>, i.e.
+// ranges of <tid> are at [off(tid);off(tid+1)[. <tid> may be tid_count
+unsigned int laik_rangelist_off(Laik_RangeList* list, int tid);
+
+// internal: index set of task <tid> in frozen <list>, 0 if none
+Laik_IndexSet* laik_rangelist_iset(Laik_RangeList* list, int tid);
+
 
 
 //
@@ -255,6 +255,11 @@ void laik_rangelist_append_single1d(Laik_RangeList* list, int tid, int64_t idx);
 void laik_rangelist_freeze(Laik_RangeList* list, bool doMerge);
 // translate task ids using <idmap> array
 void laik_rangelist_migrate(Laik_RangeList* list, int* idmap, unsigned int new_count);
+// serialize frozen list into compact binary format (buffer to be freed)
+char* laik_rangelist_serialize(Laik_RangeList* list, unsigned int* psize);
+// append ranges from serialized list, false if not matching space/task count
+bool laik_rangelist_append_serialized(Laik_RangeList* list,
+                                      char* buf, unsigned int size);
 
 // does this list cover the full space with one range for each process?
 bool laik_rangelist_isAll(Laik_RangeList* list);
@@ -368,6 +373,17 @@ void laik_append_range(Laik_RangeReceiver* r, int task, const Laik_Range* s,
 // append 1d single-index range
 void laik_append_index_1d(Laik_RangeReceiver* r, int task, int64_t idx);
 
+// may ranges of tasks [fromTask;toTask[ within <s> be stored in this run?
+// if false, a partitioner can skip calculating these ranges
+bool laik_rangereceiver_wants(Laik_RangeReceiver* r,
+                              int fromTask, int toTask, const Laik_Range* s);
+
+// ranges of base partitioning to derive ranges from. If the base only stores
+// a subset of its ranges (scalable mode), these are calculated on demand:
+// only the ones intersecting with the region of interest for this run,
+// enlarged by <reach>, i.e. the maximal distance of a derived range
+Laik_RangeList* laik_partitioner_otherranges(Laik_RangeReceiver* r, int reach);
+
 
 /**
  * Laik_Partitioning
@@ -403,6 +419,29 @@ Laik_Partitioning* laik_new_partitioning(Laik_Partitioner* pr,
                                          Laik_Group* g, Laik_Space* space,
                                          Laik_Partitioning* otherP);
 
+// create a partitioning with ranges calculated only once (by process <root>
+// of <g>, or each process its own ranges if <root> is -1), distributed via
+// the backend. Ranges are cached by <name> for reuse in further calls.
+// Must be called by all processes of the instance
+Laik_Partitioning* laik_new_shared_partitioning(Laik_Partitioner* pr,
+                                                Laik_Group* g, Laik_Space* space,
+                                                Laik_Partitioning* otherP,
+                                                char* name, int root);
+
+// scalable mode: new partitionings only store own ranges, ranges of other
+// processes intersecting own ranges are calculated on demand in transitions.
+// Default set by environment variable LAIK_PARTITIONING_SCALABLE.
+// Partitioners may be re-run: do not change their parameters afterwards
+void laik_set_scalable_partitionings(bool enable);
+bool laik_scalable_partitionings(void);
+
+// persistent cache for partitionings in directory <dir> (0 disables): on
+// creation, ranges are loaded from a cache file if one matches partitioner,
+// parameters, space, group size and base partitioning. Partitioners using
+// weights or custom partitioners need a key set via
+// laik_partitioner_set_cachekey(). Default by env var LAIK_PARTITIONING_CACHE
+void laik_set_partitioning_cache(const char* dir);
+
 // new partitioning taking ranges from another, migrating to new group
 Laik_Partitioning* laik_new_migrated_partitioning(Laik_Partitioning* other,
                                                   Laik_Group* newg);
@@ -472,6 +511,10 @@ int laik_taskrange_get_tag(Laik_TaskRange* trange);
 // get a custom data pointer from the partitioner
 void* laik_partitioner_data(Laik_Partitioner* partitioner);
 
+// set key for partitioner parameters unknown to LAIK (e.g. a hash over
+// weights or custom data), enabling the persistent partitioning cache
+void laik_partitioner_set_cachekey(Laik_Partitioner* pr, uint64_t key);
+
 
 // check for assumptions an application may have about a partitioning
 bool laik_partitioning_isAll(Laik_Partitioning* p);
@@ -493,10 +536,18 @@ Laik_Partitioner* laik_new_master_partitioner(void);
 Laik_Partitioner* laik_new_copy_partitioner(int fromDim, int toDim);
 Laik_Partitioner* laik_new_cornerhalo_partitioner(int depth);
 Laik_Partitioner* laik_new_halo_partitioner(int depth);
+Laik_Partitioner* laik_new_deephalo_partitioner(int radius, int steps);
 Laik_Partitioner* laik_new_bisection_partitioner(void);
 Laik_Partitioner* laik_new_grid_partitioner(int xblocks, int yblocks,
                                             int zblocks);
 
+// deep halos for communication-avoiding stencils: get range of own range <n>
+// in deep-halo partitioning <p> to update at <step> (0 <= step < steps)
+// after a halo exchange. The range shrinks by the stencil radius per step,
+// and contains the range of the base partitioning at the last step
+bool laik_deephalo_range(Laik_Partitioning* p, int n, int step,
+                         Laik_Range* range);
+
 // block partitioner
 typedef double (*Laik_GetIdxWeight_t)(Laik_Index*, const void* userData);
 typedef double (*Laik_GetTaskWeight_t)(int rank, const void* userData);
@@ -538,6 +589,11 @@ laik_new_reassign_partitioner(Laik_Group* newg,
                               Laik_GetIdxWeight_t getIdxW,
                               const void* userData);
 
+// for reassign partitioners: instead of spreading indexes of removed tasks
+// over all remaining tasks, merge them into adjacent ranges of remaining
+// tasks. Always used for 2d/3d spaces
+void laik_set_reassign_adjacent(Laik_Partitioner* pr, bool adjacent);
+
 
 // get local index from global one. return false if not local
 bool laik_index_global2local(Laik_Partitioning*,
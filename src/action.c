@@ -86,7 +86,7 @@ void laik_aseq_free(Laik_ActionSeq* as)
     laik_log(1, "free action seq '%s' (%d actions, %d buffers)",
              as->name, as->actionCount, as->bufferCount);
 
-    if (as->backend) {
+    if (as->backend && as->backend->cleanup) {
         // ask backend to do its own cleanup for this action sequence
         (as->backend->cleanup)(as);
     }
@@ -1597,8 +1597,7 @@ void addResorted(unsigned int count, Laik_Action** order, Laik_ActionSeq* as)
     }
 }
 
-static
-int getActionPeer(Laik_Action* a)
+int laik_action_getPeer(Laik_Action* a)
 {
     switch(a->type) {
     case LAIK_AT_RBufSend: return ((Laik_A_RBufSend*)a)->to_rank;
@@ -1635,8 +1634,8 @@ int cmp2phase(const void* aptr1, const void* aptr2)
     bool a2isSend = laik_action_isSend(a2);
     bool a1isRecv = laik_action_isRecv(a1);
     bool a2isRecv = laik_action_isRecv(a2);
-    int a1peer = (a1isSend || a1isRecv) ? getActionPeer(a1) : 0;
-    int a2peer = (a2isSend || a2isRecv) ? getActionPeer(a2) : 0;
+    int a1peer = (a1isSend || a1isRecv) ? laik_action_getPeer(a1) : 0;
+    int a2peer = (a2isSend || a2isRecv) ? laik_action_getPeer(a2) : 0;
 
     int a1phase = 0;
     if (a1isRecv) a1phase = (a1peer < myid4cmp) ? 1 : 4;
@@ -1724,8 +1723,8 @@ int cmp_rankdigits(const void* aptr1, const void* aptr2)
     bool a2isSend = laik_action_isSend(a2);
     bool a1isRecv = laik_action_isRecv(a1);
     bool a2isRecv = laik_action_isRecv(a2);
-    int a1peer = getActionPeer(a1);
-    int a2peer = getActionPeer(a2);
+    int a1peer = laik_action_getPeer(a1);
+    int a2peer = laik_action_getPeer(a2);
 
     // phase number is number of lower digits equal to my rank
     int a1phase = 0, a2phase = 0, mask = 0;
@@ -1809,6 +1808,247 @@ bool laik_aseq_sort_rankdigits(Laik_ActionSeq* as)
 }
 
 
+// helpers for edge-coloring based action sorting
+
+// edge in the communication graph of a transition (t1 < t2)
+typedef struct {
+    int t1, t2;
+    int color;
+} CommEdge;
+
+static
+int cmp_commedge(const void* p1, const void* p2)
+{
+    const CommEdge* e1 = (const CommEdge*) p1;
+    const CommEdge* e2 = (const CommEdge*) p2;
+    if (e1->t1 != e2->t1) return e1->t1 - e2->t1;
+    return e1->t2 - e2->t2;
+}
+
+// do ranges <r1> and <r2> of a <dims>-dimensional space intersect?
+static
+bool rangesIntersect(int dims, Laik_Range* r1, Laik_Range* r2)
+{
+    for(int d = 0; d < dims; d++) {
+        if (r1->from.i[d] >= r2->to.i[d]) return false;
+        if (r2->from.i[d] >= r1->to.i[d]) return false;
+    }
+    return true;
+}
+
+// calculate the edges of the global communication graph of transition <t>:
+// tasks i != j are connected if a range of i in the from-partitioning
+// intersects a range of j in the to-partitioning (or vice versa).
+// The graph is computed from global range lists, thus each process
+// gets the same result. Edges are returned sorted and without duplicates.
+// Returns -1 if the graph cannot be derived from the transition
+static
+int calcCommEdges(Laik_Transition* t, CommEdge** pEdges)
+{
+    Laik_Partitioning* fromP = t->fromPartitioning;
+    Laik_Partitioning* toP = t->toPartitioning;
+    if ((fromP == 0) || (toP == 0)) return -1;
+    if ((fromP->group != t->group) || (toP->group != t->group)) return -1;
+    // send/recv actions for reductions do not follow from/to overlaps
+    if (laik_is_reduction(t->redOp)) return -1;
+
+    Laik_RangeList* fromList = laik_partitioning_allranges(fromP);
+    Laik_RangeList* toList = laik_partitioning_allranges(toP);
+    if ((fromList == 0) || (toList == 0)) return -1;
+
+    int dims = t->space->dims;
+    int capacity = 16, count = 0;
+    CommEdge* e = malloc(capacity * sizeof(CommEdge));
+    for(unsigned int i = 0; i < fromList->count; i++) {
+        Laik_TaskRange_Gen* fr = laik_rangelist_trange(fromList, i);
+        for(unsigned int j = 0; j < toList->count; j++) {
+            Laik_TaskRange_Gen* tr = laik_rangelist_trange(toList, j);
+            if (fr->task == tr->task) continue;
+            if (!rangesIntersect(dims, &(fr->range), &(tr->range))) continue;
+            if (count == capacity) {
+                capacity = 2 * capacity;
+                e = realloc(e, capacity * sizeof(CommEdge));
+            }
+            e[count].t1 = (fr->task < tr->task) ? fr->task : tr->task;
+            e[count].t2 = (fr->task < tr->task) ? tr->task : fr->task;
+            count++;
+        }
+    }
+    if (count == 0) {
+        *pEdges = e;
+        return 0;
+    }
+
+    qsort(e, count, sizeof(CommEdge), cmp_commedge);
+    int unique = 1;
+    for(int i = 1; i < count; i++) {
+        if ((e[i].t1 == e[unique-1].t1) && (e[i].t2 == e[unique-1].t2))
+            continue;
+        e[unique++] = e[i];
+    }
+    *pEdges = e;
+    return unique;
+}
+
+// greedy edge coloring of a graph with <tasks> nodes: edges are visited
+// in their (sorted) order, each gets the lowest color not yet used at one
+// of its end points. Uses at most 2*maxdegree-1 colors. Returns number
+// of colors used
+static
+int colorCommEdges(int count, CommEdge* e, int tasks)
+{
+    if (count == 0) return 0;
+
+    // maximal degree bounds number of colors needed
+    int* degree = calloc(tasks, sizeof(int));
+    int maxdegree = 0;
+    for(int i = 0; i < count; i++) {
+        if (++degree[e[i].t1] > maxdegree) maxdegree = degree[e[i].t1];
+        if (++degree[e[i].t2] > maxdegree) maxdegree = degree[e[i].t2];
+    }
+    free(degree);
+
+    // bitset of used colors per task
+    int words = (2 * maxdegree - 1 + 63) / 64;
+    uint64_t* used = calloc((size_t) tasks * words, sizeof(uint64_t));
+    int colors = 0;
+    for(int i = 0; i < count; i++) {
+        uint64_t* u1 = used + (size_t) e[i].t1 * words;
+        uint64_t* u2 = used + (size_t) e[i].t2 * words;
+        int w = 0;
+        while((u1[w] | u2[w]) == ~((uint64_t)0)) w++;
+        assert(w < words);
+        int c = __builtin_ctzll(~(u1[w] | u2[w]));
+        u1[w] |= ((uint64_t)1) << c;
+        u2[w] |= ((uint64_t)1) << c;
+        e[i].color = 64 * w + c;
+        if (e[i].color >= colors) colors = e[i].color + 1;
+    }
+    free(used);
+
+    return colors;
+}
+
+// used by cmp_edgecolor, set directly before sort:
+// color of the edge to each peer, -1 if not in communication graph
+static int* peercolor4cmp;
+
+static
+int cmp_edgecolor(const void* aptr1, const void* aptr2)
+{
+    Laik_Action* a1 = *((Laik_Action* const *) aptr1);
+    Laik_Action* a2 = *((Laik_Action* const *) aptr2);
+
+    if (a1->round != a2->round)
+        return a1->round - a2->round;
+
+    bool a1isSend = laik_action_isSend(a1);
+    bool a2isSend = laik_action_isSend(a2);
+    bool a1isSR = a1isSend || laik_action_isRecv(a1);
+    bool a2isSR = a2isSend || laik_action_isRecv(a2);
+
+    // actions other than send/recv come first in a round
+    if (a1isSR != a2isSR)
+        return a1isSR ? 1 : -1;
+    if (!a1isSR)
+        return (int) (a1 - a2);
+
+    // sort by color of edge to peer. Peers not found in communication
+    // graph come last, sorted by peer rank: this is consistent with
+    // global edge order (lower task, higher task), so no deadlock
+    int a1peer = laik_action_getPeer(a1);
+    int a2peer = laik_action_getPeer(a2);
+    int a1color = peercolor4cmp[a1peer];
+    int a2color = peercolor4cmp[a2peer];
+    if ((a1color < 0) != (a2color < 0))
+        return (a1color < 0) ? 1 : -1;
+    if (a1color != a2color)
+        return a1color - a2color;
+    if (a1peer != a2peer)
+        return a1peer - a2peer;
+
+    // same peer: lower rank first sends, higher rank first receives
+    if (a1isSend != a2isSend) {
+        bool sendFirst = (myid4cmp < a1peer);
+        return (a1isSend == sendFirst) ? -1 : 1;
+    }
+
+    // otherwise, keep original order
+    // we can compare pointers to actions (as they are not sorted directly!)
+    return (int) (a1 - a2);
+}
+
+/* sort send/recv actions using an edge coloring of the communication graph
+ *
+ * The communication graph of the transition is derived from the global
+ * from/to partitionings, and is colored such that edges with same color
+ * do not share a task. Sorting by color turns each color into a set of
+ * disjoint pairwise exchanges: all pairs of a color can run concurrently,
+ * instead of serializing chained exchanges as done by 2-phase sorting.
+ * Within a pair, the lower rank first sends and then receives, the higher
+ * rank does it the other way round. This enables backends to execute
+ * a send and a receive with the same peer as one combined exchange.
+ *
+ * For sends/recvs among same peers, order is kept.
+ * Actions other the send/recv are moved to front.
+ * If the graph cannot be derived (e.g. for reductions), falls back to
+ * laik_aseq_sort_2phases().
+ */
+bool laik_aseq_sort_edgecolor(Laik_ActionSeq* as)
+{
+    if (as->actionCount == 0) return false;
+
+    // must not have new actions, we want to start a new build
+    assert(as->newActionCount == 0);
+
+    Laik_TransitionContext* tc = as->context[0];
+    Laik_Transition* t = tc->transition;
+
+    CommEdge* edges;
+    int ecount = calcCommEdges(t, &edges);
+    if (ecount < 0)
+        return laik_aseq_sort_2phases(as);
+
+    int colors = colorCommEdges(ecount, edges, t->group->size);
+    myid4cmp = t->group->myid;
+    peercolor4cmp = malloc(t->group->size * sizeof(int));
+    for(int i = 0; i < t->group->size; i++)
+        peercolor4cmp[i] = -1;
+    for(int i = 0; i < ecount; i++) {
+        if (edges[i].t1 == myid4cmp) peercolor4cmp[edges[i].t2] = edges[i].color;
+        if (edges[i].t2 == myid4cmp) peercolor4cmp[edges[i].t1] = edges[i].color;
+    }
+    free(edges);
+
+    laik_log(1, "sort_edgecolor: %d edges, %d colors", ecount, colors);
+
+    Laik_Action** order = malloc(as->actionCount * sizeof(void*));
+    Laik_Action* a = as->action;
+    for(unsigned int i=0; i < as->actionCount; i++, a = nextAction(a))
+        order[i] = a;
+
+    qsort(order, as->actionCount, sizeof(void*), cmp_edgecolor);
+    free(peercolor4cmp);
+    peercolor4cmp = 0;
+
+    // check if something changed
+    bool changed = false;
+    a = as->action;
+    for(unsigned int i=0; i < as->actionCount; i++, a = nextAction(a)) {
+        if (order[i] == a) continue;
+        changed = true;
+        break;
+    }
+    if (changed) {
+        addResorted(as->actionCount, order, as);
+        laik_aseq_activateNewActions(as);
+    }
+    free(order);
+
+    return changed;
+}
+
+
 // helper for just sorting by rounds
 
 static
@@ -2591,3 +2831,32 @@ void laik_exec_unpack(Laik_BackendAction* a, Laik_Mapping* map)
     assert(unpacked == a->count);
     assert(laik_index_isEqual(dims, &idx, &(a->range->to)));
 }
+
+// copy of one entry for gather/scatter: constant sizes for single elements
+// of common types allow the compiler to inline the copy. Sparse partitions
+// built from single indexes typically result in such entries
+static inline void copyEntry(char* dst, const char* src, unsigned int bytes)
+{
+    switch(bytes) {
+    case 8: memcpy(dst, src, 8); break;
+    case 4: memcpy(dst, src, 4); break;
+    case 16: memcpy(dst, src, 16); break;
+    default: memcpy(dst, src, bytes); break;
+    }
+}
+
+// LAIK_AT_CopyToBuf
+void laik_exec_copyToBuf(Laik_BackendAction* a)
+{
+    Laik_CopyEntry* ce = a->ce;
+    for(unsigned int i = 0; i < a->count; i++)
+        copyEntry(a->toBuf + ce[i].offset, ce[i].ptr, ce[i].bytes);
+}
+
+// LAIK_AT_CopyFromBuf
+void laik_exec_copyFromBuf(Laik_BackendAction* a)
+{
+    Laik_CopyEntry* ce = a->ce;
+    for(unsigned int i = 0; i < a->count; i++)
+        copyEntry(ce[i].ptr, a->fromBuf + ce[i].offset, ce[i].bytes);
+}
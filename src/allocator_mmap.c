@@ -0,0 +1,187 @@
+/*
+ * This file is part of the LAIK library.
+ * Copyright (c) 2017-2019 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+ *
+ * LAIK is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3 or later.
+ *
+ * LAIK is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE // for MADV_REMOVE
+
+#include <laik-internal.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+//--------------------------------------------------------
+// File-backed allocator for out-of-core containers
+//
+// Each allocation is a slice of a scratch file, mapped shared into
+// memory. The kernel writes back pages to the file under memory pressure,
+// so only the working set needs to be resident. Slices are page aligned
+// and never reused: freeing a slice punches a hole into the file to
+// release disk space, and unmaps it.
+
+// one allocation
+typedef struct {
+    char* ptr;
+    size_t len;
+} MMapSlice;
+
+typedef struct {
+    Laik_Allocator a; // must be first, used as Laik_Allocator
+    char* path;
+    int fd;           // -1 if not opened yet
+    off_t size;       // current file size
+    int count, capacity;
+    MMapSlice* slice;
+} MMapAllocator;
+
+static size_t pageSize = 0;
+
+static void* mmap_malloc(Laik_Data* d, size_t size);
+
+static MMapAllocator* mmapAllocator(Laik_Data* d)
+{
+    assert(d->allocator && (d->allocator->malloc == mmap_malloc));
+    return (MMapAllocator*) d->allocator;
+}
+
+static void mmapOpen(MMapAllocator* ma)
+{
+    char name[PATH_MAX];
+    snprintf(name, PATH_MAX, "%s.%d", ma->path, (int) getpid());
+    ma->fd = open(name, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (ma->fd < 0) {
+        laik_panic("mmap allocator: cannot create scratch file");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    // file only needed while mapped
+    unlink(name);
+    ma->size = 0;
+    laik_log(1, "mmap allocator: using scratch file '%s'", name);
+}
+
+static void* mmap_malloc(Laik_Data* d, size_t size)
+{
+    MMapAllocator* ma = mmapAllocator(d);
+    if (ma->fd < 0) mmapOpen(ma);
+    if (size == 0) size = 1;
+    size_t len = (size + pageSize - 1) / pageSize * pageSize;
+
+    off_t off = ma->size;
+    if (ftruncate(ma->fd, off + (off_t) len) < 0) {
+        laik_log(LAIK_LL_Warning, "mmap allocator: cannot extend file: %s",
+                 strerror(errno));
+        return 0;
+    }
+    ma->size = off + (off_t) len;
+    char* ptr = mmap(0, len, PROT_READ | PROT_WRITE, MAP_SHARED, ma->fd, off);
+    if (ptr == MAP_FAILED) {
+        laik_log(LAIK_LL_Warning, "mmap allocator: mmap failed: %s",
+                 strerror(errno));
+        return 0;
+    }
+
+    if (ma->count == ma->capacity) {
+        ma->capacity = (ma->capacity == 0) ? 8 : 2 * ma->capacity;
+        ma->slice = realloc(ma->slice, ma->capacity * sizeof(MMapSlice));
+        if (!ma->slice) {
+            laik_panic("Out of memory allocating MMapSlice entries");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+    }
+    ma->slice[ma->count].ptr = ptr;
+    ma->slice[ma->count].len = len;
+    ma->count++;
+
+    laik_log(1, "mmap allocator: %llu bytes at file offset %llu for data '%s'",
+             (unsigned long long) len, (unsigned long long) off, d->name);
+    return ptr;
+}
+
+static void mmap_free(Laik_Data* d, void* ptr)
+{
+    MMapAllocator* ma = mmapAllocator(d);
+    int i;
+    for(i = 0; i < ma->count; i++)
+        if (ma->slice[i].ptr == ptr) break;
+    assert(i < ma->count);
+
+    // punch hole into file (if supported by file system) and unmap
+    MMapSlice* s = &(ma->slice[i]);
+    madvise(s->ptr, s->len, MADV_REMOVE);
+    munmap(s->ptr, s->len);
+
+    ma->slice[i] = ma->slice[ma->count - 1];
+    ma->count--;
+}
+
+// mapping used in new partitioning: prefetch from file
+static void mmap_map(Laik_Data* d, void* ptr, size_t length)
+{
+    uintptr_t from = (uintptr_t) ptr / pageSize * pageSize;
+    uintptr_t to = ((uintptr_t) ptr + length + pageSize - 1) / pageSize * pageSize;
+    madvise((void*) from, to - from, MADV_WILLNEED);
+    laik_log(1, "mmap allocator: prefetch %llu bytes at %p for data '%s'",
+             (unsigned long long) (to - from), (void*) from, d->name);
+}
+
+// mapping not used anymore: drop resident pages (kept in file)
+static void mmap_unmap(Laik_Data* d, void* ptr, size_t length)
+{
+    // only pages completely within given range
+    uintptr_t from = ((uintptr_t) ptr + pageSize - 1) / pageSize * pageSize;
+    uintptr_t to = ((uintptr_t) ptr + length) / pageSize * pageSize;
+    if (to <= from) return;
+    madvise((void*) from, to - from, MADV_DONTNEED);
+    laik_log(1, "mmap allocator: release %llu bytes at %p for data '%s'",
+             (unsigned long long) (to - from), (void*) from, d->name);
+}
+
+Laik_Allocator* laik_new_allocator_mmap(const char* path)
+{
+    if (pageSize == 0)
+        pageSize = (size_t) sysconf(_SC_PAGESIZE);
+
+    MMapAllocator* ma = malloc(sizeof(MMapAllocator));
+    if (!ma) {
+        laik_panic("Out of memory allocating MMapAllocator object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    if (!path) path = getenv("LAIK_MMAP_PATH");
+    if (!path) path = "/tmp/laik-mmap";
+    ma->path = strdup(path);
+    ma->fd = -1;
+    ma->size = 0;
+    ma->count = 0;
+    ma->capacity = 0;
+    ma->slice = 0;
+
+    ma->a.policy = LAIK_MP_NotifyOnChange;
+    ma->a.malloc = mmap_malloc;
+    ma->a.free = mmap_free;
+    ma->a.realloc = 0;
+    ma->a.unmap = mmap_unmap;
+    ma->a.map = mmap_map;
+
+    return (Laik_Allocator*) ma;
+}
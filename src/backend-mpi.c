@@ -41,6 +41,7 @@ static void laik_mpi_exec(Laik_ActionSeq* as);
 static void laik_mpi_updateGroup(Laik_Group*);
 static bool laik_mpi_log_action(Laik_Action* a);
 static void laik_mpi_sync(Laik_KVStore* kvs);
+static void laik_mpi_sync_start(Laik_KVStore* kvs);
 
 // C guarantees that unset function pointers are NULL
 static Laik_Backend laik_backend_mpi = {
@@ -51,7 +52,8 @@ static Laik_Backend laik_backend_mpi = {
     .exec        = laik_mpi_exec,
     .updateGroup = laik_mpi_updateGroup,
     .log_action  = laik_mpi_log_action,
-    .sync        = laik_mpi_sync
+    .sync        = laik_mpi_sync,
+    .sync_start  = laik_mpi_sync_start
 };
 
 static Laik_Instance* mpi_instance = 0;
@@ -91,6 +93,7 @@ static char packbuf[PACKBUFSIZE];
 #define LAIK_AT_MpiIrecv (LAIK_AT_Backend + 1)
 #define LAIK_AT_MpiIsend (LAIK_AT_Backend + 2)
 #define LAIK_AT_MpiWait  (LAIK_AT_Backend + 3)
+#define LAIK_AT_MpiSendRecv (LAIK_AT_Backend + 4)
 
 // action structs must be packed
 #pragma pack(push,1)
@@ -121,6 +124,22 @@ typedef struct {
     char* buf;
 } Laik_A_MpiIsend;
 
+// SendRecv action: combined send to and receive from same peer.
+// If a map number is not negative, data is at <offset> in that mapping,
+// otherwise at <buf>
+typedef struct {
+    Laik_Action h;
+    int rank;
+    unsigned int sendCount;
+    int fromMapNo;
+    unsigned int fromOffset;
+    char* fromBuf;
+    unsigned int recvCount;
+    int toMapNo;
+    unsigned int toOffset;
+    char* toBuf;
+} Laik_A_MpiSendRecv;
+
 #pragma pack(pop)
 
 static
@@ -164,15 +183,20 @@ void laik_mpi_addMpiIsend(Laik_ActionSeq* as, int round,
 typedef struct {
     Laik_Action h;
     int req_id;
+    int rank; // peer of request, for statistics
+    bool isSend; // request was posted by MpiIsend (else MpiIrecv)
 } Laik_A_MpiWait;
 
 static
-void laik_mpi_addMpiWait(Laik_ActionSeq* as, int round, int req_id)
+void laik_mpi_addMpiWait(Laik_ActionSeq* as, int round,
+                         int req_id, int rank, bool isSend)
 {
     Laik_A_MpiWait* a;
     a = (Laik_A_MpiWait*) laik_aseq_addAction(as, sizeof(*a),
                                               LAIK_AT_MpiWait, round, 0);
     a->req_id = req_id;
+    a->rank = rank;
+    a->isSend = isSend;
 }
 
 static
@@ -205,6 +229,22 @@ bool laik_mpi_log_action(Laik_Action* a)
         break;
     }
 
+    case LAIK_AT_MpiSendRecv: {
+        Laik_A_MpiSendRecv* aa = (Laik_A_MpiSendRecv*) a;
+        laik_log_append("MPI-SendRecv: T%d, ", aa->rank);
+        if (aa->fromMapNo >= 0)
+            laik_log_append("from map %d off %u", aa->fromMapNo, aa->fromOffset);
+        else
+            laik_log_append("from %p", aa->fromBuf);
+        laik_log_append(" (count %d), ", aa->sendCount);
+        if (aa->toMapNo >= 0)
+            laik_log_append("to map %d off %u", aa->toMapNo, aa->toOffset);
+        else
+            laik_log_append("to %p", aa->toBuf);
+        laik_log_append(" (count %d)", aa->recvCount);
+        break;
+    }
+
     default:
         return false;
     }
@@ -245,7 +285,7 @@ bool laik_mpi_asyncSendRecv(Laik_ActionSeq* as)
             Laik_A_BufSend* aa = (Laik_A_BufSend*) a;
             laik_mpi_addMpiIsend(as, a->round + 1,
                                  aa->buf, aa->count, aa->to_rank, req_id);
-            laik_mpi_addMpiWait(as, maxround + 2, req_id);
+            laik_mpi_addMpiWait(as, maxround + 2, req_id, aa->to_rank, true);
             req_id++;
             break;
         }
@@ -254,7 +294,7 @@ bool laik_mpi_asyncSendRecv(Laik_ActionSeq* as)
             Laik_A_BufRecv* aa = (Laik_A_BufRecv*) a;
             laik_mpi_addMpiIrecv(as, 0,
                                  aa->buf, aa->count, aa->from_rank, req_id);
-            laik_mpi_addMpiWait(as, a->round + 1, req_id);
+            laik_mpi_addMpiWait(as, a->round + 1, req_id, aa->from_rank, false);
             req_id++;
             break;
         }
@@ -271,6 +311,112 @@ bool laik_mpi_asyncSendRecv(Laik_ActionSeq* as)
     return true;
 }
 
+// helper for laik_mpi_combineSendRecv: get peer and data location of
+// a send (<isSend> true) or receive action. Returns false if not handled
+static
+bool getSendRecvParams(Laik_Action* a, bool isSend, int* rank,
+                       unsigned int* count, int* mapNo,
+                       unsigned int* offset, char** buf)
+{
+    Laik_BackendAction* ba = (Laik_BackendAction*) a;
+    *mapNo = -1;
+    *offset = 0;
+    *buf = 0;
+    switch(a->type) {
+    case LAIK_AT_MapSend:
+        if (!isSend) return false;
+        *rank = ba->rank;
+        *count = ba->count;
+        *mapNo = ba->fromMapNo;
+        *offset = ba->offset;
+        return true;
+    case LAIK_AT_MapRecv:
+        if (isSend) return false;
+        *rank = ba->rank;
+        *count = ba->count;
+        *mapNo = ba->toMapNo;
+        *offset = ba->offset;
+        return true;
+    case LAIK_AT_BufSend:
+        if (!isSend) return false;
+        *rank = ((Laik_A_BufSend*)a)->to_rank;
+        *count = ((Laik_A_BufSend*)a)->count;
+        *buf = ((Laik_A_BufSend*)a)->buf;
+        return true;
+    case LAIK_AT_BufRecv:
+        if (isSend) return false;
+        *rank = ((Laik_A_BufRecv*)a)->from_rank;
+        *count = ((Laik_A_BufRecv*)a)->count;
+        *buf = ((Laik_A_BufRecv*)a)->buf;
+        return true;
+    default:
+        break;
+    }
+    return false;
+}
+
+// transformation: combine a send and a receive with the same peer directly
+// following each other in the same round into one MPI_Sendrecv.
+// Works best after laik_aseq_sort_edgecolor(), which puts send/recv
+// actions for the same peer next to each other
+bool laik_mpi_combineSendRecv(Laik_ActionSeq* as)
+{
+    // must not have new actions, we want to start a new build
+    assert(as->newActionCount == 0);
+
+    bool changed = false;
+    Laik_Action* a = as->action;
+    for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
+        if (i + 1 < as->actionCount) {
+            Laik_Action* b = nextAction(a);
+            Laik_Action *sa = a, *ra = b;
+            if ((a->type == LAIK_AT_MapRecv) || (a->type == LAIK_AT_BufRecv)) {
+                sa = b;
+                ra = a;
+            }
+
+            int srank, rrank, fromMapNo, toMapNo;
+            unsigned int scount, rcount, fromOffset, toOffset;
+            char *fromBuf, *toBuf;
+            if ((a->round == b->round) &&
+                getSendRecvParams(sa, true, &srank, &scount,
+                                  &fromMapNo, &fromOffset, &fromBuf) &&
+                getSendRecvParams(ra, false, &rrank, &rcount,
+                                  &toMapNo, &toOffset, &toBuf) &&
+                (srank == rrank)) {
+
+                Laik_A_MpiSendRecv* aa;
+                aa = (Laik_A_MpiSendRecv*) laik_aseq_addAction(as, sizeof(*aa),
+                                                               LAIK_AT_MpiSendRecv,
+                                                               a->round, a->tid);
+                aa->rank = srank;
+                aa->sendCount = scount;
+                aa->fromMapNo = fromMapNo;
+                aa->fromOffset = fromOffset;
+                aa->fromBuf = fromBuf;
+                aa->recvCount = rcount;
+                aa->toMapNo = toMapNo;
+                aa->toOffset = toOffset;
+                aa->toBuf = toBuf;
+
+                // skip the second action
+                a = b;
+                i++;
+                changed = true;
+                continue;
+            }
+        }
+        laik_aseq_add(a, as, -1);
+    }
+
+    if (changed)
+        laik_aseq_activateNewActions(as);
+    else
+        laik_aseq_discardNewActions(as);
+
+    return changed;
+}
+
 //----------------------------------------------------------------------------
 // error helpers
 
@@ -677,6 +823,123 @@ void laik_mpi_exec_groupReduce(Laik_TransitionContext* tc,
     }
 }
 
+// record MPI-specific or generic action for event tracing
+static void laik_mpi_trace_action(Laik_Action* a, double start)
+{
+    switch(a->type) {
+    case LAIK_AT_MpiReq:
+        laik_trace_event("action", "MpiReq", 0, start, a->round, -1);
+        break;
+    case LAIK_AT_MpiIsend:
+        laik_trace_event("action", "MpiIsend", 0, start, a->round,
+                         ((Laik_A_MpiIsend*)a)->to_rank);
+        break;
+    case LAIK_AT_MpiIrecv:
+        laik_trace_event("action", "MpiIrecv", 0, start, a->round,
+                         ((Laik_A_MpiIrecv*)a)->from_rank);
+        break;
+    case LAIK_AT_MpiWait:
+        laik_trace_event("action", "MpiWait", 0, start, a->round,
+                         ((Laik_A_MpiWait*)a)->rank);
+        break;
+    case LAIK_AT_MpiSendRecv:
+        laik_trace_event("action", "MpiSendRecv", 0, start, a->round,
+                         ((Laik_A_MpiSendRecv*)a)->rank);
+        break;
+    default:
+        laik_trace_action(a, start);
+        break;
+    }
+}
+
+// account send/recv action for communication matrix.
+// Messages of async actions are counted when posted, with blocking time
+// in MPI_Wait. Reductions are collective operations and not accounted
+static void laik_mpi_commstat_action(Laik_TransitionContext* tc,
+                                     Laik_Action* a, double start)
+{
+    Laik_Group* g = tc->transition->group;
+    Laik_Instance* inst = g->inst;
+    uint64_t esize = (uint64_t) tc->data->elemsize;
+    double wait = laik_wtime() - start;
+
+    switch(a->type) {
+    case LAIK_AT_MpiIsend: {
+        Laik_A_MpiIsend* aa = (Laik_A_MpiIsend*) a;
+        laik_commstat_add(inst, laik_group_locationid(g, aa->to_rank), true,
+                          1, aa->count * esize, 0.0);
+        break;
+    }
+    case LAIK_AT_MpiIrecv: {
+        Laik_A_MpiIrecv* aa = (Laik_A_MpiIrecv*) a;
+        laik_commstat_add(inst, laik_group_locationid(g, aa->from_rank), false,
+                          1, aa->count * esize, 0.0);
+        break;
+    }
+    case LAIK_AT_MpiWait: {
+        Laik_A_MpiWait* aa = (Laik_A_MpiWait*) a;
+        laik_commstat_add(inst, laik_group_locationid(g, aa->rank),
+                          aa->isSend, 0, 0, wait);
+        break;
+    }
+    case LAIK_AT_MpiSendRecv: {
+        Laik_A_MpiSendRecv* aa = (Laik_A_MpiSendRecv*) a;
+        int lid = laik_group_locationid(g, aa->rank);
+        laik_commstat_add(inst, lid, true, 1, aa->sendCount * esize, 0.0);
+        laik_commstat_add(inst, lid, false, 1, aa->recvCount * esize, wait);
+        break;
+    }
+    case LAIK_AT_MapSend:
+    case LAIK_AT_PackAndSend:
+        laik_commstat_add(inst, laik_group_locationid(g, ((Laik_BackendAction*)a)->rank),
+                          true, 1, ((Laik_BackendAction*)a)->count * esize, wait);
+        break;
+    case LAIK_AT_MapRecv:
+    case LAIK_AT_RecvAndUnpack:
+        laik_commstat_add(inst, laik_group_locationid(g, ((Laik_BackendAction*)a)->rank),
+                          false, 1, ((Laik_BackendAction*)a)->count * esize, wait);
+        break;
+    case LAIK_AT_RBufSend: {
+        Laik_A_RBufSend* aa = (Laik_A_RBufSend*) a;
+        laik_commstat_add(inst, laik_group_locationid(g, aa->to_rank), true,
+                          1, aa->count * esize, wait);
+        break;
+    }
+    case LAIK_AT_BufSend: {
+        Laik_A_BufSend* aa = (Laik_A_BufSend*) a;
+        laik_commstat_add(inst, laik_group_locationid(g, aa->to_rank), true,
+                          1, aa->count * esize, wait);
+        break;
+    }
+    case LAIK_AT_MapPackAndSend: {
+        Laik_A_MapPackAndSend* aa = (Laik_A_MapPackAndSend*) a;
+        laik_commstat_add(inst, laik_group_locationid(g, aa->to_rank), true,
+                          1, aa->count * esize, wait);
+        break;
+    }
+    case LAIK_AT_RBufRecv: {
+        Laik_A_RBufRecv* aa = (Laik_A_RBufRecv*) a;
+        laik_commstat_add(inst, laik_group_locationid(g, aa->from_rank), false,
+                          1, aa->count * esize, wait);
+        break;
+    }
+    case LAIK_AT_BufRecv: {
+        Laik_A_BufRecv* aa = (Laik_A_BufRecv*) a;
+        laik_commstat_add(inst, laik_group_locationid(g, aa->from_rank), false,
+                          1, aa->count * esize, wait);
+        break;
+    }
+    case LAIK_AT_MapRecvAndUnpack: {
+        Laik_A_MapRecvAndUnpack* aa = (Laik_A_MapRecvAndUnpack*) a;
+        laik_commstat_add(inst, laik_group_locationid(g, aa->from_rank), false,
+                          1, aa->count * esize, wait);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
 static
 void laik_mpi_exec(Laik_ActionSeq* as)
 {
@@ -695,7 +958,7 @@ void laik_mpi_exec(Laik_ActionSeq* as)
         laik_log_ActionSeqIfChanged(changed, as, "After flattening");
         changed = laik_aseq_allocBuffer(as);
         laik_log_ActionSeqIfChanged(changed, as, "After buffer alloc");
-        changed = laik_aseq_sort_2phases(as);
+        changed = laik_aseq_sort_edgecolor(as);
         laik_log_ActionSeqIfChanged(changed, as, "After sorting");
 
         int not_handled = laik_aseq_calc_stats(as);
@@ -734,6 +997,8 @@ void laik_mpi_exec(Laik_ActionSeq* as)
             laik_log_Action(a, as);
             laik_log_flush(0);
         }
+        bool timed = laik_trace_enabled || laik_commstat_enabled;
+        double traceStart = timed ? laik_wtime() : 0.0;
 
         switch(a->type) {
         case LAIK_AT_BufReserve:
@@ -780,6 +1045,35 @@ void laik_mpi_exec(Laik_ActionSeq* as)
             break;
         }
 
+        case LAIK_AT_MpiSendRecv: {
+            // MPI-specific action: combined send/recv with same peer
+            Laik_A_MpiSendRecv* aa = (Laik_A_MpiSendRecv*) a;
+            char* fromBuf = aa->fromBuf;
+            if (aa->fromMapNo >= 0) {
+                assert(aa->fromMapNo < (int) fromList->count);
+                Laik_Mapping* fromMap = &(fromList->map[aa->fromMapNo]);
+                assert(fromMap->base != 0);
+                fromBuf = fromMap->base + aa->fromOffset;
+            }
+            char* toBuf = aa->toBuf;
+            if (aa->toMapNo >= 0) {
+                assert(aa->toMapNo < (int) toList->count);
+                Laik_Mapping* toMap = &(toList->map[aa->toMapNo]);
+                assert(toMap->base != 0);
+                toBuf = toMap->base + aa->toOffset;
+            }
+            err = MPI_Sendrecv(fromBuf, aa->sendCount, dataType, aa->rank, tag,
+                               toBuf, aa->recvCount, dataType, aa->rank, tag,
+                               comm, &st);
+            if (err != MPI_SUCCESS) laik_mpi_panic(err);
+
+            // check that we received the expected number of elements
+            err = MPI_Get_count(&st, dataType, &count);
+            if (err != MPI_SUCCESS) laik_mpi_panic(err);
+            assert((int)aa->recvCount == count);
+            break;
+        }
+
         case LAIK_AT_MapSend: {
             assert(ba->fromMapNo < fromList->count);
             Laik_Mapping* fromMap = &(fromList->map[ba->fromMapNo]);
@@ -850,17 +1144,11 @@ void laik_mpi_exec(Laik_ActionSeq* as)
         }
 
         case LAIK_AT_CopyFromBuf:
-            for(unsigned int i = 0; i < ba->count; i++)
-                memcpy(ba->ce[i].ptr,
-                       ba->fromBuf + ba->ce[i].offset,
-                       ba->ce[i].bytes);
+            laik_exec_copyFromBuf(ba);
             break;
 
         case LAIK_AT_CopyToBuf:
-            for(unsigned int i = 0; i < ba->count; i++)
-                memcpy(ba->toBuf + ba->ce[i].offset,
-                       ba->ce[i].ptr,
-                       ba->ce[i].bytes);
+            laik_exec_copyToBuf(ba);
             break;
 
         case LAIK_AT_PackToBuf:
@@ -954,6 +1242,11 @@ void laik_mpi_exec(Laik_ActionSeq* as)
                      a->type, laik_at_str(a->type));
             assert(0);
         }
+
+        if (laik_commstat_enabled)
+            laik_mpi_commstat_action(tc, a, traceStart);
+        if (laik_trace_enabled)
+            laik_mpi_trace_action(a, traceStart);
     }
     assert( ((char*)as->action) + as->bytesUsed == ((char*)a) );
 }
@@ -982,6 +1275,16 @@ void laik_mpi_aseq_calc_stats(Laik_ActionSeq* as)
             as->elemRecvCount += count;
             as->byteRecvCount += count * tc->data->elemsize;
             break;
+        case LAIK_AT_MpiSendRecv:
+            count = ((Laik_A_MpiSendRecv*)a)->sendCount;
+            as->msgSendCount++;
+            as->elemSendCount += count;
+            as->byteSendCount += count * tc->data->elemsize;
+            count = ((Laik_A_MpiSendRecv*)a)->recvCount;
+            as->msgRecvCount++;
+            as->elemRecvCount += count;
+            as->byteRecvCount += count * tc->data->elemsize;
+            break;
         default: break;
         }
     }
@@ -1038,9 +1341,19 @@ void laik_mpi_prepare(Laik_ActionSeq* as)
     changed = laik_aseq_allocBuffer(as);
     laik_log_ActionSeqIfChanged(changed, as, "After buffer allocation 3");
 
-    changed = laik_aseq_sort_2phases(as);
-    //changed = laik_aseq_sort_rankdigits(as);
-    laik_log_ActionSeqIfChanged(changed, as, "After sorting for deadlock avoidance");
+    if (mpi_async) {
+        changed = laik_aseq_sort_2phases(as);
+        //changed = laik_aseq_sort_rankdigits(as);
+        laik_log_ActionSeqIfChanged(changed, as, "After sorting for deadlock avoidance");
+    }
+    else {
+        // synchronous send/recv: schedule as rounds of pairwise exchanges
+        changed = laik_aseq_sort_edgecolor(as);
+        laik_log_ActionSeqIfChanged(changed, as, "After sorting by edge coloring");
+
+        changed = laik_mpi_combineSendRecv(as);
+        laik_log_ActionSeqIfChanged(changed, as, "After combining send/recv");
+    }
 
     if (mpi_async) {
         changed = laik_mpi_asyncSendRecv(as);
@@ -1077,59 +1390,125 @@ static void laik_mpi_cleanup(Laik_ActionSeq* as)
 // KV store
 
 
-static void laik_mpi_sync(Laik_KVStore* kvs)
+// KVS sync via binomial tree: changes are merged on the way up to T0,
+// the merged result is broadcast down the same tree.
+// Changes are sent as header with number of offsets and data bytes,
+// followed by offset and data arrays if not empty.
+
+// state of KVS sync started with laik_mpi_sync_start (only one at a time)
+static struct {
+    Laik_KVStore* kvs;
+    int parent, childCount;
+    int child[LAIK_KVS_TREE_MAXCHILDREN];
+    int childHeader[LAIK_KVS_TREE_MAXCHILDREN][2];
+    MPI_Request childReq[LAIK_KVS_TREE_MAXCHILDREN];
+    int parentHeader[2];
+    MPI_Request parentReq;
+    // used by leafs to send own changes directly in start
+    int sendHeader[2];
+    MPI_Request sendReq[3];
+    int sendReqCount;
+} mpi_sync;
+
+// send KVS changes <c> to <rank>
+static void mpi_send_changes(Laik_KVS_Changes* c, int rank, MPI_Comm comm)
+{
+    int count[2];
+    count[0] = (int) c->offUsed;
+    assert((count[0] == 0) || ((count[0] & 1) == 1)); // 0 or odd number of offsets
+    count[1] = (int) c->dataUsed;
+    laik_log(1, "MPI sync: sending %d changes (total %d chars) to T%d",
+             count[0] / 2, count[1], rank);
+    int err = MPI_Send(count, 2, MPI_INTEGER, rank, 0, comm);
+    if (err != MPI_SUCCESS) laik_mpi_panic(err);
+    if (count[0] == 0) {
+        assert(count[1] == 0);
+        return;
+    }
+    assert(count[1] > 0);
+    err = MPI_Send(c->off, count[0], MPI_INTEGER, rank, 0, comm);
+    if (err != MPI_SUCCESS) laik_mpi_panic(err);
+    err = MPI_Send(c->data, count[1], MPI_CHAR, rank, 0, comm);
+    if (err != MPI_SUCCESS) laik_mpi_panic(err);
+}
+
+// receive KVS changes into <c> from <rank>, header already received
+static void mpi_recv_changes(Laik_KVS_Changes* c, int* count, int rank, MPI_Comm comm)
+{
+    MPI_Status status;
+    laik_log(1, "MPI sync: getting %d changes (total %d chars) from T%d",
+             count[0] / 2, count[1], rank);
+    laik_kvs_changes_set_size(c, 0, 0); // fresh reuse
+    if (count[0] == 0) {
+        assert(count[1] == 0);
+        return;
+    }
+    assert(count[1] > 0);
+    laik_kvs_changes_ensure_size(c, count[0], count[1]);
+    int err = MPI_Recv(c->off, count[0], MPI_INTEGER, rank, 0, comm, &status);
+    if (err != MPI_SUCCESS) laik_mpi_panic(err);
+    err = MPI_Recv(c->data, count[1], MPI_CHAR, rank, 0, comm, &status);
+    if (err != MPI_SUCCESS) laik_mpi_panic(err);
+    laik_kvs_changes_set_size(c, count[0], count[1]);
+}
+
+// post receives for headers; leafs of tree send their changes already here
+static void laik_mpi_sync_start(Laik_KVStore* kvs)
 {
     assert(kvs->inst == mpi_instance);
+    assert(mpi_sync.kvs == 0); // only one sync in progress
     MPI_Comm comm = mpiData(mpi_instance)->comm;
     Laik_Group* world = kvs->inst->world;
-    int myid = world->myid;
-    MPI_Status status;
-    int count[2] = {0,0};
     int err;
 
-    if (myid > 0) {
-        // send to master, receive from master
-        count[0] = (int) kvs->changes.offUsed;
-        assert((count[0] == 0) || ((count[0] & 1) == 1)); // 0 or odd number of offsets
-        count[1] = (int) kvs->changes.dataUsed;
-        laik_log(1, "MPI sync: sending %d changes (total %d chars) to T0",
-                 count[0] / 2, count[1]);
-        err = MPI_Send(count, 2, MPI_INTEGER, 0, 0, comm);
+    mpi_sync.kvs = kvs;
+    mpi_sync.childCount = laik_kvs_tree(world->myid, world->size,
+                                        &(mpi_sync.parent), mpi_sync.child);
+    for(int i = 0; i < mpi_sync.childCount; i++) {
+        err = MPI_Irecv(mpi_sync.childHeader[i], 2, MPI_INTEGER,
+                        mpi_sync.child[i], 0, comm, &(mpi_sync.childReq[i]));
         if (err != MPI_SUCCESS) laik_mpi_panic(err);
-        if (count[0] > 0) {
-            assert(count[1] > 0);
-            err = MPI_Send(kvs->changes.off, count[0], MPI_INTEGER, 0, 0, comm);
-            if (err != MPI_SUCCESS) laik_mpi_panic(err);
-            err = MPI_Send(kvs->changes.data, count[1], MPI_CHAR, 0, 0, comm);
-            if (err != MPI_SUCCESS) laik_mpi_panic(err);
-        }
-        else assert(count[1] == 0);
+    }
 
-        err = MPI_Recv(count, 2, MPI_INTEGER, 0, 0, comm, &status);
-        if (err != MPI_SUCCESS) laik_mpi_panic(err);
-        laik_log(1, "MPI sync: getting %d changes (total %d chars) from T0",
-                 count[0] / 2, count[1]);
-        if (count[0] > 0) {
-            assert(count[1] > 0);
-            laik_kvs_changes_ensure_size(&(kvs->changes), count[0], count[1]);
-            err = MPI_Recv(kvs->changes.off, count[0], MPI_INTEGER, 0, 0, comm, &status);
-            if (err != MPI_SUCCESS) laik_mpi_panic(err);
-            err = MPI_Recv(kvs->changes.data, count[1], MPI_CHAR, 0, 0, comm, &status);
-            if (err != MPI_SUCCESS) laik_mpi_panic(err);
-            laik_kvs_changes_set_size(&(kvs->changes), count[0], count[1]);
-            // TODO: opt - remove own changes from received ones
-            laik_kvs_changes_apply(&(kvs->changes), kvs);
-        }
-        else
-            assert(count[1] == 0);
+    mpi_sync.sendReqCount = 0;
+    if (mpi_sync.parent < 0) return;
 
-        return;
+    // result of merging will come from parent
+    err = MPI_Irecv(mpi_sync.parentHeader, 2, MPI_INTEGER,
+                    mpi_sync.parent, 0, comm, &(mpi_sync.parentReq));
+    if (err != MPI_SUCCESS) laik_mpi_panic(err);
+
+    if (mpi_sync.childCount > 0) return;
+
+    // leaf: nothing to merge, send own changes right away
+    Laik_KVS_Changes* c = &(kvs->changes);
+    int* count = mpi_sync.sendHeader;
+    count[0] = (int) c->offUsed;
+    assert((count[0] == 0) || ((count[0] & 1) == 1)); // 0 or odd number of offsets
+    count[1] = (int) c->dataUsed;
+    laik_log(1, "MPI sync: sending %d changes (total %d chars) to T%d",
+             count[0] / 2, count[1], mpi_sync.parent);
+    err = MPI_Isend(count, 2, MPI_INTEGER, mpi_sync.parent, 0, comm,
+                    &(mpi_sync.sendReq[mpi_sync.sendReqCount++]));
+    if (err != MPI_SUCCESS) laik_mpi_panic(err);
+    if (count[0] > 0) {
+        err = MPI_Isend(c->off, count[0], MPI_INTEGER, mpi_sync.parent, 0, comm,
+                        &(mpi_sync.sendReq[mpi_sync.sendReqCount++]));
+        if (err != MPI_SUCCESS) laik_mpi_panic(err);
+        err = MPI_Isend(c->data, count[1], MPI_CHAR, mpi_sync.parent, 0, comm,
+                        &(mpi_sync.sendReq[mpi_sync.sendReqCount++]));
+        if (err != MPI_SUCCESS) laik_mpi_panic(err);
     }
+}
 
-    // master: receive changes from all others, sort, merge, send back
+static void laik_mpi_sync(Laik_KVStore* kvs)
+{
+    if (mpi_sync.kvs != kvs)
+        laik_mpi_sync_start(kvs);
 
-    // first sort own changes, as preparation for merging
-    laik_kvs_changes_sort(&(kvs->changes));
+    MPI_Comm comm = mpiData(mpi_instance)->comm;
+    MPI_Status status;
+    int err;
 
     Laik_KVS_Changes recvd, changes;
     laik_kvs_changes_init(&changes); // temporary changes struct
@@ -1140,56 +1519,54 @@ static void laik_mpi_sync(Laik_KVStore* kvs)
     dst = &(kvs->changes);
     src = &changes;
 
-    for(int i = 1; i < world->size; i++) {
-        err = MPI_Recv(count, 2, MPI_INTEGER, i, 0, comm, &status);
-        if (err != MPI_SUCCESS) laik_mpi_panic(err);
-        laik_log(1, "MPI sync: getting %d changes (total %d chars) from T%d",
-                 count[0] / 2, count[1], i);
-        laik_kvs_changes_set_size(&recvd, 0, 0); // fresh reuse
-        laik_kvs_changes_ensure_size(&recvd, count[0], count[1]);
-        if (count[0] == 0) {
-            assert(count[1] == 0);
-            continue;
-        }
+    if (mpi_sync.childCount > 0) {
+        // first sort own changes, as preparation for merging
+        laik_kvs_changes_sort(dst);
 
-        assert(count[1] > 0);
-        err = MPI_Recv(recvd.off, count[0], MPI_INTEGER, i, 0, comm, &status);
-        if (err != MPI_SUCCESS) laik_mpi_panic(err);
-        err = MPI_Recv(recvd.data, count[1], MPI_CHAR, i, 0, comm, &status);
-        if (err != MPI_SUCCESS) laik_mpi_panic(err);
-        laik_kvs_changes_set_size(&recvd, count[0], count[1]);
+        // receive changes from children (smaller sub-trees first), merge
+        for(int i = 0; i < mpi_sync.childCount; i++) {
+            err = MPI_Wait(&(mpi_sync.childReq[i]), &status);
+            if (err != MPI_SUCCESS) laik_mpi_panic(err);
+            mpi_recv_changes(&recvd, mpi_sync.childHeader[i],
+                             mpi_sync.child[i], comm);
 
-        // for merging, both inputs need to be sorted
-        laik_kvs_changes_sort(&recvd);
+            // for merging, both inputs need to be sorted
+            laik_kvs_changes_sort(&recvd);
 
-        // swap src/dst: now merging can overwrite dst
-        tmp = src; src = dst; dst = tmp;
+            // swap src/dst: now merging can overwrite dst
+            tmp = src; src = dst; dst = tmp;
 
-        laik_kvs_changes_merge(dst, src, &recvd);
-    }
+            laik_kvs_changes_merge(dst, src, &recvd);
+        }
 
-    // send merged changes to all others: may be 0 entries
-    count[0] = dst->offUsed;
-    count[1] = dst->dataUsed;
-    assert(count[1] > count[0]); // more byte than offsets
-    for(int i = 1; i < world->size; i++) {
-        laik_log(1, "MPI sync: sending %d changes (total %d chars) to T%d",
-                 count[0] / 2, count[1], i);
-        err = MPI_Send(count, 2, MPI_INTEGER, i, 0, comm);
+        if (mpi_sync.parent >= 0)
+            mpi_send_changes(dst, mpi_sync.parent, comm);
+    }
+    else if (mpi_sync.sendReqCount > 0) {
+        // leaf: wait for sends started in laik_mpi_sync_start
+        err = MPI_Waitall(mpi_sync.sendReqCount, mpi_sync.sendReq,
+                          MPI_STATUSES_IGNORE);
         if (err != MPI_SUCCESS) laik_mpi_panic(err);
-        if (count[0] == 0) continue;
+    }
 
-        err = MPI_Send(dst->off, count[0], MPI_INTEGER, i, 0, comm);
-        if (err != MPI_SUCCESS) laik_mpi_panic(err);
-        err = MPI_Send(dst->data, count[1], MPI_CHAR, i, 0, comm);
+    if (mpi_sync.parent >= 0) {
+        // get merged changes from parent
+        err = MPI_Wait(&(mpi_sync.parentReq), &status);
         if (err != MPI_SUCCESS) laik_mpi_panic(err);
+        mpi_recv_changes(&recvd, mpi_sync.parentHeader, mpi_sync.parent, comm);
+        dst = &recvd;
     }
 
+    // forward merged changes to children (larger sub-trees first): may be 0 entries
+    for(int i = mpi_sync.childCount - 1; i >= 0; i--)
+        mpi_send_changes(dst, mpi_sync.child[i], comm);
+
     // TODO: opt - remove own changes from received ones
     laik_kvs_changes_apply(dst, kvs);
 
     laik_kvs_changes_free(&recvd);
     laik_kvs_changes_free(&changes);
+    mpi_sync.kvs = 0;
 }
 
 
@@ -67,51 +67,63 @@ Laik_Group* laik_single_world()
     return single_instance->group[0];
 }
 
+// reductions with only one process are copies from input to output mapping.
+// Nothing to do if the output mapping reuses memory of the input mapping
+static
+void single_reduce(Laik_TransitionContext* tc, struct redTOp* op)
+{
+    Laik_Data* d = tc->data;
+    Laik_Transition* t = tc->transition;
+    Laik_Range* range = &(op->range);
+
+    assert(laik_trans_isInGroup(t, op->outputGroup, t->group->myid));
+    assert(laik_trans_isInGroup(t, op->inputGroup, t->group->myid));
+    assert(op->myInputMapNo < tc->fromList->count);
+    assert(op->myOutputMapNo < tc->toList->count);
+    Laik_Mapping* fromMap = &(tc->fromList->map[op->myInputMapNo]);
+    Laik_Mapping* toMap = &(tc->toList->map[op->myOutputMapNo]);
+    assert(fromMap->base != 0);
+    assert(toMap->base != 0);
+
+    bool aliased = (fromMap->reusedFor == op->myOutputMapNo);
+
+    if (laik_log_begin(1)) {
+        laik_log_append("Single reduce: ");
+        laik_log_Range(range);
+        laik_log_flush(", elemsize %d, map %d => %d%s",
+                       d->elemsize, op->myInputMapNo, op->myOutputMapNo,
+                       aliased ? " (aliased, no copy)" : "");
+    }
+    if (aliased) return;
+
+    laik_data_copy(range, fromMap, toMap);
+}
+
 void laik_single_exec(Laik_ActionSeq* as)
 {
     if (as->backend == 0) {
         as->backend = &laik_backend_single;
         laik_aseq_calc_stats(as);
     }
-    // we only support 1 transition exec action
-    assert(as->actionCount == 1);
-    assert(as->action[0].type == LAIK_AT_TExec);
-    Laik_TransitionContext* tc = as->context[0];
-    Laik_Data* d = tc->data;
-    Laik_Transition* t = tc->transition;
-    Laik_MappingList* fromList = tc->fromList;
-    Laik_MappingList* toList = tc->toList;
-
-    if (t->redCount > 0) {
-        assert(fromList->count == 1);
-        assert(toList->count == 1);
-        Laik_Mapping* fromMap = &(fromList->map[0]);
-        Laik_Mapping* toMap = &(toList->map[0]);
-        char* fromBase = fromMap ? fromMap->base : 0;
-        char* toBase = toMap ? toMap->base : 0;
-
-        for(int i=0; i < t->redCount; i++) {
-            assert(d->space->dims == 1);
-            struct redTOp* op = &(t->red[i]);
-            int64_t from = op->range.from.i[0];
-            int64_t to   = op->range.to.i[0];
-            assert(fromBase != 0);
-            assert(laik_trans_isInGroup(t, op->outputGroup, t->group->myid));
-            assert(toBase != 0);
-            assert(to > from);
-
-            laik_log(1, "Single reduce: "
-                        "from %lld, to %lld, elemsize %d, base from/to %p/%p\n",
-                     (long long int) from, (long long int) to,
-                     d->elemsize, (void*) fromBase, (void*) toBase);
-
-            memcpy(toBase, fromBase, (to-from) * fromMap->data->elemsize);
+
+    // sequences are never prepared by this backend: only TExec actions
+    Laik_Action* a = as->action;
+    for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
+        if (a->type != LAIK_AT_TExec) {
+            laik_log(LAIK_LL_Panic, "Single backend: unexpected action type %d",
+                     a->type);
+            exit(1); // not actually needed, laik_panic never returns
         }
-    }
+        Laik_TransitionContext* tc = as->context[a->tid];
+        Laik_Transition* t = tc->transition;
+
+        // the single backend should never need to do send/recv actions
+        assert(t->recvCount == 0);
+        assert(t->sendCount == 0);
 
-    // the single backend should never need to do send/recv actions
-    assert(t->recvCount == 0);
-    assert(t->sendCount == 0);
+        for(int r = 0; r < t->redCount; r++)
+            single_reduce(tc, &(t->red[r]));
+    }
 }
 
 void laik_single_sync(Laik_KVStore* kvs)
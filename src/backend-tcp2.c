@@ -27,7 +27,8 @@
  * to be announced at registration time, so it is easy to fall back to ASCII
  * with nc/telnet. Also, data packages are only accepted if permission is given
  * by receiver. This enables immediate consumption of all messages without
- * blocking.
+ * blocking. Binary data chunks optionally get compressed (LAIK_TCP2_COMPRESS=1),
+ * if announced by both sender and receiver at registration time.
  *
  * Startup (master)
  * - master process (location ID 0) is the process started on LAIK_TCP2_HOST
@@ -51,6 +52,14 @@
  *       which is 0 for startup (in contract to later joining processes).
  *   These steps are both done in startup and resize mode. However, in startup,
  *   in (2) there are no existing processes
+ * - in startup, steps (2) to (4) run along a binomial tree over all LIDs to
+ *   avoid O(P^2) messages sent by master: the master sends one table with
+ *   infos on all processes via "peers <count> <bytes> <treesize>" (followed by
+ *   binary records, or "newid" lines in text mode) to its children, which
+ *   connect to and forward the table to their own children. Step (3) is
+ *   implicit: a process confirms with "ok <count>" to its parent as soon as it
+ *   got the table and all its children confirmed, with <count> being the
+ *   number of ready processes in its subtree. "phase" is forwarded the same way
  * - master sets application phase 0 for itself and returns control back
  *   to application.
  *
@@ -86,7 +95,8 @@
  * - master sends an "id" line for the new assigned location ID of registering
  *   process "id <id> <location> <host> <port>\n"
  * - master sends further "id" lines, for each existing active process, and
- *   "newid" lines for each newly joining process.
+ *   "newid" lines for each newly joining process, as one peer table ("peers").
+ *   In startup, the table is received from the parent in the bootstrap tree.
  *   With these lists, the newly joining process can create the lists of
  *   existing and joining processes
  * - after master decides that enough processes registered, he sends "getready"
@@ -122,6 +132,12 @@
  *     processes (via "newid"), and processes to remove (via "backout")
  *  - master asks every process to confirm the information sent (via "getready")
  *   - request for confirmation via "getready", waiting for "ok"
+ * - for existing processes, these steps run along a binomial tree over the
+ *   current world group (rooted at master): "enterresize <phase> <epoch> <count>"
+ *   is sent to the parent when all processes in the subtree are in resize mode.
+ *   The peer table only containing new-comers, "backedout" and "getready" are
+ *   forwarded down, "ok <count>" is aggregated upwards and "phase" forwarded
+ *   down again. New-comers get all messages directly from master
  * - new group reflecting the changes is created, and group parent attached.
  *   In newly joining processes the original group (parent) is reconstructed.
  * - control is given back to LAIK
@@ -167,6 +183,8 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/epoll.h>
+#include <fcntl.h>
 #include <arpa/inet.h>
 #include <netinet/tcp.h>
 // for VSC to see def of addrinfo
@@ -179,25 +197,35 @@
 // defaults
 #define TCP2_PORT 7777
 
-#define MAX_PEERS 256
+#define MAX_PEERS 4096
+// initial size of FD table, grows on demand
 #define MAX_FDS 256
+// max. number of events returned by one epoll_wait call
+#define MAX_EVENTS 64
 // receive buffer length
 #define RBUF_LEN 8*1024
+// header of compressed binary chunk: 'Z' + 2 bytes compressed count +
+// 2 bytes raw count + 1 byte element size, followed by compressed data
+#define ZBUF_HEADER 6
 
 // forward decl
 void tcp2_exec(Laik_ActionSeq* as);
 void tcp2_sync(Laik_KVStore* kvs);
+void tcp2_sync_start(Laik_KVStore* kvs);
 Laik_Group* tcp2_resize(Laik_ResizeRequests*);
 void tcp2_finish_resize();
 void tcp2_make_progress();
+void tcp2_finalize(Laik_Instance*);
 
 typedef struct _InstData InstData;
 
 // C guarantees that unset function pointers are NULL
 static Laik_Backend laik_backend = {
     .name = "Dynamic TCP2 Backend",
+    .finalize = tcp2_finalize,
     .exec = tcp2_exec,
     .sync = tcp2_sync,
+    .sync_start = tcp2_sync_start,
     .resize = tcp2_resize,
     .finish_resize = tcp2_finish_resize,
     .make_progress = tcp2_make_progress
@@ -244,6 +272,7 @@ typedef struct _Peer {
 
     // capabilities
     bool accepts_bin_data; // accepts binary data
+    bool accepts_zip;      // accepts compressed binary data
 
     // data we are currently receiving from peer
     int rcount;    // element count in receive
@@ -258,6 +287,20 @@ typedef struct _Peer {
     int scount;    // element count allowed to send, 0 if not
     int selemsize; // byte count expected per element
 
+    // KVS changes we are currently receiving from peer
+    Laik_KVS_Changes* kvs_rchanges; // 0 if not expecting changes
+    int kvs_rcount;    // number of changes announced, -1 if not yet
+    int kvs_received;  // number of changes received
+    char* kvs_rbuf;    // binary mode: buffer for offsets and data
+    int kvs_rlen;      // binary mode: bytes expected
+    int kvs_roff;      // binary mode: bytes received
+    int kvs_roffcount; // binary mode: number of offsets
+
+    // binary peer table we are currently receiving from peer
+    char* ptab_rbuf;   // buffer for records
+    int ptab_rlen;     // bytes expected
+    int ptab_roff;     // bytes received
+
     // info on early-entered resize phase (only used at master)
     int phase, epoch;
 } Peer;
@@ -275,6 +318,13 @@ typedef struct {
     char* rbuf;
     // if > 0 we are in binary data receive mode, outstanding bytes
     int outstanding_bin;
+    // compressed binary chunk: collected in zbuf (0 if not in zip mode)
+    char* zbuf;
+    int zused, zraw, zwidth;
+
+    // edge-triggered events: input may be pending until callback drained FD
+    bool ready;       // input pending
+    bool queued;      // in ready list (may be stale entry of closed FD)
 } FDState;
 
 struct _InstData {
@@ -288,18 +338,43 @@ struct _InstData {
     int phase;        // current phase
     int epoch;        // current epoch
     bool accept_bin_data; // configured to accept binary data
+    bool accept_zip;      // configured to accept/send compressed data
+
+    // statistics for compressed data
+    uint64_t zip_chunks, zip_rawchunks; // chunks sent compressed/raw
+    uint64_t zip_inbytes, zip_outbytes; // bytes before/after compression
+    double zip_time, unzip_time;
 
     // event loop
-    int maxfds;       // highest fd in rset
-    fd_set rset;      // read set for select
+    int epollfd;      // epoll instance for all registered FDs
     int exit;         // set to exit event loop
-    FDState fds[MAX_FDS];
+    int fds_size;     // size of <fds> and <readyList>
+    FDState* fds;     // indexed by FD
+    int readyCount;   // number of entries in <readyList>
+    int* readyList;   // FDs with pending input (see FDState.queued)
 
     // currently synced KVS (usually NULL)
     Laik_KVStore* kvs;
     char *kvs_name;  // non-null if sending changes of KVS with given name allowed
-    int kvs_changes; // number of changes expected
-    int kvs_received; // counter for incoming changes
+    bool kvs_sent;   // own (merged) changes already sent to parent
+    // KVS sync runs along binomial tree of LIDs
+    int kvs_parent;  // LID of parent in tree, -1 for root
+    int kvs_childCount;
+    int kvs_child[LAIK_KVS_TREE_MAXCHILDREN];
+    Laik_KVS_Changes kvs_cchanges[LAIK_KVS_TREE_MAXCHILDREN]; // from children
+    Laik_KVS_Changes kvs_pchanges; // merged changes from parent
+
+    // peer table distribution (see "peers" command)
+    int ptab_expect;  // number of peer infos still expected, 0 if none
+    int tree_size;    // bootstrap tree over LIDs 0..tree_size-1, 0 if not in use
+    int tree_parent;  // LID of parent in bootstrap/resize tree, -1 for root
+    int tree_childCount;
+    int tree_child[LAIK_KVS_TREE_MAXCHILDREN];
+    int tree_pending; // children not yet confirmed to be ready
+    int tree_ready;   // number of ready processes in subtrees of children
+    // resize: steps run along binomial tree over processes of current world
+    int tree_entered;      // children which entered resize
+    int tree_enteredCount; // number of processes in their subtrees
 
     int init_wsize;   // for master in startup: initial world size
     int peers;        // number of known peers (= valid entries in peer entry)
@@ -351,6 +426,14 @@ char* istr(int dims, Laik_Index* idx)
     return str;
 }
 
+// flags string for capabilities of a peer, as used in commands
+static
+char* get_flagstring(bool bin, bool zip)
+{
+    if (!bin) return "-";
+    return zip ? "bz" : "b";
+}
+
 static
 char* get_statestring(PeerState st)
 {
@@ -449,34 +532,126 @@ char* get_statestring(PeerState st)
 
 
 // event loop functions
+//
+// The event loop uses epoll in edge-triggered mode: an event only is signaled
+// when new input arrives. Thus, FDs with pending input are kept in a ready
+// list, and their callback is called (once per loop iteration) until it
+// signals via fd_drained() that no further input is available.
+
+// make sure FD table can be indexed with <fd>
+static
+void grow_fds(InstData* d, int fd)
+{
+    int newsize = (d->fds_size > 0) ? d->fds_size : MAX_FDS;
+    while(newsize <= fd) newsize *= 2;
+    d->fds = realloc(d->fds, newsize * sizeof(FDState));
+    d->readyList = realloc(d->readyList, newsize * sizeof(int));
+    if ((d->fds == 0) || (d->readyList == 0)) {
+        laik_panic("TCP2 Out of memory allocating FD table");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    for(int i = d->fds_size; i < newsize; i++) {
+        d->fds[i].state = PS_Invalid;
+        d->fds[i].cb = 0;
+        d->fds[i].rbuf = 0;
+        d->fds[i].zbuf = 0;
+        d->fds[i].ready = false;
+        d->fds[i].queued = false;
+    }
+    d->fds_size = newsize;
+}
 
 void add_rfd(InstData* d, int fd, loop_cb_t cb)
 {
-    assert(fd < MAX_FDS);
+    assert(fd >= 0);
+    if (fd >= d->fds_size) grow_fds(d, fd);
     assert(d->fds[fd].cb == 0);
 
-    FD_SET(fd, &d->rset);
-    if (fd > d->maxfds) d->maxfds = fd;
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    ev.data.fd = fd;
+    if (epoll_ctl(d->epollfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        laik_log(LAIK_LL_Panic, "TCP2 cannot add FD %d to epoll set: %s",
+                 fd, strerror(errno));
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
     d->fds[fd].cb = cb;
     d->fds[fd].lid = -1;
     d->fds[fd].cmd = 0; // no unprocessed command
     d->fds[fd].rbuf = malloc(RBUF_LEN);
     d->fds[fd].rbuf_used = 0;
     d->fds[fd].outstanding_bin = 0;
+    d->fds[fd].zbuf = 0;
+    // input which arrived before registration is signaled as first event
+    d->fds[fd].ready = false;
 }
 
 void rm_rfd(InstData* d, int fd)
 {
-    assert(fd < MAX_FDS);
+    assert((fd >= 0) && (fd < d->fds_size));
     assert(d->fds[fd].cb != 0);
 
-    FD_CLR(fd, &d->rset);
-    if (fd == d->maxfds)
-        while(!FD_ISSET(d->maxfds, &d->rset)) d->maxfds--;
+    // closed FDs are removed from epoll set automatically
+    epoll_ctl(d->epollfd, EPOLL_CTL_DEL, fd, 0);
     d->fds[fd].cb = 0;
     d->fds[fd].state = PS_Invalid;
+    d->fds[fd].ready = false;
     free(d->fds[fd].rbuf);
     d->fds[fd].rbuf = 0;
+    free(d->fds[fd].zbuf);
+    d->fds[fd].zbuf = 0;
+}
+
+// called by callbacks: no more input available on <fd>
+static
+void fd_drained(InstData* d, int fd)
+{
+    d->fds[fd].ready = false;
+}
+
+// wait for events up to <timeout> ms (-1: block), move FDs into ready list.
+// Returns number of events
+static
+int wait_events(InstData* d, int timeout)
+{
+    struct epoll_event ev[MAX_EVENTS];
+    int n = epoll_wait(d->epollfd, ev, MAX_EVENTS, timeout);
+    if (n < 0) {
+        if (errno != EINTR)
+            laik_log(LAIK_LL_Warning, "TCP2 epoll_wait error: %s", strerror(errno));
+        return 0;
+    }
+    for(int i = 0; i < n; i++) {
+        int fd = ev[i].data.fd;
+        if ((fd >= d->fds_size) || (d->fds[fd].cb == 0)) continue;
+        d->fds[fd].ready = true;
+        if (d->fds[fd].queued) continue;
+        d->fds[fd].queued = true;
+        d->readyList[d->readyCount++] = fd;
+    }
+    return n;
+}
+
+// call callback of each FD in ready list, then remove drained FDs from list
+static
+void serve_ready(InstData* d)
+{
+    // callbacks may close FDs and add new ones: re-check count and state
+    for(int i = 0; i < d->readyCount; i++) {
+        int fd = d->readyList[i];
+        if (d->fds[fd].ready && d->fds[fd].cb)
+            (d->fds[fd].cb)(d, fd);
+    }
+    int count = 0;
+    for(int i = 0; i < d->readyCount; i++) {
+        int fd = d->readyList[i];
+        if (d->fds[fd].ready && d->fds[fd].cb)
+            d->readyList[count++] = fd;
+        else
+            d->fds[fd].queued = false;
+    }
+    d->readyCount = count;
 }
 
 // run event loop until an event handler asks to exit
@@ -484,33 +659,19 @@ void run_loop(InstData* d)
 {
     d->exit = 0;
     while(d->exit == 0) {
-        fd_set rset = d->rset;
-        if (select(d->maxfds+1, &rset, 0, 0, 0) >= 0) {
-            for(int i = 0; i <= d->maxfds; i++)
-                if (FD_ISSET(i, &rset)) {
-                    assert(d->fds[i].cb != 0);
-                    (d->fds[i].cb)(d, i);
-                }
-        }
+        // only block if there is no pending input
+        wait_events(d, (d->readyCount > 0) ? 0 : -1);
+        serve_ready(d);
     }
 }
 
 // handle queued input and return immediatly
 void check_loop(InstData* d)
 {
-    struct timeval tv = {0,0}; // zero timeout: do not block
-
     while(1) {
-        fd_set rset = d->rset;
-        int ready = select(d->maxfds+1, &rset, 0, 0, &tv);
-        if (ready >= 0) {
-            for(int i = 0; i <= d->maxfds; i++)
-                if (FD_ISSET(i, &rset)) {
-                    assert(d->fds[i].cb != 0);
-                    (d->fds[i].cb)(d, i);
-                }
-        }
-        if (ready == 0) break;
+        int n = wait_events(d, 0);
+        if ((n == 0) && (d->readyCount == 0)) break;
+        serve_ready(d);
     }
 }
 
@@ -565,8 +726,13 @@ void ensure_conn(InstData* d, int lid)
     if (d->peer[lid].state == PS_Error) {
         return; // cannot revive a broken connection
     }
+    // in startup, the peer table is forwarded to children in bootstrap tree
+    // before they are ready (they accept connections from their parent).
+    // In resize, processes marked for removal still forward along the tree
     assert((d->peer[lid].state == PS_Ready) ||
-           (d->peer[lid].state == PS_ReadyRemove));
+           (d->peer[lid].state == PS_ReadyRemove) ||
+           (d->peer[lid].state == PS_InResizeRemove) ||
+           ((d->peer[lid].state == PS_NoConnect) && (d->mystate == PS_RegAccepted)));
 
     if (d->peer[lid].port < 0) {
         // we want to connect, but cannot: peer becomes broken
@@ -692,11 +858,50 @@ void send_bin(InstData* d, int lid, char* buf, int len)
     }
 }
 
+// binary data for KVS changes announced by "kvs bin" command
+static
+int got_kvs_bin_data(InstData* d, int lid, char* buf, int len)
+{
+    Peer* p = &(d->peer[lid]);
+    int consumed = p->kvs_rlen - p->kvs_roff;
+    if (consumed > len) consumed = len;
+    memcpy(p->kvs_rbuf + p->kvs_roff, buf, consumed);
+    p->kvs_roff += consumed;
+    if (p->kvs_roff < p->kvs_rlen) return consumed;
+
+    // all received: copy into change journal
+    Laik_KVS_Changes* c = p->kvs_rchanges;
+    int offBytes = p->kvs_roffcount * sizeof(int);
+    int dlen = p->kvs_rlen - offBytes;
+    laik_kvs_changes_ensure_size(c, p->kvs_roffcount, dlen);
+    memcpy(c->off, p->kvs_rbuf, offBytes);
+    memcpy(c->data, p->kvs_rbuf + offBytes, dlen);
+    laik_kvs_changes_set_size(c, p->kvs_roffcount, dlen);
+    laik_log(1, "TCP2 got %d KVS changes (%d bytes) from LID %d",
+             p->kvs_rcount, dlen, lid);
+
+    free(p->kvs_rbuf);
+    p->kvs_rbuf = 0;
+    p->kvs_rlen = 0;
+    p->kvs_roff = 0;
+    p->kvs_received = p->kvs_rcount;
+    d->exit = 1;
+
+    return consumed;
+}
+
+static int got_peers_bin_data(InstData* d, int lid, char* buf, int len);
+
 int got_binary_data(InstData* d, int lid, char* buf, int len)
 {
     laik_log(1, "TCP2 got binary data (from LID %d, len %d)", lid, len);
 
     Peer* p = &(d->peer[lid]);
+    if (p->kvs_roff < p->kvs_rlen)
+        return got_kvs_bin_data(d, lid, buf, len);
+    if (p->ptab_roff < p->ptab_rlen)
+        return got_peers_bin_data(d, lid, buf, len);
+
     if ((p->rcount == 0) || (p->rcount == p->roff)) {
         laik_log(LAIK_LL_Warning, "TCP2 ignoring data from LID %d without send permission", lid);
         return len;
@@ -873,12 +1078,16 @@ void got_register(InstData* d, int fd, int lid, char* msg)
         p = -1;
     }
 
-    bool accepts_bin_data = false;
+    bool accepts_bin_data = false, accepts_zip = false;
     if (res == 5) {
         // parse optional flags
-        for(int i = 0; (i < 5) && flags[i]; i++)
+        for(int i = 0; (i < 5) && flags[i]; i++) {
             if (flags[i] == 'b') accepts_bin_data = true;
+            if (flags[i] == 'z') accepts_zip = true;
+        }
     }
+    // compressed data is sent in binary mode
+    accepts_zip = accepts_zip && accepts_bin_data;
 
     lid = ++d->maxid;
     assert(fd >= 0);
@@ -888,8 +1097,8 @@ void got_register(InstData* d, int fd, int lid, char* msg)
     char loc[70];
     sprintf(loc, "L%d:%s", lid, l);
 
-    laik_log(1, "TCP2 registered new LID %d: location %s (at host %s, port %d, flags %c)",
-             lid, loc, h, p, accepts_bin_data ? 'b' : '-');
+    laik_log(1, "TCP2 registered new LID %d: location %s (at host %s, port %d, flags %s)",
+             lid, loc, h, p, get_flagstring(accepts_bin_data, accepts_zip));
 
     assert(d->peer[lid].port == -1);
     d->peer[lid].state = PS_RegAccepted;
@@ -898,13 +1107,15 @@ void got_register(InstData* d, int fd, int lid, char* msg)
     d->peer[lid].location = strdup(loc);
     d->peer[lid].port = p;
     d->peer[lid].accepts_bin_data = accepts_bin_data;
+    d->peer[lid].accepts_zip = accepts_zip;
     // first time we use this id for a peer: init receive
     d->peer[lid].rcount = 0;
     d->peer[lid].scount = 0;
 
     // send response to registering process: notify about assigned LID
     char str[150];
-    sprintf(str, "id %d %s %s %d %s", lid, loc, h, p, accepts_bin_data ? "b":"-");
+    sprintf(str, "id %d %s %s %d %s", lid, loc, h, p,
+            get_flagstring(accepts_bin_data, accepts_zip));
     send_cmd(d, lid, str);
 
     d->peers++;
@@ -943,9 +1154,24 @@ void got_myid(InstData* d, int fd, int lid, char* msg)
     lid = peerid;
     assert((lid >= 0) && (lid < MAX_PEERS));
     assert(lid <= d->maxid);
-    d->peer[lid].fd = fd;
     assert(fd >= 0);
     d->fds[fd].lid = lid;
+    if (d->peer[lid].fd >= 0) {
+        // both sides connected to each other at the same time: keep sending
+        // via our own connection to keep order, only receive on this one
+        laik_log(1, "TCP2 LID %d also connected at FD %d (we use FD %d)",
+                 lid, fd, d->peer[lid].fd);
+        return;
+    }
+    d->peer[lid].fd = fd;
+
+    if (d->peer[lid].location == 0) {
+        // in startup, our parent in bootstrap tree connects to forward the
+        // peer table which includes info about itself
+        assert(d->mystate == PS_RegAccepted);
+        laik_log(1, "TCP2 seen LID %d at FD %d (info comes with peer table)", lid, fd);
+        return;
+    }
 
     // must already be known, announced by master
     assert(d->peer[lid].location != 0);
@@ -1040,6 +1266,7 @@ void got_help(InstData* d, int fd, int lid)
     send_cmd(d, lid, "#  getready                     : request to finish registration");
     send_cmd(d, lid, "#  id <id> <loc> <host> <port> <flags> : announce location id info");
     send_cmd(d, lid, "#  kvs allow <name>             : allow to send changes for KVS");
+    send_cmd(d, lid, "#  kvs bin <offsets> <bytes>    : announce binary changes for KVS");
     send_cmd(d, lid, "#  kvs changes <count>          : announce number of changes for KVS");
     send_cmd(d, lid, "#  kvs data <key> <value>       : send changed KVS entry");
     send_cmd(d, lid, "#  myid <id>                    : identify your location id");
@@ -1048,6 +1275,7 @@ void got_help(InstData* d, int fd, int lid)
     send_cmd(d, lid, "#  register <loc> [<host> [<port> [<flags>]]] : request assignment of id");
     send_cmd(d, lid, "# Flags:");
     send_cmd(d, lid, "#  b                            : process accepts binary data format");
+    send_cmd(d, lid, "#  z                            : process accepts compressed binary data");
 }
 
 void got_terminate(InstData* d, int fd, int lid)
@@ -1083,9 +1311,10 @@ void got_status(InstData* d, int fd, int lid)
 
     send_cmd(d, lid, "# Known peers:");
     for(int i = 0; i <= d->maxid; i++) {
-        sprintf(msg, "#  LID%2d loc '%s' at host '%s' port %d flags %c", i,
+        sprintf(msg, "#  LID%2d loc '%s' at host '%s' port %d flags %s", i,
                     d->peer[i].location, d->peer[i].host, d->peer[i].port,
-                    d->peer[i].accepts_bin_data ? 'b':'-');
+                    get_flagstring(d->peer[i].accepts_bin_data,
+                                   d->peer[i].accepts_zip));
         send_cmd(d, lid, msg);
         if (d->peer[i].fd >= 0) {
             sprintf(msg, "#        open connection at FD %d", d->peer[i].fd);
@@ -1096,7 +1325,7 @@ void got_status(InstData* d, int fd, int lid)
         send_cmd(d, lid, msg);
     }
     bool header_sent = false;
-    for(int i = 0; i < MAX_FDS; i++) {
+    for(int i = 0; i < d->fds_size; i++) {
         if (d->fds[i].state == PS_Invalid) continue;
         if (d->fds[i].lid >= 0) continue;
         if (!header_sent) {
@@ -1114,6 +1343,71 @@ void got_status(InstData* d, int fd, int lid)
     }
 }
 
+// flags of records in binary peer table
+#define PTAB_BIN 1 // peer accepts binary data
+#define PTAB_NEW 2 // peer is joining (as announced by "newid")
+#define PTAB_ZIP 4 // peer accepts compressed binary data
+
+static void tree_forward_peers(InstData* d);
+static void tree_confirm(InstData* d);
+static int world_tree(int* parent, int* child);
+
+// store info about peer <lid> (from "id"/"newid" command or peer table)
+static
+void set_peer_info(InstData* d, int lid, char* l, char* h, int p,
+                   bool accepts_bin_data, bool accepts_zip, bool newid)
+{
+    assert((lid >= 0) && (lid < MAX_PEERS));
+    if (lid > d->maxid) d->maxid = lid;
+
+    // must be information about another peer
+    assert(lid != d->mylid);
+    // should not get same information twice
+    assert(d->peer[lid].location == 0);
+
+    // set peer state depending on own state
+    switch(d->mystate) {
+        case PS_RegAccepted:
+            // in newcomer, announced process is:
+            // - (with "id") existing process in resize mode
+            // - (with "newid") newcomer, not allowed to connect yet
+            d->peer[lid].state = newid ? PS_NoConnect : PS_InResize;
+            break;
+        case PS_InResize:
+            // in existing process: this is a new-comer, no connect yet
+            d->peer[lid].state = PS_NoConnect;
+            assert(newid); // only new ids announced to existing processes
+            break;
+        default:
+            laik_panic("Got id in wrong phase");
+    }
+    d->peer[lid].host = strdup(h);
+    d->peer[lid].location = strdup(l);
+    d->peer[lid].port = p;
+    d->peer[lid].accepts_bin_data = accepts_bin_data;
+    d->peer[lid].accepts_zip = accepts_zip;
+
+    // first time we see this peer: init receive
+    d->peer[lid].rcount = 0;
+    d->peer[lid].scount = 0;
+
+    d->peers++;
+
+    laik_log(1, "TCP2 seen peer LID %d (location %s, at %s, port %d, flags %s), known peers %d",
+             lid, l, h, p, get_flagstring(accepts_bin_data, accepts_zip), d->peers);
+
+    // announced as part of a peer table?
+    if (d->ptab_expect > 0) {
+        d->ptab_expect--;
+        if (d->ptab_expect == 0) {
+            laik_log(1, "TCP2 peer table complete");
+            d->exit = 1;
+            if (d->tree_size > 0)
+                tree_forward_peers(d);
+        }
+    }
+}
+
 void got_id(InstData* d, int from_lid, char* msg)
 {
     // id <lid> <location> <host> <port> <flags>
@@ -1135,16 +1429,17 @@ void got_id(InstData* d, int from_lid, char* msg)
     bool newid = (cmd[0] == 'n');
 
     // parse flags
-    bool accepts_bin_data = false;
-    for(int i = 0; (i < 5) && flags[i]; i++)
+    bool accepts_bin_data = false, accepts_zip = false;
+    for(int i = 0; (i < 5) && flags[i]; i++) {
         if (flags[i] == 'b') accepts_bin_data = true;
-
-    assert((lid >= 0) && (lid < MAX_PEERS));
-    if (lid > d->maxid) d->maxid = lid;
+        if (flags[i] == 'z') accepts_zip = true;
+    }
 
     if (d->mylid < 0) {
         // must be response from master about accepted registration
         assert(from_lid == 0);
+        assert((lid >= 0) && (lid < MAX_PEERS));
+        if (lid > d->maxid) d->maxid = lid;
         d->mystate = PS_RegAccepted;
         d->mylid = lid;
 
@@ -1155,6 +1450,7 @@ void got_id(InstData* d, int from_lid, char* msg)
         assert(strcmp(d->host, h) == 0);
         assert(d->listenport == p);
         assert(d->accept_bin_data == accepts_bin_data);
+        assert((d->accept_bin_data && d->accept_zip) == accepts_zip);
 
         // copy my data also to d->peer[mylid]
         d->peer[lid].state    = d->mystate;
@@ -1162,46 +1458,277 @@ void got_id(InstData* d, int from_lid, char* msg)
         d->peer[lid].location = d->location;
         d->peer[lid].port     = d->listenport;
         d->peer[lid].accepts_bin_data = accepts_bin_data;
+        d->peer[lid].accepts_zip = accepts_zip;
 
-        laik_log(1, "TCP2 got my LID %d assigned (location %s, at %s, port %d, flags %c)",
-             lid, l, h, p, accepts_bin_data ? 'b':'-');
+        laik_log(1, "TCP2 got my LID %d assigned (location %s, at %s, port %d, flags %s)",
+             lid, l, h, p, get_flagstring(accepts_bin_data, accepts_zip));
         return;
     }
 
-    // must be information about another peer
-    assert(lid != d->mylid);
-    // should not get same information twice
-    assert(d->peer[lid].location == 0);
+    set_peer_info(d, lid, l, h, p, accepts_bin_data, accepts_zip, newid);
+}
 
-    // set peer state depending on own state
-    switch(d->mystate) {
-        case PS_RegAccepted:
-            // in newcomer, announced process is:
-            // - (with "id") existing process in resize mode
-            // - (with "newid") newcomer, not allowed to connect yet
-            d->peer[lid].state = newid ? PS_NoConnect : PS_InResize;
-            break;
-        case PS_InResize:
-            // in existing process: this is a new-comer, no connect yet
-            d->peer[lid].state = PS_NoConnect;
-            assert(newid); // only new ids announced to existing processes
-            break;
-        default:
-            laik_panic("Got id in wrong phase");
+void got_peers(InstData* d, int lid, char* msg)
+{
+    // peers <count> <bytes> <treesize>
+    //  followed by <bytes> binary records, or <count> "id"/"newid" lines if 0
+    //  <treesize> > 0: forward along bootstrap tree over LIDs 0..<treesize>-1
+    char cmd[21];
+    int count, bytes, treesize;
+    if (sscanf(msg, "%20s %d %d %d", cmd, &count, &bytes, &treesize) < 4) {
+        laik_log(LAIK_LL_Warning, "cannot parse peers command '%s'; ignoring", msg);
+        return;
+    }
+    if (d->mylid <= 0) {
+        laik_log(LAIK_LL_Warning, "ignoring peers command '%s'", msg);
+        return;
     }
-    d->peer[lid].host = strdup(h);
-    d->peer[lid].location = strdup(l);
-    d->peer[lid].port = p;
-    d->peer[lid].accepts_bin_data = accepts_bin_data;
 
-    // first time we see this peer: init receive
-    d->peer[lid].rcount = 0;
-    d->peer[lid].scount = 0;
+    laik_log(1, "TCP2 got peer table with %d entries (%d bytes) from LID %d, tree size %d",
+             count, bytes, lid, treesize);
+    assert(count > 0);
+    assert(d->ptab_expect == 0);
+    d->ptab_expect = count;
+    d->tree_size = treesize;
+    if (bytes == 0) return; // text mode: "id"/"newid" lines follow
 
-    d->peers++;
+    Peer* p = &(d->peer[lid]);
+    assert(p->ptab_rlen == 0);
+    p->ptab_rlen = bytes;
+    p->ptab_roff = 0;
+    p->ptab_rbuf = malloc(bytes);
+}
+
+// binary records for peer table announced by "peers" command
+static
+int got_peers_bin_data(InstData* d, int lid, char* buf, int len)
+{
+    Peer* p = &(d->peer[lid]);
+    int consumed = p->ptab_rlen - p->ptab_roff;
+    if (consumed > len) consumed = len;
+    memcpy(p->ptab_rbuf + p->ptab_roff, buf, consumed);
+    p->ptab_roff += consumed;
+    if (p->ptab_roff < p->ptab_rlen) return consumed;
+
+    // all received. Record: <lid> <port> (int32) <flags> <location>\0<host>\0
+    char* rec = p->ptab_rbuf;
+    char* end = rec + p->ptab_rlen;
+    char* tab = rec;
+    p->ptab_rbuf = 0;
+    p->ptab_rlen = 0;
+    p->ptab_roff = 0;
+    while(rec < end) {
+        int32_t plid, port;
+        memcpy(&plid, rec, 4);
+        memcpy(&port, rec + 4, 4);
+        int flags = (unsigned char) rec[8];
+        char* l = rec + 9;
+        char* h = l + strlen(l) + 1;
+        rec = h + strlen(h) + 1;
+        assert(rec <= end);
+        set_peer_info(d, plid, l, h, port, (flags & PTAB_BIN) != 0,
+                      (flags & PTAB_ZIP) != 0, (flags & PTAB_NEW) != 0);
+    }
+    free(tab);
+
+    return consumed;
+}
 
-    laik_log(1, "TCP2 seen peer LID %d (location %s, at %s, port %d, flags %c), known peers %d",
-             lid, l, h, p, accepts_bin_data ? 'b':'-', d->peers);
+// is <lid> announced as newcomer in a peer table?
+static
+bool ptab_isnew(InstData* d, int lid, int treesize)
+{
+    // in startup, all processes are new. In resize, new-comers are
+    // RegAccepted/RegFinishing in master, NoConnect in other processes
+    if (treesize > 0) return true;
+    PeerState st = d->peer[lid].state;
+    return (st == PS_RegAccepted) || (st == PS_RegFinishing) || (st == PS_NoConnect);
+}
+
+// send table with infos about all known peers (if <onlyNew>: only joining ones)
+// to <to_lid> as one "peers" command. In binary mode, records are sent as
+// chunks of up to 64k bytes
+static
+void send_peers(InstData* d, int to_lid, int treesize, bool onlyNew)
+{
+    int count = 0, bytes = 0;
+    for(int lid = 0; lid <= d->maxid; lid++) {
+        Peer* p = &(d->peer[lid]);
+        if ((lid == to_lid) || (p->state == PS_Dead) || (p->location == 0)) continue;
+        if (onlyNew && !ptab_isnew(d, lid, treesize)) continue;
+        count++;
+        bytes += 9 + strlen(p->location) + 1 + strlen(p->host) + 1;
+    }
+    if (count == 0) return;
+
+    char msg[150];
+    bool bin = d->peer[to_lid].accepts_bin_data;
+    sprintf(msg, "peers %d %d %d", count, bin ? bytes : 0, treesize);
+    send_cmd(d, to_lid, msg);
+
+    int chunks = (bytes + 65534) / 65535;
+    char* buf = bin ? malloc(bytes + 3 * chunks) : 0;
+    int off = 0, chunkLeft = 0;
+    for(int lid = 0; lid <= d->maxid; lid++) {
+        Peer* p = &(d->peer[lid]);
+        if ((lid == to_lid) || (p->state == PS_Dead) || (p->location == 0)) continue;
+        bool isnew = ptab_isnew(d, lid, treesize);
+        if (onlyNew && !isnew) continue;
+        if (!bin) {
+            sprintf(msg, "%s %d %s %s %d %s", isnew ? "newid" : "id", lid,
+                    p->location, p->host, p->port,
+                    get_flagstring(p->accepts_bin_data, p->accepts_zip));
+            send_cmd(d, to_lid, msg);
+            continue;
+        }
+
+        char rec[150];
+        int32_t v = lid;
+        memcpy(rec, &v, 4);
+        v = p->port;
+        memcpy(rec + 4, &v, 4);
+        rec[8] = (p->accepts_bin_data ? PTAB_BIN : 0) |
+                 (p->accepts_zip ? PTAB_ZIP : 0) | (isnew ? PTAB_NEW : 0);
+        int llen = strlen(p->location) + 1, hlen = strlen(p->host) + 1;
+        memcpy(rec + 9, p->location, llen);
+        memcpy(rec + 9 + llen, p->host, hlen);
+        // copy record, records may be split among chunks
+        for(int i = 0; i < 9 + llen + hlen; i++) {
+            if (chunkLeft == 0) {
+                // start new chunk: 'B' + 2 bytes count
+                chunkLeft = bytes > 65535 ? 65535 : bytes;
+                bytes -= chunkLeft;
+                buf[off++] = 'B';
+                buf[off++] = chunkLeft & 255;
+                buf[off++] = chunkLeft >> 8;
+            }
+            buf[off++] = rec[i];
+            chunkLeft--;
+        }
+    }
+    if (bin) {
+        send_bin(d, to_lid, buf, off);
+        free(buf);
+    }
+}
+
+// startup: forward peer table to children in bootstrap tree
+static
+void tree_forward_peers(InstData* d)
+{
+    int parent, child[LAIK_KVS_TREE_MAXCHILDREN];
+    d->tree_childCount = laik_kvs_tree(d->mylid, d->tree_size, &parent, child);
+    d->tree_parent = parent;
+    d->tree_pending = d->tree_childCount;
+    d->tree_ready = 0;
+    laik_log(1, "TCP2 forwarding peer table to %d children in bootstrap tree (parent LID %d)",
+             d->tree_childCount, parent);
+
+    for(int i = 0; i < d->tree_childCount; i++) {
+        d->tree_child[i] = child[i];
+        send_peers(d, child[i], d->tree_size, false);
+    }
+    if (d->tree_pending == 0)
+        tree_confirm(d);
+}
+
+// resize: parent and children (as LIDs) of this process in binomial tree
+// over the processes of the current world, rooted at master (index 0)
+static
+int world_tree(int* parent, int* child)
+{
+    Laik_Group* w = instance->world;
+    assert(w->locationid[0] == 0);
+    int p, c[LAIK_KVS_TREE_MAXCHILDREN];
+    int count = laik_kvs_tree(w->myid, w->size, &p, c);
+    *parent = (p < 0) ? -1 : w->locationid[p];
+    for(int i = 0; i < count; i++)
+        child[i] = w->locationid[c[i]];
+    return count;
+}
+
+// resize: send LIDs of all processes marked for removal to <to_lid>
+static
+void send_backedout(InstData* d, int to_lid)
+{
+    char msg[30];
+    for(int lid = 0; lid <= d->maxid; lid++) {
+        if (d->peer[lid].state != PS_InResizeRemove) continue;
+        sprintf(msg, "backedout %d", lid);
+        send_cmd(d, to_lid, msg);
+    }
+}
+
+// resize: forward new-comers, removals and 'getready' to children in tree
+// over the current world. Confirmation via tree_confirm (when no children
+// are pending) must be triggered by the caller after updating its state
+static
+void tree_forward_resize(InstData* d)
+{
+    int child[LAIK_KVS_TREE_MAXCHILDREN];
+    d->tree_childCount = world_tree(&(d->tree_parent), child);
+    d->tree_pending = d->tree_childCount;
+    d->tree_ready = 0;
+    laik_log(1, "TCP2 resize: forwarding changes to %d children in tree (parent LID %d)",
+             d->tree_childCount, d->tree_parent);
+
+    for(int i = 0; i < d->tree_childCount; i++) {
+        d->tree_child[i] = child[i];
+        send_peers(d, child[i], 0, true);
+        send_backedout(d, child[i]);
+        send_cmd(d, child[i], "getready");
+    }
+}
+
+// startup/resize: myself and all processes in my subtree are ready
+static
+void tree_confirm(InstData* d)
+{
+    int ready = d->tree_ready + 1; // including myself
+
+    if ((d->mylid == 0) && (d->mystate == PS_InResize2)) {
+        // master in resize: all processes of current world accepted changes
+        Laik_Group* w = instance->world;
+        assert(ready == w->size);
+        for(int i = 1; i < w->size; i++) {
+            Peer* p = &(d->peer[w->locationid[i]]);
+            if (p->state == PS_InResize2)
+                p->state = PS_InResize3;
+            else if (p->state == PS_InResizeRemove2)
+                p->state = PS_InResizeRemove3;
+            else
+                assert(0); // should not happen
+        }
+        return;
+    }
+
+    if (d->mylid == 0) {
+        // master: everybody ready
+        assert(ready == d->tree_size);
+        for(int lid = 1; lid <= d->maxid; lid++)
+            d->peer[lid].state = PS_Ready;
+        d->readyPeers = ready - 1;
+        d->mystate = PS_Ready;
+        return;
+    }
+
+    char msg[30];
+    sprintf(msg, "ok %d", ready);
+    send_cmd(d, d->tree_parent, msg);
+    if (d->mystate == PS_RegAccepted) {
+        // startup: ready now. In resize, state was set on 'getready'
+        d->mystate = PS_Ready;
+        d->peer[d->mylid].state = PS_Ready;
+    }
+}
+
+// is <lid> a child in bootstrap/resize tree?
+static
+bool is_tree_child(InstData* d, int lid)
+{
+    for(int i = 0; i < d->tree_childCount; i++)
+        if (d->tree_child[i] == lid) return true;
+    return false;
 }
 
 void got_phase(InstData* d, char* msg)
@@ -1224,30 +1751,44 @@ void got_phase(InstData* d, char* msg)
     d->phase = phase;
     d->epoch = epoch;
 
+    // startup/resize: forward to children in tree, which is not used any more
+    if (d->tree_childCount > 0) {
+        char str[50];
+        sprintf(str, "phase %d %d", phase, epoch);
+        for(int i = 0; i < d->tree_childCount; i++)
+            send_cmd(d, d->tree_child[i], str);
+    }
+    d->tree_childCount = 0;
+    d->tree_size = 0;
+
     d->exit = 1;
 }
 
 void got_enterresize(InstData* d, int lid, char* msg)
 {
-    // enterresize [<phase> [<epoch>]]
+    // enterresize [<phase> [<epoch> [<count>]]]
+    //  sent by child in tree over current world when itself and all
+    //  processes in its subtree (<count>) are in resize mode
     char cmd[21];
-    int phase, epoch;
-    int res = sscanf(msg, "%20s %d %d", cmd, &phase, &epoch);
+    int phase, epoch, count;
+    int res = sscanf(msg, "%20s %d %d %d", cmd, &phase, &epoch, &count);
     if (res < 1) {
         laik_log(LAIK_LL_Warning, "cannot parse enterresize command '%s'; ignoring", msg);
         return;
     }
     if (res < 2) phase = -1; // unknown
     if (res < 3) epoch = -1; // unknown
+    if (res < 4) count = 1;
 
-    laik_log(1, "TCP2 got info that LID %d is in resize mode (phase %d, epoch %d)",
-             lid, phase, epoch);
+    laik_log(1, "TCP2 got info that LID %d is in resize mode (phase %d, epoch %d, %d in subtree)",
+             lid, phase, epoch, count);
 
     assert((lid >= 0) && (lid < MAX_PEERS));
     assert(d->peer[lid].state == PS_Ready);
-    d->peer[lid].state = PS_InResize;
     d->peer[lid].phase = phase;
     d->peer[lid].epoch = epoch;
+    d->tree_entered++;
+    d->tree_enteredCount += count;
 
     d->exit = 1;
 }
@@ -1262,8 +1803,11 @@ void got_backedout(InstData* d, int lid, char* msg)
         return;
     }
 
-    if (lid >0) {
-        laik_log(LAIK_LL_Warning, "got backedout cmd from non-master; ignoring");
+    // in resize, forwarded by parent in tree over current world
+    int parent = -1, child[LAIK_KVS_TREE_MAXCHILDREN];
+    if ((lid > 0) && instance) world_tree(&parent, child);
+    if ((lid > 0) && (lid != parent)) {
+        laik_log(LAIK_LL_Warning, "got backedout cmd from LID %d, not from parent; ignoring", lid);
         return;
     }
 
@@ -1311,11 +1855,6 @@ void got_allowsend(InstData* d, int lid, char* msg)
 
 void got_kvs_allow(InstData* d, int lid, char* msg)
 {
-    if (lid != 0) {
-        laik_log(LAIK_LL_Warning, "ignoring 'kvs allow' from LID %d", lid);
-        return;
-    }
-
     char cmd[21];
     char name[30];
     if (sscanf(msg, "%20s %29s", cmd, name) < 2) {
@@ -1323,14 +1862,29 @@ void got_kvs_allow(InstData* d, int lid, char* msg)
         return;
     }
 
-    laik_log(1, "TCP2 allowed to send changes for KVS '%s'", name);
+    // allowance comes from parent in KVS sync tree, which may not be known yet
+    laik_log(1, "TCP2 allowed to send changes for KVS '%s' (by LID %d)", name, lid);
     assert(d->kvs_name == 0);
     d->kvs_name = strdup(name);
     d->exit = 1;
 }
 
+// get peer expecting changes from, or 0 if not expected
+static
+Peer* kvs_recv_peer(InstData* d, int lid, char* msg)
+{
+    Peer* p = &(d->peer[lid]);
+    if (p->kvs_rchanges == 0) {
+        laik_log(LAIK_LL_Warning, "TCP2 not expecting KVS changes from LID %d, ignoring '%s'",
+                 lid, msg);
+        return 0;
+    }
+    return p;
+}
+
 void got_kvs_changes(InstData* d, int lid, char* msg)
 {
+    // kvs changes <count>: followed by <count> text commands "kvs data"
     char cmd[21];
     int changes = 0;
     if (sscanf(msg, "%20s %d", cmd, &changes) < 2) {
@@ -1338,15 +1892,46 @@ void got_kvs_changes(InstData* d, int lid, char* msg)
         return;
     }
 
+    Peer* p = kvs_recv_peer(d, lid, msg);
+    if (!p) return;
+
     laik_log(1, "TCP2 got %d changes announced for KVS '%s' from LID %d",
-             changes, d->kvs->name, lid);
-    assert(d->kvs_changes == -1);
-    assert(d->kvs_received == 0);
-    d->kvs_changes = changes;
+             changes, d->kvs ? d->kvs->name : "(not in sync yet)", lid);
+    assert(p->kvs_rcount == -1);
+    assert(p->kvs_received == 0);
+    p->kvs_rcount = changes;
     if (changes == 0)
         d->exit = 1;
 }
 
+void got_kvs_bin(InstData* d, int lid, char* msg)
+{
+    // kvs bin <offset count> <data bytes>: followed by binary offsets, data
+    char cmd[21];
+    int offcount = 0, dlen = 0;
+    if (sscanf(msg, "%20s %d %d", cmd, &offcount, &dlen) < 3) {
+        laik_log(LAIK_LL_Warning, "cannot parse 'kvs bin' command '%s'; ignoring", msg);
+        return;
+    }
+
+    Peer* p = kvs_recv_peer(d, lid, msg);
+    if (!p) return;
+
+    laik_log(1, "TCP2 got %d binary changes (%d bytes) announced from LID %d",
+             offcount / 2, dlen, lid);
+    assert(p->kvs_rcount == -1);
+    assert((offcount == 0) || ((offcount & 1) == 1)); // 0 or odd number of offsets
+    p->kvs_rcount = offcount / 2;
+    if (offcount == 0) {
+        d->exit = 1;
+        return;
+    }
+    p->kvs_roffcount = offcount;
+    p->kvs_rlen = offcount * sizeof(int) + dlen;
+    p->kvs_roff = 0;
+    p->kvs_rbuf = malloc(p->kvs_rlen);
+}
+
 void got_kvs_data(InstData* d, int lid, char* msg)
 {
     char cmd[21], key[31], value[101];
@@ -1355,18 +1940,17 @@ void got_kvs_data(InstData* d, int lid, char* msg)
         return;
     }
 
+    Peer* p = kvs_recv_peer(d, lid, msg);
+    if (!p) return;
+
     laik_log(1, "TCP2 got KVS data from LID %d for key '%s': '%s'", lid, key, value);
-    assert(d->kvs != 0);
-    assert(d->kvs_changes > 0);
-    assert(d->kvs_received < d->kvs_changes);
+    assert(p->kvs_rcount > 0);
+    assert(p->kvs_received < p->kvs_rcount);
 
-    Laik_KVS_Entry* e = laik_kvs_sets(d->kvs, key, value);
-    // simply mark it as updated
-    //  this may send unneeded updates, but we do not use change journal in TCP2
-    e->updated = true;
+    laik_kvs_changes_add(p->kvs_rchanges, key, strlen(value) + 1, value, true, false);
 
-    d->kvs_received++;
-    if (d->kvs_received == d->kvs_changes)
+    p->kvs_received++;
+    if (p->kvs_received == p->kvs_rcount)
         d->exit = 1;
 }
 
@@ -1381,6 +1965,7 @@ void got_kvs(InstData* d, int lid, char* msg)
 
     switch(*msg) {
     case 'a': got_kvs_allow(d, lid, msg); break;
+    case 'b': got_kvs_bin(d, lid, msg); break;
     case 'c': got_kvs_changes(d, lid, msg); break;
     case 'd': got_kvs_data(d, lid, msg); break;
     default:
@@ -1391,7 +1976,10 @@ void got_kvs(InstData* d, int lid, char* msg)
 
 void got_getready(InstData* d, int lid, char* msg)
 {
-    if (lid != 0) {
+    // in resize, forwarded by parent in tree over current world
+    int parent = -1, child[LAIK_KVS_TREE_MAXCHILDREN];
+    if ((lid > 0) && instance) world_tree(&parent, child);
+    if ((lid != 0) && (lid != parent)) {
         laik_log(LAIK_LL_Warning, "ignoring 'getready' from LID %d", lid);
         return;
     }
@@ -1421,22 +2009,48 @@ void got_getready(InstData* d, int lid, char* msg)
         return;
     }
 
-    sprintf(cmd, "ok");
-    send_cmd(d, lid, cmd);
+    if (d->mystate == PS_RegAccepted) {
+        // new-comer: confirm directly to master
+        sprintf(cmd, "ok");
+        send_cmd(d, lid, cmd);
+        d->mystate = newstate;
+        d->peer[d->mylid].state = newstate;
+        d->exit = 1;
+        return;
+    }
+
+    // resize: forward before changing state (removals are forwarded, too),
+    // confirm to parent when all children confirmed
+    tree_forward_resize(d);
     d->mystate = newstate;
     d->peer[d->mylid].state = newstate;
+    if (d->tree_pending == 0)
+        tree_confirm(d);
 
     d->exit = 1;
 }
 
 void got_ok(InstData* d, int lid, char* msg)
 {
+    // ok [<count>]
     char cmd[20];
-    if (sscanf(msg, "%15s", cmd) < 1) {
+    int count = 1;
+    if (sscanf(msg, "%15s %d", cmd, &count) < 1) {
         laik_log(LAIK_LL_Warning, "cannot parse 'ok' command '%s'; ignoring", msg);
         return;
     }
 
+    if ((d->tree_pending > 0) && is_tree_child(d, lid)) {
+        // startup/resize: child in tree confirms <count> ready processes
+        laik_log(1, "TCP2 got 'ok' from LID %d: %d processes ready in subtree", lid, count);
+        d->tree_ready += count;
+        d->tree_pending--;
+        if (d->tree_pending == 0)
+            tree_confirm(d);
+        d->exit = 1;
+        return;
+    }
+
     if ((d->mylid == 0) && (d->peer[lid].state == PS_RegFinishing)) {
         laik_log(1, "TCP2 got 'ok' from LID %d: registration done", lid);
 
@@ -1505,7 +2119,10 @@ void got_cmd(InstData* d, int fd, char* msg, int len)
     case 'n': got_id(d, lid, msg); return; // newid <lid> <location> <host> <port>
     case 'e': got_enterresize(d, lid, msg); return; // enterresize <phase> <epoch>
     case 'b': got_backedout(d, lid, msg); return; // backedout <lid>
-    case 'p': got_phase(d, msg); return; // phase <phaseid>
+    case 'p':
+        if (msg[1] == 'e') got_peers(d, lid, msg); // peers <count> <bytes> <treesize>
+        else got_phase(d, msg); // phase <phaseid> <epoch>
+        return;
     case 'a': got_allowsend(d, lid, msg); return; // allowsend <count> <elemsize>
     case 'd': got_data(d, lid, msg); return; // data <len> [(<pos>)] <hex> ...
     case 'k': got_kvs(d, lid, msg); return; // kvs ...
@@ -1517,9 +2134,29 @@ void got_cmd(InstData* d, int fd, char* msg, int len)
     laik_log(LAIK_LL_Warning, "TCP2 got from LID %d unknown msg '%s'", lid, msg);
 }
 
+// compressed chunk completely received into zbuf of <fds>
+static
+void got_zip_data(InstData* d, FDState* fds)
+{
+    char* buf = malloc(fds->zraw);
+    double start = laik_wtime();
+    if (!laik_decompress(fds->zbuf, fds->zused, fds->zwidth, buf, fds->zraw)) {
+        laik_panic("TCP2 got corrupted compressed data");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    d->unzip_time += laik_wtime() - start;
+    free(fds->zbuf);
+    fds->zbuf = 0;
+
+    // chunks only contain complete elements of one receive
+    int consumed = got_binary_data(d, fds->lid, buf, fds->zraw);
+    assert(consumed == fds->zraw);
+    free(buf);
+}
+
 void process_rbuf(InstData* d, int fd)
 {
-    assert((fd >= 0) && (fd < MAX_FDS));
+    assert((fd >= 0) && (fd < d->fds_size));
     FDState* fds = &(d->fds[fd]);
     char* rbuf = fds->rbuf;
     int used = fds->rbuf_used;
@@ -1533,6 +2170,18 @@ void process_rbuf(InstData* d, int fd)
     // pos1/pos2: start/end of section to process
     int pos1 = 0, pos2 = 0;
     while(pos2 < used) {
+        // section of compressed chunk?
+        if ((outstanding_bin > 0) && fds->zbuf) {
+            consumed = (used - pos1 < outstanding_bin) ? used - pos1 : outstanding_bin;
+            memcpy(fds->zbuf + fds->zused, rbuf + pos1, consumed);
+            fds->zused += consumed;
+            outstanding_bin -= consumed;
+            pos1 += consumed;
+            pos2 = pos1;
+            if (outstanding_bin == 0)
+                got_zip_data(d, fds);
+            continue;
+        }
         // section in bin mode?
         if (outstanding_bin > 0) {
             if (used - pos1 < outstanding_bin) {
@@ -1568,6 +2217,25 @@ void process_rbuf(InstData* d, int fd)
             pos2 = pos1;
             continue;
         }
+        // start of compressed chunk?
+        if (rbuf[pos1] == 'Z') {
+            if (pos1 + ZBUF_HEADER > used) {
+                // not enough bytes to cover header: stop
+                pos2 = used;
+                break;
+            }
+            unsigned char* h = (unsigned char*) rbuf + pos1;
+            outstanding_bin = h[1] + (h[2] << 8);
+            fds->zraw = h[3] + (h[4] << 8);
+            fds->zwidth = h[5];
+            fds->zused = 0;
+            fds->zbuf = malloc(outstanding_bin);
+            laik_log(1, "TCP2 compressed chunk started with %d bytes (raw %d)\n",
+                     outstanding_bin, fds->zraw);
+            pos1 += ZBUF_HEADER;
+            pos2 = pos1;
+            continue;
+        }
 
         if (rbuf[pos2] == 4) { // Ctrl+D: same as "quit"
             got_cmd(d, fd, "quit", 5);
@@ -1596,7 +2264,7 @@ void process_rbuf(InstData* d, int fd)
 void got_bytes(InstData* d, int fd)
 {
     // use a per-fd receive buffer to not mix partially sent commands
-    assert((fd >= 0) && (fd < MAX_FDS));
+    assert((fd >= 0) && (fd < d->fds_size));
     int used = d->fds[fd].rbuf_used;
 
     if (used == RBUF_LEN) {
@@ -1606,9 +2274,11 @@ void got_bytes(InstData* d, int fd)
     }
 
     char* rbuf = d->fds[fd].rbuf;
-    int len = read(fd, rbuf + used, RBUF_LEN - used);
+    int len = recv(fd, rbuf + used, RBUF_LEN - used, MSG_DONTWAIT);
     if (len == -1) {
         int e = errno;
+        fd_drained(d, fd);
+        if ((e == EAGAIN) || (e == EWOULDBLOCK)) return;
         laik_log(1, "TCP2 warning: read error on FD %d: %s\n",
                  fd, strerror(e));
         return;
@@ -1627,8 +2297,8 @@ void got_bytes(InstData* d, int fd)
         laik_log(1, "TCP2 FD %d closed (peer LID %d, %d bytes unprocessed)\n",
                  fd, lid, d->fds[fd].rbuf_used);
 
-        if (lid >= 0) {
-            assert(d->peer[lid].fd == fd);
+        // with simultaneous connects, this may be a receive-only connection
+        if ((lid >= 0) && (d->peer[lid].fd == fd)) {
             // peer may still be alive and just have closed connection to avoid
             // too many open connections: thus, only mark as "not connected"
             d->peer[lid].fd = -1;
@@ -1651,6 +2321,10 @@ void got_bytes(InstData* d, int fd)
                        fd, d->fds[fd].lid, used, len, lstr);
     }
 
+    // less than requested: no more input, further input is a new event
+    if (len < RBUF_LEN - used)
+        fd_drained(d, fd);
+
     d->fds[fd].rbuf_used = used + len;
     process_rbuf(d, fd);
 }
@@ -1661,6 +2335,11 @@ void got_connect(InstData* d, int fd)
     socklen_t len = sizeof(saddr);
     int newfd = accept(fd, &saddr, &len);
     if (newfd < 0) {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+            // all pending connection requests accepted
+            fd_drained(d, fd);
+            return;
+        }
         laik_panic("TCP2 Error in accept\n");
         exit(1);
     }
@@ -1706,17 +2385,29 @@ InstData* new_inst_data(char* host, char* location)
         d->peer[i].host = 0;
         d->peer[i].location = 0;
         d->peer[i].accepts_bin_data = false;
+        d->peer[i].accepts_zip = false;
         d->peer[i].rcount = 0;
         d->peer[i].scount = 0;
+        d->peer[i].kvs_rchanges = 0;
+        d->peer[i].kvs_rbuf = 0;
+        d->peer[i].kvs_rlen = 0;
+        d->peer[i].kvs_roff = 0;
+        d->peer[i].ptab_rbuf = 0;
+        d->peer[i].ptab_rlen = 0;
+        d->peer[i].ptab_roff = 0;
+    }
+
+    d->epollfd = epoll_create1(EPOLL_CLOEXEC);
+    if (d->epollfd < 0) {
+        laik_panic("TCP2 cannot create epoll instance");
+        exit(1); // not actually needed, laik_panic never returns
     }
-
-    FD_ZERO(&d->rset);
-    d->maxfds = 0;
     d->exit = 0;
-    for(int i = 0; i < MAX_FDS; i++) {
-        d->fds[i].state = PS_Invalid;
-        d->fds[i].cb = 0;
-    }
+    d->fds_size = 0;
+    d->fds = 0;
+    d->readyList = 0;
+    d->readyCount = 0;
+    grow_fds(d, 0);
 
     d->host = strdup(host);
     d->location = strdup(location);
@@ -1728,10 +2419,25 @@ InstData* new_inst_data(char* host, char* location)
     // announce capability to accept binary data? Defaults to yes, can be switched off
     char* str = getenv("LAIK_TCP2_BIN");
     d->accept_bin_data = str ? atoi(str) : 1;
+    // compression of binary data: off by default, used if both sides enable it
+    str = getenv("LAIK_TCP2_COMPRESS");
+    d->accept_zip = str ? (atoi(str) > 0) : false;
+    d->zip_chunks = 0;
+    d->zip_rawchunks = 0;
+    d->zip_inbytes = 0;
+    d->zip_outbytes = 0;
+    d->zip_time = 0.0;
+    d->unzip_time = 0.0;
     d->kvs = 0;       // only set during tcp2_sync()
-    d->kvs_changes = 0;
-    d->kvs_received = 0;
     d->kvs_name = 0;
+    d->ptab_expect = 0;
+    d->tree_size = 0;  // only used in startup
+    d->tree_parent = -1;
+    d->tree_childCount = 0;
+    d->tree_pending = 0;
+    d->tree_ready = 0;
+    d->tree_entered = 0;
+    d->tree_enteredCount = 0;
 
     return d;
 }
@@ -1764,36 +2470,25 @@ int startup_master(InstData* d)
     assert(d->peers + 1 == world_size);
     assert(d->mystate == PS_InStartup2);
 
-    // broadcast location ID infos to all non-masters
-    char msg[150];
-    for(int lid = 0; lid <= d->maxid; lid++) {
-        sprintf(msg, "newid %d %s %s %d %s", lid,
-                d->peer[lid].location, d->peer[lid].host, d->peer[lid].port,
-                d->peer[lid].accepts_bin_data ? "b":"-");
-        for(int to_lid = 1; to_lid <= d->maxid; to_lid++) {
-            if (lid == to_lid) continue;
-            send_cmd(d, to_lid, msg);
-        }
-    }
-
-    // notify peers to get ready, and wait for them to become ready
-    // (ready means they accept direct connections)
-    for(int i = 1; i <= d->maxid; i++) {
-        assert(d->peer[i].state == PS_RegAccepted);
-        d->peer[i].state = PS_RegFinishing;
-        send_cmd(d, i, "getready");
-    }
+    // send table with location ID infos down the bootstrap tree: each process
+    // forwards it to its children, and confirms with "ok <count>" when itself
+    // and all processes in its subtree are ready (accept direct connections)
+    assert(d->maxid + 1 == world_size);
+    d->tree_size = world_size;
+    tree_forward_peers(d);
     while(d->mystate == PS_InStartup2)
         run_loop(d);
     assert(d->readyPeers + 1 == world_size);
 
     laik_log(1, "TCP2 master: %d peers registered, startup done\n", d->readyPeers);
 
-    // notify all peers to start at phase 0, epoch 0
-    for(int i = 1; i <= d->maxid; i++) {
-        assert(d->peer[i].state == PS_Ready);
-        send_cmd(d, i, "phase 0 0");
+    // notify all peers to start at phase 0, epoch 0 (forwarded along tree)
+    for(int i = 0; i < d->tree_childCount; i++) {
+        assert(d->peer[d->tree_child[i]].state == PS_Ready);
+        send_cmd(d, d->tree_child[i], "phase 0 0");
     }
+    d->tree_childCount = 0;
+    d->tree_size = 0;
 
     return world_size;
 }
@@ -1805,7 +2500,8 @@ int startup_non_master(InstData* d)
     // register with master, get world size
     char msg[100];
     sprintf(msg, "register %.30s %.30s %d %s",
-            d->location, d->host, d->listenport, d->accept_bin_data ? "bin":"");
+            d->location, d->host, d->listenport,
+            d->accept_bin_data ? (d->accept_zip ? "binz" : "bin") : "");
     send_cmd(d, 0, msg);
 
     // wait until "getready" from master, confirmed with "ok", setting myself to ready
@@ -1919,7 +2615,7 @@ Laik_Instance* laik_init_tcp2(int* argc, char*** argv)
                 // listen on successfully bound socket
                 // if this fails, another process started listening first
                 // and we need to open another socket, as we cannot unbind
-                if (listen(listenfd, 5) < 0) {
+                if (listen(listenfd, SOMAXCONN) < 0) {
                     laik_log(1,"listen failed, opening new socket");
                     close(listenfd);
                     continue;
@@ -1931,7 +2627,7 @@ Laik_Instance* laik_init_tcp2(int* argc, char*** argv)
             }
         }
         // not bound yet: will bind to random port
-        if (listen(listenfd, 5) < 0) {
+        if (listen(listenfd, SOMAXCONN) < 0) {
             laik_panic("TCP2 cannot listen on socket");
             exit(1); // not actually needed, laik_panic never returns
         }
@@ -1948,6 +2644,12 @@ Laik_Instance* laik_init_tcp2(int* argc, char*** argv)
     }
     d->listenfd = listenfd;
 
+    // accept connection requests until none is pending (edge-triggered)
+    if (fcntl(listenfd, F_SETFL, fcntl(listenfd, F_GETFL) | O_NONBLOCK) < 0) {
+        laik_panic("TCP2 cannot set listening socket to non-blocking");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
     // notify us on connection requests at listening port
     add_rfd(d, d->listenfd, got_connect);
 
@@ -1970,6 +2672,7 @@ Laik_Instance* laik_init_tcp2(int* argc, char*** argv)
         d->peer[0].location = d->location;
         d->peer[0].port     = d->listenport;
         d->peer[0].accepts_bin_data = d->accept_bin_data;
+        d->peer[0].accepts_zip = d->accept_bin_data && d->accept_zip;
     }
     else {
         // we are non-master: we want to register with master
@@ -2073,9 +2776,10 @@ Laik_Instance* laik_init_tcp2(int* argc, char*** argv)
 
     d->mystate = PS_Ready;
 
-    laik_log(2, "TCP2 backend initialized (location '%s', LID %d, rank %d/%d, epoch %d, phase %d, listening at %d, flags: %c)\n",
+    laik_log(2, "TCP2 backend initialized (location '%s', LID %d, rank %d/%d, epoch %d, phase %d, listening at %d, flags: %s)\n",
              d->location, d->mylid, world->myid, world_size,
-             d->epoch, d->phase, d->listenport, d->accept_bin_data ? 'b':'-');
+             d->epoch, d->phase, d->listenport,
+             get_flagstring(d->accept_bin_data, d->accept_zip));
 
     return instance;
 }
@@ -2112,7 +2816,37 @@ void send_data(int n, int dims, Laik_Index* idx, int toLID, void* p, int s)
 #define SBUF_LEN 8*1024
 int sbuf_used = 3; // reserve space for header
 int sbuf_toLID = -1;
+int sbuf_esize = 1; // element size of buffered data, for compression
 char sbuf[SBUF_LEN];
+char zbuf[SBUF_LEN + ZBUF_HEADER];
+
+// try to send buffered data compressed, return false if not compressible
+static
+bool send_data_zip(InstData* d, int toLID, int bytes)
+{
+    double start = laik_wtime();
+    int clen = laik_compress(sbuf + 3, bytes, sbuf_esize,
+                             zbuf + ZBUF_HEADER, SBUF_LEN);
+    d->zip_time += laik_wtime() - start;
+    if (clen == 0) {
+        d->zip_rawchunks++;
+        return false;
+    }
+
+    zbuf[0] = 'Z';
+    zbuf[1] = clen & 255;
+    zbuf[2] = clen >> 8;
+    zbuf[3] = bytes & 255;
+    zbuf[4] = bytes >> 8;
+    zbuf[5] = (char) sbuf_esize;
+    send_bin(d, toLID, zbuf, clen + ZBUF_HEADER);
+
+    d->zip_chunks++;
+    d->zip_inbytes += bytes;
+    d->zip_outbytes += clen;
+    laik_log(1, "TCP2 sent %d bytes compressed to %d to LID %d", bytes, clen, toLID);
+    return true;
+}
 
 static
 void send_data_bin_flush(int toLID)
@@ -2120,12 +2854,18 @@ void send_data_bin_flush(int toLID)
     if (sbuf_used == 0) return;
     assert(sbuf_toLID == toLID);
 
-    // prepend data to send with header with byte count
+    InstData* d = (InstData*)instance->backend_data;
     int bytes = sbuf_used - 3;
-    sbuf[0] = 'B';
-    sbuf[1] = bytes & 255;
-    sbuf[2] = bytes >> 8;
-    send_bin((InstData*)instance->backend_data, toLID, sbuf, sbuf_used);
+    bool sent = false;
+    if (d->accept_zip && d->peer[toLID].accepts_zip && (sbuf_esize < 256))
+        sent = send_data_zip(d, toLID, bytes);
+    if (!sent) {
+        // prepend data to send with header with byte count
+        sbuf[0] = 'B';
+        sbuf[1] = bytes & 255;
+        sbuf[2] = bytes >> 8;
+        send_bin(d, toLID, sbuf, sbuf_used);
+    }
     sbuf_used = 3; // reserve space for header
     sbuf_toLID = -1;
 }
@@ -2135,8 +2875,10 @@ void send_data_bin(int n, int dims, Laik_Index* idx, int toLID, void* p, int s)
 {
     if (sbuf_used + s > SBUF_LEN)
         send_data_bin_flush(toLID);
-    if (sbuf_toLID < 0)
+    if (sbuf_toLID < 0) {
         sbuf_toLID = toLID;
+        sbuf_esize = s;
+    }
     else
         assert(sbuf_toLID == toLID);
 
@@ -2165,6 +2907,7 @@ void send_range(Laik_Mapping* fromMap, Laik_Range* range, int toLID)
     int dims = range->space->dims;
     assert(fromMap->start != 0); // must be backed by memory
 
+    double start = laik_commstat_enabled ? laik_wtime() : 0.0;
     InstData* d = (InstData*)instance->backend_data;
     Peer* p = &(d->peer[toLID]);
     if (p->scount == 0) {
@@ -2194,13 +2937,17 @@ void send_range(Laik_Mapping* fromMap, Laik_Range* range, int toLID)
 
     // withdraw our right to send further data
     p->scount = 0;
+
+    if (laik_commstat_enabled)
+        laik_commstat_add(instance, toLID, true, 1, (uint64_t) ecount * esize,
+                          laik_wtime() - start);
 }
 
-// queue receive action and run event loop until all data received
+// queue receive action: give peer the right to send data
 // <ro> allows to request reduction with existing value
 // (use RO_None to overwrite with received value)
 static
-void recv_range(Laik_Range* range, int fromLID, Laik_Mapping* toMap, Laik_ReductionOperation ro)
+void recv_range_start(Laik_Range* range, int fromLID, Laik_Mapping* toMap, Laik_ReductionOperation ro)
 {
     assert(toMap->start != 0); // must be backed by memory
     // check no data still registered to be received from <fromID>
@@ -2222,15 +2969,38 @@ void recv_range(Laik_Range* range, int fromLID, Laik_Mapping* toMap, Laik_Reduct
     char msg[50];
     sprintf(msg, "allowsend %d %d\n", p->rcount, p->relemsize);
     send_cmd(d, fromLID, msg);
+}
+
+// run event loop until all data of queued receive from <fromLID> received
+static
+void recv_range_wait(int fromLID)
+{
+    InstData* d = (InstData*)instance->backend_data;
+    Peer* p = &(d->peer[fromLID]);
+    assert(p->rcount > 0);
 
     // wait until all data received from peer
+    double start = laik_commstat_enabled ? laik_wtime() : 0.0;
     while(p->roff < p->rcount)
         run_loop(d);
 
+    if (laik_commstat_enabled)
+        laik_commstat_add(instance, fromLID, false, 1,
+                          (uint64_t) p->rcount * p->relemsize,
+                          laik_wtime() - start);
+
     // done
     p->rcount = 0;
 }
 
+// queue receive action and run event loop until all data received
+static
+void recv_range(Laik_Range* range, int fromLID, Laik_Mapping* toMap, Laik_ReductionOperation ro)
+{
+    recv_range_start(range, fromLID, toMap, ro);
+    recv_range_wait(fromLID);
+}
+
 /* reduction at one process using send/recv
  * 
  * One process is chosen to do the reduction (reduceProcess): this is selected
@@ -2335,7 +3105,7 @@ void tcp2_exec(Laik_ActionSeq* as)
         laik_log_ActionSeqIfChanged(true, as, "Original sequence");
         bool changed = laik_aseq_splitTransitionExecs(as);
         laik_log_ActionSeqIfChanged(changed, as, "After splitting texecs");
-        changed = laik_aseq_sort_2phases(as);
+        changed = laik_aseq_sort_edgecolor(as);
         laik_log_ActionSeqIfChanged(changed, as, "After sorting");
 
         laik_aseq_calc_stats(as);
@@ -2345,6 +3115,7 @@ void tcp2_exec(Laik_ActionSeq* as)
     Laik_TransitionContext* tc = as->context[0];
     Laik_Action* a = as->action;
     for(unsigned int i = 0; i < as->actionCount; i++, a = nextAction(a)) {
+        double traceStart = laik_trace_enabled ? laik_wtime() : 0.0;
         switch(a->type) {
         case LAIK_AT_MapPackAndSend: {
             Laik_A_MapPackAndSend* aa = (Laik_A_MapPackAndSend*) a;
@@ -2353,7 +3124,36 @@ void tcp2_exec(Laik_ActionSeq* as)
                      aa->to_rank, toLID, aa->count, tc->data->elemsize);
             assert(tc->fromList && (aa->fromMapNo < tc->fromList->count));
             Laik_Mapping* m = &(tc->fromList->map[aa->fromMapNo]);
+
+            // combined exchange if followed by receive from same peer
+            // (lower rank of a pair after sorting by edge coloring):
+            // allow peer to send before we send, saving a round trip
+            Laik_A_MapRecvAndUnpack* ra = 0;
+            if (i + 1 < as->actionCount) {
+                Laik_Action* next = nextAction(a);
+                if ((next->type == LAIK_AT_MapRecvAndUnpack) &&
+                    (next->round == a->round) &&
+                    (((Laik_A_MapRecvAndUnpack*)next)->from_rank == aa->to_rank))
+                    ra = (Laik_A_MapRecvAndUnpack*) next;
+            }
+            if (ra) {
+                laik_log(1, "TCP2 MapRecvAndUnpack from T%d (LID %d), %d x %dB (combined)\n",
+                         ra->from_rank, toLID, ra->count, tc->data->elemsize);
+                assert(tc->toList && (ra->toMapNo < tc->toList->count));
+                Laik_Mapping* rm = &(tc->toList->map[ra->toMapNo]);
+                recv_range_start(ra->range, toLID, rm, LAIK_RO_None);
+            }
             send_range(m, aa->range, toLID);
+            if (ra) {
+                recv_range_wait(toLID);
+                // skip the receive action
+                a = nextAction(a);
+                i++;
+                if (laik_trace_enabled)
+                    laik_trace_event("action", "MapSendRecv", 0, traceStart,
+                                     a->round, aa->to_rank);
+                continue;
+            }
             break;
         }
         case LAIK_AT_MapRecvAndUnpack: {
@@ -2379,20 +3179,110 @@ void tcp2_exec(Laik_ActionSeq* as)
             assert(0);
             break;
         }
+
+        if (laik_trace_enabled)
+            laik_trace_action(a, traceStart);
     }
 }
 
-void tcp2_sync(Laik_KVStore* kvs)
+// KVS sync runs along a binomial tree of active LIDs: changes are merged
+// on the way up to LID 0, and the merged result is sent down the tree.
+// Changes are sent in binary mode if the receiver accepts it, otherwise
+// as text commands
+
+// send <len> bytes from <buf> to <lid> in binary mode, using sbuf
+static
+void send_kvs_bin(InstData* d, int lid, char* buf, int len)
 {
-    char msg[100];
-    InstData* d = (InstData*)instance->backend_data;
+    assert(sbuf_used == 3); // no pending binary container data
+    while(len > 0) {
+        int bytes = len;
+        if (bytes > SBUF_LEN - 3) bytes = SBUF_LEN - 3;
+        sbuf[0] = 'B';
+        sbuf[1] = bytes & 255;
+        sbuf[2] = bytes >> 8;
+        memcpy(sbuf + 3, buf, bytes);
+        send_bin(d, lid, sbuf, bytes + 3);
+        buf += bytes;
+        len -= bytes;
+    }
+}
 
-    int count = 0;
-    for(unsigned int i = 0; i < kvs->used; i++) {
-        if (!kvs->entry[i].updated) continue;
-        count++;
+// send KVS changes <c> to <lid>
+static
+void send_kvs_changes(InstData* d, int lid, Laik_KVS_Changes* c)
+{
+    char msg[150];
+    assert((c->offUsed == 0) || ((c->offUsed & 1) == 1)); // 0 or odd number of offsets
+    laik_log(1, "TCP2 sending %d changes for KVS '%s' (%d bytes) to LID %d",
+             c->offUsed / 2, d->kvs->name, c->dataUsed, lid);
+
+    if (d->peer[lid].accepts_bin_data) {
+        sprintf(msg, "kvs bin %d %d", c->offUsed, c->dataUsed);
+        send_cmd(d, lid, msg);
+        if (c->offUsed == 0) return;
+        send_kvs_bin(d, lid, (char*) c->off, c->offUsed * sizeof(int));
+        send_kvs_bin(d, lid, c->data, c->dataUsed);
+        return;
+    }
+
+    sprintf(msg, "kvs changes %d", c->offUsed / 2);
+    send_cmd(d, lid, msg);
+    for(int i = 0; i + 2 < c->offUsed; i += 2) {
+        sprintf(msg, "kvs data %s %s", c->data + c->off[i], c->data + c->off[i+1]);
+        send_cmd(d, lid, msg);
     }
-    laik_log(1, "TCP2 syncing KVS '%s' with %d own changes", kvs->name, count);
+}
+
+// start receiving KVS changes from <lid> into <c>
+static
+void kvs_recv_start(InstData* d, int lid, Laik_KVS_Changes* c)
+{
+    Peer* p = &(d->peer[lid]);
+    assert(p->kvs_rchanges == 0);
+    laik_kvs_changes_init(c);
+    p->kvs_rchanges = c;
+    p->kvs_rcount = -1;
+    p->kvs_received = 0;
+}
+
+// run event loop until all KVS changes from <lid> are received
+static
+void kvs_recv_wait(InstData* d, int lid)
+{
+    Peer* p = &(d->peer[lid]);
+    assert(p->kvs_rchanges != 0);
+    while((p->kvs_rcount < 0) || (p->kvs_received < p->kvs_rcount))
+        run_loop(d);
+    p->kvs_rchanges = 0;
+}
+
+// send (merged) changes to parent, needs allowance
+static
+void kvs_send_parent(InstData* d, Laik_KVS_Changes* c)
+{
+    laik_log(1, "TCP2 waiting for allowance to send changes");
+    while(d->kvs_name == 0)
+        run_loop(d);
+    // this must be allowance to send changes for same KVS
+    assert(strcmp(d->kvs->name, d->kvs_name) == 0);
+
+    send_kvs_changes(d, d->kvs_parent, c);
+
+    // all changes sent, remove own permission
+    // (needs to be done here, as we may receive next allowance
+    //  before end of sync, which would trigger assertion)
+    free(d->kvs_name);
+    d->kvs_name = 0;
+    d->kvs_sent = true;
+}
+
+// start KVS sync: allow children in sync tree to send their changes.
+// If we are a leaf and already have the allowance, send own changes
+void tcp2_sync_start(Laik_KVStore* kvs)
+{
+    char msg[100];
+    InstData* d = (InstData*)instance->backend_data;
 
     // must not be in middle of another sync
     assert(d->kvs == 0);
@@ -2400,73 +3290,116 @@ void tcp2_sync(Laik_KVStore* kvs)
     if (d->kvs_name)
         assert(strcmp(d->kvs_name, kvs->name) == 0);
     d->kvs = kvs;
+    d->kvs_sent = false;
 
-    if (d->mylid > 0) {
-        laik_log(1, "TCP2 waiting for allowance to send changes");
-        while(d->kvs_name == 0)
-            run_loop(d);
-        // this must be allowance to send changes for same KVS
-        assert(strcmp(kvs->name, d->kvs_name) == 0);
-
-        sprintf(msg, "kvs changes %d", count);
-        send_cmd(d, 0, msg);
-        for(unsigned int i = 0; i < kvs->used; i++) {
-            if (!kvs->entry[i].updated) continue;
-            sprintf(msg, "kvs data %s %s",
-                    kvs->entry[i].key, kvs->entry[i].value);
-            send_cmd(d, 0, msg);
-        }
-        // all changes sent, remove own permission
-        // (needs to be done here, as we may receive next allowance
-        //  before end of sync, which would trigger assertion)
-        free(d->kvs_name);
-        d->kvs_name = 0;
-        // wait for all changes being send by LID 0
-        d->kvs_changes = -1;
-        d->kvs_received = 0;
-        while((d->kvs_changes < 0) || (d->kvs_received < d->kvs_changes))
-            run_loop(d);
-        laik_log(1, "TCP2 synced %d changes for KVS %s",
-                d->kvs_changes, kvs->name);
-        d->kvs = 0;
-        return;
+    // tree among active LIDs
+    int lids[MAX_PEERS], n = 0, myidx = -1;
+    for(int lid = 0; lid <= d->maxid; lid++) {
+        if (d->peer[lid].state == PS_Dead) continue;
+        if (lid == d->mylid) myidx = n;
+        lids[n++] = lid;
     }
+    assert(myidx >= 0);
+    int parent, child[LAIK_KVS_TREE_MAXCHILDREN];
+    d->kvs_childCount = laik_kvs_tree(myidx, n, &parent, child);
+    d->kvs_parent = (parent < 0) ? -1 : lids[parent];
 
-    // master
+    laik_log(1, "TCP2 syncing KVS '%s' with %d own changes (parent LID %d, %d children)",
+             kvs->name, kvs->changes.offUsed / 2, d->kvs_parent, d->kvs_childCount);
 
-    for(int lid = 1; lid <= d->maxid; lid++) {
+    for(int i = 0; i < d->kvs_childCount; i++) {
+        int lid = lids[child[i]];
+        d->kvs_child[i] = lid;
+        kvs_recv_start(d, lid, &(d->kvs_cchanges[i]));
         sprintf(msg, "kvs allow %s", kvs->name);
         send_cmd(d, lid, msg);
+    }
+    if (d->kvs_parent < 0) return;
 
-        // wait for changes from LID <lid>
-        d->kvs_changes = -1;
-        d->kvs_received = 0;
-        while((d->kvs_changes < 0) || (d->kvs_received < d->kvs_changes))
-            run_loop(d);
-        laik_log(1, "TCP2 got %d changes for KVS %s from LID %d",
-                d->kvs_changes, kvs->name, lid);
+    // merged changes will come from parent
+    kvs_recv_start(d, d->kvs_parent, &(d->kvs_pchanges));
+
+    if (d->kvs_childCount == 0) {
+        // leaf: nothing to merge, send own changes if already allowed
+        check_loop(d);
+        if (d->kvs_name)
+            kvs_send_parent(d, &(kvs->changes));
     }
-    count = 0;
-    for(unsigned int i = 0; i < kvs->used; i++) {
-        if (!kvs->entry[i].updated) continue;
-        count++;
+}
+
+void tcp2_sync(Laik_KVStore* kvs)
+{
+    InstData* d = (InstData*)instance->backend_data;
+    if (d->kvs != kvs)
+        tcp2_sync_start(kvs);
+
+    Laik_KVS_Changes changes;
+    laik_kvs_changes_init(&changes); // temporary changes struct
+
+    Laik_KVS_Changes *src, *dst, *tmp;
+    // after merging, result should be in dst;
+    dst = &(kvs->changes);
+    src = &changes;
+
+    if (d->kvs_childCount > 0) {
+        // first sort own changes, as preparation for merging
+        laik_kvs_changes_sort(dst);
+
+        // changes from children (smaller sub-trees first), merge
+        for(int i = 0; i < d->kvs_childCount; i++) {
+            Laik_KVS_Changes* recvd = &(d->kvs_cchanges[i]);
+            kvs_recv_wait(d, d->kvs_child[i]);
+
+            // for merging, both inputs need to be sorted
+            laik_kvs_changes_sort(recvd);
+
+            // swap src/dst: now merging can overwrite dst
+            tmp = src; src = dst; dst = tmp;
+
+            laik_kvs_changes_merge(dst, src, recvd);
+        }
     }
-    laik_log(1, "TCP2 with %d merged changes", count);
-    sprintf(msg, "kvs changes %d", count);
-    for(int lid = 1; lid <= d->maxid; lid++)
-        send_cmd(d, lid, msg);
-    for(unsigned int i = 0; i < kvs->used; i++) {
-        if (!kvs->entry[i].updated) continue;
-        sprintf(msg, "kvs data %s %s",
-                kvs->entry[i].key, kvs->entry[i].value);
-        for(int lid = 1; lid <= d->maxid; lid++)
-            send_cmd(d, lid, msg);
+
+    if (d->kvs_parent >= 0) {
+        if (!d->kvs_sent)
+            kvs_send_parent(d, dst);
+
+        // wait for merged changes from parent
+        kvs_recv_wait(d, d->kvs_parent);
+        dst = &(d->kvs_pchanges);
     }
+
+    // forward merged changes to children (larger sub-trees first)
+    for(int i = d->kvs_childCount - 1; i >= 0; i--)
+        send_kvs_changes(d, d->kvs_child[i], dst);
+
+    laik_kvs_changes_apply(dst, kvs);
     laik_log(1, "TCP2 synced %d changes for KVS %s",
-            count, kvs->name);
+             dst->offUsed / 2, kvs->name);
+
+    for(int i = 0; i < d->kvs_childCount; i++)
+        laik_kvs_changes_free(&(d->kvs_cchanges[i]));
+    if (d->kvs_parent >= 0)
+        laik_kvs_changes_free(&(d->kvs_pchanges));
+    laik_kvs_changes_free(&changes);
     d->kvs = 0;
 }
 
+// report statistics on compressed data
+void tcp2_finalize(Laik_Instance* inst)
+{
+    InstData* d = (InstData*)inst->backend_data;
+    if (!d->accept_zip) return;
+
+    uint64_t chunks = d->zip_chunks + d->zip_rawchunks;
+    laik_log(2, "TCP2 compression: %llu of %llu chunks compressed, "
+                "%llu -> %llu bytes (ratio %.2f), time %.3f s, decompress %.3f s",
+             (unsigned long long) d->zip_chunks, (unsigned long long) chunks,
+             (unsigned long long) d->zip_inbytes, (unsigned long long) d->zip_outbytes,
+             d->zip_outbytes ? (double) d->zip_inbytes / d->zip_outbytes : 1.0,
+             d->zip_time, d->unzip_time);
+}
+
 void tcp2_make_progress()
 {
     // process incoming commands
@@ -2475,11 +3408,12 @@ void tcp2_make_progress()
 
     // collect register requests into join list
     // make sure to do this only once: change state
-    for(int fd = 0; fd < MAX_FDS; fd++) {
+    for(int fd = 0; fd < d->fds_size; fd++) {
         switch(d->fds[fd].state) {
             case PS_RegReceived:
                 d->fds[fd].state = PS_RegReceived2;
-                laik_add_join_req(instance, &(d->fds[fd]));
+                // FD table may get reallocated: pass FD instead of pointer
+                laik_add_join_req(instance, (void*) (intptr_t) fd);
                 break;
             case PS_CutoffReceived:
                 // replay
@@ -2536,10 +3470,18 @@ Laik_Group* tcp2_resize(Laik_ResizeRequests* resizeReqs)
     int epoch = instance->epoch;
     laik_log(1, "TCP2 resize: phase %d, epoch %d", phase, epoch);
 
+    int parent, child[LAIK_KVS_TREE_MAXCHILDREN];
+    int childCount = world_tree(&parent, child);
+
     if (d->mylid > 0) {
-        // tell master that we are in resize mode
-        sprintf(msg, "enterresize %d %d", phase, epoch);
-        send_cmd(d, 0, msg);
+        // tell parent in tree (finally master) that we and all processes
+        // in our subtree are in resize mode
+        while(d->tree_entered < childCount)
+            run_loop(d);
+        sprintf(msg, "enterresize %d %d %d", phase, epoch, d->tree_enteredCount + 1);
+        d->tree_entered = 0;
+        d->tree_enteredCount = 0;
+        send_cmd(d, parent, msg);
 
         // wait for master to finish resize phase
         d->phase = -1;
@@ -2618,17 +3560,18 @@ Laik_Group* tcp2_resize(Laik_ResizeRequests* resizeReqs)
 
     // master
 
-    // wait for all ready processes to join resize phase
-    for(int lid = 1; lid <= d->maxid; lid++) {
-        laik_log(1, "TCP2 resize master: LID %d state %d (%s)",
-                 lid, d->peer[lid].state, get_statestring(d->peer[lid].state));
-        if (d->peer[lid].state == PS_Dead) continue;
-        if (d->peer[lid].state == PS_InResize) continue;
-        while(d->peer[lid].state == PS_Ready)
-            run_loop(d);
-        // originally "ready" processes may become broken: simply skip them
-        if (d->peer[lid].state == PS_Error) continue;
-        assert(d->peer[lid].state == PS_InResize);
+    // wait for all processes of current world to join resize phase,
+    // aggregated along tree over current world
+    while(d->tree_entered < childCount)
+        run_loop(d);
+    Laik_Group* w = instance->world;
+    assert(d->tree_enteredCount + 1 == w->size);
+    d->tree_entered = 0;
+    d->tree_enteredCount = 0;
+    for(int i = 1; i < w->size; i++) {
+        int lid = w->locationid[i];
+        assert(d->peer[lid].state == PS_Ready);
+        d->peer[lid].state = PS_InResize;
     }
 
     // all ready processes now are in resize phase
@@ -2639,9 +3582,9 @@ Laik_Group* tcp2_resize(Laik_ResizeRequests* resizeReqs)
         for(int i = 0; i < resizeReqs->used; i++) {
             Laik_ResizeRequest* req = &(resizeReqs->req[i]);
             if (req->is_join_req) {
-                FDState* fds = (FDState*) req->backend_data;
-                int fd = fds - d->fds;
-                assert(&(d->fds[fd]) == fds);
+                int fd = (int) (intptr_t) req->backend_data;
+                assert((fd >= 0) && (fd < d->fds_size));
+                FDState* fds = &(d->fds[fd]);
                 assert(fds->state == PS_RegReceived2);
                 assert(fds->lid < 0);
                 assert(fds->cmd);
@@ -2673,58 +3616,33 @@ Laik_Group* tcp2_resize(Laik_ResizeRequests* resizeReqs)
         else if (d->peer[i].state == PS_InResizeRemove) to_remove++;
     }
 
-    // broadcast location ID info of old processes to all new-comers
-    for(int lid = 0; lid <= d->maxid; lid++) {
-        if (d->peer[lid].state == PS_Dead) continue;
-        if (d->peer[lid].state == PS_RegAccepted) continue;
-        // <lid> is an old process
-        sprintf(msg, "id %d %s %s %d %s", lid,
-                d->peer[lid].location, d->peer[lid].host, d->peer[lid].port,
-                d->peer[lid].accepts_bin_data ? "b":"-");
-        for(int to_lid = 1; to_lid <= d->maxid; to_lid++) {
-            if (d->peer[to_lid].state != PS_RegAccepted) continue;
-            assert(lid != to_lid);
-            send_cmd(d, to_lid, msg);
-        }
-    }
-
-    // broadcast location ID info of all new-comers to all non-masters
-    for(int lid = 0; lid <= d->maxid; lid++) {
+    // new-comers get a peer table with all processes, LIDs of processes
+    // marked for removal and 'getready' directly from master
+    for(int lid = 1; lid <= d->maxid; lid++)
+        if (d->peer[lid].state == PS_RegAccepted)
+            send_peers(d, lid, 0, false);
+    for(int lid = 1; lid <= d->maxid; lid++) {
         if (d->peer[lid].state != PS_RegAccepted) continue;
-        sprintf(msg, "newid %d %s %s %d %s", lid,
-                d->peer[lid].location, d->peer[lid].host, d->peer[lid].port,
-                d->peer[lid].accepts_bin_data ? "b":"-");
-        for(int to_lid = 1; to_lid <= d->maxid; to_lid++) {
-            if (d->peer[to_lid].state == PS_Dead) continue;
-            if (lid == to_lid) continue;
-            send_cmd(d, to_lid, msg);
-        }
-    }
-
-    // broadcast LIDs of all processes marked for removal
-    for(int lid = 0; lid <= d->maxid; lid++) {
-        if (d->peer[lid].state != PS_InResizeRemove) continue;
-        sprintf(msg, "backedout %d", lid);
-        for(int to_lid = 1; to_lid <= d->maxid; to_lid++) {
-            if (d->peer[to_lid].state == PS_Dead) continue;
-            send_cmd(d, to_lid, msg);
-        }
-    }
-
-    // request confirmation from all non-master about new info: send 'getReady'
-    for(int i = 1; i <= d->maxid; i++) {
-        if (d->peer[i].state == PS_Dead) continue;
-        if (d->peer[i].state == PS_RegAccepted)
-            d->peer[i].state = PS_RegFinishing;
-        else if (d->peer[i].state == PS_InResize)
-            d->peer[i].state = PS_InResize2;
-        else if (d->peer[i].state == PS_InResizeRemove)
-            d->peer[i].state = PS_InResizeRemove2;
+        send_backedout(d, lid);
+        d->peer[lid].state = PS_RegFinishing;
+        send_cmd(d, lid, "getready");
+    }
+
+    // processes of current world only get the new-comers and removals,
+    // forwarded along tree over current world together with 'getready'.
+    // Confirmations are aggregated upwards via "ok <count>"
+    tree_forward_resize(d);
+    for(int i = 1; i < w->size; i++) {
+        Peer* p = &(d->peer[w->locationid[i]]);
+        if (p->state == PS_InResize)
+            p->state = PS_InResize2;
+        else if (p->state == PS_InResizeRemove)
+            p->state = PS_InResizeRemove2;
         else
             assert(0); // should not happen
-
-        send_cmd(d, i, "getready");
     }
+    if (d->tree_pending == 0)
+        tree_confirm(d);
 
     // wait for ready confirmation
     int ready = 0, dead = 0;
@@ -2744,13 +3662,17 @@ Laik_Group* tcp2_resize(Laik_ResizeRequests* resizeReqs)
     laik_log(1, "TCP2 resize master: %d ready peers (%d added, %d to remove), %d dead",
              ready, added, to_remove, dead);
 
-    // finish resize
+    // finish resize: phase directly to new-comers (now ready), along tree
+    // to processes of current world
     if ((added > 0) || (to_remove > 0)) epoch++;
     sprintf(msg, "phase %d %d", phase, epoch);
     for(int lid = 1; lid <= d->maxid; lid++) {
-        if (d->peer[lid].state == PS_Dead) continue;
-        send_cmd(d, lid, msg);
+        if (d->peer[lid].state == PS_Ready)
+            send_cmd(d, lid, msg);
     }
+    for(int i = 0; i < d->tree_childCount; i++)
+        send_cmd(d, d->tree_child[i], msg);
+    d->tree_childCount = 0;
 
     if ((added == 0) && (to_remove == 0)) {
         // nothing changed
@@ -2763,7 +3685,6 @@ Laik_Group* tcp2_resize(Laik_ResizeRequests* resizeReqs)
     }
 
     // create new group from current world group, with parent relatinship
-    Laik_Group* w = instance->world;
     Laik_Group* g = laik_create_group(instance, d->maxid + 1);
     g->parent = w;
     int i1 = 0, i2 = 0; // i1: index in parent, i2: new process index
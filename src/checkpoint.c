@@ -0,0 +1,407 @@
+/*
+ * This file is part of the LAIK library.
+ * Copyright (c) 2017-2019 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+ *
+ * LAIK is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3 or later.
+ *
+ * LAIK is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <laik-internal.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+//--------------------------------------------------------
+// In-memory buddy checkpointing
+//
+// A checkpoint of a container is a copy of each process's own ranges,
+// held in a separate container which also gets copies of the ranges of
+// its buddy processes. Buddies are chosen on other nodes if possible.
+// The copies are distributed via a switch of the checkpoint container
+// from the partitioning of the original container to a "buddy"
+// partitioning, which can be spread over multiple collective steps
+// using prefetching. Two checkpoint containers are used alternately,
+// such that the last completed checkpoint stays valid while a new one
+// is distributed.
+//
+// On restore, lost ranges of failed processes are taken over by the
+// first surviving buddy. The original container is switched to the
+// resulting partitioning without preserving data, and the values are
+// copied locally from the checkpoint container.
+
+#define CHECKPOINT_MAXBUDDIES 2
+
+struct _Laik_Checkpoint {
+    Laik_Data* data; // container to checkpoint
+    int redundancy;  // number of buddies holding copies
+
+    Laik_Data* ckp[2];             // alternating checkpoint containers
+    Laik_Partitioning* base[2];    // partitioning of data at checkpoint
+    Laik_Partitioning* buddyP[2];  // base ranges with copies at buddies
+    Laik_Group* buddyGroup[2];     // group for which buddies were set
+    int* buddy[2];                 // buddies of each task in group
+
+    int valid;       // index of last completed checkpoint, -1: none
+    int inProgress;  // index of checkpoint being distributed, -1: none
+};
+
+// node of a location string of format "<host>:<pid>"
+static bool sameNode(char* l1, char* l2)
+{
+    if (!l1 || !l2) return false;
+    char* p1 = strrchr(l1, ':');
+    char* p2 = strrchr(l2, ':');
+    size_t len1 = p1 ? (size_t) (p1 - l1) : strlen(l1);
+    size_t len2 = p2 ? (size_t) (p2 - l2) : strlen(l2);
+    return (len1 == len2) && (strncmp(l1, l2, len1) == 0);
+}
+
+// choose buddies for each task in <g>: the next tasks on other nodes,
+// if not enough of them exist, the next tasks on same node.
+// Unused entries (group too small) are set to -1
+static int* chooseBuddies(Laik_Group* g, int redundancy)
+{
+    int size = laik_size(g);
+    int* buddy = malloc(size * redundancy * sizeof(int));
+    if (!buddy) {
+        laik_panic("Out of memory allocating buddy list");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    for(int t = 0; t < size; t++) {
+        int* b = buddy + t * redundancy;
+        int count = 0;
+        char* loc = laik_group_location(g, t);
+        for(int pass = 0; pass < 2; pass++) {
+            for(int k = 1; (k < size) && (count < redundancy); k++) {
+                int c = (t + k) % size;
+                bool other = !sameNode(loc, laik_group_location(g, c));
+                if ((pass == 0) && !other) continue;
+                if ((pass == 1) && other) continue;
+                b[count++] = c;
+            }
+        }
+        while(count < redundancy)
+            b[count++] = -1;
+        if (redundancy > 1)
+            laik_log(1, "checkpoint: buddies of task %d: %d, %d", t, b[0], b[1]);
+        else
+            laik_log(1, "checkpoint: buddy of task %d: %d", t, b[0]);
+    }
+    return buddy;
+}
+
+// partitioner: ranges of base partitioning, also given to buddies.
+// The partitioner may run any time while its partitioning exists (not
+// only during a checkpoint), thus it gets its own copy of the buddies
+typedef struct {
+    int redundancy;
+    int* buddy;
+} BuddyData;
+
+static void runBuddyPartitioner(Laik_RangeReceiver* rr, Laik_PartitionerParams* p)
+{
+    BuddyData* bd = (BuddyData*) p->partitioner->data;
+
+    for(int i = 0; i < laik_partitioning_rangecount(p->other); i++) {
+        Laik_TaskRange* tr = laik_partitioning_get_taskrange(p->other, i);
+        int task = laik_taskrange_get_task(tr);
+        const Laik_Range* r = laik_taskrange_get_range(tr);
+        laik_append_range(rr, task, r, 0, 0);
+        for(int k = 0; k < bd->redundancy; k++) {
+            int b = bd->buddy[task * bd->redundancy + k];
+            if (b >= 0)
+                laik_append_range(rr, b, r, 0, 0);
+        }
+    }
+}
+
+// buddy partitioning for checkpoint slot <slot>, based on <base>
+static Laik_Partitioning* newBuddyPartitioning(Laik_Checkpoint* c, int slot,
+                                               Laik_Partitioning* base)
+{
+    int size = laik_size(c->buddyGroup[slot]);
+    BuddyData* bd = malloc(sizeof(BuddyData));
+    int* buddy = malloc(size * c->redundancy * sizeof(int));
+    if (!bd || !buddy) {
+        laik_panic("Out of memory allocating BuddyData object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    memcpy(buddy, c->buddy[slot], size * c->redundancy * sizeof(int));
+    bd->redundancy = c->redundancy;
+    bd->buddy = buddy;
+
+    Laik_Partitioner* pr;
+    pr = laik_new_partitioner("buddy", runBuddyPartitioner, bd, 0);
+    return laik_new_partitioning(pr, base->group, c->data->space, base);
+}
+
+// free buddy partitioning together with its partitioner
+static void freeBuddyPartitioning(Laik_Partitioning* p)
+{
+    Laik_Partitioner* pr = p->partitioner;
+    BuddyData* bd = (BuddyData*) pr->data;
+    laik_free_partitioning(p);
+    free(bd->buddy);
+    free(bd);
+    free(pr);
+}
+
+// partitioner: ranges of base partitioning, ranges of failed tasks given
+// to first surviving buddy. The partitioner group is the group of the
+// base partitioning, <newg> is the shrinked group without failed tasks
+typedef struct {
+    Laik_Group* newg;
+    int redundancy;
+    int* buddy; // own copy, partitioner may outlive checkpoint
+} RestoreData;
+
+static int restoreTask(RestoreData* rd, int task)
+{
+    if (rd->newg->fromParent[task] >= 0) return task;
+    for(int k = 0; k < rd->redundancy; k++) {
+        int b = rd->buddy[task * rd->redundancy + k];
+        if ((b >= 0) && (rd->newg->fromParent[b] >= 0)) return b;
+    }
+    return -1;
+}
+
+static void runRestorePartitioner(Laik_RangeReceiver* rr, Laik_PartitionerParams* p)
+{
+    RestoreData* rd = (RestoreData*) p->partitioner->data;
+
+    for(int i = 0; i < laik_partitioning_rangecount(p->other); i++) {
+        Laik_TaskRange* tr = laik_partitioning_get_taskrange(p->other, i);
+        int task = restoreTask(rd, laik_taskrange_get_task(tr));
+        assert(task >= 0);
+        laik_append_range(rr, task, laik_taskrange_get_range(tr),
+                          laik_taskrange_get_tag(tr), 0);
+    }
+}
+
+static RestoreData* newRestoreData(Laik_Checkpoint* c, Laik_Group* newg)
+{
+    int size = laik_size(c->buddyGroup[c->valid]);
+    RestoreData* rd = malloc(sizeof(RestoreData));
+    int* buddy = malloc(size * c->redundancy * sizeof(int));
+    if (!rd || !buddy) {
+        laik_panic("Out of memory allocating RestoreData object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    memcpy(buddy, c->buddy[c->valid], size * c->redundancy * sizeof(int));
+    rd->newg = newg;
+    rd->redundancy = c->redundancy;
+    rd->buddy = buddy;
+    return rd;
+}
+
+static void freeRestoreData(RestoreData* rd)
+{
+    free(rd->buddy);
+    free(rd);
+}
+
+// copy own ranges of partitioning <toP> used by container <to> from
+// container <from>, which must hold each range within one of its ranges
+static void copyOwnRanges(Laik_Data* from, Laik_Data* to, Laik_Partitioning* toP)
+{
+    Laik_Partitioning* fromP = laik_data_get_partitioning(from);
+    for(int n = 0; n < laik_my_rangecount(toP); n++) {
+        // task range objects are reused by next laik_my_range() call
+        Laik_TaskRange* tr = laik_my_range(toP, n);
+        Laik_Range r = *laik_taskrange_get_range(tr);
+        int toMapNo = laik_taskrange_get_mapNo(tr);
+        int fromMapNo = -1;
+        for(int m = 0; m < laik_my_rangecount(fromP); m++) {
+            Laik_TaskRange* ftr = laik_my_range(fromP, m);
+            if (!laik_range_within_range(&r, laik_taskrange_get_range(ftr)))
+                continue;
+            fromMapNo = laik_taskrange_get_mapNo(ftr);
+            break;
+        }
+        assert(fromMapNo >= 0);
+        laik_data_copy(&r, laik_get_map(from, fromMapNo),
+                       laik_get_map(to, toMapNo));
+    }
+}
+
+Laik_Checkpoint* laik_checkpoint_new(Laik_Data* d, int redundancy)
+{
+    assert((redundancy >= 1) && (redundancy <= CHECKPOINT_MAXBUDDIES));
+
+    Laik_Checkpoint* c = malloc(sizeof(Laik_Checkpoint));
+    if (!c) {
+        laik_panic("Out of memory allocating Laik_Checkpoint object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    // buddies should be on other nodes: needs location strings
+    Laik_Instance* inst = d->space->inst;
+    if (inst->location == 0)
+        laik_sync_location(inst);
+
+    c->data = d;
+    c->redundancy = redundancy;
+    for(int i = 0; i < 2; i++) {
+        c->ckp[i] = laik_new_data(d->space, d->type);
+        c->base[i] = 0;
+        c->buddyP[i] = 0;
+        c->buddyGroup[i] = 0;
+        c->buddy[i] = 0;
+    }
+    c->valid = -1;
+    c->inProgress = -1;
+
+    return c;
+}
+
+void laik_checkpoint_start(Laik_Checkpoint* c, int steps)
+{
+    if (c->inProgress >= 0)
+        laik_checkpoint_finish(c);
+
+    Laik_Data* d = c->data;
+    Laik_Partitioning* p = laik_data_get_partitioning(d);
+    assert(p != 0);
+
+    int cur = (c->valid == 0) ? 1 : 0;
+    c->inProgress = cur;
+    Laik_Data* ckp = c->ckp[cur];
+
+    // buddy partitioning needs update if partitioning of data changed.
+    // The old one is still active in <ckp>, free it after switching away
+    Laik_Partitioning* oldBuddyP = 0;
+    if (c->base[cur] != p) {
+        if (c->buddyGroup[cur] != p->group) {
+            free(c->buddy[cur]);
+            c->buddy[cur] = chooseBuddies(p->group, c->redundancy);
+            c->buddyGroup[cur] = p->group;
+        }
+        oldBuddyP = c->buddyP[cur];
+        c->base[cur] = p;
+        c->buddyP[cur] = newBuddyPartitioning(c, cur, p);
+    }
+
+    // snapshot of own ranges, then distribute copies to buddies
+    laik_switchto_partitioning(ckp, p, LAIK_DF_None, LAIK_RO_None);
+    if (oldBuddyP)
+        freeBuddyPartitioning(oldBuddyP);
+    copyOwnRanges(d, ckp, p);
+
+    laik_log(1, "checkpoint of data '%s': start in %d steps", d->name, steps);
+    if (steps > 0)
+        laik_data_prefetch_start(ckp, c->buddyP[cur], steps);
+    else
+        laik_checkpoint_finish(c);
+}
+
+bool laik_checkpoint_step(Laik_Checkpoint* c)
+{
+    if (c->inProgress < 0) return false;
+    return laik_data_prefetch_step(c->ckp[c->inProgress]);
+}
+
+void laik_checkpoint_finish(Laik_Checkpoint* c)
+{
+    int cur = c->inProgress;
+    if (cur < 0) return;
+
+    laik_switchto_partitioning(c->ckp[cur], c->buddyP[cur],
+                               LAIK_DF_Preserve, LAIK_RO_None);
+    c->valid = cur;
+    c->inProgress = -1;
+
+    laik_log(1, "checkpoint of data '%s': done", c->data->name);
+}
+
+bool laik_checkpoint_valid(Laik_Checkpoint* c)
+{
+    return c->valid >= 0;
+}
+
+// restore from checkpoint into shrinked group <newg>
+static void restore(Laik_Checkpoint* c, Laik_Group* newg)
+{
+    int v = c->valid;
+    Laik_Data* d = c->data;
+    Laik_Data* ckp = c->ckp[v];
+    Laik_Partitioning* base = c->base[v];
+
+    Laik_Partitioner* pr;
+    pr = laik_new_partitioner("restore", runRestorePartitioner,
+                              newRestoreData(c, newg), 0);
+    Laik_Partitioning* p = laik_new_partitioning(pr, base->group, d->space, base);
+    laik_partitioning_migrate(p, newg);
+
+    // all own ranges are available locally in checkpoint container.
+    // no transition for checkpoint container: with ranges held by
+    // multiple processes, it could involve failed ones
+    laik_switchto_partitioning(d, p, LAIK_DF_None, LAIK_RO_None);
+    if (laik_myid(newg) >= 0)
+        copyOwnRanges(ckp, d, p);
+
+    // copies at buddies are gone, a new checkpoint is required
+    c->base[v] = 0;
+    c->valid = -1;
+}
+
+Laik_Group* laik_checkpoint_restore(int count, Laik_Checkpoint** list,
+                                    int failedCount, int* failed)
+{
+    assert(count > 0);
+    Laik_Group* g = laik_data_get_group(list[0]->data);
+    Laik_Group* newg = laik_new_shrinked_group(g, failedCount, failed);
+
+    // check that data of all failed tasks can be restored before changing
+    for(int i = 0; i < count; i++) {
+        Laik_Checkpoint* c = list[i];
+        if (c->valid < 0) {
+            laik_log(LAIK_LL_Warning, "restore of data '%s': no checkpoint",
+                     c->data->name);
+            return 0;
+        }
+        assert(c->base[c->valid]->group == g);
+
+        RestoreData* rd = newRestoreData(c, newg);
+        for(int f = 0; f < failedCount; f++) {
+            if (restoreTask(rd, failed[f]) >= 0) continue;
+            laik_log(LAIK_LL_Warning, "restore of data '%s': task %d and "
+                     "all its buddies failed", c->data->name, failed[f]);
+            freeRestoreData(rd);
+            return 0;
+        }
+        freeRestoreData(rd);
+    }
+
+    for(int i = 0; i < count; i++) {
+        Laik_Checkpoint* c = list[i];
+        // a checkpoint being distributed is incomplete, drop it
+        c->inProgress = -1;
+        restore(c, newg);
+        laik_log(1, "restore of data '%s' from checkpoint done", c->data->name);
+    }
+    return newg;
+}
+
+void laik_checkpoint_free(Laik_Checkpoint* c)
+{
+    for(int i = 0; i < 2; i++) {
+        laik_free(c->ckp[i]);
+        if (c->buddyP[i])
+            freeBuddyPartitioning(c->buddyP[i]);
+        free(c->buddy[i]);
+    }
+    free(c);
+}
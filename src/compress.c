@@ -0,0 +1,185 @@
+/*
+ * This file is part of the LAIK library.
+ * Copyright (c) 2017-2019 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+ *
+ * LAIK is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3 or later.
+ *
+ * LAIK is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <laik-internal.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+//--------------------------------------------------------
+// Wire compression for backends
+//
+// Elements of <width> bytes first get byte-shuffled: all first bytes of
+// the elements, then all second bytes, and so on. For smooth fields of
+// numbers, this puts similar bytes (sign/exponent) next to each other.
+// The result is compressed with a simple LZ77-style codec using tokens
+//  - <c> with c < 0x80: literal run of c+1 bytes following the token
+//  - <c> with c >= 0x80, 2 bytes offset: copy (c & 0x7f) + 4 bytes
+//    starting <offset> bytes before the current output position
+
+#define LZ_MINMATCH   4
+#define LZ_MAXMATCH   (0x7f + LZ_MINMATCH)
+#define LZ_MAXLITERAL 0x80
+#define LZ_MAXOFFSET  0xffff
+#define LZ_HASHBITS   12
+
+static uint32_t load32(const unsigned char* p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static int lzHash(uint32_t v)
+{
+    return (int) ((v * 2654435761u) >> (32 - LZ_HASHBITS));
+}
+
+// byte shuffle (or unshuffle) of <len> bytes with element size <width>
+static void shuffle(const char* in, char* out, int len, int width, bool undo)
+{
+    int n = len / width;
+    for(int k = 0; k < n; k++)
+        for(int b = 0; b < width; b++) {
+            if (undo)
+                out[k * width + b] = in[b * n + k];
+            else
+                out[b * n + k] = in[k * width + b];
+        }
+}
+
+// write literal run, return new output position or -1 if out of space
+static int putLiterals(const unsigned char* lit, int count,
+                       unsigned char* out, int o, int outcap)
+{
+    while(count > 0) {
+        int c = (count > LZ_MAXLITERAL) ? LZ_MAXLITERAL : count;
+        if (o + 1 + c > outcap) return -1;
+        out[o++] = (unsigned char) (c - 1);
+        memcpy(out + o, lit, c);
+        o += c;
+        lit += c;
+        count -= c;
+    }
+    return o;
+}
+
+int laik_compress(const char* in, int len, int width, char* out, int outcap)
+{
+    if (len < 2 * LZ_MINMATCH) return 0;
+    if (outcap > len - 1) outcap = len - 1; // must be smaller than raw
+
+    const unsigned char* src = (const unsigned char*) in;
+    unsigned char* tmp = 0;
+    if ((width > 1) && (len % width == 0)) {
+        tmp = malloc(len);
+        if (!tmp) return 0;
+        shuffle(in, (char*) tmp, len, width, false);
+        src = tmp;
+    }
+
+    int table[1 << LZ_HASHBITS];
+    for(int i = 0; i < (1 << LZ_HASHBITS); i++)
+        table[i] = -1;
+
+    unsigned char* dst = (unsigned char*) out;
+    int o = 0, i = 0, litStart = 0;
+    while((o >= 0) && (i + LZ_MINMATCH <= len)) {
+        uint32_t v = load32(src + i);
+        int h = lzHash(v);
+        int cand = table[h];
+        table[h] = i;
+        if ((cand < 0) || (i - cand > LZ_MAXOFFSET) || (load32(src + cand) != v)) {
+            i++;
+            continue;
+        }
+
+        int mlen = LZ_MINMATCH;
+        while((mlen < LZ_MAXMATCH) && (i + mlen < len) &&
+              (src[cand + mlen] == src[i + mlen]))
+            mlen++;
+
+        o = putLiterals(src + litStart, i - litStart, dst, o, outcap);
+        if ((o < 0) || (o + 3 > outcap)) {
+            o = -1;
+            break;
+        }
+        int off = i - cand;
+        dst[o++] = (unsigned char) (0x80 | (mlen - LZ_MINMATCH));
+        dst[o++] = (unsigned char) (off & 255);
+        dst[o++] = (unsigned char) (off >> 8);
+        i += mlen;
+        litStart = i;
+    }
+    if (o >= 0)
+        o = putLiterals(src + litStart, len - litStart, dst, o, outcap);
+
+    free(tmp);
+    return (o < 0) ? 0 : o;
+}
+
+bool laik_decompress(const char* in, int clen, int width, char* out, int len)
+{
+    bool doShuffle = (width > 1) && (len % width == 0);
+    unsigned char* dst = (unsigned char*) out;
+    if (doShuffle) {
+        dst = malloc(len);
+        if (!dst) return false;
+    }
+
+    const unsigned char* src = (const unsigned char*) in;
+    int i = 0, o = 0;
+    bool ok = true;
+    while(ok && (i < clen)) {
+        int c = src[i++];
+        if (c < 0x80) {
+            int count = c + 1;
+            if ((i + count > clen) || (o + count > len)) {
+                ok = false;
+                break;
+            }
+            memcpy(dst + o, src + i, count);
+            i += count;
+            o += count;
+            continue;
+        }
+        if (i + 2 > clen) {
+            ok = false;
+            break;
+        }
+        int mlen = (c & 0x7f) + LZ_MINMATCH;
+        int off = src[i] | (src[i+1] << 8);
+        i += 2;
+        if ((off == 0) || (off > o) || (o + mlen > len)) {
+            ok = false;
+            break;
+        }
+        // byte-wise: source and destination may overlap
+        for(int k = 0; k < mlen; k++, o++)
+            dst[o] = dst[o - off];
+    }
+    if (o != len) ok = false;
+
+    if (doShuffle) {
+        if (ok)
+            shuffle((char*) dst, out, len, width, true);
+        free(dst);
+    }
+    return ok;
+}
@@ -149,6 +149,9 @@ void laik_finalize(Laik_Instance* inst)
     // finish an eventual ongoing resize phase
     laik_finish_world_resize(inst);
 
+    // collective: needs backend
+    laik_commstat_writeout(inst);
+
     if (inst->backend && inst->backend->finalize)
         (*inst->backend->finalize)(inst);
 
@@ -175,6 +178,7 @@ void laik_finalize(Laik_Instance* inst)
         laik_log_flush(0);
     }
 
+    laik_trace_writeout(inst);
     laik_close_profiling_file(inst);
     laik_free_profiling(inst);
     free(inst->control);
@@ -221,6 +225,7 @@ Laik_Instance* laik_new_instance(const Laik_Backend* b,
     instance->location = 0; // set at location sync
 
     instance->spaceStore = 0;
+    instance->partitioningStore = 0;
 
     // for logging wall-clock time since LAIK initialization
     gettimeofday(&(instance->init_time), NULL);
@@ -76,6 +76,7 @@ Laik_SwitchStat* laik_newSwitchStat()
     ss->initOpCount = 0;
     ss->reduceOpCount = 0;
     ss->byteBufCopyCount = 0;
+    ss->migratedBytes = 0;
 
     return ss;
 }
@@ -107,6 +108,7 @@ void laik_addSwitchStat(Laik_SwitchStat* target, Laik_SwitchStat* src)
     target->initOpCount        += src->initOpCount;
     target->reduceOpCount      += src->reduceOpCount;
     target->byteBufCopyCount   += src->byteBufCopyCount;
+    target->migratedBytes      += src->migratedBytes;
 }
 
 void laik_switchstat_addASeq(Laik_SwitchStat* target, Laik_ActionSeq* as)
@@ -156,6 +158,55 @@ void laik_switchstat_free(Laik_SwitchStat* ss, uint64_t bytes)
 
 static int data_id = 0;
 
+// names of field containers are "<data name>.<field name>"
+static
+void setFieldNames(Laik_Data* d)
+{
+    for(int f = 0; f < d->type->fieldCount; f++) {
+        char* fname = d->type->field[f].name;
+        char* n = malloc(strlen(d->name) + strlen(fname) + 2);
+        if (!n) {
+            laik_panic("Out of memory allocating field container name");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+        sprintf(n, "%s.%s", d->name, fname);
+        d->field[f]->name = n;
+    }
+}
+
+// functions working on mappings cannot be used with compound containers
+static
+void checkNotCompound(Laik_Data* d, const char* func)
+{
+    if (d->field == 0) return;
+
+    laik_log(LAIK_LL_Panic,
+             "%s: not supported for compound container '%s', "
+             "use field containers (laik_data_get_field)", func, d->name);
+    exit(1); // not actually needed, laik_log never returns
+}
+
+// for compound container: set partitioning to the one used by all fields,
+// or to 0 if fields use different partitionings (after selective switches)
+static
+void updateCompoundPartitioning(Laik_Data* d)
+{
+    Laik_Partitioning* p = d->field[0]->activePartitioning;
+    for(int f = 1; f < d->type->fieldCount; f++)
+        if (d->field[f]->activePartitioning != p) {
+            p = 0;
+            break;
+        }
+    d->activePartitioning = p;
+}
+
+// for compound container: should field <f> be transferred?
+static
+bool fieldSelected(Laik_Data* d, int f)
+{
+    return (d->fieldMask >> f) & 1;
+}
+
 Laik_Data* laik_new_data(Laik_Space* space, Laik_Type* type)
 {
     Laik_Data* d = malloc(sizeof(Laik_Data));
@@ -176,6 +227,10 @@ Laik_Data* laik_new_data(Laik_Space* space, Laik_Type* type)
     d->backend_data = 0;
     d->activePartitioning = 0;
     d->activeMappings = 0;
+    d->prefetchPartitioning = 0;
+    d->prefetchMappings = 0;
+    d->prefetchTransition = 0;
+    d->prefetchDirty = 0;
     assert(laik_allocator_def);
     d->allocator = laik_allocator_def; // malloc/free + reuse if possible
     d->layout_factory = laik_new_layout_lex; // by default, use lex layouts
@@ -185,6 +240,21 @@ Laik_Data* laik_new_data(Laik_Space* space, Laik_Type* type)
     d->map0_base = 0;
     d->map0_size = 0;
 
+    d->field = 0;
+    d->fieldMask = LAIK_FIELDS_ALL;
+    if (type->kind == LAIK_TK_Compound) {
+        // struct of arrays: separate container for each field
+        assert(type->fieldCount > 0);
+        d->field = malloc(type->fieldCount * sizeof(Laik_Data*));
+        if (!d->field) {
+            laik_panic("Out of memory allocating field containers");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+        for(int f = 0; f < type->fieldCount; f++)
+            d->field[f] = laik_new_data(space, type->field[f].type);
+        setFieldNames(d);
+    }
+
     laik_log(1, "new data '%s':\n"
              "  type '%s' (elemsize %d), space '%s' (%lu elems, %.3f MB)\n",
              d->name, type->name, d->elemsize, space->name,
@@ -215,6 +285,7 @@ void laik_data_set_name(Laik_Data* d, char* n)
     laik_log(1, "data '%s' renamed to '%s'", d->name, n);
 
     d->name = n;
+    if (d->field) setFieldNames(d);
 }
 
 // get space used for data
@@ -247,6 +318,26 @@ Laik_Partitioning* laik_data_get_partitioning(Laik_Data* d)
 void laik_data_set_layout_factory(Laik_Data* d, laik_layout_factory_t lf)
 {
     d->layout_factory = lf;
+    if (d->field)
+        for(int f = 0; f < d->type->fieldCount; f++)
+            d->field[f]->layout_factory = lf;
+}
+
+// container for field <f> of compound container
+Laik_Data* laik_data_get_field(Laik_Data* d, int f)
+{
+    assert(d->field != 0);
+    assert((f >= 0) && (f < d->type->fieldCount));
+    return d->field[f];
+}
+
+// restrict data transfer in following transitions to fields in <mask>
+void laik_data_set_fieldmask(Laik_Data* d, uint64_t mask)
+{
+    assert(d->field != 0);
+    laik_log(1, "data '%s': field mask set to %llx",
+             d->name, (unsigned long long) mask);
+    d->fieldMask = mask;
 }
 
 static
@@ -307,15 +398,27 @@ Laik_Range* coveringRanges(int n, Laik_RangeList* list, int myid)
 
     laik_log(1, "coveringRanges: %d maps", n);
 
+    if (list->iset) {
+        // single index format: one mapping covering all indexes
+        assert(n == 1);
+        int64_t from, to;
+        bool notEmpty = laik_indexset_bounds(laik_rangelist_iset(list, myid),
+                                             &from, &to);
+        assert(notEmpty);
+        laik_range_init_1d(&(ranges[0]), list->space, from, to);
+        return ranges;
+    }
+
     int mapNo = 0;
-    for(unsigned int o = list->off[myid]; o < list->off[myid+1]; o++, mapNo++) {
+    unsigned int lastOff = laik_rangelist_off(list, myid + 1);
+    for(unsigned int o = laik_rangelist_off(list, myid); o < lastOff; o++, mapNo++) {
         unsigned int firstOff = o;
         assert(mapNo == list->trange[o].mapNo);
         Laik_Range* range = &(ranges[mapNo]);
 
         // range covering all task ranges for a given map number
         *range = list->trange[o].range;
-        while((o+1 < list->off[myid+1]) && (list->trange[o+1].mapNo == mapNo)) {
+        while((o+1 < lastOff) && (list->trange[o+1].mapNo == mapNo)) {
             o++;
             laik_range_expand(range, &(list->trange[o].range));
         }
@@ -331,6 +434,7 @@ Laik_Range* coveringRanges(int n, Laik_RangeList* list, int myid)
 
 // forward decl
 static void laik_map_set_allocation(Laik_Mapping*, char*, uint64_t, Laik_Allocator*);
+static void prefetchDiscard(Laik_Data* d);
 
 static
 Laik_MappingList* prepareMaps(Laik_Data* d, Laik_Partitioning* p)
@@ -360,12 +464,12 @@ Laik_MappingList* prepareMaps(Laik_Data* d, Laik_Partitioning* p)
     assert(list != 0); // TODO: API user error
 
     // number of local ranges
-    int sn = list->off[myid+1] - list->off[myid];
+    int sn = laik_rangelist_tidrangecount(list, myid);
 
     // number of maps
     int n = 0;
     if (sn > 0)
-        n = list->trange[list->off[myid+1] - 1].mapNo + 1;
+        n = laik_rangelist_tidmapcount(list, myid);
 
     laik_log(1, "prepareMaps: %d maps for data '%s' (partitioning '%s')",
              n, d->name, p->name);
@@ -449,11 +553,11 @@ uint64_t freeMappingList(Laik_MappingList* ml, Laik_SwitchStat* ss)
         Laik_Mapping* m = &(ml->map[i]);
         assert(m != 0);
 
-        if (ml->layout != m->layout) free(m->layout);
+        if (ml->layout != m->layout) laik_free_layout(m->layout);
         freed += freeMap(m, m->data, ss);
     }
 
-    free(ml->layout);
+    laik_free_layout(ml->layout);
     free(ml);
 
     return freed;
@@ -757,6 +861,72 @@ void allocateMappings(Laik_MappingList* toList, Laik_SwitchStat* ss)
     }
 }
 
+// address range covering the required range of mapping <m>
+static
+bool mapRegion(Laik_Mapping* m, char** start, size_t* len)
+{
+    if ((m->base == 0) || (m->count == 0) || (m->layout == 0)) return false;
+
+    Laik_Range* r = &(m->requiredRange);
+    Laik_Index last = r->to;
+    for(int i = 0; i < m->data->space->dims; i++)
+        last.i[i]--;
+    int64_t off1 = laik_offset(m->layout, m->layoutSection, &(r->from));
+    int64_t off2 = laik_offset(m->layout, m->layoutSection, &last);
+    if (off2 < off1) {
+        int64_t tmp = off1; off1 = off2; off2 = tmp;
+    }
+    *start = m->base + off1 * m->data->elemsize;
+    *len = (size_t) (off2 - off1 + 1) * (size_t) m->data->elemsize;
+    return true;
+}
+
+// with memory policy LAIK_MP_NotifyOnChange, tell the allocator about
+// mappings used in the new partitioning (<toList>), before data transfer
+static
+void notifyAllocatorMap(Laik_Data* d, Laik_MappingList* toList)
+{
+    Laik_Allocator* a = d->allocator;
+    if ((a == 0) || (a->policy != LAIK_MP_NotifyOnChange)) return;
+    if ((toList == 0) || (a->map == 0)) return;
+
+    char* start;
+    size_t len;
+    for(int i = 0; i < toList->count; i++)
+        if (mapRegion(&(toList->map[i]), &start, &len))
+            (a->map)(d, start, len);
+}
+
+// with memory policy LAIK_MP_NotifyOnChange, tell the allocator about
+// mappings of the old partitioning (<fromList>) not overlapping any new
+// mapping. Must be done after all data was transfered/copied from them
+static
+void notifyAllocatorUnmap(Laik_Data* d,
+                          Laik_MappingList* fromList, Laik_MappingList* toList)
+{
+    Laik_Allocator* a = d->allocator;
+    if ((a == 0) || (a->policy != LAIK_MP_NotifyOnChange)) return;
+
+    char* start;
+    size_t len;
+    if (fromList && a->unmap) {
+        for(int i = 0; i < fromList->count; i++) {
+            Laik_Mapping* m = &(fromList->map[i]);
+            bool overlap = false;
+            for(int j = 0; toList && (j < toList->count); j++) {
+                if (toList->map[j].count == 0) continue;
+                if (laik_range_intersect(&(m->requiredRange),
+                                         &(toList->map[j].requiredRange))) {
+                    overlap = true;
+                    break;
+                }
+            }
+            if (!overlap && mapRegion(m, &start, &len))
+                (a->unmap)(d, start, len);
+        }
+    }
+}
+
 static
 Laik_ActionSeq* createTransASeq(Laik_Data* d, Laik_Transition* t,
                                 Laik_MappingList* fromList,
@@ -775,6 +945,23 @@ Laik_ActionSeq* createTransASeq(Laik_Data* d, Laik_Transition* t,
 }
 
 
+// number of indexes in range <r> received in a transition which were not
+// owned before, ie. not within required ranges of mappings in <fromList>
+static
+uint64_t migratedCount(Laik_Range* r, Laik_MappingList* fromList)
+{
+    uint64_t count = laik_range_size(r);
+    uint64_t owned = 0;
+    if (fromList) {
+        for(int i = 0; i < fromList->count; i++) {
+            if (fromList->map[i].requiredRange.space == 0) continue; // empty
+            Laik_Range* is = laik_range_intersect(r, &(fromList->map[i].requiredRange));
+            if (is) owned += laik_range_size(is);
+        }
+    }
+    return (owned < count) ? count - owned : 0;
+}
+
 static
 void doTransition(Laik_Data* d, Laik_Transition* t, Laik_ActionSeq* as,
                   Laik_MappingList* fromList, Laik_MappingList* toList)
@@ -783,10 +970,15 @@ void doTransition(Laik_Data* d, Laik_Transition* t, Laik_ActionSeq* as,
         d->stat->switches++;
         if (!t || (t->actionCount == 0))
             d->stat->switches_noactions++;
+        if (t)
+            for(int i = 0; i < t->recvCount; i++)
+                d->stat->migratedBytes +=
+                    migratedCount(&(t->recv[i].range), fromList) * d->elemsize;
     }
 
     if (t == 0) {
         // no transition to exec, just free old mappings
+        notifyAllocatorUnmap(d, fromList, 0);
 
         // only free mappings if not part of a reservation
         if (fromList->res == 0)
@@ -803,9 +995,14 @@ void doTransition(Laik_Data* d, Laik_Transition* t, Laik_ActionSeq* as,
     // is fine.
     checkMapReuse(toList, fromList);
 
+    double traceStart = laik_trace_enabled ? laik_wtime() : 0.0;
+
     // allocate space for mappings for which reuse is not possible
     allocateMappings(toList, d->stat);
 
+    // hint for allocator: memory used from now on
+    notifyAllocatorMap(d, toList);
+
     bool doASeqCleanup = false;
     if (as) {
         // we are given a prepared action sequence:
@@ -825,8 +1022,12 @@ void doTransition(Laik_Data* d, Laik_Transition* t, Laik_ActionSeq* as,
         as = createTransASeq(d, t, fromList, toList);
 #if 1
         const Laik_Backend* backend = d->space->inst->backend;
-        if (backend->prepare)
+        if (backend->prepare) {
+            double prepStart = laik_trace_enabled ? laik_wtime() : 0.0;
+            laik_trace_mark();
             (backend->prepare)(as);
+            laik_trace_event("prepare", "Prepare", d->name, prepStart, -1, -1);
+        }
         else {
             // for statistics: usually called in backend prepare function
             laik_aseq_calc_stats(as);
@@ -842,7 +1043,10 @@ void doTransition(Laik_Data* d, Laik_Transition* t, Laik_ActionSeq* as,
         if (inst->profiling->do_profiling)
             inst->profiling->timer_backend = laik_wtime();
 
+        double execStart = laik_trace_enabled ? laik_wtime() : 0.0;
+        laik_trace_mark();
         (inst->backend->exec)(as);
+        laik_trace_event("exec", "Exec", d->name, execStart, -1, -1);
 
         if (inst->profiling->do_profiling)
             inst->profiling->time_backend += laik_wtime() - inst->profiling->timer_backend;
@@ -863,12 +1067,17 @@ void doTransition(Laik_Data* d, Laik_Transition* t, Laik_ActionSeq* as,
     if (t->initCount > 0)
         initMaps(t, toList, fromList, d->stat);
 
+    // hint for allocator: old memory not used anymore
+    notifyAllocatorUnmap(d, fromList, toList);
+
     // free old mapping/partitioning
     if (fromList) {
         // only free mappings if not part of a reservation
         if (fromList->res == 0)
             freeMappingList(fromList, d->stat);
     }
+
+    laik_trace_event("transition", "Transition", d->name, traceStart, -1, -1);
 }
 
 // make data container aware of reservation
@@ -888,6 +1097,8 @@ static int res_id = 0;
 // create a reservation object for <data>
 Laik_Reservation* laik_reservation_new(Laik_Data* d)
 {
+    checkNotCompound(d, "laik_reservation_new");
+
     Laik_Reservation* r = malloc(sizeof(Laik_Reservation));
     if (!r) {
         laik_panic("Out of memory allocating Laik_Reservation object");
@@ -1043,7 +1254,7 @@ void laik_reservation_alloc(Laik_Reservation* res)
         Laik_RangeList* list = laik_partitioning_myranges(p);
         for(int mapNo = 0; mapNo < (int) list->map_count; mapNo++) {
             unsigned int off = list->map_off[mapNo];
-            int tag = list->trange[off].tag;
+            int tag = laik_rangelist_trange(list, off)->tag;
             // for reservation, tag >0 to specify partitioning relations
             // TODO: tag == 0 means to use heuristic, but not implemented yet
             //       but we are fine with just one range group and tag 0
@@ -1106,14 +1317,15 @@ void laik_reservation_alloc(Laik_Reservation* res)
         Laik_Partitioning* p = res->entry[idx].p;
         Laik_RangeList* list = laik_partitioning_myranges(p);
         for(unsigned int o = list->map_off[partMapNo]; o < list->map_off[partMapNo+1]; o++) {
-            assert(list->trange[o].range.space != 0);
-            assert(list->trange[o].mapNo == partMapNo);
-            assert(list->trange[o].tag == glist[i].tag);
-            assert(laik_range_size(&(list->trange[o].range)) > 0);
+            Laik_TaskRange_Gen* tr = laik_rangelist_trange(list, o);
+            assert(tr->range.space != 0);
+            assert(tr->mapNo == partMapNo);
+            assert(tr->tag == glist[i].tag);
+            assert(laik_range_size(&(tr->range)) > 0);
             if (laik_range_isEmpty(&(pMap->requiredRange)))
-                pMap->requiredRange = list->trange[o].range;
+                pMap->requiredRange = tr->range;
             else
-                laik_range_expand(&(pMap->requiredRange), &(list->trange[o].range));
+                laik_range_expand(&(pMap->requiredRange), &(tr->range));
         }
 
         // extend combined mapping descriptor by required size
@@ -1194,18 +1406,32 @@ void laik_exec_transition(Laik_Data* d, Laik_Transition* t)
         laik_log_flush(" on data '%s'", d->name);
     }
 
+    if (d->field) {
+        // compound: only selected fields do the transition
+        for(int f = 0; f < d->type->fieldCount; f++)
+            if (fieldSelected(d, f))
+                laik_exec_transition(d->field[f], t);
+        updateCompoundPartitioning(d);
+        return;
+    }
+
     // we only can execute transtion if start state in transition is correct
     if (d->activePartitioning != t->fromPartitioning) {
         laik_panic("laik_exec_transition starts in wrong partitioning!");
         exit(1);
     }
 
+    Laik_Instance* inst = d->space->inst;
+    laik_profile_laik_start(inst);
+
     Laik_MappingList* toList = prepareMaps(d, t->toPartitioning);
     doTransition(d, t, 0, d->activeMappings, toList);
 
     // set new mapping/partitioning active
     d->activePartitioning = t->toPartitioning;
     d->activeMappings = toList;
+
+    laik_profile_laik_stop(inst);
 }
 
 Laik_ActionSeq* laik_calc_actions(Laik_Data* d,
@@ -1215,6 +1441,7 @@ Laik_ActionSeq* laik_calc_actions(Laik_Data* d,
 {
     // never create a sequence with an invalid transition
     if (t == 0) return 0;
+    checkNotCompound(d, "laik_calc_actions");
 
     Laik_MappingList* fromList = 0;
     Laik_MappingList* toList = 0;
@@ -1227,7 +1454,10 @@ Laik_ActionSeq* laik_calc_actions(Laik_Data* d,
     Laik_ActionSeq* as = createTransASeq(d, t, fromList, toList);
     const Laik_Backend* backend = d->space->inst->backend;
     if (backend->prepare) {
+        double prepStart = laik_trace_enabled ? laik_wtime() : 0.0;
+        laik_trace_mark();
         (backend->prepare)(as);
+        laik_trace_event("prepare", "Prepare", d->name, prepStart, -1, -1);
 
         // remember mappings at prepare time
         Laik_TransitionContext* tc = as->context[0];
@@ -1282,11 +1512,267 @@ void laik_exec_actions(Laik_ActionSeq* as)
     if (as->backend)
         assert(as->backend == d->space->inst->backend);
 
+    Laik_Instance* inst = d->space->inst;
+    laik_profile_laik_start(inst);
+
     doTransition(d, t, as, d->activeMappings, toList);
 
     // set new mapping/partitioning active
     d->activePartitioning = t->toPartitioning;
     d->activeMappings = toList;
+
+    laik_profile_laik_stop(inst);
+}
+
+
+//
+// prefetch
+//
+
+// only do sends/recvs of <t> for indexes in [from;to[ of 1st dimension
+static
+Laik_Transition* prefetchTransition(Laik_Transition* t, int64_t from, int64_t to)
+{
+    Laik_Transition* pt = malloc(sizeof(Laik_Transition));
+    *pt = *t;
+    pt->localCount = 0;
+    pt->initCount = 0;
+    pt->redCount = 0;
+
+    pt->sendCount = 0;
+    pt->send = malloc((t->sendCount + 1) * sizeof(struct sendTOp));
+    for(int i = 0; i < t->sendCount; i++) {
+        Laik_Range r = t->send[i].range;
+        if (r.from.i[0] < from) r.from.i[0] = from;
+        if (r.to.i[0] > to) r.to.i[0] = to;
+        if (r.from.i[0] >= r.to.i[0]) continue;
+        pt->send[pt->sendCount] = t->send[i];
+        pt->send[pt->sendCount].range = r;
+        pt->sendCount++;
+    }
+
+    pt->recvCount = 0;
+    pt->recv = malloc((t->recvCount + 1) * sizeof(struct recvTOp));
+    for(int i = 0; i < t->recvCount; i++) {
+        Laik_Range r = t->recv[i].range;
+        if (r.from.i[0] < from) r.from.i[0] = from;
+        if (r.to.i[0] > to) r.to.i[0] = to;
+        if (r.from.i[0] >= r.to.i[0]) continue;
+        pt->recv[pt->recvCount] = t->recv[i];
+        pt->recv[pt->recvCount].range = r;
+        pt->recvCount++;
+    }
+    return pt;
+}
+
+// first index of slab for prefetch step <step> in 1st dimension
+static
+int64_t prefetchSlabStart(Laik_Data* d, int step)
+{
+    Laik_Range* sr = &(d->space->range);
+    int64_t size = sr->to.i[0] - sr->from.i[0];
+    return sr->from.i[0] + size * step / d->prefetchSteps;
+}
+
+// do prefetch steps [step1;step2[: transfer data of corresponding slabs
+static
+void prefetchSteps(Laik_Data* d, int step1, int step2)
+{
+    int steps = d->prefetchSteps;
+    int64_t from = prefetchSlabStart(d, step1);
+    int64_t to = prefetchSlabStart(d, step2);
+    Laik_Transition* t = prefetchTransition(d->prefetchTransition, from, to);
+
+    laik_log(1, "prefetch for data '%s': steps %d-%d of %d (index %lld - %lld), %d sends, %d recvs",
+             d->name, step1, step2 - 1, steps, (long long) from, (long long) to - 1,
+             t->sendCount, t->recvCount);
+
+    if (t->sendCount + t->recvCount > 0) {
+        Laik_ActionSeq* as = createTransASeq(d, t, d->activeMappings,
+                                             d->prefetchMappings);
+        const Laik_Backend* backend = d->space->inst->backend;
+        if (backend->prepare)
+            (backend->prepare)(as);
+        else
+            laik_aseq_calc_stats(as);
+        (backend->exec)(as);
+        if (d->stat)
+            laik_switchstat_addASeq(d->stat, as);
+        laik_aseq_free(as);
+    }
+
+    free(t->send);
+    free(t->recv);
+    free(t);
+}
+
+// stop a prefetch and free its resources
+static
+void prefetchDiscard(Laik_Data* d)
+{
+    if (d->prefetchPartitioning == 0) return;
+
+    laik_log(1, "prefetch for data '%s': discarded after %d of %d steps",
+             d->name, d->prefetchStepsDone, d->prefetchSteps);
+    if (d->prefetchMappings)
+        freeMappingList(d->prefetchMappings, d->stat);
+    laik_free_transition(d->prefetchTransition);
+    free(d->prefetchDirty);
+    d->prefetchPartitioning = 0;
+    d->prefetchMappings = 0;
+    d->prefetchTransition = 0;
+    d->prefetchDirty = 0;
+}
+
+void laik_data_prefetch_start(Laik_Data* d, Laik_Partitioning* toP, int steps)
+{
+    checkNotCompound(d, "laik_data_prefetch_start");
+    assert(d->activePartitioning != 0);
+    assert(steps > 0);
+    // mappings for prefetched data are separate from active ones
+    assert((d->activeReservation == 0) && (d->map0_base == 0));
+
+    prefetchDiscard(d);
+
+    Laik_Instance* inst = d->space->inst;
+    laik_profile_laik_start(inst);
+
+    // same as in laik_switchto_partitioning: transition in common group
+    Laik_Partitioning* fromP = d->activePartitioning;
+    Laik_Group *toGroup = toP->group, *fromGroup = fromP->group;
+    Laik_Group* commonGroup = 0;
+    if (fromGroup != toGroup) {
+        commonGroup = laik_new_union_group(fromGroup, toGroup);
+        laik_partitioning_transranges(fromP, toP);
+        laik_partitioning_transranges(toP, fromP);
+        laik_partitioning_migrate(fromP, commonGroup);
+        laik_partitioning_migrate(toP, commonGroup);
+    }
+    Laik_Transition* t = do_calc_transition(d->space, fromP, toP,
+                                            LAIK_DF_Preserve, LAIK_RO_None);
+    if (commonGroup) {
+        laik_partitioning_migrate(fromP, fromGroup);
+        laik_partitioning_migrate(toP, toGroup);
+    }
+    assert(t && (t->redCount == 0));
+
+    d->prefetchPartitioning = toP;
+    d->prefetchTransition = t;
+    d->prefetchSteps = steps;
+    d->prefetchStepsDone = 0;
+    d->prefetchDirty = calloc(steps, sizeof(bool));
+    if (!d->prefetchDirty) {
+        laik_panic("Out of memory allocating prefetch state");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    d->prefetchMappings = prepareMaps(d, toP);
+    if (d->prefetchMappings)
+        allocateMappings(d->prefetchMappings, d->stat);
+
+    laik_log(1, "prefetch for data '%s' to partitioning '%s' in %d steps: %d sends, %d recvs",
+             d->name, toP->name, steps, t->sendCount, t->recvCount);
+
+    laik_profile_laik_stop(inst);
+}
+
+bool laik_data_prefetch_step(Laik_Data* d)
+{
+    if (d->prefetchPartitioning == 0) return false;
+    if (d->prefetchStepsDone == d->prefetchSteps) return false;
+
+    Laik_Instance* inst = d->space->inst;
+    laik_profile_laik_start(inst);
+    prefetchSteps(d, d->prefetchStepsDone, d->prefetchStepsDone + 1);
+    d->prefetchStepsDone++;
+    laik_profile_laik_stop(inst);
+
+    return (d->prefetchStepsDone < d->prefetchSteps);
+}
+
+void laik_data_prefetch_invalidate(Laik_Data* d, const Laik_Range* r)
+{
+    if (d->prefetchPartitioning == 0) return;
+    assert(r->space == d->space);
+
+    // only slabs already sent need to be sent again
+    for(int step = 0; step < d->prefetchStepsDone; step++) {
+        if ((r->from.i[0] < prefetchSlabStart(d, step + 1)) &&
+            (r->to.i[0] > prefetchSlabStart(d, step)))
+            d->prefetchDirty[step] = true;
+    }
+}
+
+// collective among processes of transition <t>: mark slabs changed in
+// any process as dirty everywhere, return number of dirty slabs
+static
+int prefetchSyncDirty(Laik_Data* d, Laik_Transition* t)
+{
+    int steps = d->prefetchSteps;
+    Laik_Space* s = laik_new_space_1d(d->space->inst, steps);
+    Laik_Data* flags = laik_new_data(s, laik_Int64);
+    Laik_Partitioning* all = laik_new_partitioning(laik_All, t->group, s, 0);
+    laik_switchto_partitioning(flags, all, LAIK_DF_None, LAIK_RO_None);
+    int64_t* v;
+    laik_get_map_1d(flags, 0, (void**) &v, 0);
+    for(int step = 0; step < steps; step++)
+        v[step] = d->prefetchDirty[step] ? 1 : 0;
+    laik_switchto_partitioning(flags, all, LAIK_DF_Preserve, LAIK_RO_Max);
+    laik_get_map_1d(flags, 0, (void**) &v, 0);
+    int count = 0;
+    for(int step = 0; step < steps; step++) {
+        d->prefetchDirty[step] = (v[step] != 0);
+        if (d->prefetchDirty[step]) count++;
+    }
+
+    laik_free(flags);
+    laik_free_partitioning(all);
+    laik_free_space(s);
+    return count;
+}
+
+// finish prefetch on switch: send again slabs changed after being sent,
+// transfer what is left, copy locally kept data
+static
+void prefetchFinish(Laik_Data* d)
+{
+    Laik_Transition* t = d->prefetchTransition;
+
+    if (prefetchSyncDirty(d, t) > 0) {
+        // consecutive dirty slabs are sent together
+        int step = 0;
+        while(step < d->prefetchStepsDone) {
+            if (!d->prefetchDirty[step]) { step++; continue; }
+            int first = step;
+            while((step < d->prefetchStepsDone) && d->prefetchDirty[step])
+                step++;
+            laik_log(1, "prefetch for data '%s': sending changed steps %d-%d again",
+                     d->name, first, step - 1);
+            prefetchSteps(d, first, step);
+        }
+    }
+    if (d->prefetchStepsDone < d->prefetchSteps)
+        prefetchSteps(d, d->prefetchStepsDone, d->prefetchSteps);
+
+    if (d->stat)
+        d->stat->switches++;
+    if (t->localCount > 0)
+        copyMaps(t, d->prefetchMappings, d->activeMappings, d->stat);
+    if (t->initCount > 0)
+        initMaps(t, d->prefetchMappings, d->activeMappings, d->stat);
+    if (d->activeMappings && (d->activeMappings->res == 0))
+        freeMappingList(d->activeMappings, d->stat);
+
+    laik_log(1, "prefetch for data '%s': switched to partitioning '%s'",
+             d->name, d->prefetchPartitioning->name);
+
+    d->activePartitioning = d->prefetchPartitioning;
+    d->activeMappings = d->prefetchMappings;
+    laik_free_transition(t);
+    free(d->prefetchDirty);
+    d->prefetchPartitioning = 0;
+    d->prefetchMappings = 0;
+    d->prefetchTransition = 0;
+    d->prefetchDirty = 0;
 }
 
 
@@ -1295,15 +1781,60 @@ void laik_switchto_partitioning(Laik_Data* d,
                                 Laik_Partitioning* toP, Laik_DataFlow flow,
                                 Laik_ReductionOperation redOp)
 {
+    if (d->field) {
+        // compound: only selected fields switch, others stay as they are
+        for(int f = 0; f < d->type->fieldCount; f++)
+            if (fieldSelected(d, f))
+                laik_switchto_partitioning(d->field[f], toP, flow, redOp);
+        updateCompoundPartitioning(d);
+        return;
+    }
+
+    if (d->prefetchPartitioning) {
+        // prefetch started for this switch?
+        if ((toP == d->prefetchPartitioning) && (flow == LAIK_DF_Preserve) &&
+            !laik_is_reduction(redOp)) {
+            Laik_Instance* inst = d->space->inst;
+            laik_profile_laik_start(inst);
+            prefetchFinish(d);
+            laik_profile_laik_stop(inst);
+            return;
+        }
+        prefetchDiscard(d);
+    }
+
+    // staying in same partitioning without reduction is a no-op, as long
+    // as mappings do not have to move into an active reservation
+    if (toP && (toP == d->activePartitioning) && (flow != LAIK_DF_Init) &&
+        !laik_is_reduction(redOp) &&
+        ((d->activeMappings == 0) ||
+         (d->activeMappings->res == d->activeReservation))) {
+        if (d->stat) {
+            d->stat->switches++;
+            d->stat->switches_noactions++;
+        }
+        laik_log(1, "switch of data '%s' to active partitioning '%s': no-op",
+                 d->name, toP->name);
+        return;
+    }
+
     // calculate actions to be done for switching
 
     Laik_Group *toGroup = 0, *fromGroup = 0, *commonGroup = 0;
+    Laik_Instance* inst = d->space->inst;
+    laik_profile_laik_start(inst);
     if (d->activePartitioning) {
         if (toP && (d->activePartitioning->group != toP->group)) {
             // to a partitioning based on another group? migrate to common group first
             toGroup = toP->group;
             fromGroup = d->activePartitioning->group;
             commonGroup = laik_new_union_group(fromGroup, toGroup);
+            if (flow == LAIK_DF_Preserve) {
+                // partitioners must run for original groups: calculate
+                // ranges required for the transition before migration
+                laik_partitioning_transranges(d->activePartitioning, toP);
+                laik_partitioning_transranges(toP, d->activePartitioning);
+            }
             laik_partitioning_migrate(d->activePartitioning, commonGroup);
             laik_partitioning_migrate(toP, commonGroup);
         }
@@ -1311,6 +1842,7 @@ void laik_switchto_partitioning(Laik_Data* d,
     else {
         if (!toP) {
             // nothing to switch from/to
+            laik_profile_laik_stop(inst);
             return;
         }
     }
@@ -1331,6 +1863,8 @@ void laik_switchto_partitioning(Laik_Data* d,
     // set new mapping/partitioning active
     d->activePartitioning = toP;
     d->activeMappings = toList;
+
+    laik_profile_laik_stop(inst);
 }
 
 
@@ -1338,6 +1872,13 @@ void laik_switchto_partitioning(Laik_Data* d,
 void laik_switchto_flow(Laik_Data* d,
                         Laik_DataFlow flow, Laik_ReductionOperation redOp)
 {
+    if (d->field) {
+        // compound: selected fields keep their own partitioning
+        for(int f = 0; f < d->type->fieldCount; f++)
+            if (fieldSelected(d, f))
+                laik_switchto_flow(d->field[f], flow, redOp);
+        return;
+    }
     if (!d->activePartitioning) {
         // makes no sense without partitioning
         laik_panic("laik_switch_flow without active partitioning!");
@@ -1379,6 +1920,13 @@ void laik_set_initial_partitioning(Laik_Data* d, Laik_Partitioning* p)
     laik_log(1, "set initial partitioning of data '%s' to '%s'",
              d->name, p->name);
 
+    if (d->field) {
+        for(int f = 0; f < d->type->fieldCount; f++)
+            laik_set_initial_partitioning(d->field[f], p);
+        d->activePartitioning = p;
+        return;
+    }
+
     d->activeMappings = prepareMaps(d, p);
     d->activePartitioning = p;
 }
@@ -1439,6 +1987,7 @@ void checkOwnParticipation(Laik_Data* d)
 // provide memory resources for a mapping of own partition
 void laik_data_provide_memory(Laik_Data* d, void* start, uint64_t size)
 {
+    checkNotCompound(d, "laik_data_provide_memory");
     d->map0_base = start;
     d->map0_size = size;
 }
@@ -1446,6 +1995,7 @@ void laik_data_provide_memory(Laik_Data* d, void* start, uint64_t size)
 // get mapping of own partition into local memory for direct access
 Laik_Mapping* laik_get_map(Laik_Data* d, int n)
 {
+    checkNotCompound(d, "laik_get_map");
     checkOwnParticipation(d);
 
     if ((n<0) || (n >= d->activeMappings->count))
@@ -1613,11 +2163,47 @@ int laik_map_get_mapNo(const Laik_Mapping* map)
     return map->mapNo;
 }
 
+const Laik_Range* laik_map_get_range(const Laik_Mapping* map)
+{
+    assert(map);
+
+    return &(map->requiredRange);
+}
+
+Laik_Layout* laik_map_get_layout(const Laik_Mapping* map)
+{
+    assert(map);
+
+    return map->layout;
+}
+
+bool laik_map_get_tile(Laik_Mapping* map, Laik_Index* idx, Laik_Tile* t)
+{
+    assert(map && map->layout);
+
+    Laik_Layout* l = map->layout;
+    if (l->tile == 0) return false;
+
+    int64_t off;
+    if (!(l->tile)(l, map->layoutSection, idx, &(t->range), &off, t->stride))
+        return false;
+
+    t->base = map->start + off * map->data->elemsize;
+    return true;
+}
+
 
 void laik_free(Laik_Data* d)
 {
     // TODO: free space, partitionings
 
+    prefetchDiscard(d);
+    if (d->field) {
+        for(int f = 0; f < d->type->fieldCount; f++)
+            laik_free(d->field[f]);
+        free(d->field);
+    }
+
     free(d);
 }
 
@@ -1657,6 +2243,7 @@ Laik_Allocator* laik_new_allocator(Laik_malloc_t malloc_func,
     a->free = free_func;
     a->realloc = realloc_func;
     a->unmap = 0;   // no notification
+    a->map = 0;
 
     return a;
 }
@@ -1666,6 +2253,9 @@ void laik_set_allocator(Laik_Data* d, Laik_Allocator* a)
     // TODO: decrement reference count for existing allocator
 
     d->allocator = a;
+    if (d->field)
+        for(int f = 0; f < d->type->fieldCount; f++)
+            d->field[f]->allocator = a;
 }
 
 Laik_Allocator* laik_get_allocator(Laik_Data* d)
@@ -237,10 +237,9 @@ void laik_log_RangeList(Laik_RangeList* list)
                     list->count, list->tid_count);
     laik_log_Space(list->space);
     if (list->count > 0) {
-        assert(list->trange); // only show generic ranges
         laik_log_append(": (tid:range-tag/mapNo)\n    ");
         for(unsigned int i = 0; i < list->count; i++) {
-            Laik_TaskRange_Gen* trange = &(list->trange[i]);
+            Laik_TaskRange_Gen* trange = laik_rangelist_trange(list, i);
             if (i>0)
                 laik_log_append(", ");
             laik_log_append("%d:", trange->task);
@@ -257,13 +256,13 @@ void laik_log_RangeFilter(Laik_RangeFilter* sf)
     else if (sf->filter_tid >=0)
         laik_log_append("filter for task %d", sf->filter_tid);
     else if (sf->pfilter1) {
-        laik_log_append("intersection filter with %d [%lld;%lld[",
-                        sf->pfilter1->len,
-                        (long long) sf->pfilter1->from, (long long) sf->pfilter1->to);
-        if (sf->pfilter2)
-            laik_log_append(" and %d [%lld;%lld[", sf->pfilter2->len,
-                        (long long) sf->pfilter2->from, (long long) sf->pfilter2->to);
-        laik_log_append(" ranges");
+        laik_log_append("intersection filter with %d ranges in ",
+                        sf->pfilter1->len);
+        laik_log_Range(&(sf->pfilter1->bbox));
+        if (sf->pfilter2) {
+            laik_log_append(" and %d in ", sf->pfilter2->len);
+            laik_log_Range(&(sf->pfilter2->bbox));
+        }
     }
 }
 
@@ -362,6 +361,11 @@ void laik_log_SwitchStat(Laik_SwitchStat* ss)
         laik_log_PrettyInt(ss->byteRecvCount / msgRecvCount);
         laik_log_append("B/msg)\n");
     }
+    if (ss->migratedBytes > 0) {
+        laik_log_append("    migrated: ");
+        laik_log_PrettyInt(ss->migratedBytes);
+        laik_log_append("B\n");
+    }
     if (ss->msgReduceCount > 0) {
         laik_log_append("    %s reduce: %dx, ", out++ ? "   ":"msg", ss->msgReduceCount);
         laik_log_PrettyInt(ss->elemReduceCount);
@@ -765,6 +769,9 @@ void laik_log_Checksum(char* buf, int count, Laik_Type* t)
 // write action sequence at level 1 if <changed> is true, prepend with title
 void laik_log_ActionSeqIfChanged(bool changed, Laik_ActionSeq* as, char* title)
 {
+    // called after each transformation step in backend prepare functions
+    laik_trace_step(title);
+
     if (laik_log_begin(1)) {
         laik_log_append(title);
         if (changed) {
@@ -774,5 +781,7 @@ void laik_log_ActionSeqIfChanged(bool changed, Laik_ActionSeq* as, char* title)
         else
             laik_log_append(": nothing changed\n");
         laik_log_flush(0);
+        // do not account logging to next step
+        laik_trace_mark();
     }
 }
@@ -0,0 +1,429 @@
+/*
+ * This file is part of the LAIK library.
+ * Copyright (c) 2017-2019 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+ *
+ * LAIK is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3 or later.
+ *
+ * LAIK is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "laik-internal.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+//--------------------------------------------------------
+// Laik_IndexSet: compressed set of 1d indexes
+//
+// Indexes are grouped into chunks of 2^16 consecutive indexes, with
+// chunks sorted by their key (index >> 16). A chunk stores the lower
+// 16 bits of its indexes either
+//  - as array (sparse): unsorted, may contain duplicates while adding.
+//    When full, it gets sorted and duplicates removed, and converted into
+//    a bitmap if it has more than ISET_ARRAYMAX distinct indexes
+//  - as bitmap (dense): one bit per index, 8 KB
+// As in roaring bitmaps, a bitmap only is used where it is smaller than
+// an array of its distinct indexes. Thus a chunk needs at most 2 bytes per
+// distinct index, plus 2 bytes per duplicate added since the last cleanup
+// (arrays buffer up to 2 * ISET_ARRAYMAX entries, i.e. 16 KB).
+// There is no sorting of the whole set.
+
+#define ISET_CHUNKBITS 16
+#define ISET_CHUNKSIZE (1 << ISET_CHUNKBITS)
+#define ISET_ARRAYMAX  4096
+#define ISET_WORDS     (ISET_CHUNKSIZE / 64)
+
+typedef struct {
+    int64_t key;
+    unsigned int count, capacity; // array entries used/allocated
+    uint16_t* array;  // sparse: offsets within chunk
+    uint64_t* bitmap; // dense: used instead of array if set
+} ISetChunk;
+
+struct _Laik_IndexSet {
+    unsigned int count, capacity; // chunks used/allocated
+    unsigned int last;            // chunk used in last add, for locality
+    ISetChunk* chunk;
+};
+
+Laik_IndexSet* laik_indexset_new(void)
+{
+    Laik_IndexSet* s = malloc(sizeof(Laik_IndexSet));
+    if (!s) {
+        laik_panic("Out of memory allocating Laik_IndexSet object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    s->count = 0;
+    s->capacity = 0;
+    s->last = 0;
+    s->chunk = 0;
+    return s;
+}
+
+void laik_indexset_free(Laik_IndexSet* s)
+{
+    for(unsigned int i = 0; i < s->count; i++) {
+        free(s->chunk[i].array);
+        free(s->chunk[i].bitmap);
+    }
+    free(s->chunk);
+    free(s);
+}
+
+// index of first chunk with key >= <key>
+static unsigned int findChunk(Laik_IndexSet* s, int64_t key)
+{
+    unsigned int lo = 0, hi = s->count;
+    while(lo < hi) {
+        unsigned int mid = (lo + hi) / 2;
+        if (s->chunk[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// find chunk with <key>, insert an empty one if not existing
+static ISetChunk* getChunk(Laik_IndexSet* s, int64_t key)
+{
+    if ((s->last < s->count) && (s->chunk[s->last].key == key))
+        return &(s->chunk[s->last]);
+
+    unsigned int lo = findChunk(s, key);
+    s->last = lo;
+    if ((lo < s->count) && (s->chunk[lo].key == key))
+        return &(s->chunk[lo]);
+
+    if (s->count == s->capacity) {
+        s->capacity = (s->capacity + 2) * 2;
+        s->chunk = realloc(s->chunk, s->capacity * sizeof(ISetChunk));
+        if (!s->chunk) {
+            laik_panic("Out of memory allocating memory for Laik_IndexSet");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+    }
+    memmove(&(s->chunk[lo + 1]), &(s->chunk[lo]),
+            (s->count - lo) * sizeof(ISetChunk));
+    s->count++;
+
+    ISetChunk* c = &(s->chunk[lo]);
+    c->key = key;
+    c->count = 0;
+    c->capacity = 0;
+    c->array = 0;
+    c->bitmap = 0;
+    return c;
+}
+
+static int u16_cmp(const void *p1, const void *p2)
+{
+    return (int) *((const uint16_t*) p1) - (int) *((const uint16_t*) p2);
+}
+
+// sort array of sparse chunk and remove duplicates
+static void normalizeChunk(ISetChunk* c)
+{
+    if (c->bitmap || (c->count < 2)) return;
+
+    qsort(c->array, c->count, sizeof(uint16_t), u16_cmp);
+    unsigned int dst = 0;
+    for(unsigned int src = 1; src < c->count; src++)
+        if (c->array[src] != c->array[dst])
+            c->array[++dst] = c->array[src];
+    c->count = dst + 1;
+}
+
+static void toBitmap(ISetChunk* c)
+{
+    c->bitmap = calloc(ISET_WORDS, sizeof(uint64_t));
+    if (!c->bitmap) {
+        laik_panic("Out of memory allocating memory for Laik_IndexSet");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    for(unsigned int i = 0; i < c->count; i++)
+        c->bitmap[c->array[i] >> 6] |= 1ull << (c->array[i] & 63);
+
+    free(c->array);
+    c->array = 0;
+    c->count = 0;
+    c->capacity = 0;
+}
+
+void laik_indexset_add(Laik_IndexSet* s, int64_t idx)
+{
+    ISetChunk* c = getChunk(s, idx >> ISET_CHUNKBITS);
+    uint16_t off = (uint16_t) (idx & (ISET_CHUNKSIZE - 1));
+
+    if (c->bitmap) {
+        c->bitmap[off >> 6] |= 1ull << (off & 63);
+        return;
+    }
+
+    if (c->count == c->capacity) {
+        // full array with room for duplicates: remove them first. If it
+        // is not converted, at least ISET_ARRAYMAX entries are free again
+        if (c->capacity == 2 * ISET_ARRAYMAX) {
+            normalizeChunk(c);
+            if (c->count > ISET_ARRAYMAX) {
+                toBitmap(c);
+                c->bitmap[off >> 6] |= 1ull << (off & 63);
+                return;
+            }
+        }
+        else {
+            c->capacity = (c->capacity == 0) ? 16 : 2 * c->capacity;
+            c->array = realloc(c->array, c->capacity * sizeof(uint16_t));
+            if (!c->array) {
+                laik_panic("Out of memory allocating memory for Laik_IndexSet");
+                exit(1); // not actually needed, laik_panic never returns
+            }
+        }
+    }
+    c->array[c->count++] = off;
+}
+
+// state for merging runs across chunk borders
+typedef struct {
+    laik_indexset_run_t f;
+    void* ctx;
+    bool valid;
+    int64_t from, to;
+    unsigned int runs;
+} RunState;
+
+static void addRun(RunState* rs, int64_t from, int64_t to)
+{
+    if (rs->valid && (from == rs->to)) {
+        rs->to = to;
+        return;
+    }
+    if (rs->valid) {
+        if (rs->f) (rs->f)(rs->ctx, rs->from, rs->to);
+        rs->runs++;
+    }
+    rs->valid = true;
+    rs->from = from;
+    rs->to = to;
+}
+
+// add runs of set bits in <bits>, bit 0 being index <from>
+static void addBitRuns(RunState* rs, int64_t from, uint64_t bits)
+{
+    while(bits) {
+        // run of set bits starting at lowest set bit
+        int b = __builtin_ctzll(bits);
+        uint64_t rest = ~(bits >> b);
+        int len = rest ? __builtin_ctzll(rest) : 64 - b;
+        addRun(rs, from + b, from + b + len);
+        if (len == 64) break;
+        bits &= ~(((1ull << len) - 1) << b);
+    }
+}
+
+// bits of word <w> within chunk offsets [lo;hi[
+static uint64_t maskWord(unsigned int w, unsigned int lo, unsigned int hi)
+{
+    uint64_t mask = ~0ull;
+    if (w == lo >> 6) mask &= ~0ull << (lo & 63);
+    if ((w == (hi - 1) >> 6) && (hi & 63)) mask &= (1ull << (hi & 63)) - 1;
+    return mask;
+}
+
+// first array entry >= <lo> in normalized array of chunk <c>
+static unsigned int lowerBound(ISetChunk* c, unsigned int lo)
+{
+    unsigned int l = 0, h = c->count;
+    while(l < h) {
+        unsigned int mid = (l + h) / 2;
+        if (c->array[mid] < lo) l = mid + 1;
+        else h = mid;
+    }
+    return l;
+}
+
+// add runs of chunk <c> within chunk offsets [lo;hi[, lo < hi
+static void addChunkRuns(RunState* rs, ISetChunk* c, unsigned int lo, unsigned int hi)
+{
+    int64_t base = c->key << ISET_CHUNKBITS;
+
+    if (c->bitmap) {
+        for(unsigned int w = lo >> 6; w <= (hi - 1) >> 6; w++)
+            addBitRuns(rs, base + 64 * w, c->bitmap[w] & maskWord(w, lo, hi));
+        return;
+    }
+
+    normalizeChunk(c);
+    for(unsigned int j = lowerBound(c, lo); (j < c->count) && (c->array[j] < hi); j++)
+        addRun(rs, base + c->array[j], base + c->array[j] + 1);
+}
+
+// add runs of indexes in both chunks <c1> and <c2> (same key)
+static void addChunkIntersectRuns(RunState* rs, ISetChunk* c1, ISetChunk* c2)
+{
+    int64_t base = c1->key << ISET_CHUNKBITS;
+
+    if (c1->bitmap && c2->bitmap) {
+        for(int w = 0; w < ISET_WORDS; w++)
+            addBitRuns(rs, base + 64 * w, c1->bitmap[w] & c2->bitmap[w]);
+        return;
+    }
+
+    if (c1->bitmap || c2->bitmap) {
+        // check each array entry in bitmap
+        ISetChunk* a = c1->bitmap ? c2 : c1;
+        uint64_t* bitmap = c1->bitmap ? c1->bitmap : c2->bitmap;
+        normalizeChunk(a);
+        for(unsigned int j = 0; j < a->count; j++) {
+            uint16_t off = a->array[j];
+            if (bitmap[off >> 6] & (1ull << (off & 63)))
+                addRun(rs, base + off, base + off + 1);
+        }
+        return;
+    }
+
+    // merge sorted arrays
+    normalizeChunk(c1);
+    normalizeChunk(c2);
+    unsigned int j1 = 0, j2 = 0;
+    while((j1 < c1->count) && (j2 < c2->count)) {
+        if (c1->array[j1] < c2->array[j2]) j1++;
+        else if (c1->array[j1] > c2->array[j2]) j2++;
+        else {
+            addRun(rs, base + c1->array[j1], base + c1->array[j1] + 1);
+            j1++;
+            j2++;
+        }
+    }
+}
+
+static void initRunState(RunState* rs, laik_indexset_run_t f, void* ctx)
+{
+    rs->f = f;
+    rs->ctx = ctx;
+    rs->valid = false;
+    rs->from = rs->to = 0;
+    rs->runs = 0;
+}
+
+static unsigned int finishRunState(RunState* rs)
+{
+    if (rs->valid) {
+        if (rs->f) (rs->f)(rs->ctx, rs->from, rs->to);
+        rs->runs++;
+    }
+    return rs->runs;
+}
+
+unsigned int laik_indexset_runs(Laik_IndexSet* s,
+                                laik_indexset_run_t f, void* ctx)
+{
+    RunState rs;
+    initRunState(&rs, f, ctx);
+    for(unsigned int i = 0; i < s->count; i++)
+        addChunkRuns(&rs, &(s->chunk[i]), 0, ISET_CHUNKSIZE);
+    return finishRunState(&rs);
+}
+
+unsigned int laik_indexset_runs_in(Laik_IndexSet* s, int64_t from, int64_t to,
+                                   laik_indexset_run_t f, void* ctx)
+{
+    RunState rs;
+    initRunState(&rs, f, ctx);
+    if (from >= to) return 0;
+
+    for(unsigned int i = findChunk(s, from >> ISET_CHUNKBITS); i < s->count; i++) {
+        ISetChunk* c = &(s->chunk[i]);
+        int64_t base = c->key << ISET_CHUNKBITS;
+        if (base >= to) break;
+        unsigned int lo = (from > base) ? (unsigned int) (from - base) : 0;
+        unsigned int hi = (to - base < ISET_CHUNKSIZE) ?
+                          (unsigned int) (to - base) : ISET_CHUNKSIZE;
+        addChunkRuns(&rs, c, lo, hi);
+    }
+    return finishRunState(&rs);
+}
+
+unsigned int laik_indexset_intersect(Laik_IndexSet* s1, Laik_IndexSet* s2,
+                                     laik_indexset_run_t f, void* ctx)
+{
+    RunState rs;
+    initRunState(&rs, f, ctx);
+
+    // chunks of both sets are sorted by key
+    unsigned int i1 = 0, i2 = 0;
+    while((i1 < s1->count) && (i2 < s2->count)) {
+        ISetChunk* c1 = &(s1->chunk[i1]);
+        ISetChunk* c2 = &(s2->chunk[i2]);
+        if (c1->key < c2->key) i1++;
+        else if (c1->key > c2->key) i2++;
+        else {
+            addChunkIntersectRuns(&rs, c1, c2);
+            i1++;
+            i2++;
+        }
+    }
+    return finishRunState(&rs);
+}
+
+bool laik_indexset_intersects(Laik_IndexSet* s, int64_t from, int64_t to)
+{
+    if (from >= to) return false;
+
+    for(unsigned int i = findChunk(s, from >> ISET_CHUNKBITS); i < s->count; i++) {
+        ISetChunk* c = &(s->chunk[i]);
+        int64_t base = c->key << ISET_CHUNKBITS;
+        if (base >= to) break;
+        unsigned int lo = (from > base) ? (unsigned int) (from - base) : 0;
+        unsigned int hi = (to - base < ISET_CHUNKSIZE) ?
+                          (unsigned int) (to - base) : ISET_CHUNKSIZE;
+        if (c->bitmap) {
+            for(unsigned int w = lo >> 6; w <= (hi - 1) >> 6; w++)
+                if (c->bitmap[w] & maskWord(w, lo, hi)) return true;
+            continue;
+        }
+        normalizeChunk(c);
+        unsigned int j = lowerBound(c, lo);
+        if ((j < c->count) && (c->array[j] < hi)) return true;
+    }
+    return false;
+}
+
+bool laik_indexset_bounds(Laik_IndexSet* s, int64_t* from, int64_t* to)
+{
+    // chunks are never empty: they only get created when adding an index
+    if (s->count == 0) return false;
+
+    ISetChunk* c = &(s->chunk[0]);
+    int64_t base = c->key << ISET_CHUNKBITS;
+    if (c->bitmap) {
+        int w = 0;
+        while(c->bitmap[w] == 0) w++;
+        *from = base + 64 * w + __builtin_ctzll(c->bitmap[w]);
+    }
+    else {
+        normalizeChunk(c);
+        *from = base + c->array[0];
+    }
+
+    c = &(s->chunk[s->count - 1]);
+    base = c->key << ISET_CHUNKBITS;
+    if (c->bitmap) {
+        int w = ISET_WORDS - 1;
+        while(c->bitmap[w] == 0) w--;
+        *to = base + 64 * w + 64 - __builtin_clzll(c->bitmap[w]);
+    }
+    else {
+        normalizeChunk(c);
+        *to = base + c->array[c->count - 1] + 1;
+    }
+    return true;
+}
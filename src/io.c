@@ -0,0 +1,383 @@
+/*
+ * This file is part of the LAIK library.
+ * Copyright (c) 2017-2019 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+ *
+ * LAIK is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3 or later.
+ *
+ * LAIK is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE // for O_DIRECT
+
+#include <laik-internal.h>
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+
+//--------------------------------------------------------
+// Parallel file I/O for containers
+//
+// A file consists of a header describing space and type, followed by
+// the values of all indexes of the space in lexicographical order
+// (1st dimension varying fastest). Every process writes/reads its own
+// ranges directly at their offsets in the file, without any data
+// exchange. Rows of ranges are collected into vectored I/O calls,
+// merging rows contiguous in file and memory.
+//
+// With LAIK_IO_DIRECT=1, I/O calls with file offset, memory addresses
+// and lengths aligned to LAIK_IO_ALIGN bytes bypass the page cache.
+
+#define LAIK_IO_MAGIC     "LAIKDATA"
+#define LAIK_IO_VERSION   1
+#define LAIK_IO_ALIGN     4096
+// header padded to alignment, so values start aligned
+#define LAIK_IO_HEADERSIZE LAIK_IO_ALIGN
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t dims;
+    int64_t from[3], to[3]; // space range
+    uint64_t elemsize;
+    char typeName[64];
+} IOHeader;
+
+// batch of consecutive file regions for one vectored I/O call
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+#define IOBATCH_MAX ((IOV_MAX < 1024) ? IOV_MAX : 1024)
+
+typedef struct {
+    int fd, fdDirect; // fdDirect: -1 if O_DIRECT not used
+    bool write;
+    bool ok;
+    const char* path;
+    off_t start;      // file offset of batch
+    size_t len;       // bytes in batch
+    int count;
+    struct iovec iov[IOBATCH_MAX];
+} IOBatch;
+
+static bool isAligned(uint64_t v) { return (v % LAIK_IO_ALIGN) == 0; }
+
+static void ioFlush(IOBatch* b)
+{
+    if ((b->count == 0) || !b->ok) {
+        b->count = 0;
+        return;
+    }
+
+    int fd = b->fd;
+    if ((b->fdDirect >= 0) && isAligned(b->start)) {
+        bool aligned = true;
+        for(int i = 0; i < b->count; i++)
+            if (!isAligned((uint64_t) b->iov[i].iov_base) ||
+                !isAligned(b->iov[i].iov_len))
+                aligned = false;
+        if (aligned) fd = b->fdDirect;
+    }
+
+    // loop for partial transfers
+    struct iovec* iov = b->iov;
+    int count = b->count;
+    off_t off = b->start;
+    size_t left = b->len;
+    while(left > 0) {
+        ssize_t res;
+        if (b->write)
+            res = pwritev(fd, iov, count, off);
+        else
+            res = preadv(fd, iov, count, off);
+        if (res <= 0) {
+            if ((res < 0) && (errno == EINTR)) continue;
+            laik_log(LAIK_LL_Warning, "%s '%s' at offset %lld: %s",
+                     b->write ? "writing" : "reading", b->path,
+                     (long long) off,
+                     (res < 0) ? strerror(errno) : "unexpected end of file");
+            b->ok = false;
+            break;
+        }
+        off += res;
+        left -= (size_t) res;
+        while((count > 0) && ((size_t) res >= iov->iov_len)) {
+            res -= (ssize_t) iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*) iov->iov_base + res;
+            iov->iov_len -= (size_t) res;
+        }
+    }
+    b->count = 0;
+}
+
+// add I/O of <len> bytes at <addr> to/from file offset <off>
+static void ioAdd(IOBatch* b, char* addr, size_t len, off_t off)
+{
+    if (b->count > 0) {
+        if (off == b->start + (off_t) b->len) {
+            struct iovec* last = &(b->iov[b->count - 1]);
+            if ((char*) last->iov_base + last->iov_len == addr) {
+                last->iov_len += len;
+                b->len += len;
+                return;
+            }
+            if (b->count < IOBATCH_MAX) {
+                b->iov[b->count].iov_base = addr;
+                b->iov[b->count].iov_len = len;
+                b->count++;
+                b->len += len;
+                return;
+            }
+        }
+        ioFlush(b);
+    }
+    b->start = off;
+    b->len = len;
+    b->iov[0].iov_base = addr;
+    b->iov[0].iov_len = len;
+    b->count = 1;
+}
+
+// file offset for global index <idx>
+static off_t fileOffset(Laik_Data* d, Laik_Index* idx)
+{
+    Laik_Range* s = &(d->space->range);
+    int dims = d->space->dims;
+    int64_t off = 0;
+    for(int i = dims - 1; i >= 0; i--)
+        off = off * (s->to.i[i] - s->from.i[i]) + (idx->i[i] - s->from.i[i]);
+    return LAIK_IO_HEADERSIZE + (off_t) off * (off_t) d->elemsize;
+}
+
+// do I/O for own ranges of active partitioning of <d>
+static void ioRanges(Laik_Data* d, IOBatch* b)
+{
+    Laik_Partitioning* p = d->activePartitioning;
+    int dims = d->space->dims;
+    uint64_t esize = d->elemsize;
+    char* row = 0; // bounce buffer for layouts without tiles
+
+    for(int n = 0; n < laik_my_rangecount(p); n++) {
+        // task range objects are reused by next laik_my_range() call
+        Laik_TaskRange* tr = laik_my_range(p, n);
+        Laik_Range r = *laik_taskrange_get_range(tr);
+        Laik_Mapping* m = laik_get_map(d, laik_taskrange_get_mapNo(tr));
+        if (laik_range_isEmpty(&r)) continue;
+
+        Laik_Index idx;
+        laik_index_init(&idx, 0, 0, 0);
+        int64_t zfrom = (dims > 2) ? r.from.i[2] : 0;
+        int64_t zto   = (dims > 2) ? r.to.i[2] : 1;
+        int64_t yfrom = (dims > 1) ? r.from.i[1] : 0;
+        int64_t yto   = (dims > 1) ? r.to.i[1] : 1;
+        for(idx.i[2] = zfrom; idx.i[2] < zto; idx.i[2]++) {
+            for(idx.i[1] = yfrom; idx.i[1] < yto; idx.i[1]++) {
+                idx.i[0] = r.from.i[0];
+                while(idx.i[0] < r.to.i[0]) {
+                    off_t off = fileOffset(d, &idx);
+                    Laik_Tile t;
+                    if (laik_map_get_tile(m, &idx, &t)) {
+                        int64_t to = r.to.i[0];
+                        if (t.range.to.i[0] < to) to = t.range.to.i[0];
+                        uint64_t o = (uint64_t) (idx.i[0] - t.range.from.i[0]);
+                        if (dims > 1)
+                            o += (uint64_t) (idx.i[1] - t.range.from.i[1]) * t.stride[1];
+                        if (dims > 2)
+                            o += (uint64_t) (idx.i[2] - t.range.from.i[2]) * t.stride[2];
+                        ioAdd(b, t.base + o * esize,
+                              (size_t) (to - idx.i[0]) * esize, off);
+                        idx.i[0] = to;
+                        continue;
+                    }
+
+                    // generic layout: element-wise copy via bounce buffer
+                    ioFlush(b);
+                    int64_t count = r.to.i[0] - idx.i[0];
+                    if (!row) row = malloc((size_t) count * esize);
+                    else row = realloc(row, (size_t) count * esize);
+                    if (!row) {
+                        laik_panic("Out of memory in container I/O");
+                        exit(1); // not actually needed, laik_panic never returns
+                    }
+                    Laik_Index i = idx;
+                    if (b->write)
+                        for(int64_t k = 0; k < count; k++, i.i[0]++)
+                            memcpy(row + k * esize, laik_get_map_addr(d, m->mapNo, &i), esize);
+                    ioAdd(b, row, (size_t) count * esize, off);
+                    ioFlush(b);
+                    i = idx;
+                    if (!b->write)
+                        for(int64_t k = 0; k < count; k++, i.i[0]++)
+                            memcpy(laik_get_map_addr(d, m->mapNo, &i), row + k * esize, esize);
+                    idx.i[0] = r.to.i[0];
+                }
+            }
+        }
+    }
+    ioFlush(b);
+    free(row);
+}
+
+// collective among processes of group <g>: true if <ok> on all
+static bool ioAllOk(Laik_Group* g, Laik_Space* s, bool ok)
+{
+    Laik_Instance* inst = s->inst;
+    Laik_Space* one = laik_new_space_1d(inst, 1);
+    Laik_Data* flag = laik_new_data(one, laik_Int64);
+    Laik_Partitioning* all = laik_new_partitioning(laik_All, g, one, 0);
+    laik_switchto_partitioning(flag, all, LAIK_DF_None, LAIK_RO_None);
+    int64_t* v;
+    laik_get_map_1d(flag, 0, (void**) &v, 0);
+    *v = ok ? 0 : 1;
+    laik_switchto_partitioning(flag, all, LAIK_DF_Preserve, LAIK_RO_Sum);
+    laik_get_map_1d(flag, 0, (void**) &v, 0);
+    bool allOk = (*v == 0);
+
+    laik_free(flag);
+    laik_free_partitioning(all);
+    laik_free_space(one);
+    return allOk;
+}
+
+static void ioInit(IOBatch* b, const char* path, bool write)
+{
+    b->path = path;
+    b->write = write;
+    b->ok = true;
+    b->count = 0;
+    b->fdDirect = -1;
+    int flags = write ? (O_WRONLY | O_CREAT) : O_RDONLY;
+    b->fd = open(path, flags, 0644);
+    if (b->fd < 0) {
+        laik_log(LAIK_LL_Warning, "cannot open '%s': %s", path, strerror(errno));
+        b->ok = false;
+        return;
+    }
+    char* str = getenv("LAIK_IO_DIRECT");
+    if (str && (atoi(str) > 0)) {
+        b->fdDirect = open(path, flags | O_DIRECT, 0644);
+        if (b->fdDirect < 0)
+            laik_log(1, "O_DIRECT not supported for '%s', not used", path);
+    }
+}
+
+static void ioClose(IOBatch* b)
+{
+    if (b->fd >= 0) close(b->fd);
+    if (b->fdDirect >= 0) close(b->fdDirect);
+}
+
+bool laik_data_write(Laik_Data* d, const char* path)
+{
+    assert(d->type->kind != LAIK_TK_Compound);
+    Laik_Partitioning* p = d->activePartitioning;
+    assert(p != 0);
+
+    IOBatch* b = malloc(sizeof(IOBatch));
+    if (!b) {
+        laik_panic("Out of memory allocating IOBatch");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    ioInit(b, path, true);
+
+    // never truncate: other processes may already have written values
+    if (b->ok && (p->group->myid == 0)) {
+        char hbuf[LAIK_IO_HEADERSIZE];
+        IOHeader* h = (IOHeader*) hbuf;
+        memset(hbuf, 0, LAIK_IO_HEADERSIZE);
+        memcpy(h->magic, LAIK_IO_MAGIC, 8);
+        h->version = LAIK_IO_VERSION;
+        h->dims = (uint32_t) d->space->dims;
+        for(int i = 0; i < 3; i++) {
+            h->from[i] = (i < d->space->dims) ? d->space->range.from.i[i] : 0;
+            h->to[i] = (i < d->space->dims) ? d->space->range.to.i[i] : 1;
+        }
+        h->elemsize = (uint64_t) d->elemsize;
+        strncpy(h->typeName, d->type->name, sizeof(h->typeName) - 1);
+        ioAdd(b, hbuf, LAIK_IO_HEADERSIZE, 0);
+        ioFlush(b);
+
+        off_t size = LAIK_IO_HEADERSIZE +
+                     (off_t) (laik_space_size(d->space) * d->elemsize);
+        if (b->ok && (ftruncate(b->fd, size) < 0)) {
+            laik_log(LAIK_LL_Warning, "cannot set size of '%s': %s",
+                     path, strerror(errno));
+            b->ok = false;
+        }
+    }
+    if (b->ok)
+        ioRanges(d, b);
+    if (b->ok && (fsync(b->fd) < 0)) {
+        laik_log(LAIK_LL_Warning, "sync of '%s' failed: %s", path, strerror(errno));
+        b->ok = false;
+    }
+    ioClose(b);
+
+    bool ok = ioAllOk(p->group, d->space, b->ok);
+    free(b);
+    laik_log(1, "write of data '%s' to '%s': %s", d->name, path, ok ? "done" : "failed");
+    return ok;
+}
+
+bool laik_data_read(Laik_Data* d, const char* path)
+{
+    assert(d->type->kind != LAIK_TK_Compound);
+    Laik_Partitioning* p = d->activePartitioning;
+    assert(p != 0);
+
+    IOBatch* b = malloc(sizeof(IOBatch));
+    if (!b) {
+        laik_panic("Out of memory allocating IOBatch");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    ioInit(b, path, false);
+
+    if (b->ok) {
+        IOHeader h;
+        ssize_t res = pread(b->fd, &h, sizeof(IOHeader), 0);
+        bool match = (res == (ssize_t) sizeof(IOHeader)) &&
+                     (memcmp(h.magic, LAIK_IO_MAGIC, 8) == 0) &&
+                     (h.version == LAIK_IO_VERSION) &&
+                     (h.dims == (uint32_t) d->space->dims) &&
+                     (h.elemsize == (uint64_t) d->elemsize);
+        for(int i = 0; match && (i < d->space->dims); i++)
+            if ((h.from[i] != d->space->range.from.i[i]) ||
+                (h.to[i] != d->space->range.to.i[i]))
+                match = false;
+        if (match) {
+            h.typeName[sizeof(h.typeName) - 1] = 0;
+            match = (strcmp(h.typeName, d->type->name) == 0);
+        }
+        if (!match) {
+            laik_log(LAIK_LL_Warning, "'%s' does not match space/type of data '%s'",
+                     path, d->name);
+            b->ok = false;
+        }
+    }
+    if (b->ok)
+        ioRanges(d, b);
+    ioClose(b);
+
+    bool ok = ioAllOk(p->group, d->space, b->ok);
+    free(b);
+    laik_log(1, "read of data '%s' from '%s': %s", d->name, path, ok ? "done" : "failed");
+    return ok;
+}
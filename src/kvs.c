@@ -18,9 +18,6 @@
 
 #include <laik-internal.h>
 
-// for string.h to declare strdup
-#define __STDC_WANT_LIB_EXT2__ 1
-
 #include <assert.h>
 #include <string.h>
 
@@ -285,10 +282,147 @@ void laik_kvs_changes_apply(Laik_KVS_Changes* c, Laik_KVStore *kvs)
 }
 
 
+// binomial tree with root 0 for synchronization among <size> processes.
+// Children of <id> are <id>+2^k for all 2^k below the lowest set bit of
+// <id> (all 2^k < size for root), parent is <id> with lowest bit cleared
+int laik_kvs_tree(int id, int size, int* parent, int* child)
+{
+    assert((id >= 0) && (id < size));
+    *parent = (id == 0) ? -1 : (id & (id - 1));
+
+    int count = 0;
+    for(int m = 1; (m < size) && ((id & m) == 0); m = m << 1) {
+        if (id + m >= size) break;
+        assert(count < LAIK_KVS_TREE_MAXCHILDREN);
+        child[count++] = id + m;
+    }
+    return count;
+}
+
+
 //
 // Laik_KVStore
 //
 
+// arena allocation: blocks are chained, never moved
+#define KVS_ARENA_MINSIZE 65536
+
+static char* arena_alloc(Laik_KVStore* kvs, size_t size)
+{
+    size = (size + 7) & ~((size_t) 7); // keep 8-byte alignment
+
+    Laik_KVS_Arena* a = kvs->arena;
+    if (!a || (a->used + size > a->size)) {
+        // new block, double in size with each block
+        size_t bsize = a ? 2 * a->size : KVS_ARENA_MINSIZE;
+        if (bsize < size) bsize = size;
+        Laik_KVS_Arena* na;
+        na = (Laik_KVS_Arena*) malloc(sizeof(Laik_KVS_Arena) + bsize);
+        if (!na) {
+            laik_log(LAIK_LL_Panic, "KVS '%s': out of memory", kvs->name);
+            exit(1);
+        }
+        na->next = a;
+        na->size = bsize;
+        na->used = 0;
+        kvs->arena = a = na;
+    }
+
+    char* p = a->data + a->used;
+    a->used += size;
+    return p;
+}
+
+// slot of largest size class, larger slots are allocated with malloc
+#define KVS_SLOT_MAXSIZE ((size_t) 8 << (LAIK_KVS_SLOTCLASSES - 1))
+
+// capacity of the slot used to store <size> bytes
+static size_t slot_size(size_t size)
+{
+    if (size > KVS_SLOT_MAXSIZE) return size;
+    size_t s = 8;
+    while(s < size) s = s << 1;
+    return s;
+}
+
+// free list index for slot capacity <cap> (power of 2, at most max size)
+static int slot_class(size_t cap)
+{
+    int c = 0;
+    for(size_t s = 8; s < cap; s = s << 1) c++;
+    return c;
+}
+
+// get a slot for <size> bytes, reusing freed slots of same size class
+static char* slot_alloc(Laik_KVStore* kvs, size_t size)
+{
+    size_t cap = slot_size(size);
+    if (cap > KVS_SLOT_MAXSIZE) {
+        char* p = (char*) malloc(cap);
+        if (!p) {
+            laik_log(LAIK_LL_Panic, "KVS '%s': out of memory", kvs->name);
+            exit(1);
+        }
+        return p;
+    }
+
+    int c = slot_class(cap);
+    char* p = kvs->freeSlot[c];
+    if (p) {
+        kvs->freeSlot[c] = *((char**) p);
+        return p;
+    }
+    return arena_alloc(kvs, cap);
+}
+
+// give back slot <p> which was allocated for <size> bytes
+static void slot_free(Laik_KVStore* kvs, char* p, size_t size)
+{
+    size_t cap = slot_size(size);
+    if (cap > KVS_SLOT_MAXSIZE) {
+        free(p);
+        return;
+    }
+
+    int c = slot_class(cap);
+    *((char**) p) = kvs->freeSlot[c];
+    kvs->freeSlot[c] = p;
+}
+
+// FNV-1a hash of a key
+static unsigned int hash_key(const char* key)
+{
+    unsigned int h = 2166136261u;
+    for(; *key; key++) {
+        h ^= (unsigned char) *key;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// insert entry with index <idx> into hash index (key must not be in index)
+static void hindex_insert(Laik_KVStore* kvs, unsigned int idx)
+{
+    unsigned int mask = kvs->hsize - 1;
+    unsigned int h = hash_key(kvs->entry[idx].key) & mask;
+    while(kvs->hindex[h] != 0)
+        h = (h + 1) & mask;
+    kvs->hindex[h] = idx + 1;
+}
+
+// (re)build hash index with at least <hsize> slots
+static void hindex_rebuild(Laik_KVStore* kvs, unsigned int hsize)
+{
+    if (hsize != kvs->hsize) {
+        free(kvs->hindex);
+        kvs->hindex = (unsigned int*) malloc(hsize * sizeof(unsigned int));
+        kvs->hsize = hsize;
+    }
+    memset(kvs->hindex, 0, hsize * sizeof(unsigned int));
+    for(unsigned int i = 0; i < kvs->used; i++)
+        hindex_insert(kvs, i);
+}
+
 Laik_KVStore* laik_kvs_new(const char* name, Laik_Instance *inst)
 {
     Laik_KVStore* kvs = (Laik_KVStore*) malloc(sizeof(Laik_KVStore));
@@ -301,6 +435,15 @@ Laik_KVStore* laik_kvs_new(const char* name, Laik_Instance *inst)
     kvs->used = 0;
     kvs->sorted_upto = 0;
 
+    // keep load factor of hash index at most 1/2
+    kvs->hindex = 0;
+    kvs->hsize = 0;
+    hindex_rebuild(kvs, 2048);
+
+    kvs->arena = 0;
+    for(int c = 0; c < LAIK_KVS_SLOTCLASSES; c++)
+        kvs->freeSlot[c] = 0;
+
     kvs->created_func = 0;
     kvs->changed_func = 0;
     kvs->removed_func = 0;
@@ -308,6 +451,7 @@ Laik_KVStore* laik_kvs_new(const char* name, Laik_Instance *inst)
     laik_kvs_changes_init(&(kvs->changes));
     laik_kvs_changes_ensure_size(&(kvs->changes), 10, 1000);
     kvs->in_sync = false;
+    kvs->sync_pending = false;
 
     return kvs;
 }
@@ -316,7 +460,21 @@ void laik_kvs_free(Laik_KVStore* kvs)
 {
     assert(kvs);
 
+    // slots not in arena
+    for(unsigned int i = 0; i < kvs->used; i++) {
+        Laik_KVS_Entry* e = &(kvs->entry[i]);
+        size_t klen = strlen(e->key) + 1;
+        if (klen > KVS_SLOT_MAXSIZE) free(e->key);
+        if (e->value && (e->vcap > KVS_SLOT_MAXSIZE)) free(e->value);
+    }
+
     free(kvs->entry);
+    free(kvs->hindex);
+    while(kvs->arena) {
+        Laik_KVS_Arena* next = kvs->arena->next;
+        free(kvs->arena);
+        kvs->arena = next;
+    }
     laik_kvs_changes_free(&(kvs->changes));
     free(kvs);
 }
@@ -327,14 +485,20 @@ static void remove_entry(Laik_KVStore* kvs, Laik_KVS_Entry* e)
     if (kvs->in_sync && kvs->removed_func)
         (kvs->removed_func)(kvs, e->key);
 
-    // key of removed entry still exists but with empty data
-    free(e->value);
+    // key of removed entry still exists but with empty data until
+    // next sync (see compact_entries), value slot gets reused
+    if (e->value)
+        slot_free(kvs, e->value, e->vcap);
     e->value = 0;
     e->vlen = 0;
+    e->vcap = 0;
     e->data = 0;
 
-    if (!kvs->in_sync)
+    if (!kvs->in_sync) {
+        // no changes allowed while sync is in progress
+        assert(!kvs->sync_pending);
         laik_kvs_changes_add(&(kvs->changes), e->key, 0, 0, true, false);
+    }
 }
 
 // remove all entries
@@ -367,16 +531,19 @@ Laik_KVS_Entry* laik_kvs_set(Laik_KVStore* kvs, char* key, unsigned int size, ch
         return 0;
     }
 
+    // no changes allowed while sync is in progress
+    assert(kvs->in_sync || !kvs->sync_pending);
+
     Laik_KVS_Entry* e = laik_kvs_entry(kvs, key);
     bool created;
     if (e) {
         if (e->value) {
-            if (memcmp(e->value, value, (size_t) size) == 0) {
+            if ((e->vlen == size) &&
+                (memcmp(e->value, value, (size_t) size) == 0)) {
                 laik_log(1, "KVS '%s': entry '%s' (size %d, '%.20s') already existing",
                          kvs->name, key, size, value);
                 return e;
             }
-            free(e->value);
             created = false;
         }
         else {
@@ -393,11 +560,20 @@ Laik_KVS_Entry* laik_kvs_set(Laik_KVStore* kvs, char* key, unsigned int size, ch
         }
         e = &kvs->entry[kvs->used];
         kvs->used++;
-        e->key = strdup(key);
+        size_t klen = strlen(key) + 1;
+        e->key = slot_alloc(kvs, klen);
+        memcpy(e->key, key, klen);
         e->value = 0;
+        e->vlen = 0;
+        e->vcap = 0;
         e->data = 0;
         e->updated = false;
         created = true;
+
+        if (2 * kvs->used > kvs->hsize)
+            hindex_rebuild(kvs, 2 * kvs->hsize);
+        else
+            hindex_insert(kvs, kvs->used - 1);
     }
 
     if (e->updated && kvs->in_sync) {
@@ -408,8 +584,13 @@ Laik_KVS_Entry* laik_kvs_set(Laik_KVStore* kvs, char* key, unsigned int size, ch
         exit(1);
     }
 
-    e->value = (char*) malloc(size);
-    assert(e->value);
+    // overwrite in place if new value fits into space of old one
+    if (!e->value || (size > e->vcap)) {
+        if (e->value)
+            slot_free(kvs, e->value, e->vcap);
+        e->value = slot_alloc(kvs, size);
+        e->vcap = (unsigned int) slot_size(size);
+    }
     memcpy(e->value, value, size);
     e->vlen = size;
 
@@ -441,17 +622,55 @@ Laik_KVS_Entry* laik_kvs_sets(Laik_KVStore* kvs, char* key, char* str)
     return laik_kvs_set(kvs, key, len, str);
 }
 
-// synchronize KV store
-void laik_kvs_sync(Laik_KVStore* kvs)
+// start synchronization of KV store
+void laik_kvs_sync_start(Laik_KVStore* kvs)
 {
     const Laik_Backend* b = kvs->inst->backend;
     assert(b && b->sync);
+    assert(!kvs->sync_pending);
 
-    laik_log(1, "sync KVS '%s' (progagating %d/%d entries) ...",
+    laik_log(1, "start sync KVS '%s' (progagating %d/%d entries) ...",
              kvs->name, kvs->changes.offUsed / 2, kvs->used);
+    kvs->sync_pending = true;
+    if (b->sync_start)
+        (b->sync_start)(kvs);
+}
+
+// drop entries of removed keys, reusing their key slots
+static void compact_entries(Laik_KVStore* kvs)
+{
+    unsigned int o = 0, sorted = 0;
+    for(unsigned int i = 0; i < kvs->used; i++) {
+        Laik_KVS_Entry* e = &(kvs->entry[i]);
+        if (e->value == 0) {
+            slot_free(kvs, e->key, strlen(e->key) + 1);
+            continue;
+        }
+        if (i < kvs->sorted_upto) sorted++;
+        if (o < i) kvs->entry[o] = *e;
+        o++;
+    }
+    if (o == kvs->used) return;
+
+    laik_log(1, "KVS '%s': dropped %d removed entries",
+             kvs->name, kvs->used - o);
+    kvs->used = o;
+    // removing entries keeps order
+    kvs->sorted_upto = sorted;
+    hindex_rebuild(kvs, kvs->hsize);
+}
+
+// wait for synchronization of KV store to finish
+void laik_kvs_sync_wait(Laik_KVStore* kvs)
+{
+    const Laik_Backend* b = kvs->inst->backend;
+    assert(kvs->sync_pending);
+
+    // without sync_start, backend does full sync here
     kvs->in_sync = true;
     (b->sync)(kvs);
     kvs->in_sync = false;
+    kvs->sync_pending = false;
 
     // all queued entries sent, remove
     laik_kvs_changes_set_size(&(kvs->changes), 0, 0);
@@ -459,39 +678,30 @@ void laik_kvs_sync(Laik_KVStore* kvs)
     for(unsigned int i = 0; i < kvs->used; i++)
         kvs->entry[i].updated = false;
 
+    // removal of keys is propagated now
+    compact_entries(kvs);
+
     laik_log(1, "  sync done (now %d entries).", kvs->used);
+}
 
-    laik_kvs_sort(kvs);
+// synchronize KV store
+void laik_kvs_sync(Laik_KVStore* kvs)
+{
+    laik_kvs_sync_start(kvs);
+    laik_kvs_sync_wait(kvs);
 }
 
 Laik_KVS_Entry* laik_kvs_entry(Laik_KVStore* kvs, char* key)
 {
-    Laik_KVS_Entry* e;
-
-    // do binary search in range [0 .. (sorted_upto-1)]
-    int low = 0, high = ((int)kvs->sorted_upto) - 1, mid, res;
-    //laik_log(1, "  binary search in KVS '%s' for '%s' in [%d,%d]",
-    //         kvs->name, key, low, high);
-    while(low <= high) {
-        mid = (low + high) / 2;
-        e = &(kvs->entry[mid]);
-        res = strcmp(key, e->key);
-        //laik_log(1, "    test [%d] '%s': %d", mid, e->key, res);
-        if (res == 0)
-            return e;
-        if (res < 0)
-            high = mid-1;
-        else
-            low = mid+1;
-    }
-
-    // linear search for unsorted items
-    for(unsigned int i = kvs->sorted_upto; i < kvs->used; i++) {
-        e = &(kvs->entry[i]);
+    // linear probing in hash index
+    unsigned int mask = kvs->hsize - 1;
+    unsigned int h = hash_key(key) & mask;
+    while(kvs->hindex[h] != 0) {
+        Laik_KVS_Entry* e = &(kvs->entry[kvs->hindex[h] - 1]);
         if (strcmp(e->key, key) == 0)
             return e;
+        h = (h + 1) & mask;
     }
-
     return 0;
 }
 
@@ -546,8 +756,14 @@ unsigned int laik_kvs_copy(Laik_KVS_Entry* e, char* mem, unsigned int size)
 
 void laik_kvs_sort(Laik_KVStore* kvs)
 {
+    // entries only get appended or dropped: still sorted if no new ones
+    if (kvs->sorted_upto == kvs->used) return;
+
     qsort(kvs->entry, kvs->used, sizeof(Laik_KVS_Entry), entrycmp);
     kvs->sorted_upto = kvs->used;
+
+    // entry indexes changed
+    hindex_rebuild(kvs, kvs->hsize);
 }
 
 void laik_kvs_reg_callbacks(Laik_KVStore* kvs,
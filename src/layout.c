@@ -270,6 +270,20 @@ void laik_init_layout(Laik_Layout* l, int dims, int map_count, uint64_t count,
     l->unpack = unpack;
     l->describe = describe;
     l->copy = copy;
+
+    // optional hooks, to be set by layout implementations after init
+    l->tile = 0;
+    l->release = 0;
+}
+
+// free a layout object, calling its release function if set
+void laik_free_layout(Laik_Layout* l)
+{
+    if (l == 0) return;
+
+    if (l->release)
+        (l->release)(l);
+    free(l);
 }
 
 
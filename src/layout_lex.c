@@ -111,6 +111,25 @@ int64_t offset_lex(Laik_Layout* l, int n, Laik_Index* idx)
 }
 
 
+// the whole range of map <n> is one lexicographically ordered tile
+static
+bool tile_lex(Laik_Layout* l, int n, Laik_Index* idx,
+              Laik_Range* range, int64_t* off, uint64_t* stride)
+{
+    Laik_Layout_Lex* ll = laik_is_layout_lex(l);
+    assert(ll);
+    assert((n >= 0) && (n < l->map_count));
+    Lex_Entry* e = &(ll->e[n]);
+    (void) idx;
+
+    *range = e->range;
+    *off = 0;
+    stride[0] = e->stride[0];
+    stride[1] = e->stride[1];
+    stride[2] = e->stride[2];
+    return true;
+}
+
 static
 char* describe_lex(Laik_Layout* l)
 {
@@ -498,6 +517,7 @@ Laik_Layout* laik_new_layout_lex(int n, Laik_Range* ranges)
                      pack_lex,
                      unpack_lex,
                      copy_lex);
+    l->h.tile = tile_lex;
 
     uint64_t count = 0;
     for(int i = 0; i < n; i++) {
@@ -531,6 +551,12 @@ Laik_Layout* laik_new_layout_lex(int n, Laik_Range* ranges)
 }
 
 
+// is layout <l> a lexicographical layout?
+bool laik_layout_is_lex(Laik_Layout* l)
+{
+    return laik_is_layout_lex(l) != 0;
+}
+
 // return stride for dimension <d> in lex layout map <n>
 uint64_t laik_layout_lex_stride(Laik_Layout* l, int n, int d)
 {
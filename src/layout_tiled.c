@@ -0,0 +1,699 @@
+/*
+ * This file is part of the LAIK library.
+ * Copyright (c) 2020 Josef Weidendorfer <Josef.Weidendorfer@gmx.de>
+ *
+ * LAIK is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, version 3 or later.
+ *
+ * LAIK is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "laik-internal.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// this file implements tiled layouts for 2d/3d ranges, requesting a
+// separate allocation for each range:
+// - tiles are aligned to multiples of the tile size in the global index
+//   space, such that mappings of different partitionings share tile
+//   borders. Tiles at range borders are cut, so no padding is needed
+// - elements inside of a tile are ordered lexicographically
+// - the order of tiles is either lexicographical ("tiled") or along
+//   a Z-order curve ("morton"). The offset of each tile is stored in a
+//   table indexed by lexicographical tile number
+
+// parameters for one range
+typedef struct _Tiled_Entry Tiled_Entry;
+struct _Tiled_Entry {
+    Laik_Range range;   // covered range, unused dimensions set to [0;1[
+    uint64_t count;
+    int64_t first[3];   // global number of first tile in each dimension
+    int64_t tiles[3];   // number of tiles in each dimension
+    uint64_t* toff;     // offsets of tiles, indexed by lex tile number
+};
+
+typedef struct _Laik_Layout_Tiled Laik_Layout_Tiled;
+struct _Laik_Layout_Tiled {
+    Laik_Layout h;
+    bool morton;        // tiles in Z-order instead of lex order?
+    int64_t tsize[3];   // tile size in each dimension
+    Tiled_Entry e[0];
+};
+
+// tile size for new layouts, 0: use default
+static int64_t tilesize[3] = {0, 0, 0};
+static bool tilesize_checked = false;
+
+// position in lexicographical traversal of a range (unused dims: [0;1[)
+typedef struct _Tiled_Walk {
+    int64_t from[3], to[3];
+    int64_t i[3];
+} Tiled_Walk;
+
+
+//--------------------------------------------------------------
+// helpers
+//
+
+// rounding-down division (indexes may be negative)
+static inline
+int64_t tdiv(int64_t i, int64_t t)
+{
+    return (i >= 0) ? (i / t) : -((t - 1 - i) / t);
+}
+
+// for coordinate <i> in dimension <d> of entry <e>, return number of tile
+// relative to first tile, and set start/end of tile (cut to range)
+static inline
+int64_t tile_of(Laik_Layout_Tiled* l, Tiled_Entry* e, int d, int64_t i,
+                int64_t* start, int64_t* end)
+{
+    int64_t t = l->tsize[d];
+    int64_t g = tdiv(i, t);
+    int64_t s = g * t, en = s + t;
+    *start = (s < e->range.from.i[d]) ? e->range.from.i[d] : s;
+    *end = (en > e->range.to.i[d]) ? e->range.to.i[d] : en;
+    return g - e->first[d];
+}
+
+// return offset of tile containing index <i>, with start/end of tile
+static inline
+int64_t locate(Laik_Layout_Tiled* l, Tiled_Entry* e, int64_t* i,
+               int64_t* start, int64_t* end)
+{
+    int64_t k0 = tile_of(l, e, 0, i[0], &start[0], &end[0]);
+    int64_t k1 = tile_of(l, e, 1, i[1], &start[1], &end[1]);
+    int64_t k2 = tile_of(l, e, 2, i[2], &start[2], &end[2]);
+    assert((k0 >= 0) && (k0 < e->tiles[0]));
+    assert((k1 >= 0) && (k1 < e->tiles[1]));
+    assert((k2 >= 0) && (k2 < e->tiles[2]));
+
+    return e->toff[k0 + e->tiles[0] * (k1 + e->tiles[1] * k2)];
+}
+
+// offset of index <i> in entry <e>
+static inline
+int64_t offset_in(Laik_Layout_Tiled* l, Tiled_Entry* e, int64_t* i)
+{
+    int64_t s[3], en[3];
+    int64_t off = locate(l, e, i, s, en);
+    int64_t w = en[0] - s[0], h = en[1] - s[1];
+
+    return off + (i[0] - s[0]) + ((i[1] - s[1]) + (i[2] - s[2]) * h) * w;
+}
+
+// number of elements with consecutive offsets in entry <e>, traversing
+// from position of walk <w>. Sets offset of current position in <*off>
+static
+uint64_t run_tiled(Laik_Layout_Tiled* l, Tiled_Entry* e, Tiled_Walk* w,
+                   int64_t* off)
+{
+    int64_t s[3], en[3];
+    int64_t* i = w->i;
+    int64_t toff = locate(l, e, i, s, en);
+    int64_t tw = en[0] - s[0], th = en[1] - s[1];
+    *off = toff + (i[0] - s[0]) + ((i[1] - s[1]) + (i[2] - s[2]) * th) * tw;
+
+    int64_t end0 = (en[0] < w->to[0]) ? en[0] : w->to[0];
+    uint64_t run = end0 - i[0];
+
+    // traversed range aligned to tile in x: rows in tile follow each other
+    if ((i[0] == w->from[0]) && (w->from[0] == s[0]) && (w->to[0] == en[0])) {
+        int64_t end1 = (en[1] < w->to[1]) ? en[1] : w->to[1];
+        run = tw * (end1 - i[1]);
+
+        // also aligned in y: planes in tile follow each other
+        if ((i[1] == w->from[1]) && (w->from[1] == s[1]) && (w->to[1] == en[1])) {
+            int64_t end2 = (en[2] < w->to[2]) ? en[2] : w->to[2];
+            run = tw * th * (end2 - i[2]);
+        }
+    }
+    return run;
+}
+
+static
+void walk_init(Tiled_Walk* w, int dims, Laik_Range* r, Laik_Index* idx)
+{
+    for(int d = 0; d < 3; d++) {
+        if (d < dims) {
+            w->from[d] = r->from.i[d];
+            w->to[d] = r->to.i[d];
+            w->i[d] = idx->i[d];
+        }
+        else {
+            w->from[d] = 0;
+            w->to[d] = 1;
+            w->i[d] = 0;
+        }
+    }
+}
+
+// advance walk by <n> elements in lexicographical order.
+// Returns false if end of range is reached
+static
+bool walk_advance(Tiled_Walk* w, uint64_t n)
+{
+    int64_t d0 = w->to[0] - w->from[0];
+    int64_t d1 = w->to[1] - w->from[1];
+
+    int64_t lin = w->i[0] - w->from[0] + (int64_t) n;
+    w->i[0] = w->from[0] + lin % d0;
+    lin = lin / d0;
+    if (lin == 0) return true;
+
+    lin += w->i[1] - w->from[1];
+    w->i[1] = w->from[1] + lin % d1;
+    lin = lin / d1;
+    if (lin == 0) return true;
+
+    w->i[2] += lin;
+    return (w->i[2] < w->to[2]);
+}
+
+static
+void walk_save(Tiled_Walk* w, int dims, bool atEnd, Laik_Range* r, Laik_Index* idx)
+{
+    if (atEnd) {
+        *idx = r->to;
+        return;
+    }
+    for(int d = 0; d < dims; d++)
+        idx->i[d] = w->i[d];
+}
+
+// extent of tile number <k> in dimension <d> of entry <e>
+static
+int64_t tile_extent(Laik_Layout_Tiled* l, Tiled_Entry* e, int d, int64_t k)
+{
+    int64_t s, en;
+    tile_of(l, e, d, (e->first[d] + k) * l->tsize[d], &s, &en);
+    return en - s;
+}
+
+// set parameters of entry <e> to cover range <r>, calculating tile offsets
+static
+void init_entry(Laik_Layout_Tiled* l, Tiled_Entry* e, Laik_Range* r)
+{
+    int dims = l->h.dims;
+
+    e->range = *r;
+    e->count = laik_range_size(r);
+    uint64_t tcount = 1;
+    for(int d = 0; d < 3; d++) {
+        if (d >= dims) {
+            e->range.from.i[d] = 0;
+            e->range.to.i[d] = 1;
+        }
+        assert(e->range.from.i[d] < e->range.to.i[d]);
+        e->first[d] = tdiv(e->range.from.i[d], l->tsize[d]);
+        e->tiles[d] = tdiv(e->range.to.i[d] - 1, l->tsize[d]) - e->first[d] + 1;
+        tcount *= e->tiles[d];
+    }
+
+    e->toff = malloc(tcount * sizeof(uint64_t));
+    if (!e->toff) {
+        laik_panic("Out of memory allocating tile table of tiled layout");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    uint64_t off = 0;
+    if (!l->morton) {
+        uint64_t tno = 0;
+        for(int64_t k2 = 0; k2 < e->tiles[2]; k2++)
+            for(int64_t k1 = 0; k1 < e->tiles[1]; k1++)
+                for(int64_t k0 = 0; k0 < e->tiles[0]; k0++) {
+                    e->toff[tno++] = off;
+                    off += tile_extent(l, e, 0, k0) *
+                           tile_extent(l, e, 1, k1) *
+                           tile_extent(l, e, 2, k2);
+                }
+    }
+    else {
+        // go over Z-order codes of tile grid rounded up to power of 2 in
+        // each dimension, skipping tiles outside of range. Codes only
+        // interleave bits a dimension has: same order as in a cube, but
+        // at most 2^dims times more codes than tiles
+        int bits[3] = {0, 0, 0}, allbits = 0;
+        for(int d = 0; d < dims; d++) {
+            while ((1ll << bits[d]) < e->tiles[d]) bits[d]++;
+            allbits += bits[d];
+        }
+        assert(allbits < 64);
+
+        uint64_t codes = 1ull << allbits;
+        for(uint64_t c = 0; c < codes; c++) {
+            int64_t k[3] = {0, 0, 0};
+            int pos = 0;
+            for(int b = 0; pos < allbits; b++)
+                for(int d = 0; d < dims; d++) {
+                    if (b >= bits[d]) continue;
+                    k[d] |= (int64_t) ((c >> pos) & 1) << b;
+                    pos++;
+                }
+            if ((k[0] >= e->tiles[0]) || (k[1] >= e->tiles[1]) ||
+                (k[2] >= e->tiles[2])) continue;
+
+            e->toff[k[0] + e->tiles[0] * (k[1] + e->tiles[1] * k[2])] = off;
+            off += tile_extent(l, e, 0, k[0]) *
+                   tile_extent(l, e, 1, k[1]) *
+                   tile_extent(l, e, 2, k[2]);
+        }
+    }
+    assert(off == e->count);
+}
+
+
+//--------------------------------------------------------------
+// interface implementation of tiled layouts
+//
+
+// forward decl
+static int64_t offset_tiled(Laik_Layout* l, int n, Laik_Index* idx);
+
+// return tiled layout if given layout is a tiled/morton layout
+static
+Laik_Layout_Tiled* laik_is_layout_tiled(Laik_Layout* l)
+{
+    if (l->offset == offset_tiled)
+        return (Laik_Layout_Tiled*) l;
+
+    return 0; // not a tiled layout
+}
+
+// return map number whose ranges contains index <idx>
+static
+int section_tiled(Laik_Layout* l, Laik_Index* idx)
+{
+    Laik_Layout_Tiled* lt = laik_is_layout_tiled(l);
+    assert(lt);
+
+    for(int i = 0; i < l->map_count; i++) {
+        Tiled_Entry* e = &(lt->e[i]);
+        int d;
+        for(d = 0; d < l->dims; d++)
+            if ((idx->i[d] < e->range.from.i[d]) ||
+                (idx->i[d] >= e->range.to.i[d])) break;
+        if (d == l->dims) return i;
+    }
+    return -1; // not found
+}
+
+// section is allocation number
+static
+int mapno_tiled(Laik_Layout* l, int n)
+{
+    assert(n < l->map_count);
+    return n;
+}
+
+// return offset for <idx> in map <n> of this layout
+static
+int64_t offset_tiled(Laik_Layout* l, int n, Laik_Index* idx)
+{
+    Laik_Layout_Tiled* lt = laik_is_layout_tiled(l);
+    assert(lt);
+    assert((n >= 0) && (n < l->map_count));
+    Tiled_Entry* e = &(lt->e[n]);
+
+    int64_t i[3] = {0, 0, 0};
+    for(int d = 0; d < l->dims; d++)
+        i[d] = idx->i[d];
+
+    int64_t off = offset_in(lt, e, i);
+    assert((off >= 0) && (off < (int64_t) e->count));
+    return off;
+}
+
+static
+bool tile_tiled(Laik_Layout* l, int n, Laik_Index* idx,
+                Laik_Range* range, int64_t* off, uint64_t* stride)
+{
+    Laik_Layout_Tiled* lt = laik_is_layout_tiled(l);
+    assert(lt);
+    assert((n >= 0) && (n < l->map_count));
+    Tiled_Entry* e = &(lt->e[n]);
+
+    int64_t i[3] = {0, 0, 0};
+    for(int d = 0; d < l->dims; d++)
+        i[d] = idx->i[d];
+
+    int64_t s[3], en[3];
+    *off = locate(lt, e, i, s, en);
+    range->space = e->range.space;
+    for(int d = 0; d < 3; d++) {
+        range->from.i[d] = s[d];
+        range->to.i[d] = en[d];
+    }
+    stride[0] = 1;
+    stride[1] = en[0] - s[0];
+    stride[2] = stride[1] * (en[1] - s[1]);
+    return true;
+}
+
+static
+char* describe_tiled(Laik_Layout* l)
+{
+    static char s[100];
+
+    Laik_Layout_Tiled* lt = laik_is_layout_tiled(l);
+    assert(lt);
+
+    int o = sprintf(s, "%s (%dd, %d maps, tile %lld",
+                    lt->morton ? "morton" : "tiled", l->dims, l->map_count,
+                    (long long) lt->tsize[0]);
+    for(int d = 1; d < l->dims; d++)
+        o += sprintf(s+o, "x%lld", (long long) lt->tsize[d]);
+    o += sprintf(s+o, ")");
+    assert(o < 100);
+
+    return s;
+}
+
+static
+bool reuse_tiled(Laik_Layout* l, int n, Laik_Layout* old, int nold)
+{
+    Laik_Layout_Tiled* lnew = laik_is_layout_tiled(l);
+    assert(lnew);
+    Laik_Layout_Tiled* lold = laik_is_layout_tiled(old);
+    assert(lold);
+    assert((n >= 0) && (n < l->map_count));
+
+    if (laik_log_begin(1)) {
+        laik_log_append("reuse_tiled: check reuse for map %d in %s",
+                        n, describe_tiled(l));
+        laik_log_flush(" using map %d in old %s", nold, describe_tiled(old));
+    }
+
+    // tile order and tile size must match
+    if ((lnew->morton != lold->morton) ||
+        (lnew->tsize[0] != lold->tsize[0]) ||
+        (lnew->tsize[1] != lold->tsize[1]) ||
+        (lnew->tsize[2] != lold->tsize[2]))
+        return false;
+
+    Tiled_Entry* eNew = &(lnew->e[n]);
+    Tiled_Entry* eOld = &(lold->e[nold]);
+    if (!laik_range_within_range(&(eNew->range), &(eOld->range))) {
+        // no, cannot reuse
+        return false;
+    }
+    laik_log(1, "reuse_tiled: old map %d can be reused (count %llu -> %llu)",
+             nold,
+             (unsigned long long) eNew->count,
+             (unsigned long long) eOld->count);
+
+    // take over geometry of old entry, with own copy of tile table
+    uint64_t tcount = eOld->tiles[0] * eOld->tiles[1] * eOld->tiles[2];
+    uint64_t* toff = realloc(eNew->toff, tcount * sizeof(uint64_t));
+    if (!toff) {
+        laik_panic("Out of memory allocating tile table of tiled layout");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    memcpy(toff, eOld->toff, tcount * sizeof(uint64_t));
+
+    l->count += eOld->count - eNew->count;
+    *eNew = *eOld;
+    eNew->toff = toff;
+    return true;
+}
+
+static
+void release_tiled(Laik_Layout* l)
+{
+    Laik_Layout_Tiled* lt = laik_is_layout_tiled(l);
+    assert(lt);
+
+    for(int i = 0; i < l->map_count; i++)
+        free(lt->e[i].toff);
+}
+
+
+// copy between mappings with tiled layouts (tile sizes may differ):
+// copy runs of elements which are contiguous in both mappings
+static
+void copy_tiled(Laik_Range* range,
+                Laik_Mapping* from, Laik_Mapping* to)
+{
+    Laik_Layout_Tiled* fromLayout = laik_is_layout_tiled(from->layout);
+    Laik_Layout_Tiled* toLayout = laik_is_layout_tiled(to->layout);
+    assert(fromLayout != 0);
+    assert(toLayout != 0);
+    Tiled_Entry* fromEntry = &(fromLayout->e[from->layoutSection]);
+    Tiled_Entry* toEntry = &(toLayout->e[to->layoutSection]);
+
+    unsigned int elemsize = from->data->elemsize;
+    assert(elemsize == to->data->elemsize);
+    int dims = from->layout->dims;
+    assert(dims == to->layout->dims);
+
+    if (laik_log_begin(1)) {
+        laik_log_append("tiled copy of range ");
+        laik_log_Range(range);
+        laik_log_append(" (count %llu, elemsize %d) from mapping %p",
+            laik_range_size(range), elemsize, from->start);
+        laik_log_append(" (data '%s'/%d, %s) ",
+            from->data->name, from->mapNo,
+            from->layout->describe(from->layout));
+        laik_log_flush("to mapping %p (data '%s'/%d, layout %s)",
+            to->start, to->data->name, to->mapNo,
+            to->layout->describe(to->layout));
+    }
+
+    Tiled_Walk w;
+    walk_init(&w, dims, range, &(range->from));
+    uint64_t count = 0, n;
+    do {
+        int64_t fromOff, toOff;
+        n = run_tiled(fromLayout, fromEntry, &w, &fromOff);
+        uint64_t n2 = run_tiled(toLayout, toEntry, &w, &toOff);
+        if (n2 < n) n = n2;
+
+        memcpy(to->start + toOff * elemsize,
+               from->start + fromOff * elemsize, n * elemsize);
+        count += n;
+    } while(walk_advance(&w, n));
+    assert(count == laik_range_size(range));
+}
+
+
+// pack/unpack routines for tiled layouts: elements are packed in
+// lexicographical traversal order of the range (as with other layouts),
+// copying runs of contiguous elements. For ranges aligned to tiles,
+// runs span multiple rows/planes of a tile
+static
+unsigned int pack_tiled(Laik_Mapping* m, Laik_Range* range,
+                        Laik_Index* idx, char* buf, unsigned int size)
+{
+    unsigned int elemsize = m->data->elemsize;
+    Laik_Layout_Tiled* layout = laik_is_layout_tiled(m->layout);
+    assert(layout != 0);
+    Tiled_Entry* e = &(layout->e[m->layoutSection]);
+    int dims = m->layout->dims;
+
+    if (laik_index_isEqual(dims, idx, &(range->to))) {
+        // nothing left to pack
+        return 0;
+    }
+
+    // range to pack must within local valid range of mapping
+    assert(laik_range_within_range(range, &(m->requiredRange)));
+
+    if (laik_log_begin(1)) {
+        laik_log_append("        tiled packing of range ");
+        laik_log_Range(range);
+        laik_log_append(" (count %llu, elemsize %d) from mapping %p",
+            laik_range_size(range), elemsize, m->start);
+        laik_log_append(" (data '%s'/%d, %s) at idx ",
+            m->data->name, m->mapNo, describe_tiled(m->layout));
+        laik_log_Index(dims, idx);
+        laik_log_flush(" into buf (size %d)", size);
+    }
+
+    Tiled_Walk w;
+    walk_init(&w, dims, range, idx);
+    unsigned int count = 0;
+    bool atEnd = false;
+    while(size >= elemsize) {
+        int64_t off;
+        uint64_t n = run_tiled(layout, e, &w, &off);
+        if (n > size / elemsize) n = size / elemsize;
+
+        // copy run of elements into buffer
+        memcpy(buf, m->start + off * elemsize, n * elemsize);
+        size -= n * elemsize;
+        buf += n * elemsize;
+        count += n;
+
+        if (!walk_advance(&w, n)) {
+            atEnd = true;
+            break;
+        }
+    }
+    walk_save(&w, dims, atEnd, range, idx);
+
+    if (laik_log_begin(1)) {
+        laik_log_append("        packed '%s': end (", m->data->name);
+        laik_log_Index(dims, idx);
+        laik_log_flush("), %lu elems = %lu bytes, %d left",
+                       count, count * elemsize, size);
+    }
+
+    return count;
+}
+
+static
+unsigned int unpack_tiled(Laik_Mapping* m, Laik_Range* range,
+                          Laik_Index* idx, char* buf, unsigned int size)
+{
+    unsigned int elemsize = m->data->elemsize;
+    Laik_Layout_Tiled* layout = laik_is_layout_tiled(m->layout);
+    assert(layout != 0);
+    Tiled_Entry* e = &(layout->e[m->layoutSection]);
+    int dims = m->layout->dims;
+
+    // there should be something to unpack
+    assert(size > 0);
+    assert(!laik_index_isEqual(dims, idx, &(range->to)));
+
+    // range to unpack into must be within local valid range of mapping
+    assert(laik_range_within_range(range, &(m->requiredRange)));
+
+    if (laik_log_begin(1)) {
+        laik_log_append("        tiled unpacking of range ");
+        laik_log_Range(range);
+        laik_log_append(" (count %llu, elemsize %d) into mapping %p",
+            laik_range_size(range), elemsize, m->start);
+        laik_log_append(" (data '%s'/%d, %s) at idx ",
+            m->data->name, m->mapNo, describe_tiled(m->layout));
+        laik_log_Index(dims, idx);
+        laik_log_flush(" from buf (size %d)", size);
+    }
+
+    Tiled_Walk w;
+    walk_init(&w, dims, range, idx);
+    unsigned int count = 0;
+    bool atEnd = false;
+    while(size >= elemsize) {
+        int64_t off;
+        uint64_t n = run_tiled(layout, e, &w, &off);
+        if (n > size / elemsize) n = size / elemsize;
+
+        // copy run of elements from buffer into mapping
+        memcpy(m->start + off * elemsize, buf, n * elemsize);
+        size -= n * elemsize;
+        buf += n * elemsize;
+        count += n;
+
+        if (!walk_advance(&w, n)) {
+            atEnd = true;
+            break;
+        }
+    }
+    walk_save(&w, dims, atEnd, range, idx);
+
+    if (laik_log_begin(1)) {
+        laik_log_append("        unpacked '%s': end (", m->data->name);
+        laik_log_Index(dims, idx);
+        laik_log_flush("), %lu elems = %lu bytes, %d left",
+                       count, count * elemsize, size);
+    }
+
+    return count;
+}
+
+
+// tile size to use for new layouts with <dims> dimensions
+static
+void get_tilesize(int dims, int64_t* ts)
+{
+    if (!tilesize_checked) {
+        tilesize_checked = true;
+        char* str = getenv("LAIK_LAYOUT_TILE");
+        if (str && (tilesize[0] == 0)) {
+            long long x = 0, y = 0, z = 0;
+            if (sscanf(str, "%lldx%lldx%lld", &x, &y, &z) < 2)
+                laik_log(LAIK_LL_Warning,
+                         "LAIK_LAYOUT_TILE: cannot parse '%s', ignored", str);
+            else
+                laik_layout_set_tilesize(x, y, z);
+        }
+    }
+
+    // defaults: tiles of 8 KB for doubles
+    ts[0] = (dims == 2) ? 32 : 16;
+    ts[1] = (dims == 2) ? 32 : 8;
+    ts[2] = (dims == 2) ? 1 : 8;
+    for(int d = 0; d < dims; d++)
+        if (tilesize[d] > 0) ts[d] = tilesize[d];
+}
+
+static
+Laik_Layout* new_layout_tiled(int n, Laik_Range* ranges, bool morton)
+{
+    int dims = ranges->space->dims;
+
+    // tiles make no sense in 1d
+    if (dims == 1)
+        return laik_new_layout_lex(n, ranges);
+
+    Laik_Layout_Tiled* l = malloc(sizeof(Laik_Layout_Tiled) + n * sizeof(Tiled_Entry));
+    if (!l) {
+        laik_panic("Out of memory allocating Laik_Layout_Tiled object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    // count calculated later
+    laik_init_layout(&(l->h), dims, n, 0,
+                     section_tiled,
+                     mapno_tiled,
+                     offset_tiled,
+                     reuse_tiled,
+                     describe_tiled,
+                     pack_tiled,
+                     unpack_tiled,
+                     copy_tiled);
+    l->h.tile = tile_tiled;
+    l->h.release = release_tiled;
+
+    l->morton = morton;
+    get_tilesize(dims, l->tsize);
+
+    uint64_t count = 0;
+    for(int i = 0; i < n; i++) {
+        init_entry(l, &(l->e[i]), &ranges[i]);
+        count += l->e[i].count;
+    }
+    l->h.count = count;
+
+    return (Laik_Layout*) l;
+}
+
+// create tiled layout with tiles in lexicographical order covering <n> ranges
+Laik_Layout* laik_new_layout_tiled(int n, Laik_Range* ranges)
+{
+    return new_layout_tiled(n, ranges, false);
+}
+
+// create tiled layout with tiles in Z-order covering <n> ranges
+Laik_Layout* laik_new_layout_morton(int n, Laik_Range* ranges)
+{
+    return new_layout_tiled(n, ranges, true);
+}
+
+// set tile size for tiled/morton layouts created afterwards (0: default)
+void laik_layout_set_tilesize(int64_t x, int64_t y, int64_t z)
+{
+    tilesize[0] = (x > 0) ? x : 0;
+    tilesize[1] = (y > 0) ? y : 0;
+    tilesize[2] = (z > 0) ? z : 0;
+    tilesize_checked = true; // explicit setting overrides env var
+}
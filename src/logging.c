@@ -20,8 +20,11 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
 #include <string.h>
 #include <stdarg.h>
+#include <pthread.h>
 
 // default log level
 static int laik_loglevel = LAIK_LL_Error;
@@ -39,6 +42,11 @@ static int laik_logctr = 0;
 // filter
 static int laik_log_fromLID = -1;
 static int laik_log_toLID = -1;
+// binary mode: record messages unformatted, see below
+static bool laik_log_binary = false;
+static int laik_log_bufsize = 1 << 20;
+
+static void bin_dump_all(void);
 
 void laik_log_init_internal()
 {
@@ -50,6 +58,7 @@ void laik_log_init_internal()
 
     char* str = getenv("LAIK_LOG");
     if (str) {
+        if (*str == 'b') { laik_log_binary = true; str++; }
         if (*str == 'n') { laik_logprefix = 0; str++; }
         if (*str == 's') { laik_logprefix = 1; str++; }
 
@@ -61,6 +70,7 @@ void laik_log_init_internal()
             fprintf(stderr, "Unknown LAIK_LOG syntax. Use\n\n"
                             "    LAIK_LOG=[option]level[:locID[-toID]]\n\n"
                             " option : logging option (characters, defaults to none)\n"
+                            "            b - binary mode: format messages deferred\n"
                             "            n - no line prefix\n"
                             "            s - use short prefix\n"
                             " level  : minimum logging level (digit, defaults to 0: no logging)\n"
@@ -92,6 +102,15 @@ void laik_log_init_internal()
         stdout = laik_logfile;
     }
 
+    if (laik_log_binary) {
+        str = getenv("LAIK_LOG_BUFSIZE");
+        if (str) {
+            int size = atoi(str);
+            if (size >= 1024) laik_log_bufsize = size;
+        }
+        // messages still buffered at exit (e.g. after errors)
+        atexit(bin_dump_all);
+    }
 }
 
 // initialize logging for instance <instance>
@@ -127,6 +146,7 @@ void laik_log_cleanup(Laik_Instance* i)
     }
 
     laik_log_flush(0);
+    bin_dump_all();
 
     if (laik_logfile)
         fclose(laik_logfile);
@@ -145,7 +165,7 @@ void laik_set_loglevel(int l)
 }
 
 // check for log level: return true if given log level will be shown
-bool laik_log_shown(int l)
+bool (laik_log_shown)(int l)
 {
     return (l >= laik_loglevel);
 }
@@ -171,14 +191,22 @@ bool laik_log_shown(int l)
  * Or just use log(<level>, <msg>, ...) which internally uses above functions
 */
 
-// buffered logging, not thread-safe
+// buffered logging, not thread-safe in text mode
+
+// message text being built
+typedef struct _Laik_LogText {
+    char* buf;
+    int size, pos;
+} Laik_LogText;
 
-static int current_logLevel = LAIK_LL_None;
-static char* current_logBuffer = 0;
-static int current_logSize = 0;
-static int current_logPos = 0;
+static __thread int current_logLevel = LAIK_LL_None;
+// text mode: message of current laik_log_begin/append/flush
+static Laik_LogText current_logText = { 0, 0, 0 };
 
-bool laik_log_begin(int l)
+static void bin_record(int level, const char* format, va_list ap);
+static void log_reset(Laik_LogText* t);
+
+bool (laik_log_begin)(int l)
 {
     // if nothing should be logged, set level to none and return
     if (l < laik_loglevel) {
@@ -194,48 +222,77 @@ bool laik_log_begin(int l)
         }
     }
     current_logLevel = l;
+    if (laik_log_binary) return true;
+
+    log_reset(&current_logText);
+    return true;
+}
 
-    current_logPos = 0;
-    if (current_logBuffer == 0) {
+// start new message in <t>
+static void log_reset(Laik_LogText* t)
+{
+    t->pos = 0;
+    if (t->buf == 0) {
         // init: start with 1k buffer
-        current_logBuffer = malloc(1024);
-        assert(current_logBuffer); // cannot call laik_panic
-        current_logSize = 1024;
+        t->buf = malloc(1024);
+        assert(t->buf); // cannot call laik_panic
+        t->size = 1024;
     }
-    return true;
+    t->buf[0] = 0;
 }
 
 static
-void log_append(const char *format, va_list ap)
+void log_append(Laik_LogText* t, const char *format, va_list ap)
 {
-    if (current_logLevel == LAIK_LL_None) return;
-
     // to be able to do a 2nd pass over ap (if buffer is too small)
     va_list ap2;
     va_copy(ap2, ap);
 
     int left, len;
-    left = current_logSize - current_logPos;
+    left = t->size - t->pos;
     assert(left > 0);
-    len = vsnprintf(current_logBuffer + current_logPos, left,
-                    format, ap);
+    len = vsnprintf(t->buf + t->pos, left, format, ap);
 
     // does it fit into buffer? (len is without terminating zero byte)
     if (len >= left) {
-        int size = 2 * current_logSize;
-        if (size < len + 1) size = len + 1;
-        current_logBuffer = realloc(current_logBuffer, size);
-        current_logSize = size;
-        // printf("Enlarging log buffer to %d bytes ...\n", size);
+        int size = 2 * t->size;
+        if (size < t->pos + len + 1) size = t->pos + len + 1;
+        t->buf = realloc(t->buf, size);
+        assert(t->buf); // cannot call laik_panic
+        t->size = size;
 
         // print again into enlarged buffer - must fit
-        left = current_logSize - current_logPos;
-        len = vsnprintf(current_logBuffer + current_logPos, left,
-                        format, ap2);
+        left = t->size - t->pos;
+        len = vsnprintf(t->buf + t->pos, left, format, ap2);
         assert(len < left);
     }
+    va_end(ap2);
 
-    current_logPos += len;
+    t->pos += len;
+}
+
+// append <len> characters of <str> to message in <t>
+static void log_appendn(Laik_LogText* t, const char* str, int len)
+{
+    if (t->pos + len + 1 > t->size) {
+        int size = 2 * t->size;
+        if (size < t->pos + len + 1) size = t->pos + len + 1;
+        t->buf = realloc(t->buf, size);
+        assert(t->buf); // cannot call laik_panic
+        t->size = size;
+    }
+    memcpy(t->buf + t->pos, str, len);
+    t->pos += len;
+    t->buf[t->pos] = 0;
+}
+
+// append formatted text to message in <t>
+static void log_appendf(Laik_LogText* t, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    log_append(t, format, args);
+    va_end(args);
 }
 
 void laik_log_append(const char* msg, ...)
@@ -244,7 +301,10 @@ void laik_log_append(const char* msg, ...)
 
     va_list args;
     va_start(args, msg);
-    log_append(msg, args);
+    if (laik_log_binary)
+        bin_record(LAIK_LL_None, msg, args);
+    else
+        log_append(&current_logText, msg, args);
     va_end(args);
 }
 
@@ -254,14 +314,23 @@ void laik_log_inc()
     laik_logctr++;
 }
 
-static
-void log_flush()
+// wall clock time since initialization of logging
+static double log_wtime(void)
 {
-    if (current_logLevel == LAIK_LL_None) return;
-    if ((current_logPos == 0) || (current_logBuffer == 0)) return;
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (double)(now.tv_sec - laik_log_init_time.tv_sec) +
+           0.000001 * (now.tv_usec - laik_log_init_time.tv_usec);
+}
 
+// print message in <t> with prefix, using given level, time since
+// initialization, log counter and location ID (-1: no instance yet).
+// Only one thread may call this at a time
+static
+void log_output(Laik_LogText* t, int level, double wtime, int logctr, int lid)
+{
     const char* lstr = 0;
-    switch(current_logLevel) {
+    switch(level) {
     case LAIK_LL_Warning: lstr = "Warning"; break;
     case LAIK_LL_Error:   lstr = "ERROR"; break;
     case LAIK_LL_Panic:   lstr = "PANIC"; break;
@@ -272,9 +341,9 @@ void log_flush()
     static int counter = 0;
     static int last_logctr = 0;
     int line_counter = 0;
-    if (last_logctr != laik_logctr) {
+    if (last_logctr != logctr) {
         counter = 0;
-        last_logctr = laik_logctr;
+        last_logctr = logctr;
     }
     counter++;
 
@@ -283,15 +352,11 @@ void log_flush()
     static char buf2[150 + LINE_LEN];
     int off1 = 0, off, off2;
 
-    char* buf1 = current_logBuffer;
+    char* buf1 = t->buf;
 
     int spaces = 0, last_break = 0;
     bool at_newline = true;
 
-    struct timeval now;
-    gettimeofday(&now, NULL);
-    double wtime = (double)(now.tv_sec - laik_log_init_time.tv_sec) +
-                   0.000001 * (now.tv_usec - laik_log_init_time.tv_usec);
     int wtime_min = (int) (wtime/60.0);
     double wtime_s = wtime - 60.0 * wtime_min;
 
@@ -302,18 +367,18 @@ void log_flush()
         // sorting makes chunks from output of each MPI task
         line_counter++;
         off2 = sprintf(buf2, "%s ", (line_counter == 1) ? "==" : "..");
-        if (laik_loginst == 0) {
+        if (lid < 0) {
             off2 += sprintf(buf2+off2, "%-7s: ",
                             laik_log_mylocation ? laik_log_mylocation : "");
 
         }
         else {
             if (laik_logprefix == 1)
-                off2 += sprintf(buf2+off2, "L%02d | ", laik_loginst->mylocationid);
+                off2 += sprintf(buf2+off2, "L%02d | ", lid);
             else if (laik_logprefix == 2)
                 off2 += sprintf(buf2+off2,
                                 "LAIK-%04d-L%02d %04d.%02d %2d:%06.3f | ",
-                                laik_logctr, laik_loginst->mylocationid,
+                                logctr, lid,
                                 counter, line_counter,
                                 wtime_min, wtime_s);
         }
@@ -362,36 +427,58 @@ void log_flush()
         // TODO: allow to go to debug file
         fprintf(stderr, "%s", buf2);
     }
-    current_logPos = 0;
+    t->pos = 0;
 
     // stop program on panic with failed assertion
-    if (current_logLevel == LAIK_LL_Panic) assert(0);
+    if (level == LAIK_LL_Panic) assert(0);
+}
+
+static
+void log_flush()
+{
+    if (current_logLevel == LAIK_LL_None) return;
+    int level = current_logLevel;
+    // appending requires a new laik_log_begin
+    current_logLevel = LAIK_LL_None;
+    if ((current_logText.pos == 0) || (current_logText.buf == 0)) return;
+
+    log_output(&current_logText, level, log_wtime(), laik_logctr,
+               laik_loginst ? laik_loginst->mylocationid : -1);
 }
 
 void laik_log_flush(const char* msg, ...)
 {
     if (current_logLevel == LAIK_LL_None) return;
 
-    if (msg) {
-        va_list args;
-        va_start(args, msg);
-        log_append(msg, args);
-        va_end(args);
+    va_list args;
+    va_start(args, msg);
+    if (laik_log_binary) {
+        bin_record(current_logLevel, msg, args);
+        current_logLevel = LAIK_LL_None;
     }
-
-    log_flush();
+    else {
+        if (msg)
+            log_append(&current_logText, msg, args);
+        log_flush();
+    }
+    va_end(args);
 }
 
-void laik_log(int l, const char* msg, ...)
+void (laik_log)(int l, const char* msg, ...)
 {
-    if (!laik_log_begin(l)) return;
+    if (!(laik_log_begin)(l)) return;
 
     va_list args;
     va_start(args, msg);
-    log_append(msg, args);
+    if (laik_log_binary) {
+        bin_record(l, msg, args);
+        current_logLevel = LAIK_LL_None;
+    }
+    else {
+        log_append(&current_logText, msg, args);
+        log_flush();
+    }
     va_end(args);
-
-    log_flush();
 }
 
 // panic: terminate application
@@ -399,3 +486,377 @@ void laik_panic(const char* msg)
 {
     laik_log(LAIK_LL_Panic, "%s", msg);
 }
+
+
+/* Binary log mode (LAIK_LOG=b<level>)
+ *
+ * Formatting log messages is expensive. In binary mode, only the pointer
+ * to the format string and the raw arguments (with strings copied) are
+ * recorded into a per-thread buffer (size LAIK_LOG_BUFSIZE bytes). Full
+ * buffers are handed over to a background thread which formats and prints
+ * the messages. Errors and cleanup/exit print all pending messages
+ * synchronously. Format strings must be static (literals).
+*/
+
+// recording buffer of one thread
+typedef struct _Laik_LogBuffer {
+    char* buf;
+    int size, used;
+    int done; // end of last complete message
+    struct _Laik_LogBuffer* next; // list of all buffers
+} Laik_LogBuffer;
+
+// full buffer queued for the writer thread
+typedef struct _Laik_LogQueued {
+    char* buf;
+    int used;
+    struct _Laik_LogQueued* next;
+} Laik_LogQueued;
+
+// recorded part of a message, followed by the raw arguments
+typedef struct _Laik_LogRecord {
+    int size;        // including header and arguments
+    int level;       // LAIK_LL_None: message continues in next record
+    int logctr, lid; // for prefix
+    double wtime;    // time of recording
+    const char* fmt; // may be 0
+} Laik_LogRecord;
+
+// argument classes of conversion specifications
+enum { LA_None = 0, LA_Int, LA_Long, LA_LLong, LA_Size, LA_Ptrdiff,
+       LA_Double, LA_LDouble, LA_Str, LA_Ptr };
+
+// maximum number of full buffers waiting for the writer thread
+#define LOG_MAX_QUEUED 4
+
+static __thread Laik_LogBuffer* bin_buf = 0;
+static Laik_LogBuffer* bin_buflist = 0;
+// serializes formatting/output, protects bin_text
+static pthread_mutex_t bin_mutex = PTHREAD_MUTEX_INITIALIZER;
+// message being formatted, separate from state of recording threads
+static Laik_LogText bin_text = { 0, 0, 0 };
+// queue for writer thread, protected by bin_qmutex
+static pthread_mutex_t bin_qmutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t bin_qcond = PTHREAD_COND_INITIALIZER;
+static Laik_LogQueued *bin_qhead = 0, *bin_qtail = 0;
+static int bin_queued = 0;       // including the one being written
+static bool bin_writer_started = false;
+
+// parse conversion specification starting behind '%' in <f>, return
+// pointer behind it. Sets argument class, number of '*' arguments and
+// precision (-1: none, -2: given by last '*' argument)
+static const char* parse_spec(const char* f, int* cls, int* stars, int* prec)
+{
+    *cls = LA_None;
+    *stars = 0;
+    *prec = -1;
+    if (*f == '%') return f + 1;
+
+    while(*f && strchr("-+ #0'", *f)) f++;
+    if (*f == '*') { (*stars)++; f++; }
+    else while((*f >= '0') && (*f <= '9')) f++;
+    if (*f == '.') {
+        f++;
+        if (*f == '*') { (*stars)++; *prec = -2; f++; }
+        else *prec = atoi(f);
+        while((*f >= '0') && (*f <= '9')) f++;
+    }
+
+    int len = LA_Int;
+    switch(*f) {
+    case 'h': f++; if (*f == 'h') f++; break;
+    case 'l': f++; len = LA_Long; if (*f == 'l') { f++; len = LA_LLong; } break;
+    case 'q': case 'j': f++; len = LA_LLong; break;
+    case 'z': f++; len = LA_Size; break;
+    case 't': f++; len = LA_Ptrdiff; break;
+    case 'L': f++; len = LA_LDouble; break;
+    default: break;
+    }
+
+    switch(*f) {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+        *cls = (len == LA_LDouble) ? LA_LLong : len; break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G':
+    case 'a': case 'A':
+        *cls = (len == LA_LDouble) ? LA_LDouble : LA_Double; break;
+    case 's': *cls = LA_Str; break;
+    case 'p': *cls = LA_Ptr; break;
+    default: return f; // unsupported: printed as is
+    }
+    return f + 1;
+}
+
+// store arguments for format <f> into <out>, return size needed.
+// Only calculates the size if <out> is 0
+static int bin_args(const char* f, va_list ap, char* out)
+{
+#define PUT(ptr, n) \
+    do { if (out) memcpy(out + size, ptr, n); size += (n); } while(0)
+
+    int size = 0;
+    while((f = strchr(f, '%')) != 0) {
+        int cls, stars, prec;
+        f = parse_spec(f + 1, &cls, &stars, &prec);
+        for(int i = 0; i < stars; i++) {
+            int v = va_arg(ap, int);
+            if ((prec == -2) && (i == stars - 1)) prec = v;
+            PUT(&v, sizeof(int));
+        }
+        switch(cls) {
+        case LA_Int:     { int v = va_arg(ap, int); PUT(&v, sizeof(v)); break; }
+        case LA_Long:    { long v = va_arg(ap, long); PUT(&v, sizeof(v)); break; }
+        case LA_LLong:   { long long v = va_arg(ap, long long); PUT(&v, sizeof(v)); break; }
+        case LA_Size:    { size_t v = va_arg(ap, size_t); PUT(&v, sizeof(v)); break; }
+        case LA_Ptrdiff: { ptrdiff_t v = va_arg(ap, ptrdiff_t); PUT(&v, sizeof(v)); break; }
+        case LA_Double:  { double v = va_arg(ap, double); PUT(&v, sizeof(v)); break; }
+        case LA_LDouble: { long double v = va_arg(ap, long double); PUT(&v, sizeof(v)); break; }
+        case LA_Ptr:     { void* v = va_arg(ap, void*); PUT(&v, sizeof(v)); break; }
+        case LA_Str: {
+            // copy string, respecting precision (may not be 0-terminated)
+            const char* v = va_arg(ap, const char*);
+            if (!v) v = "(null)";
+            int len = (prec >= 0) ? (int) strnlen(v, prec) : (int) strlen(v);
+            PUT(v, len);
+            PUT("", 1);
+            break;
+        }
+        default: break;
+        }
+    }
+    return size;
+#undef PUT
+}
+
+// append message text of format <f> with arguments stored at <args> to <t>
+static void bin_format(Laik_LogText* t, const char* f, const char* args)
+{
+#define GET(v) do { memcpy(&v, args, sizeof(v)); args += sizeof(v); } while(0)
+#define OUT(v) \
+    do { if (stars == 0) log_appendf(t, spec, v); \
+         else if (stars == 1) log_appendf(t, spec, sv[0], v); \
+         else log_appendf(t, spec, sv[0], sv[1], v); } while(0)
+
+    while(*f) {
+        const char* pct = strchr(f, '%');
+        if (!pct) {
+            log_appendn(t, f, strlen(f));
+            break;
+        }
+        if (pct > f)
+            log_appendn(t, f, pct - f);
+
+        int cls, stars, prec;
+        f = parse_spec(pct + 1, &cls, &stars, &prec);
+        char spec[32];
+        int len = f - pct;
+        if (len > 31) len = 31;
+        memcpy(spec, pct, len);
+        spec[len] = 0;
+        int sv[2] = {0, 0};
+        for(int i = 0; i < stars; i++)
+            GET(sv[i]);
+
+        switch(cls) {
+        case LA_Int:     { int v; GET(v); OUT(v); break; }
+        case LA_Long:    { long v; GET(v); OUT(v); break; }
+        case LA_LLong:   { long long v; GET(v); OUT(v); break; }
+        case LA_Size:    { size_t v; GET(v); OUT(v); break; }
+        case LA_Ptrdiff: { ptrdiff_t v; GET(v); OUT(v); break; }
+        case LA_Double:  { double v; GET(v); OUT(v); break; }
+        case LA_LDouble: { long double v; GET(v); OUT(v); break; }
+        case LA_Ptr:     { void* v; GET(v); OUT(v); break; }
+        case LA_Str: {
+            const char* v = args;
+            int slen = strlen(v);
+            args += slen + 1;
+            if (len == 2) // plain "%s"
+                log_appendn(t, v, slen);
+            else
+                OUT(v);
+            break;
+        }
+        default:
+            if (strcmp(spec, "%%") == 0)
+                log_appendn(t, "%", 1);
+            else
+                log_appendn(t, spec, len);
+            break;
+        }
+    }
+#undef GET
+#undef OUT
+}
+
+// format and print complete messages in <buf>, return end of last one
+static int bin_output(char* buf, int used)
+{
+    pthread_mutex_lock(&bin_mutex);
+
+    log_reset(&bin_text);
+    int off = 0, done = 0;
+    while(off < used) {
+        Laik_LogRecord r;
+        memcpy(&r, buf + off, sizeof(r));
+        if (r.fmt)
+            bin_format(&bin_text, r.fmt, buf + off + sizeof(r));
+        off += r.size;
+        if (r.level != LAIK_LL_None) {
+            if (bin_text.pos > 0)
+                log_output(&bin_text, r.level, r.wtime, r.logctr, r.lid);
+            log_reset(&bin_text);
+            done = off;
+        }
+    }
+
+    pthread_mutex_unlock(&bin_mutex);
+    return done;
+}
+
+// background thread printing queued buffers
+static void* bin_writer(void* arg)
+{
+    (void) arg;
+    pthread_mutex_lock(&bin_qmutex);
+    while(1) {
+        while(bin_qhead == 0)
+            pthread_cond_wait(&bin_qcond, &bin_qmutex);
+        Laik_LogQueued* q = bin_qhead;
+        pthread_mutex_unlock(&bin_qmutex);
+
+        bin_output(q->buf, q->used);
+
+        pthread_mutex_lock(&bin_qmutex);
+        bin_qhead = q->next;
+        if (bin_qhead == 0) bin_qtail = 0;
+        bin_queued--;
+        pthread_cond_broadcast(&bin_qcond);
+        free(q->buf);
+        free(q);
+    }
+    return 0;
+}
+
+// hand over complete messages in <b> to writer thread
+static void bin_handoff(Laik_LogBuffer* b)
+{
+    // keep unfinished message in new buffer
+    char* buf = malloc(b->size);
+    assert(buf); // cannot call laik_panic
+    memcpy(buf, b->buf + b->done, b->used - b->done);
+
+    Laik_LogQueued* q = malloc(sizeof(Laik_LogQueued));
+    assert(q);
+    q->buf = b->buf;
+    q->used = b->done;
+    q->next = 0;
+    b->buf = buf;
+    b->used -= b->done;
+    b->done = 0;
+
+    pthread_mutex_lock(&bin_qmutex);
+    if (!bin_writer_started) {
+        pthread_t t;
+        if (pthread_create(&t, 0, bin_writer, 0) == 0) {
+            pthread_detach(t);
+            bin_writer_started = true;
+        }
+    }
+    if (!bin_writer_started) {
+        // fallback: print synchronously
+        pthread_mutex_unlock(&bin_qmutex);
+        bin_output(q->buf, q->used);
+        free(q->buf);
+        free(q);
+        return;
+    }
+    // limit memory usage if writer is too slow
+    while(bin_queued >= LOG_MAX_QUEUED)
+        pthread_cond_wait(&bin_qcond, &bin_qmutex);
+    if (bin_qtail)
+        bin_qtail->next = q;
+    else
+        bin_qhead = q;
+    bin_qtail = q;
+    bin_queued++;
+    pthread_cond_broadcast(&bin_qcond);
+    pthread_mutex_unlock(&bin_qmutex);
+}
+
+// print complete messages in <b> after all queued ones
+static void bin_dump(Laik_LogBuffer* b)
+{
+    pthread_mutex_lock(&bin_qmutex);
+    while(bin_queued > 0)
+        pthread_cond_wait(&bin_qcond, &bin_qmutex);
+    pthread_mutex_unlock(&bin_qmutex);
+
+    int done = bin_output(b->buf, b->used);
+    assert(done == b->done);
+    memmove(b->buf, b->buf + done, b->used - done);
+    b->used -= done;
+    b->done = 0;
+}
+
+// print pending messages of all threads, called at cleanup/exit
+static void bin_dump_all(void)
+{
+    for(Laik_LogBuffer* b = bin_buflist; b; b = b->next)
+        bin_dump(b);
+}
+
+// record part of a message, <level> only given for its last part
+static void bin_record(int level, const char* format, va_list ap)
+{
+    Laik_LogBuffer* b = bin_buf;
+    if (!b) {
+        b = malloc(sizeof(Laik_LogBuffer));
+        assert(b); // cannot call laik_panic
+        b->size = laik_log_bufsize;
+        b->buf = malloc(b->size);
+        assert(b->buf);
+        b->used = 0;
+        b->done = 0;
+        pthread_mutex_lock(&bin_mutex);
+        b->next = bin_buflist;
+        bin_buflist = b;
+        pthread_mutex_unlock(&bin_mutex);
+        bin_buf = b;
+    }
+
+    int size = sizeof(Laik_LogRecord);
+    if (format) {
+        va_list ap2;
+        va_copy(ap2, ap);
+        size += bin_args(format, ap2, 0);
+        va_end(ap2);
+    }
+    if (b->used + size > b->size) {
+        if (b->done > 0)
+            bin_handoff(b);
+        if (b->used + size > b->size) {
+            // unfinished message with large parts: enlarge
+            b->size = 2 * (b->used + size);
+            b->buf = realloc(b->buf, b->size);
+            assert(b->buf);
+        }
+    }
+
+    Laik_LogRecord r;
+    r.size = size;
+    r.level = level;
+    r.logctr = laik_logctr;
+    r.lid = laik_loginst ? laik_loginst->mylocationid : -1;
+    r.wtime = (level != LAIK_LL_None) ? log_wtime() : 0.0;
+    r.fmt = format;
+    char* p = b->buf + b->used;
+    memcpy(p, &r, sizeof(r));
+    if (format)
+        bin_args(format, ap, p + sizeof(r));
+    b->used += size;
+    if (level != LAIK_LL_None)
+        b->done = b->used;
+
+    // show errors immediately
+    if (level >= LAIK_LL_Error)
+        bin_dump(b);
+}
@@ -19,6 +19,7 @@
 
 #include <assert.h>
 #include <stdint.h>
+#include <string.h>
 
 
 //
@@ -41,6 +42,7 @@ Laik_Partitioner* laik_new_partitioner(const char* name,
     pr->run = run;
     pr->flags = flags;
     pr->data = d;
+    pr->cacheKey = 0;
 
     return pr;
 }
@@ -51,6 +53,13 @@ void* laik_partitioner_data(Laik_Partitioner* partitioner)
     return partitioner->data;
 }
 
+// public: set key for partitioner parameters unknown to LAIK, such as
+// weights returned by getter functions or custom data (0 to unset)
+void laik_partitioner_set_cachekey(Laik_Partitioner* pr, uint64_t key)
+{
+    pr->cacheKey = key;
+}
+
 
 // running a partitioner
 
@@ -71,11 +80,15 @@ Laik_RangeList* laik_run_partitioner(Laik_PartitionerParams* params,
     r.params = params;
     r.list = array;
     r.filter = filter;
+    r.otherList = 0;
 
     Laik_Partitioner* pr = params->partitioner;
 
     (pr->run)(&r, params);
 
+    if (r.otherList)
+        laik_rangelist_free(r.otherList);
+
     bool doMerge = (pr->flags & LAIK_PF_Merge) > 0;
     laik_rangelist_freeze(array, doMerge);
 
@@ -143,6 +156,48 @@ void laik_append_index_1d(Laik_RangeReceiver* r, int task, int64_t idx)
     laik_rangelist_append_single1d(r->list, task, idx);
 }
 
+// partitioner API: may ranges of tasks [fromTask;toTask[ within <s> be stored?
+bool laik_rangereceiver_wants(Laik_RangeReceiver* r,
+                              int fromTask, int toTask, const Laik_Range* s)
+{
+    if (r->filter == 0) return true;
+    return laik_rangefilter_check(r->filter, fromTask, toTask, s);
+}
+
+// partitioner API: ranges of base partitioning required to derive ranges
+// wanted in this run. If the base partitioning does not store all ranges,
+// run its partitioner with our filter enlarged by <reach>
+Laik_RangeList* laik_partitioner_otherranges(Laik_RangeReceiver* r, int reach)
+{
+    Laik_Partitioning* other = r->params->other;
+    assert(other != 0);
+
+    Laik_RangeList* list = laik_partitioning_allranges(other);
+    if (list) return list;
+    if (r->otherList) return r->otherList;
+
+    if (other->partitioner == 0) {
+        laik_log(LAIK_LL_Panic,
+                 "partitioner '%s' needs ranges of base partitioning '%s'",
+                 r->params->partitioner->name, other->name);
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    if (r->filter == 0) {
+        // all ranges wanted: also need all base ranges
+        laik_partitioning_store_allranges(other);
+        return laik_partitioning_allranges(other);
+    }
+
+    Laik_RangeFilter* sf = laik_rangefilter_enlarged(r->filter, reach);
+    r->otherList = laik_partitioning_calc_ranges(other, sf);
+    laik_rangefilter_free(sf);
+
+    laik_log(1, "partitioner '%s': calculated %d ranges of base '%s'",
+             r->params->partitioner->name, r->otherList->count, other->name);
+
+    return r->otherList;
+}
+
 
 
 
@@ -232,20 +287,22 @@ Laik_Partitioner* laik_new_copy_partitioner(int fromDim, int toDim)
 
 // corner-halo partitioner: extend borders of other partitioning
 //  including corners - e.g. for 9-point 2d stencil
-void runCornerHaloPartitioner(Laik_RangeReceiver* r, Laik_PartitionerParams* p)
+
+// helper for corner-halo and deep-halo partitioner: extend by depth <d>
+static void appendCornerHalos(Laik_RangeReceiver* r, Laik_PartitionerParams* p,
+                              int d)
 {
     Laik_Partitioning* other = p->other;
     assert(other->group == p->group); // must use same task group
     assert(other->space == p->space);
 
     int dims = p->space->dims;
-    int d = *((int*) p->partitioner->data);
 
     // take all ranges and extend them if possible
-    int count = laik_partitioning_rangecount(other);
-    for(int i = 0; i < count; i++) {
-        Laik_TaskRange* ts = laik_partitioning_get_taskrange(other, i);
-        const Laik_Range* s = laik_taskrange_get_range(ts);
+    Laik_RangeList* list = laik_partitioner_otherranges(r, d);
+    for(unsigned int i = 0; i < list->count; i++) {
+        Laik_TaskRange_Gen* ts = laik_rangelist_trange(list, i);
+        const Laik_Range* s = &(ts->range);
         const Laik_Index* from = &(s->from);
         const Laik_Index* to = &(s->to);
         Laik_Range range = p->space->range;
@@ -268,11 +325,15 @@ void runCornerHaloPartitioner(Laik_RangeReceiver* r, Laik_PartitionerParams* p)
                     range.to.i[2] = to->i[2] + d;
             }
         }
-        laik_append_range(r, laik_taskrange_get_task(ts), &range,
-                          laik_taskrange_get_tag(ts), 0);
+        laik_append_range(r, ts->task, &range, ts->tag, 0);
     }
 }
 
+void runCornerHaloPartitioner(Laik_RangeReceiver* r, Laik_PartitionerParams* p)
+{
+    appendCornerHalos(r, p, *((int*) p->partitioner->data));
+}
+
 Laik_Partitioner* laik_new_cornerhalo_partitioner(int depth)
 {
     int* data = malloc(sizeof(int));
@@ -284,6 +345,65 @@ Laik_Partitioner* laik_new_cornerhalo_partitioner(int depth)
 }
 
 
+// deep-halo partitioner: corner halos of depth <radius> * <steps>, for
+// communication-avoiding stencil codes. After a halo exchange, <steps>
+// iterations of a stencil with given radius can be done without further
+// communication, updating a range shrinking by the radius in each step
+// (redundant computation of values owned by neighbors)
+
+typedef struct _Laik_DeepHaloPartitionerData {
+    int depth; // must be first: same as corner-halo partitioner
+    int radius, steps;
+} Laik_DeepHaloPartitionerData;
+
+void runDeepHaloPartitioner(Laik_RangeReceiver* r, Laik_PartitionerParams* p)
+{
+    Laik_DeepHaloPartitionerData* data;
+    data = (Laik_DeepHaloPartitionerData*) p->partitioner->data;
+    appendCornerHalos(r, p, data->depth);
+}
+
+Laik_Partitioner* laik_new_deephalo_partitioner(int radius, int steps)
+{
+    assert((radius > 0) && (steps > 0));
+    Laik_DeepHaloPartitionerData* data;
+    data = malloc(sizeof(Laik_DeepHaloPartitionerData));
+    assert(data);
+    data->depth = radius * steps;
+    data->radius = radius;
+    data->steps = steps;
+
+    return laik_new_partitioner("deephalo", runDeepHaloPartitioner, data, 0);
+}
+
+bool laik_deephalo_range(Laik_Partitioning* p, int n, int step,
+                         Laik_Range* range)
+{
+    assert(p->partitioner && (p->partitioner->run == runDeepHaloPartitioner));
+    Laik_DeepHaloPartitionerData* data;
+    data = (Laik_DeepHaloPartitionerData*) p->partitioner->data;
+    assert((step >= 0) && (step < data->steps));
+
+    Laik_TaskRange* tr = laik_my_range(p, n);
+    if (!tr) return false;
+    *range = *laik_taskrange_get_range(tr);
+
+    // halo borders become invalid by stencil radius per step; at space
+    // borders, values stay valid (fixed boundary)
+    Laik_Range* sp = &(p->space->range);
+    int64_t shrink = (int64_t) data->radius * (step + 1);
+    for(int d = 0; d < p->space->dims; d++) {
+        if (range->from.i[d] > sp->from.i[d])
+            range->from.i[d] += shrink;
+        if (range->to.i[d] < sp->to.i[d])
+            range->to.i[d] -= shrink;
+        if (range->to.i[d] < range->from.i[d])
+            range->to.i[d] = range->from.i[d];
+    }
+    return true;
+}
+
+
 // halo partitioner: extend borders of another partitioning
 // excluding corners, e.g. for 5-point 2d stencil.
 // this creates multiple ranges for each original range, and uses tags
@@ -301,12 +421,12 @@ void runHaloPartitioner(Laik_RangeReceiver* r, Laik_PartitionerParams* p)
     Laik_Range sp = p->space->range;
 
     // take all ranges and extend them if possible
-    int count = laik_partitioning_rangecount(other);
-    for(int i = 0; i < count; i++) {
-        Laik_TaskRange* ts = laik_partitioning_get_taskrange(other, i);
-        const Laik_Range* s = laik_taskrange_get_range(ts);
-        int task = laik_taskrange_get_task(ts);
-        int tag = laik_taskrange_get_tag(ts);
+    Laik_RangeList* list = laik_partitioner_otherranges(r, depth);
+    for(unsigned int i = 0; i < list->count; i++) {
+        Laik_TaskRange_Gen* ts = laik_rangelist_trange(list, i);
+        const Laik_Range* s = &(ts->range);
+        int task = ts->task;
+        int tag = ts->tag;
         assert(tag > 0); // tag must be >0 to specify range groups
 
         Laik_Range range = *s;
@@ -375,6 +495,9 @@ static void doBisection(Laik_RangeReceiver* r, Laik_PartitionerParams* p,
     int tag = 1; // TODO: make it a parameter
 
     assert(toTask > fromTask);
+    // skip if no range of this sub-tree would be stored
+    if (!laik_rangereceiver_wants(r, fromTask, toTask, s)) return;
+
     if (toTask - fromTask == 1) {
         laik_append_range(r, fromTask, s, tag, 0);
         return;
@@ -449,10 +572,18 @@ void runGridPartitioner(Laik_RangeReceiver* r, Laik_PartitionerParams* p)
     double yStep = (ss->to.i[1] - ss->from.i[1]) / (double) data->yblocks;
     double zStep = (ss->to.i[2] - ss->from.i[2]) / (double) data->zblocks;
 
-    Laik_Range range;
+    // tasks are numbered along non-empty blocks, x first
+    int xUsed = 0, yUsed = 0;
+    for(int x = 0; x < data->xblocks; x++)
+        if ((int64_t)(ss->from.i[0] + x * xStep) !=
+            (int64_t)(ss->from.i[0] + (x+1) * xStep)) xUsed++;
+    for(int y = 0; y < data->yblocks; y++)
+        if ((int64_t)(ss->from.i[1] + y * yStep) !=
+            (int64_t)(ss->from.i[1] + (y+1) * yStep)) yUsed++;
+
+    Laik_Range range = *ss;
     int64_t from, to;
 
-    range.space = p->space;
     int task = 0;
     for(int z = 0; z < data->zblocks; z++) {
         from = ss->from.i[2] + z * zStep;
@@ -462,6 +593,19 @@ void runGridPartitioner(Laik_RangeReceiver* r, Laik_PartitionerParams* p)
         range.from.i[2] = from;
         range.to.i[2]   = to;
 
+        // skip slab if none of its ranges is wanted
+        range.from.i[1] = ss->from.i[1];
+        range.to.i[1]   = ss->to.i[1];
+        range.from.i[0] = ss->from.i[0];
+        range.to.i[0]   = ss->to.i[0];
+        int toTask = task + xUsed * yUsed;
+        if (toTask > p->group->size) toTask = p->group->size;
+        if (!laik_rangereceiver_wants(r, task, toTask, &range)) {
+            task = toTask;
+            if (task == p->group->size) return;
+            continue;
+        }
+
         for(int y = 0; y < data->yblocks; y++) {
             from = ss->from.i[1] + y * yStep;
             to   = ss->from.i[1] + (y+1) * yStep;
@@ -470,6 +614,17 @@ void runGridPartitioner(Laik_RangeReceiver* r, Laik_PartitionerParams* p)
             range.from.i[1] = from;
             range.to.i[1]   = to;
 
+            // same for row
+            range.from.i[0] = ss->from.i[0];
+            range.to.i[0]   = ss->to.i[0];
+            toTask = task + xUsed;
+            if (toTask > p->group->size) toTask = p->group->size;
+            if (!laik_rangereceiver_wants(r, task, toTask, &range)) {
+                task = toTask;
+                if (task == p->group->size) return;
+                continue;
+            }
+
             for(int x = 0; x < data->xblocks; x++) {
                 from = ss->from.i[0] + x * xStep;
                 to   = ss->from.i[0] + (x+1) * xStep;
@@ -529,6 +684,42 @@ struct _Laik_BlockPartitionerData {
     const void* userData;
 };
 
+// offset of block <k> when splitting <size> indexes into <parts> blocks:
+// k * size / parts, rounded to nearest (exact, avoiding overflow)
+static int64_t blockStart(int64_t size, int parts, int k)
+{
+    int64_t q = size / parts, rem = size % parts;
+    int64_t n = 2 * (int64_t) k * rem - parts;
+    int64_t c = (n <= 0) ? 0 : (n + 2 * (int64_t) parts - 1) / (2 * (int64_t) parts);
+    return k * q + c;
+}
+
+// without weights: ranges of tasks [fromTask;toTask[ in cycle <cycle>
+// are consecutive. Recursively split, skipping tasks not wanted
+static void doBlocks(Laik_RangeReceiver* r, Laik_PartitionerParams* p,
+                     int pdim, int cycle, int fromTask, int toTask)
+{
+    Laik_Range range = p->space->range;
+    int64_t size = range.to.i[pdim] - range.from.i[pdim];
+    int count = p->group->size;
+    int parts = count * ((Laik_BlockPartitionerData*) p->partitioner->data)->cycles;
+
+    int64_t from = blockStart(size, parts, cycle * count + fromTask);
+    int64_t to = blockStart(size, parts, cycle * count + toTask);
+    if (from == to) return;
+    range.to.i[pdim] = range.from.i[pdim] + to;
+    range.from.i[pdim] += from;
+    if (!laik_rangereceiver_wants(r, fromTask, toTask, &range)) return;
+
+    if (toTask - fromTask == 1) {
+        laik_append_range(r, fromTask, &range, 0, 0);
+        return;
+    }
+    int midTask = (fromTask + toTask) / 2;
+    doBlocks(r, p, pdim, cycle, fromTask, midTask);
+    doBlocks(r, p, pdim, cycle, midTask, toTask);
+}
+
 void runBlockPartitioner(Laik_RangeReceiver* r, Laik_PartitionerParams* p)
 {
     Laik_BlockPartitionerData* data;
@@ -542,6 +733,13 @@ void runBlockPartitioner(Laik_RangeReceiver* r, Laik_PartitionerParams* p)
     int64_t size = s->range.to.i[pdim] - s->range.from.i[pdim];
     assert(size > 0);
 
+    if ((data->getIdxW == 0) && (data->getTaskW == 0)) {
+        // block borders can be calculated for each task
+        for(int cycle = 0; cycle < data->cycles; cycle++)
+            doBlocks(r, p, pdim, cycle, 0, count);
+        return;
+    }
+
     Laik_Index idx;
     double totalW;
     if (data && data->getIdxW) {
@@ -705,9 +903,278 @@ typedef struct {
 
     Laik_GetIdxWeight_t getIdxW; // application-specified weights
     const void* userData;
+
+    // adjacent mode: give indexes to tasks owning neighbor ranges
+    bool adjacent;
 } ReassignData;
 
+// weight of all indexes in a range
+static double reassignWeight(ReassignData* data, const Laik_Range* r)
+{
+    if (!data->getIdxW)
+        return (double) laik_range_size(r);
+
+    int dims = r->space->dims;
+    Laik_Index idx;
+    double w = 0.0;
+    laik_index_init(&idx, 0, 0, 0);
+    int64_t zfrom = (dims > 2) ? r->from.i[2] : 0;
+    int64_t zto   = (dims > 2) ? r->to.i[2] : 1;
+    int64_t yfrom = (dims > 1) ? r->from.i[1] : 0;
+    int64_t yto   = (dims > 1) ? r->to.i[1] : 1;
+    for(idx.i[2] = zfrom; idx.i[2] < zto; idx.i[2]++)
+        for(idx.i[1] = yfrom; idx.i[1] < yto; idx.i[1]++)
+            for(idx.i[0] = r->from.i[0]; idx.i[0] < r->to.i[0]; idx.i[0]++)
+                w += (data->getIdxW)(&idx, data->userData);
+    return w;
+}
+
+// a range of the partitioning under construction
+typedef struct {
+    Laik_Range r;
+    int task;    // task in parent group, -1: still to be reassigned
+} ReassignBox;
+
+// does <b> touch <r> at side <right> of dimension <dim>?
+// with <fullFace>, the union of both must be a range again
+static bool reassignTouches(const Laik_Range* b, const Laik_Range* r,
+                            int dims, int dim, bool right, bool fullFace)
+{
+    if (right) {
+        if (b->from.i[dim] != r->to.i[dim]) return false;
+    }
+    else {
+        if (b->to.i[dim] != r->from.i[dim]) return false;
+    }
+    for(int e = 0; e < dims; e++) {
+        if (e == dim) continue;
+        if (fullFace) {
+            if ((b->from.i[e] != r->from.i[e]) || (b->to.i[e] != r->to.i[e]))
+                return false;
+        }
+        else if ((b->from.i[e] >= r->to.i[e]) || (r->from.i[e] >= b->to.i[e]))
+            return false;
+    }
+    return true;
+}
+
+// accumulated weight of current ranges of a task, calculated on first use
+static double reassignTaskWeight(ReassignData* data, double* taskW,
+                                 ReassignBox* box, int boxCount, int task)
+{
+    if (taskW[task] >= 0.0) return taskW[task];
+
+    double w = 0.0;
+    for(int i = 0; i < boxCount; i++)
+        if (box[i].task == task)
+            w += reassignWeight(data, &(box[i].r));
+    taskW[task] = w;
+    return w;
+}
+
+// split range <r> in dimension <dim> at an index such that the weights
+// <wl> (adding the lower part) and <wr> (adding the upper part) get balanced.
+// uses a prefix sum over the weights of slices orthogonal to <dim>.
+// returns split index, stores weight of lower part into <lowW>
+static int64_t reassignSplit(ReassignData* data, const Laik_Range* r, int dim,
+                             double wl, double wr, double* lowW)
+{
+    int64_t len = r->to.i[dim] - r->from.i[dim];
+    double* psum = malloc((len + 1) * sizeof(double));
+    if (!psum) {
+        laik_panic("Out of memory in reassign partitioner");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    Laik_Range slice = *r;
+    psum[0] = 0.0;
+    for(int64_t k = 0; k < len; k++) {
+        double w;
+        if (data->getIdxW) {
+            slice.from.i[dim] = r->from.i[dim] + k;
+            slice.to.i[dim] = r->from.i[dim] + k + 1;
+            w = reassignWeight(data, &slice);
+        }
+        else
+            w = (double) (laik_range_size(r) / len);
+        psum[k + 1] = psum[k] + w;
+    }
 
+    // lower part should get weight (total + wr - wl) / 2
+    double target = (psum[len] + wr - wl) / 2.0;
+    int64_t lo = 0, hi = len;
+    while(lo < hi) {
+        int64_t mid = (lo + hi) / 2;
+        if (psum[mid] < target) lo = mid + 1;
+        else hi = mid;
+    }
+    if ((lo > 0) && (target - psum[lo - 1] < psum[lo] - target))
+        lo--;
+
+    *lowW = psum[lo];
+    free(psum);
+    return r->from.i[dim] + lo;
+}
+
+// reassign ranges of removed tasks to tasks owning adjacent ranges.
+// ranges of remaining tasks are kept (no data of these has to migrate),
+// but get enlarged by merging (parts of) removed ranges into them.
+// if a removed range has neighbors on both sides of one dimension
+// with same extension in all other dimensions, it is split between them
+// to balance their weights
+static void runReassignAdjacent(Laik_RangeReceiver* rr,
+                                Laik_PartitionerParams* p,
+                                ReassignData* data)
+{
+    Laik_Group* newg = data->newg;
+    Laik_Partitioning* oldP = p->other;
+    int dims = p->space->dims;
+    int boxCount = laik_partitioning_rangecount(oldP);
+
+    // at most one additional box per removed range for fallback assignments
+    ReassignBox* box = malloc(2 * boxCount * sizeof(ReassignBox));
+    double* taskW = malloc(oldP->group->size * sizeof(double));
+    if (!box || !taskW) {
+        laik_panic("Out of memory in reassign partitioner");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    for(int t = 0; t < oldP->group->size; t++)
+        taskW[t] = -1.0;
+
+    int todo = 0;
+    for(int i = 0; i < boxCount; i++) {
+        Laik_TaskRange* ts = laik_partitioning_get_taskrange(oldP, i);
+        int task = laik_taskrange_get_task(ts);
+        box[i].r = *laik_taskrange_get_range(ts);
+        box[i].task = (newg->fromParent[task] >= 0) ? task : -1;
+        if (box[i].task >= 0) continue;
+        if (laik_range_isEmpty(&(box[i].r)))
+            box[i].task = -2;
+        else
+            todo++;
+    }
+    int origCount = boxCount;
+
+    while(todo > 0) {
+        bool progress = false;
+        for(int i = 0; i < origCount; i++) {
+            if (box[i].task != -1) continue;
+            Laik_Range* r = &(box[i].r);
+
+            // search for full-face neighbors, prefer dimensions with both
+            int bestDim = -1, bestL = -1, bestR = -1;
+            double bestW = 0.0;
+            for(int dim = 0; dim < dims; dim++) {
+                int nl = -1, nr = -1;
+                for(int j = 0; j < boxCount; j++) {
+                    if (box[j].task < 0) continue;
+                    if (reassignTouches(&(box[j].r), r, dims, dim, false, true))
+                        nl = j;
+                    else if (reassignTouches(&(box[j].r), r, dims, dim, true, true))
+                        nr = j;
+                }
+                if ((nl >= 0) && (nr >= 0)) {
+                    bestDim = dim; bestL = nl; bestR = nr;
+                    break;
+                }
+                // single neighbor: take the one with lowest weight
+                int n = (nl >= 0) ? nl : nr;
+                if (n < 0) continue;
+                double w = reassignTaskWeight(data, taskW, box, boxCount,
+                                              box[n].task);
+                if ((bestDim < 0) || (w < bestW)) {
+                    bestDim = dim; bestW = w;
+                    bestL = (nl >= 0) ? nl : -1;
+                    bestR = (nl >= 0) ? -1 : nr;
+                }
+            }
+            if (bestDim < 0) continue;
+
+            int dim = bestDim;
+            if ((bestL >= 0) && (bestR >= 0)) {
+                int tl = box[bestL].task, tr = box[bestR].task;
+                double wl = reassignTaskWeight(data, taskW, box, boxCount, tl);
+                double wr = reassignTaskWeight(data, taskW, box, boxCount, tr);
+                double lowW;
+                int64_t split = reassignSplit(data, r, dim, wl, wr, &lowW);
+                double totalW = reassignWeight(data, r);
+
+                laik_log(1, "reassign: split removed range %d in dim %d at %lld "
+                         "between tasks %d and %d",
+                         i, dim, (long long int) split, tl, tr);
+
+                box[bestL].r.to.i[dim] = split;
+                box[bestR].r.from.i[dim] = split;
+                taskW[tl] += lowW;
+                taskW[tr] += totalW - lowW;
+            }
+            else {
+                int n = (bestL >= 0) ? bestL : bestR;
+                int t = box[n].task;
+                laik_log(1, "reassign: merge removed range %d into range of "
+                         "task %d (dim %d)", i, t, dim);
+
+                reassignTaskWeight(data, taskW, box, boxCount, t);
+                taskW[t] += reassignWeight(data, r);
+                if (bestL >= 0)
+                    box[n].r.to.i[dim] = r->to.i[dim];
+                else
+                    box[n].r.from.i[dim] = r->from.i[dim];
+            }
+            // mark as done by making the range empty
+            box[i].task = -2;
+            r->to.i[0] = r->from.i[0];
+            todo--;
+            progress = true;
+        }
+        if (progress) continue;
+
+        // no full-face neighbor for any removed range: give one range as
+        // separate range to the task with lowest weight, preferring tasks
+        // with touching ranges. It may be a full-face neighbor for others
+        int i, best = -1;
+        double bestW = 0.0;
+        for(i = 0; i < origCount; i++)
+            if (box[i].task == -1) break;
+        assert(i < origCount);
+        for(int pass = 0; (pass < 2) && (best < 0); pass++) {
+            for(int j = 0; j < boxCount; j++) {
+                if (box[j].task < 0) continue;
+                if (pass == 0) {
+                    bool touches = false;
+                    for(int dim = 0; dim < dims; dim++)
+                        if (reassignTouches(&(box[j].r), &(box[i].r), dims, dim, false, false) ||
+                            reassignTouches(&(box[j].r), &(box[i].r), dims, dim, true, false))
+                            touches = true;
+                    if (!touches) continue;
+                }
+                double w = reassignTaskWeight(data, taskW, box, boxCount,
+                                              box[j].task);
+                if ((best < 0) || (w < bestW)) {
+                    best = box[j].task; bestW = w;
+                }
+            }
+        }
+        assert(best >= 0);
+        laik_log(1, "reassign: give removed range %d to task %d", i, best);
+
+        box[boxCount].r = box[i].r;
+        box[boxCount].task = best;
+        taskW[best] += reassignWeight(data, &(box[i].r));
+        boxCount++;
+        box[i].task = -2;
+        box[i].r.to.i[0] = box[i].r.from.i[0];
+        todo--;
+    }
+
+    for(int i = 0; i < boxCount; i++) {
+        if (box[i].task < 0) continue;
+        if (laik_range_isEmpty(&(box[i].r))) continue;
+        laik_append_range(rr, box[i].task, &(box[i].r), 0, 0);
+    }
+    free(box);
+    free(taskW);
+}
 
 void runReassignPartitioner(Laik_RangeReceiver* rr, Laik_PartitionerParams* p)
 {
@@ -719,8 +1186,12 @@ void runReassignPartitioner(Laik_RangeReceiver* rr, Laik_PartitionerParams* p)
     assert(oldP);
     // TODO: only works if parent of new group is used in oldP
     assert(newg->parent == oldP->group);
-    // only 1d for now
-    assert(oldP->space->dims == 1);
+
+    // spreading over all tasks only implemented for 1d
+    if (data->adjacent || (oldP->space->dims > 1)) {
+        runReassignAdjacent(rr, p, data);
+        return;
+    }
 
     // total weight sum of indexes to redistribute
     Laik_Index idx;
@@ -833,7 +1304,60 @@ laik_new_reassign_partitioner(Laik_Group* newg,
     data->newg = newg;
     data->getIdxW = getIdxW;
     data->userData = userData;
+    data->adjacent = false;
 
     return laik_new_partitioner("reassign", runReassignPartitioner,
                                 data, 0);
 }
+
+void laik_set_reassign_adjacent(Laik_Partitioner* pr, bool adjacent)
+{
+    assert(pr->run == runReassignPartitioner);
+
+    ReassignData* data = (ReassignData*) pr->data;
+    data->adjacent = adjacent;
+}
+
+
+// parameter keys for partitioning cache
+
+uint64_t laik_hash64(uint64_t h, const void* d, size_t len)
+{
+    const unsigned char* p = (const unsigned char*) d;
+    for(size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+bool laik_partitioner_paramkey(Laik_Partitioner* pr, uint64_t* key)
+{
+    uint64_t h = laik_hash64(LAIK_HASH64_INIT, pr->name, strlen(pr->name));
+    h = laik_hash64(h, &(pr->cacheKey), sizeof(uint64_t));
+
+    // parameters of LAIK partitioners are known, weights only via user key
+    bool known = true;
+    if (pr->run == runCopyPartitioner)
+        h = laik_hash64(h, pr->data, sizeof(Laik_CopyPartitionerData));
+    else if ((pr->run == runHaloPartitioner) ||
+             (pr->run == runCornerHaloPartitioner))
+        h = laik_hash64(h, pr->data, sizeof(int));
+    else if (pr->run == runDeepHaloPartitioner)
+        h = laik_hash64(h, pr->data, sizeof(Laik_DeepHaloPartitionerData));
+    else if (pr->run == runGridPartitioner)
+        h = laik_hash64(h, pr->data, sizeof(Laik_GridPartitionerData));
+    else if (pr->run == runBlockPartitioner) {
+        Laik_BlockPartitionerData* data = (Laik_BlockPartitionerData*) pr->data;
+        h = laik_hash64(h, &(data->pdim), sizeof(int));
+        h = laik_hash64(h, &(data->cycles), sizeof(int));
+        known = (data->getIdxW == 0) && (data->getTaskW == 0);
+    }
+    else if ((pr->run != runAllPartitioner) &&
+             (pr->run != runMasterPartitioner) &&
+             (pr->run != runBisectionPartitioner))
+        known = false; // custom partitioner or reassign
+
+    *key = h;
+    return known || (pr->cacheKey != 0);
+}
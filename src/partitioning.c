@@ -33,6 +33,11 @@
 #include <assert.h>
 #include <string.h>
 #include <stdio.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 
 /// RangeFilter
@@ -57,10 +62,18 @@ Laik_RangeFilter* laik_rangefilter_new()
     return sf;
 }
 
+// helper for laik_rangefilter_free
+static void pfilter_free(PFilterPar* par)
+{
+    if (par == 0) return;
+    free(par->range);
+    free(par);
+}
+
 void laik_rangefilter_free(Laik_RangeFilter* sf)
 {
-    free(sf->pfilter1);
-    free(sf->pfilter2);
+    pfilter_free(sf->pfilter1);
+    pfilter_free(sf->pfilter2);
     free(sf);
 }
 
@@ -83,60 +96,116 @@ void laik_rangefilter_set_myfilter(Laik_RangeFilter* sf, Laik_Group* g)
 }
 
 
-// helper for laik_rangefilter_set_idxfilter
+// helpers for laik_rangefilter_add_idxfilter
+
+static int pfilter_cmp(const void* p1, const void* p2)
+{
+    const Laik_Range* r1 = (const Laik_Range*) p1;
+    const Laik_Range* r2 = (const Laik_Range*) p2;
+    if (r1->from.i[0] < r2->from.i[0]) return -1;
+    if (r1->from.i[0] > r2->from.i[0]) return 1;
+    return 0;
+}
+
+// create intersection filter parameters from <len> ranges, enlarging
+// them by <reach> in each dimension
+static PFilterPar* pfilter_new(Laik_Range* r, unsigned int len, int reach)
+{
+    assert(len > 0);
+    int dims = r[0].space->dims;
+
+    PFilterPar* par = malloc(sizeof(PFilterPar));
+    Laik_Range* range = malloc(len * sizeof(Laik_Range));
+    if ((par == 0) || (range == 0)) {
+        laik_panic("Out of memory allocating intersection filter");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    for(unsigned int i = 0; i < len; i++) {
+        range[i] = r[i];
+        for(int d = 0; d < dims; d++) {
+            range[i].from.i[d] -= reach;
+            range[i].to.i[d] += reach;
+        }
+    }
+
+    if (dims == 1) {
+        // sort and merge overlapping ranges for binary search
+        qsort(range, len, sizeof(Laik_Range), pfilter_cmp);
+        unsigned int n = 0;
+        for(unsigned int i = 1; i < len; i++) {
+            if (range[i].from.i[0] <= range[n].to.i[0]) {
+                if (range[i].to.i[0] > range[n].to.i[0])
+                    range[n].to.i[0] = range[i].to.i[0];
+                continue;
+            }
+            n++;
+            range[n] = range[i];
+        }
+        len = n + 1;
+    }
+
+    par->range = range;
+    par->len = len;
+    par->iset = 0;
+    par->reach = 0;
+    par->bbox = range[0];
+    for(unsigned int i = 1; i < len; i++)
+        laik_range_expand(&(par->bbox), &(range[i]));
+
+    return par;
+}
+
+// create intersection filter parameters from index set <iset> with <len>
+// runs, enlarging indexes by <reach>. The set is not copied
+static PFilterPar* pfilter_newSI(Laik_Space* space, Laik_IndexSet* iset,
+                                 unsigned int len, int reach)
+{
+    PFilterPar* par = malloc(sizeof(PFilterPar));
+    if (par == 0) {
+        laik_panic("Out of memory allocating intersection filter");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    int64_t from, to;
+    bool notEmpty = laik_indexset_bounds(iset, &from, &to);
+    assert(notEmpty);
+    laik_range_init_1d(&(par->bbox), space, from - reach, to + reach);
+    par->range = 0;
+    par->len = len;
+    par->iset = iset;
+    par->reach = reach;
+    return par;
+}
 
-// check if [from;to[ intersects ranges given in par
-static bool idxfilter_check(int64_t from, int64_t to, PFilterPar* par)
+// check if range <s> intersects ranges given in par
+static bool idxfilter_check(const Laik_Range* s, PFilterPar* par)
 {
-    assert(par->len > 0);
+    if (laik_range_intersect(s, &(par->bbox)) == 0) return false;
 
-    laik_log(1,"  filter [%lld;%lld[ check with range [%lld;%lld[",
-             (long long) from, (long long) to,
-             (long long) par->from, (long long) par->to);
+    if (par->iset)
+        return laik_indexset_intersects(par->iset, s->from.i[0] - par->reach,
+                                        s->to.i[0] + par->reach);
 
-    if ((from >= par->to) || (to <= par->from)) {
-        laik_log(1,"    no intersection!");
+    if (s->space->dims > 1) {
+        // we expect only a few own ranges: linear search
+        for(unsigned int i = 0; i < par->len; i++)
+            if (laik_range_intersect(s, &(par->range[i]))) return true;
         return false;
     }
 
-    // binary search
-    Laik_TaskRange_Gen* ts = par->ts;
+    // 1d: binary search for first range ending after start of <s>
+    int64_t from = s->from.i[0];
+    int64_t to = s->to.i[0];
+    Laik_Range* range = par->range;
     unsigned int off1 = 0, off2 = par->len;
     while(off1 < off2) {
         unsigned int mid = (off1 + off2) / 2;
-        laik_log(1,"  filter check at %d: [%lld;%lld[",
-                 mid,
-                 (long long) ts[mid].range.from.i[0],
-                 (long long) ts[mid].range.to.i[0]);
-
-        if (from >= ts[mid].range.to.i[0]) {
-            laik_log(1,"    larger, check against %d: [%lld;%lld[",
-                     mid+1,
-                     (long long) ts[mid+1].range.from.i[0],
-                     (long long) ts[mid+1].range.to.i[0]);
-            if (to <= ts[mid+1].range.from.i[0]) {
-                laik_log(1,"    no intersection!");
-                return false;
-            }
-            off1 = mid;
-            continue;
-        }
-        if (to <= ts[mid].range.from.i[0]) {
-            laik_log(1,"    smaller, check against %d: [%lld;%lld[",
-                     mid-1,
-                     (long long) ts[mid-1].range.from.i[0],
-                     (long long) ts[mid-1].range.to.i[0]);
-            if (from >= ts[mid-1].range.to.i[0]) {
-                laik_log(1,"    no intersection!");
-                return false;
-            }
+        if (range[mid].to.i[0] <= from)
+            off1 = mid + 1;
+        else
             off2 = mid;
-            continue;
-        }
-        break;
     }
-    laik_log(1,"    found intersection!");
-    return true;
+    return (off1 < par->len) && (range[off1].from.i[0] < to);
 }
 
 
@@ -145,11 +214,8 @@ bool idxfilter(Laik_RangeFilter* sf, int task, const Laik_Range* s)
 {
     (void) task; // unused parameter of filter signature
 
-    int64_t from = s->from.i[0];
-    int64_t to = s->to.i[0];
-
-    if (sf->pfilter1 && idxfilter_check(from, to, sf->pfilter1)) return true;
-    if (sf->pfilter2 && idxfilter_check(from, to, sf->pfilter2)) return true;
+    if (sf->pfilter1 && idxfilter_check(s, sf->pfilter1)) return true;
+    if (sf->pfilter2 && idxfilter_check(s, sf->pfilter2)) return true;
     return false;
 }
 
@@ -158,31 +224,77 @@ void laik_rangefilter_add_idxfilter(Laik_RangeFilter* sf, Laik_RangeList* list,
 {
     assert(list);
     assert(list->off != 0);
-    assert(list->space->dims == 1); // TODO: only for 1d for now
 
-    assert((tid >= 0) && (tid < (int) list->tid_count));
-    // no own ranges?
-    unsigned mycount = list->off[tid+1] - list->off[tid];
-    if (mycount == 0) return;
+    assert(tid < (int) list->tid_count);
+    // install filter function (also without own ranges: keep nothing)
+    sf->filter_func = idxfilter;
 
-    Laik_TaskRange_Gen* ts1 = list->trange + list->off[tid];
-    Laik_TaskRange_Gen* ts2 = list->trange + list->off[tid+1]-1;
+    // not in group or no own ranges?
+    if (tid < 0) return;
+    unsigned mycount = (unsigned) laik_rangelist_tidrangecount(list, tid);
+    if (mycount == 0) return;
 
-    PFilterPar* par = malloc(sizeof(PFilterPar));
-    par->len = mycount;
-    par->from = ts1->range.from.i[0];
-    par->to   = ts2->range.to.i[0];
-    par->ts = ts1;
+    PFilterPar* par;
+    if (list->iset) {
+        // single index format: check against index set
+        par = pfilter_newSI(list->space, laik_rangelist_iset(list, tid),
+                            mycount, 0);
+    }
+    else {
+        Laik_Range* r = malloc(mycount * sizeof(Laik_Range));
+        assert(r);
+        unsigned int firstOff = laik_rangelist_off(list, tid);
+        for(unsigned int i = 0; i < mycount; i++)
+            r[i] = list->trange[firstOff + i].range;
+        par = pfilter_new(r, mycount, 0);
+        free(r);
+    }
 
     if      (sf->pfilter1 == 0) sf->pfilter1 = par;
     else if (sf->pfilter2 == 0) sf->pfilter2 = par;
     else assert(0);
 
-    laik_log(1,"Set pfilter to intersection with %d ranges between [%lld;%lld[",
-             par->len, (long long) par->from, (long long) par->to);
+    if (laik_log_begin(1)) {
+        laik_log_append("Set pfilter to intersection with %d ranges in ", par->len);
+        laik_log_Range(&(par->bbox));
+        laik_log_flush(0);
+    }
+}
 
-    // install filter function
-    sf->filter_func = idxfilter;
+// helper for laik_rangefilter_enlarged
+static PFilterPar* pfilter_enlarged(PFilterPar* par, int reach)
+{
+    if (par == 0) return 0;
+    if (par->iset)
+        return pfilter_newSI(par->bbox.space, par->iset, par->len,
+                             par->reach + reach);
+    return pfilter_new(par->range, par->len, reach);
+}
+
+// internal: copy of filter with regions of intersection filters
+// enlarged by <reach> in each dimension. Used to get the ranges of a base
+// partitioning required for derived ranges which pass filter <sf>
+Laik_RangeFilter* laik_rangefilter_enlarged(Laik_RangeFilter* sf, int reach)
+{
+    Laik_RangeFilter* res = laik_rangefilter_new();
+    res->filter_func = sf->filter_func;
+    res->filter_tid = sf->filter_tid;
+    res->pfilter1 = pfilter_enlarged(sf->pfilter1, reach);
+    res->pfilter2 = pfilter_enlarged(sf->pfilter2, reach);
+    return res;
+}
+
+// internal: can ranges of tasks [fromTask;toTask[ within <r> pass the filter?
+// allows partitioners to skip calculation of ranges which would be dropped
+bool laik_rangefilter_check(Laik_RangeFilter* sf,
+                            int fromTask, int toTask, const Laik_Range* r)
+{
+    if (sf->filter_func == tidfilter)
+        return (sf->filter_tid >= fromTask) && (sf->filter_tid < toTask);
+    if (sf->filter_func == idxfilter)
+        return idxfilter(sf, fromTask, r);
+    // unknown filter function: cannot decide
+    return true;
 }
 
 
@@ -253,6 +365,7 @@ Laik_Partitioning* laik_partitioning_new(char* name,
     p->group = g;
     p->space = s;
     p->partitioner = pr;
+    p->pgroup = g;
 
     // no ranges stored yet
     p->rangeList = 0;
@@ -295,8 +408,10 @@ void laik_free_partitioning(Laik_Partitioning* p)
 {
     RangeList_Entry* e = p->rangeList;
     while(e) {
+        RangeList_Entry* next = e->next;
         laik_rangelist_free(e->ranges);
-        e = e->next;
+        free(e);
+        e = next;
     }
     free(p);
 }
@@ -314,6 +429,21 @@ Laik_RangeList* laik_partitioning_allranges(Laik_Partitioning* p)
     return 0;
 }
 
+// all ranges, running the partitioner on demand if not stored yet
+// (e.g. in scalable mode, when checking global properties)
+static
+Laik_RangeList* allranges(Laik_Partitioning* p)
+{
+    Laik_RangeList* list = laik_partitioning_allranges(p);
+    if ((list == 0) && p->partitioner) {
+        laik_log(1, "calculating all ranges of partitioning '%s' on demand",
+                 p->name);
+        laik_partitioning_store_allranges(p);
+        list = laik_partitioning_allranges(p);
+    }
+    return list;
+}
+
 // ranges from a partitioner run including own ranges
 Laik_RangeList* laik_partitioning_myranges(Laik_Partitioning* p)
 {
@@ -381,22 +511,58 @@ RangeList_Entry* laik_partitioning_add_ranges(Laik_Partitioning* p, Laik_RangeLi
     return e;
 }
 
-// internal: run partitioner given for partitioning, using given filter
-// and add resulting range list to partitioning
+// mapping of process IDs from group <oldg> to <newg>, for migrating ranges.
+// Only supported if one group is parent of the other, otherwise returns 0
 static
-RangeList_Entry* laik_partitioning_run(Laik_Partitioning* p, Laik_RangeFilter* sf)
+int* migrationMap(Laik_Group* oldg, Laik_Group* newg)
+{
+    if (newg->parent == oldg) {
+        // new group is child of old
+        return newg->fromParent;
+    }
+    if (newg->parent2 == oldg) {
+        // new group is child of old
+        return newg->fromParent2;
+    }
+    if (oldg->parent == newg) {
+        // new group is parent of old
+        return oldg->toParent;
+    }
+    if (oldg->parent2 == newg) {
+        // new group is parent of old
+        return oldg->toParent2;
+    }
+    return 0;
+}
+
+// internal: run partitioner given for partitioning, using given filter.
+// Returns resulting range list without storing it in partitioning
+Laik_RangeList* laik_partitioning_calc_ranges(Laik_Partitioning* p,
+                                              Laik_RangeFilter* sf)
 {
     assert(p->partitioner != 0);
 
     Laik_PartitionerParams params;
     params.space       = p->space;
-    params.group       = p->group;
+    params.group       = p->pgroup;
     params.partitioner = p->partitioner;
     params.other       = p->other;
 
     Laik_RangeList* list;
     list = laik_run_partitioner(&params, sf);
 
+    if (p->pgroup != p->group) {
+        // partitioning got migrated since creation: do same with new ranges
+        int* fromOld = migrationMap(p->pgroup, p->group);
+        if (fromOld == 0) {
+            laik_log(LAIK_LL_Panic,
+                     "cannot run partitioner for migrated partitioning '%s'",
+                     p->name);
+            exit(1); // not actually needed, laik_panic never returns
+        }
+        laik_rangelist_migrate(list, fromOld, (unsigned int) p->group->size);
+    }
+
     if (laik_log_begin(2)) {
         laik_log_append("run partitioner '%s' for '%s' (group %d, space '%s'): %d ranges",
                         p->partitioner->name, p->name,
@@ -408,6 +574,15 @@ RangeList_Entry* laik_partitioning_run(Laik_Partitioning* p, Laik_RangeFilter* s
         laik_log_flush(0);
     }
 
+    return list;
+}
+
+// internal: run partitioner given for partitioning, using given filter
+// and add resulting range list to partitioning
+static
+RangeList_Entry* laik_partitioning_run(Laik_Partitioning* p, Laik_RangeFilter* sf)
+{
+    Laik_RangeList* list = laik_partitioning_calc_ranges(p, sf);
     return laik_partitioning_add_ranges(p, list);
 }
 
@@ -423,12 +598,23 @@ void laik_partitioning_store_allranges(Laik_Partitioning* p)
 // run the partitioner specified for the partitioning, keeping only ranges of this task
 void laik_partitioning_store_myranges(Laik_Partitioning* p)
 {
-    if (p->group->myid < 0) return;
+    RangeList_Entry* e;
+
+    if ((p->group->myid < 0) || (p->pgroup->myid < 0)) {
+        // not part of group: no own ranges. Still store the empty list,
+        // needed after migration to a group including this process
+        Laik_RangeList* list = laik_rangelist_new(p->space, p->group->size);
+        laik_rangelist_freeze(list, false);
+        e = laik_partitioning_add_ranges(p, list);
+        e->info = LAIK_RI_SINGLETASK;
+        e->filter_tid = p->group->myid;
+        return;
+    }
 
     Laik_RangeFilter* sf = laik_rangefilter_new();
-    laik_rangefilter_set_myfilter(sf, p->group);
+    laik_rangefilter_set_myfilter(sf, p->pgroup);
 
-    RangeList_Entry* e = laik_partitioning_run(p, sf);
+    e = laik_partitioning_run(p, sf);
     laik_rangefilter_free(sf);
 
     e->info = LAIK_RI_SINGLETASK;
@@ -474,6 +660,24 @@ void laik_partitioning_store_intersectranges(Laik_Partitioning* p,
 }
 
 
+// internal: ranges of <p> required for calculating a transition between
+// <p> and <p2>: all ranges if stored, otherwise ranges intersecting own ranges
+// of <p>/<p2>. The latter are calculated on demand if own ranges are known,
+// e.g. for partitionings created in scalable mode. Returns 0 if not possible
+Laik_RangeList* laik_partitioning_transranges(Laik_Partitioning* p,
+                                              Laik_Partitioning* p2)
+{
+    Laik_RangeList* list = laik_partitioning_interranges(p, p2);
+    if (list) return list;
+
+    if ((p->partitioner == 0) ||
+        (laik_partitioning_myranges(p) == 0) ||
+        (laik_partitioning_myranges(p2) == 0)) return 0;
+
+    laik_partitioning_store_intersectranges(p, p2);
+    return laik_partitioning_interranges(p, p2);
+}
+
 // public: return the space a partitioning is used for
 Laik_Space* laik_partitioning_get_space(Laik_Partitioning* p)
 {
@@ -491,7 +695,7 @@ Laik_Group* laik_partitioning_get_group(Laik_Partitioning* p)
 // only allowed for offline partitioners, may be expensive
 int laik_partitioning_rangecount(Laik_Partitioning* p)
 {
-    Laik_RangeList* list = laik_partitioning_allranges(p);
+    Laik_RangeList* list = allranges(p);
     assert(list != 0); // TODO: API user error
     return laik_rangelist_rangecount(list);
 }
@@ -504,7 +708,7 @@ Laik_TaskRange* laik_partitioning_get_taskrange(Laik_Partitioning* p, int n)
 {
     static Laik_TaskRange ts;
 
-    Laik_RangeList* list = laik_partitioning_allranges(p);
+    Laik_RangeList* list = allranges(p);
     assert(list != 0); // TODO: API user error
 
     if (n >= (int) list->count) return 0;
@@ -525,7 +729,7 @@ Laik_TaskRange* laik_partitioning_get_taskrange(Laik_Partitioning* p, int n)
 bool laik_partitioning_isAll(Laik_Partitioning* p)
 {
     // no filter allowed
-    Laik_RangeList* list = laik_partitioning_allranges(p);
+    Laik_RangeList* list = allranges(p);
     assert(list != 0); // TODO: API user error
 
     return laik_rangelist_isAll(list);
@@ -538,7 +742,7 @@ bool laik_partitioning_isAll(Laik_Partitioning* p)
 int laik_partitioning_isSingle(Laik_Partitioning* p)
 {
     // no filter allowed
-    Laik_RangeList* list = laik_partitioning_allranges(p);
+    Laik_RangeList* list = allranges(p);
     assert(list != 0); // TODO: API user error
 
     return laik_rangelist_isSingle(list);
@@ -548,7 +752,7 @@ int laik_partitioning_isSingle(Laik_Partitioning* p)
 bool laik_partitioning_coversSpace(Laik_Partitioning* p)
 {
     // no filter allowed
-    Laik_RangeList* list = laik_partitioning_allranges(p);
+    Laik_RangeList* list = allranges(p);
     assert(list != 0); // TODO: API user error
 
     return laik_rangelist_coversSpace(list);
@@ -558,9 +762,9 @@ bool laik_partitioning_coversSpace(Laik_Partitioning* p)
 bool laik_partitioning_isEqual(Laik_Partitioning* p1, Laik_Partitioning* p2)
 {
     // no filters allowed
-    Laik_RangeList* sa1 = laik_partitioning_allranges(p1);
+    Laik_RangeList* sa1 = allranges(p1);
     assert(sa1 != 0); // TODO: API user error
-    Laik_RangeList* sa2 = laik_partitioning_allranges(p2);
+    Laik_RangeList* sa2 = allranges(p2);
     assert(sa2 != 0); // TODO: API user error
 
     return laik_rangelist_isEqual(sa1, sa2);
@@ -568,6 +772,187 @@ bool laik_partitioning_isEqual(Laik_Partitioning* p1, Laik_Partitioning* p2)
 
 
 
+// scalable mode: new partitionings only store own ranges. Ranges of other
+// processes are calculated on demand when needed for a transition, keeping
+// only the ones intersecting own ranges (i.e. of communication partners).
+// Default is taken from environment variable LAIK_PARTITIONING_SCALABLE
+static int scalable_mode = -1;
+
+// public: enable/disable scalable mode for partitionings created afterwards
+void laik_set_scalable_partitionings(bool enable)
+{
+    scalable_mode = enable ? 1 : 0;
+}
+
+// public: are partitionings created in scalable mode?
+bool laik_scalable_partitionings(void)
+{
+    if (scalable_mode < 0) {
+        char* str = getenv("LAIK_PARTITIONING_SCALABLE");
+        scalable_mode = (str && (atoi(str) > 0)) ? 1 : 0;
+    }
+    return scalable_mode == 1;
+}
+
+// persistent partitioning cache: range lists of partitionings are stored
+// in a directory, in the binary range list format. Files are named by
+// partitioner and a key covering partitioner parameters, space, group size
+// and ranges of the base partitioning. On a cache hit, the file is mapped
+// into memory instead of running the partitioner.
+// Default directory is taken from environment variable LAIK_PARTITIONING_CACHE
+static char* cache_dir = 0;
+static bool cache_dir_set = false;
+
+#define PARTCACHE_MAGIC 0x4c504348
+
+typedef struct {
+    uint32_t magic;
+    uint32_t unused;
+    uint64_t key;
+    uint64_t size; // size of serialized range list following header
+} PartCache_Header;
+
+// public: set directory for persistent partitioning cache (0 to disable)
+void laik_set_partitioning_cache(const char* dir)
+{
+    free(cache_dir);
+    cache_dir = dir ? strdup(dir) : 0;
+    cache_dir_set = true;
+}
+
+static
+char* partcache_dir(void)
+{
+    if (!cache_dir_set) {
+        char* str = getenv("LAIK_PARTITIONING_CACHE");
+        if (str && *str) cache_dir = strdup(str);
+        cache_dir_set = true;
+    }
+    return cache_dir;
+}
+
+// key of a partitioning to be calculated, false if not cacheable
+static
+bool partcache_key(Laik_Partitioning* p, uint64_t* key)
+{
+    uint64_t h;
+    if (!laik_partitioner_paramkey(p->partitioner, &h)) return false;
+
+    Laik_Space* s = p->space;
+    h = laik_hash64(h, &(s->dims), sizeof(int));
+    for(int d = 0; d < s->dims; d++) {
+        h = laik_hash64(h, &(s->range.from.i[d]), sizeof(int64_t));
+        h = laik_hash64(h, &(s->range.to.i[d]), sizeof(int64_t));
+    }
+    h = laik_hash64(h, &(p->pgroup->size), sizeof(int));
+
+    if (p->other) {
+        Laik_RangeList* list = allranges(p->other);
+        if (list == 0) return false;
+        for(unsigned int i = 0; i < list->count; i++) {
+            Laik_TaskRange_Gen* tr = laik_rangelist_trange(list, i);
+            h = laik_hash64(h, &(tr->task), sizeof(int));
+            h = laik_hash64(h, &(tr->tag), sizeof(int));
+            for(int d = 0; d < s->dims; d++) {
+                h = laik_hash64(h, &(tr->range.from.i[d]), sizeof(int64_t));
+                h = laik_hash64(h, &(tr->range.to.i[d]), sizeof(int64_t));
+            }
+        }
+    }
+    *key = h;
+    return true;
+}
+
+static
+void partcache_filename(char* buf, int len, Laik_Partitioning* p, uint64_t key)
+{
+    snprintf(buf, len, "%s/%s-%016llx.lrl", cache_dir,
+             p->partitioner->name, (unsigned long long) key);
+}
+
+// try to load ranges of <p> from cache, true on success
+static
+bool partcache_load(Laik_Partitioning* p, uint64_t key)
+{
+    char fname[PATH_MAX];
+    partcache_filename(fname, PATH_MAX, p, key);
+
+    int fd = open(fname, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if ((fstat(fd, &st) < 0) || (st.st_size < (off_t) sizeof(PartCache_Header))) {
+        close(fd);
+        return false;
+    }
+    char* buf = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (buf == MAP_FAILED) return false;
+
+    Laik_RangeList* list = 0;
+    PartCache_Header* h = (PartCache_Header*) buf;
+    if ((h->magic == PARTCACHE_MAGIC) && (h->key == key) &&
+        (h->size == st.st_size - sizeof(PartCache_Header))) {
+        list = laik_rangelist_new(p->space, p->pgroup->size);
+        if (!laik_rangelist_append_serialized(list,
+                                              buf + sizeof(PartCache_Header),
+                                              (unsigned int) h->size)) {
+            laik_rangelist_free(list);
+            list = 0;
+        }
+    }
+    munmap(buf, st.st_size);
+
+    if (list == 0) {
+        laik_log(LAIK_LL_Warning, "partitioning cache: ignoring invalid file '%s'",
+                 fname);
+        return false;
+    }
+    laik_rangelist_freeze(list, false);
+    RangeList_Entry* e = laik_partitioning_add_ranges(p, list);
+    e->info = LAIK_RI_FULL;
+
+    laik_log(1, "partitioning cache: loaded %d ranges of '%s' from '%s'",
+             list->count, p->name, fname);
+    return true;
+}
+
+// write ranges of <p> into cache. Written to a temporary file which is
+// renamed afterwards, as concurrent processes may use the same cache
+static
+void partcache_store(Laik_Partitioning* p, uint64_t key)
+{
+    char fname[PATH_MAX], tmpname[PATH_MAX + 20];
+    partcache_filename(fname, PATH_MAX, p, key);
+    snprintf(tmpname, PATH_MAX + 20, "%s.%d", fname, (int) getpid());
+
+    Laik_RangeList* list = laik_partitioning_allranges(p);
+    assert(list != 0);
+    unsigned int size;
+    char* buf = laik_rangelist_serialize(list, &size);
+    PartCache_Header h;
+    memset(&h, 0, sizeof(PartCache_Header));
+    h.magic = PARTCACHE_MAGIC;
+    h.key = key;
+    h.size = size;
+
+    bool ok = false;
+    FILE* f = fopen(tmpname, "w");
+    if (f) {
+        ok = (fwrite(&h, sizeof(PartCache_Header), 1, f) == 1) &&
+             (fwrite(buf, size, 1, f) == 1);
+        ok = (fclose(f) == 0) && ok;
+        ok = ok && (rename(tmpname, fname) == 0);
+        if (!ok) unlink(tmpname);
+    }
+    free(buf);
+
+    if (ok)
+        laik_log(1, "partitioning cache: stored %d ranges of '%s' into '%s'",
+                 list->count, p->name, fname);
+    else
+        laik_log(LAIK_LL_Warning, "partitioning cache: cannot write '%s'", fname);
+}
+
 // public: create a new partitioning by running an offline partitioner
 // the partitioner may be derived from another partitioning which is
 // forwarded to the partitioner algorithm
@@ -577,48 +962,177 @@ Laik_Partitioning* laik_new_partitioning(Laik_Partitioner* pr,
 {
     Laik_Partitioning* p;
     p = laik_new_empty_partitioning(g, space, pr, otherP);
+    if (laik_scalable_partitionings()) {
+        laik_partitioning_store_myranges(p);
+        return p;
+    }
+
+    uint64_t key;
+    if (pr && partcache_dir() && partcache_key(p, &key)) {
+        if (partcache_load(p, key)) return p;
+        laik_partitioning_store_allranges(p);
+        // only one process of the group writes the cache file
+        if (g->myid == 0)
+            partcache_store(p, key);
+        return p;
+    }
     laik_partitioning_store_allranges(p);
     return p;
 }
 
 
 
-// migrate partitioning borders to new group without changing borders
-// - added tasks get empty partitions
-// - removed tasks must have empty partitiongs
-void laik_partitioning_migrate(Laik_Partitioning* p, Laik_Group* newg)
+// shared partitionings: ranges are calculated only once and distributed
+// as serialized range lists via a KV store of the instance, with keys
+// "<name>/<id>" for the ranges calculated by process <id>. Key "<name>"
+// describes what the ranges were calculated for (see sharedDesc)
+
+static
+Laik_KVStore* laik_partitioningstore(Laik_Instance* i)
 {
-    Laik_Group* oldg = p->group;
-    if (oldg == newg) return;
+    if (!i->partitioningStore)
+        i->partitioningStore = laik_kvs_new("partitioning", i);
 
-    int* fromOld; // mapping of IDs from old group to new group
+    return i->partitioningStore;
+}
 
-    if (newg->parent == oldg) {
-        // new group is child of old
-        fromOld = newg->fromParent;
-    }
-    else if (newg->parent2 == oldg) {
-        // new group is child of old
-        fromOld = newg->fromParent2;
+// assemble all ranges of shared partitioning <name> from KV store
+// returns 0 if not found
+static
+Laik_RangeList* sharedRanges(Laik_KVStore* kvs, char* name, int root,
+                             Laik_Group* g, Laik_Space* s)
+{
+    char key[100];
+    Laik_RangeList* list = laik_rangelist_new(s, g->size);
+    int found = 0;
+    for(int id = 0; id < g->size; id++) {
+        if ((root >= 0) && (id != root)) continue;
+        snprintf(key, 100, "%s/%d", name, id);
+        unsigned int size;
+        char* buf = laik_kvs_get(kvs, key, &size);
+        if (buf == 0) continue;
+        if (!laik_rangelist_append_serialized(list, buf, size)) {
+            laik_log(LAIK_LL_Panic,
+                     "shared partitioning '%s' does not match space '%s' / group %d",
+                     name, s->name, g->gid);
+            exit(1); // not actually needed, laik_panic never returns
+        }
+        found++;
     }
-    else if (oldg->parent == newg) {
-        // new group is parent of old
-        fromOld = oldg->toParent;
+    if (found == 0) {
+        laik_rangelist_free(list);
+        return 0;
     }
-    else if (oldg->parent2 == newg) {
-        // new group is parent of old
-        fromOld = oldg->toParent2;
+    laik_rangelist_freeze(list, false);
+    return list;
+}
+
+// write description of shared partitioning parameters into <buf>:
+// ranges cached under a name are only reused if this matches
+static
+void sharedDesc(char* buf, int len, Laik_Partitioner* pr, Laik_Group* g,
+                Laik_Space* s, int root)
+{
+    uint64_t key = 0;
+    if (!laik_partitioner_paramkey(pr, &key)) key = 0;
+    snprintf(buf, len, "%s:%016llx/G%d:%d/S%d/R%d",
+             pr->name, (unsigned long long) key, g->gid, g->size, s->id, root);
+}
+
+// public: create a partitioning with ranges calculated only once and then
+// distributed via the backend instead of running the partitioner in every
+// process. This is useful for expensive partitioners.
+// With <root> >= 0, only process <root> of group <g> runs the partitioner,
+// otherwise each process calculates its own ranges (partitioners can skip
+// ranges of other processes via laik_rangereceiver_wants()).
+// Ranges are cached by name: further calls with same name reuse them if
+// partitioner, group, space and root match, otherwise they get replaced.
+// All processes of the instance have to call this (collective)
+Laik_Partitioning* laik_new_shared_partitioning(Laik_Partitioner* pr,
+                                                Laik_Group* g, Laik_Space* space,
+                                                Laik_Partitioning* otherP,
+                                                char* name, int root)
+{
+    assert(name != 0);
+    assert(root < g->size);
+
+    // sync first: all processes must see the same store content to agree
+    // on reusing ranges, as the decision controls the collective sync below
+    Laik_KVStore* kvs = laik_partitioningstore(g->inst);
+    laik_kvs_sync(kvs);
+    char desc[200];
+    sharedDesc(desc, 200, pr, g, space, root);
+    char* oldDesc = laik_kvs_get(kvs, name, 0);
+    Laik_RangeList* list = 0;
+    if (oldDesc && (strcmp(oldDesc, desc) == 0))
+        list = sharedRanges(kvs, name, root, g, space);
+    else if (oldDesc)
+        laik_log(1, "shared partitioning '%s': parameters changed, recalculate",
+                 name);
+    if (list) {
+        laik_log(1, "shared partitioning '%s': reuse %d ranges",
+                 name, list->count);
     }
     else {
-        // other cases not supported
-        assert(0);
+        Laik_Partitioning* p;
+        p = laik_new_empty_partitioning(g, space, pr, otherP);
+        Laik_RangeList* mylist = 0;
+        if ((root < 0) && (g->myid >= 0)) {
+            Laik_RangeFilter* sf = laik_rangefilter_new();
+            laik_rangefilter_set_myfilter(sf, g);
+            mylist = laik_partitioning_calc_ranges(p, sf);
+            laik_rangefilter_free(sf);
+        }
+        else if ((root >= 0) && (g->myid == root))
+            mylist = laik_partitioning_calc_ranges(p, 0);
+        if (mylist) {
+            char key[100];
+            snprintf(key, 100, "%s/%d", name, g->myid);
+            unsigned int size;
+            char* buf = laik_rangelist_serialize(mylist, &size);
+            laik_kvs_set(kvs, key, size, buf);
+            free(buf);
+            laik_rangelist_free(mylist);
+        }
+        // one process writes description, keys of ranges are overwritten
+        if (g->myid == ((root >= 0) ? root : 0))
+            laik_kvs_sets(kvs, name, desc);
+        laik_free_partitioning(p);
+
+        laik_kvs_sync(kvs);
+        list = sharedRanges(kvs, name, root, g, space);
+        assert(list != 0);
+        laik_log(1, "shared partitioning '%s': got %d ranges",
+                 name, list->count);
     }
 
+    Laik_Partitioning* p = laik_partitioning_new(name, g, space, pr, otherP);
+    RangeList_Entry* e = laik_partitioning_add_ranges(p, list);
+    e->info = LAIK_RI_FULL;
+    return p;
+}
+
+
+// migrate partitioning borders to new group without changing borders
+// - added tasks get empty partitions
+// - removed tasks must have empty partitiongs
+void laik_partitioning_migrate(Laik_Partitioning* p, Laik_Group* newg)
+{
+    Laik_Group* oldg = p->group;
+    if (oldg == newg) return;
+
+    int* fromOld = migrationMap(oldg, newg);
+    assert(fromOld != 0); // other cases not supported
+
     RangeList_Entry* e = p->rangeList;
     while(e) {
         if (e->info == LAIK_RI_SINGLETASK) {
             assert(e->filter_tid < oldg->size);
-            e->filter_tid = fromOld[e->filter_tid];
+            // empty list of process not in old group: own one in new group
+            if (e->filter_tid < 0)
+                e->filter_tid = newg->myid;
+            else
+                e->filter_tid = fromOld[e->filter_tid];
         }
         laik_rangelist_migrate(e->ranges, fromOld, (unsigned int) newg->size);
         e = e->next;
@@ -741,5 +1255,6 @@ Laik_TaskRange* laik_my_range_3d(Laik_Partitioning* p, int n,
 // give an access phase a name, for debug output
 void laik_partitioning_set_name(Laik_Partitioning* p, char* n)
 {
+    free(p->name);
     p->name = strdup(n);
 }
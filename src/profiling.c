@@ -21,6 +21,15 @@
 #include <time.h>
 #include <sys/time.h>
 #include <stdarg.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 /**
  * Application controlled profiling
@@ -67,7 +76,6 @@
  *   instrumentation destroys measurements anyway, so
  *   better keep overhead low)
  * - enable automatic measurement output on iteration/phase change
- * - PAPI counters
  * - combine this with sampling to become more precise
  *   without higher overhead
 */
@@ -75,12 +83,127 @@
 static Laik_Instance* laik_profinst = 0;
 extern char* __progname;
 
+//
+// Hardware counters via perf_event_open
+//
+
+static bool perf_enabled = false;
+static bool perf_initialized = false;
+static const char* perf_name[LAIK_PERF_COUNTERS] = {
+    "cycles", "instructions", "llc-misses", "stalled-cycles" };
+
+#ifdef __linux__
+// group leader, all counters are read with one read() call
+static int perf_fd = -1;
+// number of opened counters, position of each in group read (-1: none)
+static int perf_count = 0;
+static int perf_idx[LAIK_PERF_COUNTERS];
+
+static const uint64_t perf_config[LAIK_PERF_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_STALLED_CYCLES_BACKEND };
+
+static int perf_open(uint64_t config, int group)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    // user-level only: allowed with default perf_event_paranoid setting
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    // calling thread, any CPU
+    return (int) syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+// open counters if requested via LAIK_PERF_COUNTERS, only once per process
+static void perf_init(void)
+{
+    if (perf_initialized) return;
+    perf_initialized = true;
+
+    char* str = getenv("LAIK_PERF_COUNTERS");
+    if (!str || (atoi(str) == 0)) return;
+
+    for(int i = 0; i < LAIK_PERF_COUNTERS; i++)
+        perf_idx[i] = -1;
+
+    perf_fd = perf_open(perf_config[0], -1);
+    if (perf_fd < 0) {
+        laik_log(LAIK_LL_Warning, "hardware counters not available: %s",
+                 strerror(errno));
+        return;
+    }
+    perf_idx[0] = perf_count++;
+    for(int i = 1; i < LAIK_PERF_COUNTERS; i++) {
+        if (perf_open(perf_config[i], perf_fd) < 0) {
+            laik_log(1, "hardware counter '%s' not available", perf_name[i]);
+            continue;
+        }
+        perf_idx[i] = perf_count++;
+    }
+    perf_enabled = true;
+    laik_log(1, "hardware counters enabled (%d of %d available)",
+             perf_count, LAIK_PERF_COUNTERS);
+}
+
+// read current counter values into <v>
+static void perf_read(uint64_t* v)
+{
+    // read format for group: number of counters, followed by values
+    uint64_t buf[1 + LAIK_PERF_COUNTERS];
+    ssize_t len = read(perf_fd, buf, sizeof(buf));
+    if (len < (ssize_t) ((1 + perf_count) * sizeof(uint64_t))) {
+        memset(v, 0, LAIK_PERF_COUNTERS * sizeof(uint64_t));
+        return;
+    }
+    for(int i = 0; i < LAIK_PERF_COUNTERS; i++)
+        v[i] = (perf_idx[i] < 0) ? 0 : buf[1 + perf_idx[i]];
+}
+
+#else
+
+static void perf_init(void)
+{
+    perf_initialized = true;
+    if (getenv("LAIK_PERF_COUNTERS"))
+        laik_log(LAIK_LL_Warning, "hardware counters only supported on Linux");
+}
+
+static void perf_read(uint64_t* v)
+{
+    memset(v, 0, LAIK_PERF_COUNTERS * sizeof(uint64_t));
+}
+
+#endif
+
+// add counter increments since <start> to <sum>
+static void perf_accumulate(uint64_t* start, uint64_t* sum)
+{
+    uint64_t now[LAIK_PERF_COUNTERS];
+    perf_read(now);
+    for(int i = 0; i < LAIK_PERF_COUNTERS; i++)
+        sum[i] += now[i] - start[i];
+}
+
+static void perf_reset(Laik_Profiling_Controller* p)
+{
+    memset(p->perf_laik, 0, sizeof(p->perf_laik));
+    memset(p->perf_user, 0, sizeof(p->perf_user));
+}
+
 // called by laik_init
 Laik_Profiling_Controller* laik_init_profiling(void)
 {
     Laik_Profiling_Controller* ctrl = (Laik_Profiling_Controller*) 
             calloc(1, sizeof(Laik_Profiling_Controller));
 
+    laik_trace_init();
+    laik_commstat_init();
+
     return ctrl;
 }
 
@@ -124,6 +247,8 @@ void laik_enable_profiling(Laik_Instance* i)
     i->profiling->time_backend = 0.0;
     i->profiling->time_total = 0.0;
     i->profiling->time_user = 0.0;
+    perf_init();
+    perf_reset(i->profiling);
 }
 
 // reset measured time spans
@@ -136,6 +261,7 @@ void laik_reset_profiling(Laik_Instance* i)
                 i->profiling->time_backend = 0.0;
                 i->profiling->time_total = 0.0;
                 i->profiling->time_user = 0.0;
+                perf_reset(i->profiling);
             }
         }
     }
@@ -149,6 +275,8 @@ void laik_profile_user_start(Laik_Instance* i)
             if (i->profiling->do_profiling) {
                 i->profiling->timer_user = laik_wtime();
                 i->profiling->user_timer_active = 1;
+                if (perf_enabled)
+                    perf_read(i->profiling->perf_start_user);
             }
         }
     }
@@ -165,12 +293,50 @@ void laik_profile_user_stop(Laik_Instance* i)
                                               i->profiling->timer_user;
                     i->profiling->timer_user = 0.0;
                     i->profiling->user_timer_active = 0;
+                    if (perf_enabled)
+                        perf_accumulate(i->profiling->perf_start_user,
+                                        i->profiling->perf_user);
                 }
             }
         }
     }
 }
 
+// start of time span spent in LAIK, e.g. in laik_switchto
+void laik_profile_laik_start(Laik_Instance* i)
+{
+    if (laik_profinst != i) return;
+    Laik_Profiling_Controller* p = i->profiling;
+    if (!p->do_profiling) return;
+
+    // only outermost call starts measurement
+    if (p->laik_timer_depth++ > 0) return;
+    p->timer_total = laik_wtime();
+    if (perf_enabled) {
+        perf_read(p->perf_start_laik);
+        // keep counters of user time span exclusive of LAIK time
+        if (p->user_timer_active)
+            perf_accumulate(p->perf_start_user, p->perf_user);
+    }
+}
+
+// end of time span spent in LAIK
+void laik_profile_laik_stop(Laik_Instance* i)
+{
+    if (laik_profinst != i) return;
+    Laik_Profiling_Controller* p = i->profiling;
+    if (!p->do_profiling) return;
+    if (p->laik_timer_depth == 0) return; // profiling enabled within LAIK
+
+    if (--p->laik_timer_depth > 0) return;
+    p->time_total += laik_wtime() - p->timer_total;
+    if (perf_enabled) {
+        perf_accumulate(p->perf_start_laik, p->perf_laik);
+        if (p->user_timer_active)
+            perf_read(p->perf_start_user);
+    }
+}
+
 // enable output-to-file mode for use of laik_writeout_profile()
 void laik_enable_profiling_file(Laik_Instance* i, const char* filename)
 {
@@ -185,6 +351,8 @@ void laik_enable_profiling_file(Laik_Instance* i, const char* filename)
     i->profiling->do_profiling = true;
     i->profiling->time_backend = 0.0;
     i->profiling->time_total = 0.0;
+    perf_init();
+    perf_reset(i->profiling);
     snprintf(i->profiling->filename, MAX_FILENAME_LENGTH, "t%s.%s", i->guid, filename);
     i->profiling->profile_file = fopen(filename, "a+");
     if (i->profiling->profile_file == NULL) {
@@ -197,6 +365,13 @@ void laik_enable_profiling_file(Laik_Instance* i, const char* filename)
     fprintf((FILE*)i->profiling->profile_file, "======Application %s======\n", 
             __progname);
 
+    if (perf_enabled) {
+        fprintf((FILE*)i->profiling->profile_file, "======Counters (LAIK, user):");
+        for(int c = 0; c < LAIK_PERF_COUNTERS; c++)
+            fprintf((FILE*)i->profiling->profile_file, " %s", perf_name[c]);
+        fprintf((FILE*)i->profiling->profile_file, "======\n");
+    }
+
 }
 
 // get LAIK total time for LAIK instance for which profiling is enabled
@@ -225,7 +400,7 @@ void laik_writeout_profile()
     if (!laik_profinst->profiling->profile_file) return;
     //backend-id, phase, iteration, time_total, time_ackend, user_time
     fprintf( (FILE*)laik_profinst->profiling->profile_file,
-             "%s, %d, %d, %f, %f, %f\n",
+             "%s, %d, %d, %f, %f, %f",
              laik_profinst->guid,
              laik_profinst->control->cur_phase,
              laik_profinst->control->cur_iteration,
@@ -233,6 +408,18 @@ void laik_writeout_profile()
              laik_profinst->profiling->time_backend,
              laik_profinst->profiling->time_user
             );
+    if (perf_enabled) {
+        // counter sums since last writeout: LAIK time, then user time
+        Laik_Profiling_Controller* p = laik_profinst->profiling;
+        for(int c = 0; c < LAIK_PERF_COUNTERS; c++)
+            fprintf((FILE*)p->profile_file, ", %llu",
+                    (unsigned long long) p->perf_laik[c]);
+        for(int c = 0; c < LAIK_PERF_COUNTERS; c++)
+            fprintf((FILE*)p->profile_file, ", %llu",
+                    (unsigned long long) p->perf_user[c]);
+        perf_reset(p);
+    }
+    fprintf((FILE*)laik_profinst->profiling->profile_file, "\n");
 }
 
 // disable output-to-file mode, eventually closing yet open file before
@@ -257,3 +444,469 @@ void laik_profile_printf(const char* msg, ...)
     }
 }
 
+
+
+//
+// Event tracing
+//
+
+// one recorded time span
+typedef struct _Laik_TraceEvent {
+    double start, end;
+    const char* cat;
+    const char* name;
+    char detail[24];
+    int round, peer;
+} Laik_TraceEvent;
+
+bool laik_trace_enabled = false;
+
+static char* trace_prefix = 0;
+static Laik_TraceEvent* trace_buf = 0;
+static unsigned int trace_size = 0;
+// total number of events recorded, next one goes to trace_count % trace_size
+static unsigned long trace_count = 0;
+// start time of next prepare step
+static double trace_markTime = 0.0;
+
+void laik_trace_init(void)
+{
+    // only one ring buffer per process, even with multiple instances
+    if (trace_buf) return;
+
+    char* str = getenv("LAIK_TRACE");
+    if (!str || (*str == 0)) return;
+    trace_prefix = str;
+
+    trace_size = 100000;
+    str = getenv("LAIK_TRACE_SIZE");
+    if (str) {
+        int s = atoi(str);
+        if (s > 0) trace_size = (unsigned int) s;
+    }
+    trace_buf = (Laik_TraceEvent*) malloc(trace_size * sizeof(Laik_TraceEvent));
+    if (!trace_buf) {
+        laik_log(LAIK_LL_Error, "Unable to allocate trace buffer, tracing disabled");
+        return;
+    }
+    trace_count = 0;
+    laik_trace_enabled = true;
+}
+
+void laik_trace_mark(void)
+{
+    if (!laik_trace_enabled) return;
+    trace_markTime = laik_wtime();
+}
+
+void laik_trace_event(const char* cat, const char* name, const char* detail,
+                      double start, int round, int peer)
+{
+    if (!laik_trace_enabled) return;
+
+    Laik_TraceEvent* e = &(trace_buf[trace_count % trace_size]);
+    trace_count++;
+
+    e->start = start;
+    e->end = laik_wtime();
+    e->cat = cat;
+    e->name = name;
+    if (detail) {
+        strncpy(e->detail, detail, sizeof(e->detail) - 1);
+        e->detail[sizeof(e->detail) - 1] = 0;
+    }
+    else
+        e->detail[0] = 0;
+    e->round = round;
+    e->peer = peer;
+
+    trace_markTime = e->end;
+}
+
+void laik_trace_step(const char* name)
+{
+    if (!laik_trace_enabled) return;
+    laik_trace_event("prepare", name, 0, trace_markTime, -1, -1);
+}
+
+void laik_trace_action(Laik_Action* a, double start)
+{
+    if (!laik_trace_enabled) return;
+
+    int peer = -1;
+    if (laik_action_isSend(a) || laik_action_isRecv(a))
+        peer = laik_action_getPeer(a);
+    laik_trace_event("action", laik_at_str(a->type), 0, start, a->round, peer);
+}
+
+// write <s> as JSON string, with quotes and escaped special characters
+static void write_string(FILE* f, const char* s)
+{
+    fputc('"', f);
+    for(; *s; s++) {
+        unsigned char c = (unsigned char) *s;
+        if ((c == '"') || (c == '\\'))
+            fprintf(f, "\\%c", c);
+        else if (c < 0x20)
+            fprintf(f, "\\u%04x", c);
+        else
+            fputc(c, f);
+    }
+    fputc('"', f);
+}
+
+// write event in Chrome trace JSON format (complete event, time in us)
+static void write_event(FILE* f, int pid,
+                        const char* cat, const char* name, const char* detail,
+                        double start, double end, int round, int peer)
+{
+    fprintf(f, ",\n{\"ph\":\"X\",\"pid\":%d,\"tid\":0,\"cat\":", pid);
+    write_string(f, cat);
+    fprintf(f, ",\"name\":");
+    write_string(f, name);
+    fprintf(f, ",\"ts\":%.3f,\"dur\":%.3f,\"args\":{",
+            start * 1e6, (end - start) * 1e6);
+    bool firstArg = true;
+    if (detail && detail[0]) {
+        fprintf(f, "\"detail\":");
+        write_string(f, detail);
+        firstArg = false;
+    }
+    if (round >= 0) {
+        fprintf(f, "%s\"round\":%d", firstArg ? "" : ",", round);
+        firstArg = false;
+    }
+    if (peer >= 0)
+        fprintf(f, "%s\"peer\":%d", firstArg ? "" : ",", peer);
+    fprintf(f, "}}");
+}
+
+void laik_trace_writeout(Laik_Instance* inst)
+{
+    if (!laik_trace_enabled) return;
+    laik_trace_enabled = false;
+
+    char filename[MAX_FILENAME_LENGTH];
+    snprintf(filename, MAX_FILENAME_LENGTH, "%s-%d.json",
+             trace_prefix, inst->mylocationid);
+    FILE* f = fopen(filename, "w");
+    if (!f) {
+        laik_log(LAIK_LL_Error, "Unable to write trace to '%s'", filename);
+        return;
+    }
+
+    // one process per LAIK location
+    int pid = inst->mylocationid;
+    char pname[200];
+    snprintf(pname, sizeof(pname), "LID %d (%s)",
+             pid, inst->mylocation ? inst->mylocation : "");
+    fprintf(f, "{\"traceEvents\":[\n"
+            "{\"ph\":\"M\",\"pid\":%d,\"name\":\"process_name\","
+            "\"args\":{\"name\":", pid);
+    write_string(f, pname);
+    fprintf(f, "}}");
+
+    unsigned long first = 0;
+    if (trace_count > trace_size) {
+        laik_log(1, "trace buffer overflow: %lu oldest events lost",
+                 trace_count - trace_size);
+        first = trace_count - trace_size;
+    }
+
+    // consecutive action events with same round form an action round
+    int round = -1;
+    double roundStart = 0.0, roundEnd = 0.0;
+    for(unsigned long i = first; i < trace_count; i++) {
+        Laik_TraceEvent* e = &(trace_buf[i % trace_size]);
+        bool isAction = (strcmp(e->cat, "action") == 0);
+        if ((round >= 0) && (!isAction || (e->round != round))) {
+            write_event(f, pid, "round", "Round", 0,
+                        roundStart, roundEnd, round, -1);
+            round = -1;
+        }
+        if (isAction) {
+            if (round < 0) {
+                round = e->round;
+                roundStart = e->start;
+            }
+            roundEnd = e->end;
+        }
+        write_event(f, pid, e->cat, e->name, e->detail,
+                    e->start, e->end, e->round, e->peer);
+    }
+    if (round >= 0)
+        write_event(f, pid, "round", "Round", 0,
+                    roundStart, roundEnd, round, -1);
+
+    fprintf(f, "\n],\"displayTimeUnit\":\"ns\"}\n");
+    fclose(f);
+    laik_log(1, "written %lu trace events to '%s'",
+             trace_count - first, filename);
+
+    free(trace_buf);
+    trace_buf = 0;
+}
+
+
+//
+// Communication matrix
+//
+
+// counters for communication with one peer location
+typedef struct _Laik_CommStat {
+    uint64_t msgSend, byteSend, msgRecv, byteRecv;
+    double waitSend, waitRecv; // blocked in sending to/receiving from peer
+} Laik_CommStat;
+
+// counters of this process in one program phase
+typedef struct _Laik_PhaseCommStat {
+    int phase;
+    const char* name;
+    int peers;
+    Laik_CommStat* stat; // indexed by peer location ID
+} Laik_PhaseCommStat;
+
+// record sent in KV store at finalize
+typedef struct _Laik_CommStatRecord {
+    int phase, from, to;
+    Laik_CommStat stat;
+} Laik_CommStatRecord;
+
+bool laik_commstat_enabled = false;
+
+static char* commstat_prefix = 0;
+static Laik_PhaseCommStat* commstat = 0;
+static int commstat_count = 0, commstat_size = 0;
+// index of phase used last
+static int commstat_last = -1;
+
+void laik_commstat_init(void)
+{
+    if (laik_commstat_enabled) return;
+
+    char* str = getenv("LAIK_COMM_MATRIX");
+    if (!str || (*str == 0)) return;
+    commstat_prefix = str;
+    laik_commstat_enabled = true;
+}
+
+// get counters for current phase of <inst>, with space for peer <lid>
+static Laik_CommStat* commstat_get(Laik_Instance* inst, int lid)
+{
+    int phase = inst->control->cur_phase;
+    Laik_PhaseCommStat* pcs = 0;
+    if ((commstat_last >= 0) && (commstat[commstat_last].phase == phase))
+        pcs = &(commstat[commstat_last]);
+    else {
+        for(int i = 0; i < commstat_count; i++) {
+            if (commstat[i].phase != phase) continue;
+            commstat_last = i;
+            pcs = &(commstat[i]);
+            break;
+        }
+    }
+    if (!pcs) {
+        if (commstat_count == commstat_size) {
+            commstat_size = (commstat_size == 0) ? 8 : 2 * commstat_size;
+            commstat = (Laik_PhaseCommStat*)
+                       realloc(commstat, commstat_size * sizeof(Laik_PhaseCommStat));
+            assert(commstat);
+        }
+        commstat_last = commstat_count++;
+        pcs = &(commstat[commstat_last]);
+        pcs->phase = phase;
+        pcs->peers = 0;
+        pcs->stat = 0;
+    }
+    // latest name given for this phase
+    pcs->name = inst->control->cur_phase_name;
+
+    if (lid >= pcs->peers) {
+        int peers = (inst->locations > lid) ? inst->locations : lid + 1;
+        pcs->stat = (Laik_CommStat*) realloc(pcs->stat, peers * sizeof(Laik_CommStat));
+        assert(pcs->stat);
+        memset(pcs->stat + pcs->peers, 0, (peers - pcs->peers) * sizeof(Laik_CommStat));
+        pcs->peers = peers;
+    }
+    return &(pcs->stat[lid]);
+}
+
+void laik_commstat_add(Laik_Instance* inst, int lid, bool isSend,
+                       int msgs, uint64_t bytes, double waitTime)
+{
+    if (!laik_commstat_enabled) return;
+    assert(lid >= 0);
+
+    Laik_CommStat* cs = commstat_get(inst, lid);
+    if (isSend) {
+        cs->msgSend += msgs;
+        cs->byteSend += bytes;
+        cs->waitSend += waitTime;
+    }
+    else {
+        cs->msgRecv += msgs;
+        cs->byteRecv += bytes;
+        cs->waitRecv += waitTime;
+    }
+}
+
+// for sorting collected records by phase, sender, receiver
+static int cmp_commstat_record(const void* p1, const void* p2)
+{
+    const Laik_CommStatRecord* r1 = (const Laik_CommStatRecord*) p1;
+    const Laik_CommStatRecord* r2 = (const Laik_CommStatRecord*) p2;
+    if (r1->phase != r2->phase) return r1->phase - r2->phase;
+    if (r1->from != r2->from) return r1->from - r2->from;
+    return r1->to - r2->to;
+}
+
+// write collected records <r> as CSV and JSON, <n> locations
+static void commstat_write(Laik_KVStore* kvs, Laik_CommStatRecord* r,
+                           int count, int n)
+{
+    char filename[MAX_FILENAME_LENGTH], key[30];
+
+    snprintf(filename, MAX_FILENAME_LENGTH, "%s.csv", commstat_prefix);
+    FILE* f = fopen(filename, "w");
+    if (!f) {
+        laik_log(LAIK_LL_Error, "Unable to write comm matrix to '%s'", filename);
+        return;
+    }
+    fprintf(f, "phase,name,from,to,sendMsgs,sendBytes,recvMsgs,recvBytes,sendWait,recvWait\n");
+    for(int i = 0; i < count; i++) {
+        sprintf(key, "name-%d", r[i].phase);
+        char* name = laik_kvs_get(kvs, key, 0);
+        fprintf(f, "%d,%s,%d,%d,%lu,%lu,%lu,%lu,%.6f,%.6f\n",
+                r[i].phase, name ? name : "", r[i].from, r[i].to,
+                (unsigned long) r[i].stat.msgSend,
+                (unsigned long) r[i].stat.byteSend,
+                (unsigned long) r[i].stat.msgRecv,
+                (unsigned long) r[i].stat.byteRecv,
+                r[i].stat.waitSend, r[i].stat.waitRecv);
+    }
+    fclose(f);
+
+    // JSON: per phase, n x n matrices indexed by [from][to]
+    snprintf(filename, MAX_FILENAME_LENGTH, "%s.json", commstat_prefix);
+    f = fopen(filename, "w");
+    if (!f) {
+        laik_log(LAIK_LL_Error, "Unable to write comm matrix to '%s'", filename);
+        return;
+    }
+    uint64_t* msgs  = (uint64_t*) malloc(n * n * sizeof(uint64_t));
+    uint64_t* bytes = (uint64_t*) malloc(n * n * sizeof(uint64_t));
+    double*   wait  = (double*)   malloc(n * n * sizeof(double));
+    fprintf(f, "{\"locations\":%d,\"phases\":[", n);
+    int i = 0;
+    while(i < count) {
+        int phase = r[i].phase;
+        memset(msgs,  0, n * n * sizeof(uint64_t));
+        memset(bytes, 0, n * n * sizeof(uint64_t));
+        memset(wait,  0, n * n * sizeof(double));
+        for(; (i < count) && (r[i].phase == phase); i++) {
+            // messages/bytes as seen by sender, waiting time by waiting process
+            int idx = r[i].from * n + r[i].to;
+            msgs[idx]  += r[i].stat.msgSend;
+            bytes[idx] += r[i].stat.byteSend;
+            wait[idx]  += r[i].stat.waitSend + r[i].stat.waitRecv;
+        }
+        sprintf(key, "name-%d", phase);
+        char* name = laik_kvs_get(kvs, key, 0);
+        fprintf(f, "\n{\"phase\":%d,\"name\":\"%s\",", phase, name ? name : "");
+        for(int m = 0; m < 3; m++) {
+            fprintf(f, "\n \"%s\":[", (m == 0) ? "messages" : (m == 1) ? "bytes" : "wait");
+            for(int from = 0; from < n; from++) {
+                fprintf(f, "%s[", (from > 0) ? ",\n  " : "\n  ");
+                for(int to = 0; to < n; to++) {
+                    int idx = from * n + to;
+                    if (m == 0) fprintf(f, "%s%lu", to ? "," : "", (unsigned long) msgs[idx]);
+                    if (m == 1) fprintf(f, "%s%lu", to ? "," : "", (unsigned long) bytes[idx]);
+                    if (m == 2) fprintf(f, "%s%.6f", to ? "," : "", wait[idx]);
+                }
+                fprintf(f, "]");
+            }
+            fprintf(f, "]%s", (m < 2) ? "," : "");
+        }
+        fprintf(f, "}%s", (i < count) ? "," : "");
+    }
+    fprintf(f, "\n]}\n");
+    fclose(f);
+    free(msgs);
+    free(bytes);
+    free(wait);
+
+    laik_log(2, "written comm matrix to '%s.{csv,json}'", commstat_prefix);
+}
+
+void laik_commstat_writeout(Laik_Instance* inst)
+{
+    if (!laik_commstat_enabled) return;
+    laik_commstat_enabled = false;
+
+    // processes already removed from world cannot take part
+    int myid = laik_myid(inst->world);
+    if (myid < 0) return;
+
+    // own records, only non-zero entries
+    int count = 0;
+    for(int i = 0; i < commstat_count; i++)
+        count += commstat[i].peers;
+    Laik_CommStatRecord* r;
+    r = (Laik_CommStatRecord*) malloc((count + 1) * sizeof(Laik_CommStatRecord));
+    count = 0;
+    Laik_KVStore* kvs = laik_kvs_new("commstat", inst);
+    char key[30];
+    for(int i = 0; i < commstat_count; i++) {
+        Laik_PhaseCommStat* pcs = &(commstat[i]);
+        for(int lid = 0; lid < pcs->peers; lid++) {
+            Laik_CommStat* cs = &(pcs->stat[lid]);
+            if ((cs->msgSend == 0) && (cs->msgRecv == 0)) continue;
+            r[count].phase = pcs->phase;
+            r[count].from = inst->mylocationid;
+            r[count].to = lid;
+            r[count].stat = *cs;
+            count++;
+        }
+        if (pcs->name) {
+            sprintf(key, "name-%d", pcs->phase);
+            laik_kvs_sets(kvs, key, (char*) pcs->name);
+        }
+        free(pcs->stat);
+    }
+    free(commstat);
+    commstat = 0;
+    commstat_count = commstat_size = 0;
+    commstat_last = -1;
+
+    sprintf(key, "%d", inst->mylocationid);
+    if (count > 0)
+        laik_kvs_set(kvs, key, count * sizeof(Laik_CommStatRecord), (char*) r);
+    free(r);
+    laik_kvs_sync(kvs);
+
+    if (myid == 0) {
+        // collect records from all locations
+        int n = inst->locations;
+        count = 0;
+        for(int lid = 0; lid < n; lid++) {
+            unsigned int size;
+            sprintf(key, "%d", lid);
+            if (laik_kvs_get(kvs, key, &size))
+                count += size / sizeof(Laik_CommStatRecord);
+        }
+        r = (Laik_CommStatRecord*) malloc((count + 1) * sizeof(Laik_CommStatRecord));
+        count = 0;
+        for(int lid = 0; lid < n; lid++) {
+            unsigned int size;
+            sprintf(key, "%d", lid);
+            char* v = laik_kvs_get(kvs, key, &size);
+            if (!v) continue;
+            memcpy(r + count, v, size);
+            count += size / sizeof(Laik_CommStatRecord);
+        }
+        qsort(r, count, sizeof(Laik_CommStatRecord), cmp_commstat_record);
+        commstat_write(kvs, r, count, n);
+        free(r);
+    }
+    laik_kvs_free(kvs);
+}
@@ -22,6 +22,80 @@
 
 /// Laik_RangeList
 
+// task id of i-th entry in offset array
+static int taskAt(Laik_RangeList* list, unsigned int i)
+{
+    return list->tasks ? list->tasks[i] : (int) i;
+}
+
+// index into offset array of first task with id >= <tid>
+static unsigned int taskPos(Laik_RangeList* list, int tid)
+{
+    if (list->tasks == 0) return (unsigned int) tid;
+
+    unsigned int lo = 0, hi = list->taskCount;
+    while(lo < hi) {
+        unsigned int mid = (lo + hi) / 2;
+        if (list->tasks[mid] < tid) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// internal
+unsigned int laik_rangelist_off(Laik_RangeList* list, int tid)
+{
+    assert(list->off != 0);
+    assert((tid >= 0) && (tid <= (int) list->tid_count));
+    return list->off[taskPos(list, tid)];
+}
+
+// internal
+Laik_IndexSet* laik_rangelist_iset(Laik_RangeList* list, int tid)
+{
+    assert(list->off != 0);
+    if (list->iset == 0) return 0;
+    unsigned int i = taskPos(list, tid);
+    if ((i == list->taskCount) || (taskAt(list, i) != tid)) return 0;
+    return list->iset[i];
+}
+
+// allocate offset array for <used> tasks with ranges: only store these
+// if less than half of the task ids are used
+static void allocOffsets(Laik_RangeList* list, unsigned int used)
+{
+    free(list->off);
+    free(list->tasks);
+    list->tasks = 0;
+    list->taskCount = list->tid_count;
+    if (2 * used < list->tid_count) {
+        list->taskCount = used;
+        list->tasks = malloc((used + 1) * sizeof(int));
+    }
+    list->off = malloc((list->taskCount + 1) * sizeof(unsigned int));
+    if ((list->off == 0) || ((list->taskCount < list->tid_count) && (list->tasks == 0))) {
+        laik_panic("Out of memory allocating space for Laik_RangeList object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+}
+
+static void freeIndexSets(Laik_RangeList* list)
+{
+    if (!list->iset) return;
+    // before freezing, index sets are indexed by task id
+    unsigned int n = list->off ? list->taskCount : list->tid_count;
+    for(unsigned int i = 0; i < n; i++) {
+        if (list->iset[i])
+            laik_indexset_free(list->iset[i]);
+        if (list->siRange)
+            free(list->siRange[i]);
+    }
+    free(list->iset);
+    free(list->siRange);
+    list->iset = 0;
+    list->siRange = 0;
+}
+
 Laik_RangeList* laik_rangelist_new(Laik_Space* space, unsigned int tid_count)
 {
     Laik_RangeList* list;
@@ -36,12 +110,15 @@ Laik_RangeList* laik_rangelist_new(Laik_Space* space, unsigned int tid_count)
     list->tid_count = tid_count;
 
     list->trange = 0;
-    list->tss1d = 0; // TODO: move into a temporary RangeReceiver
+    list->iset = 0;
+    list->siRange = 0;
     list->count = 0;
     list->capacity = 0;
 
     // as long as no offset array is set, this range list is invalid
     list->off = 0;
+    list->tasks = 0;
+    list->taskCount = 0;
 
     // number of maps still unknown
     list->map_tid = -1; // not used
@@ -54,9 +131,11 @@ Laik_RangeList* laik_rangelist_new(Laik_Space* space, unsigned int tid_count)
 void laik_rangelist_free(Laik_RangeList* list)
 {
     free(list->trange);
-    free(list->tss1d);
+    freeIndexSets(list);
     free(list->off);
+    free(list->tasks);
     free(list->map_off);
+    free(list);
 }
 
 // does this cover the full space with one range for each process?
@@ -64,8 +143,9 @@ bool laik_rangelist_isAll(Laik_RangeList* list)
 {
     if (list->count != list->tid_count) return false;
     for(unsigned int i = 0; i < list->count; i++) {
-        if (list->trange[i].task != (int) i) return false;
-        if (!laik_range_isEqual(&(list->trange[i].range), &(list->space->range)))
+        Laik_TaskRange_Gen* tr = laik_rangelist_trange(list, i);
+        if (tr->task != (int) i) return false;
+        if (!laik_range_isEqual(&(tr->range), &(list->space->range)))
             return false;
     }
     return true;
@@ -76,10 +156,17 @@ bool laik_rangelist_isAll(Laik_RangeList* list)
 int laik_rangelist_isSingle(Laik_RangeList* list)
 {
     if (list->count != 1) return -1;
-    if (!laik_range_isEqual(&(list->trange[0].range), &(list->space->range)))
+    Laik_TaskRange_Gen* tr = laik_rangelist_trange(list, 0);
+    if (!laik_range_isEqual(&(tr->range), &(list->space->range)))
         return -1;
 
-    return list->trange[0].task;
+    return tr->task;
+}
+
+// helper for laik_rangelist_isEqual: sum up sizes of runs
+static void addRunSize(void* ctx, int64_t from, int64_t to)
+{
+    *((int64_t*) ctx) += to - from;
 }
 
 // are the ranges of two range lists equal?
@@ -92,14 +179,33 @@ bool laik_rangelist_isEqual(Laik_RangeList* r1, Laik_RangeList* r2)
     if (r1->space != r2->space) return false;
     if (r1->count != r2->count) return false;
 
-    for(unsigned int i = 0; i < r1->tid_count; i++)
+    // which tasks are stored only depends on tasks with ranges
+    if (r1->taskCount != r2->taskCount) return false;
+    if ((r1->tasks == 0) != (r2->tasks == 0)) return false;
+    for(unsigned int i = 0; i < r1->taskCount; i++) {
         if (r1->off[i] != r2->off[i]) return false;
+        if (r1->tasks && (r1->tasks[i] != r2->tasks[i])) return false;
+    }
+
+    if (r1->iset && r2->iset) {
+        // same number of runs per task: sets equal if intersection has same size
+        for(unsigned int i = 0; i < r1->taskCount; i++) {
+            if (r1->off[i] == r1->off[i+1]) continue;
+            int64_t size1 = 0, sizeI = 0;
+            laik_indexset_runs(r1->iset[i], addRunSize, &size1);
+            laik_indexset_intersect(r1->iset[i], r2->iset[i], addRunSize, &sizeI);
+            if (size1 != sizeI) return false;
+        }
+        return true;
+    }
 
     for(unsigned int i = 0; i < r1->count; i++) {
+        Laik_TaskRange_Gen* tr1 = laik_rangelist_trange(r1, i);
+        Laik_TaskRange_Gen* tr2 = laik_rangelist_trange(r2, i);
         // tasks must match, as offset array matched
-        assert(r1->trange[i].task == r2->trange[i].task);
+        assert(tr1->task == tr2->task);
 
-        if (!laik_range_isEqual(&(r1->trange[i].range), &(r2->trange[i].range)))
+        if (!laik_range_isEqual(&(tr1->range), &(tr2->range)))
             return false;
     }
     return true;
@@ -116,7 +222,7 @@ int laik_rangelist_tidrangecount(Laik_RangeList* list, int tid)
     assert(list->off != 0);
     assert((tid >= 0) && (tid < (int) list->tid_count));
 
-    return (int)(list->off[tid+1] - list->off[tid]);
+    return (int)(laik_rangelist_off(list, tid+1) - laik_rangelist_off(list, tid));
 }
 
 // get number of mappings for this task
@@ -124,10 +230,14 @@ int laik_rangelist_tidmapcount(Laik_RangeList* list, int tid)
 {
     assert(list->off != 0);
     assert((tid >= 0) && (tid < (int) list->tid_count));
-    if (list->off[tid+1] == list->off[tid]) return 0;
+    unsigned int lastOff = laik_rangelist_off(list, tid+1);
+    if (lastOff == laik_rangelist_off(list, tid)) return 0;
+
+    // single index format: one mapping
+    if (list->iset) return 1;
 
     // map number of my last range, incremented by one to get count
-    return list->trange[list->off[tid+1] - 1].mapNo + 1;
+    return list->trange[lastOff - 1].mapNo + 1;
 }
 
 Laik_TaskRange* laik_rangelist_taskrange(Laik_RangeList* list, int n)
@@ -148,12 +258,13 @@ Laik_TaskRange* laik_rangelist_tidrange(Laik_RangeList* list, int tid, int n)
 {
     assert(list->off != 0);
     assert((tid >= 0) && (tid < (int) list->tid_count));
-    int count = (int)(list->off[tid + 1] - list->off[tid]);
+    unsigned int firstOff = laik_rangelist_off(list, tid);
+    int count = (int)(laik_rangelist_off(list, tid + 1) - firstOff);
 
     // range <n> invalid?
     if ((n < 0) || (n >= count)) return 0;
-    int o = (int) list->off[tid] + n;
-    assert(list->trange[o].task == tid);
+    int o = (int) firstOff + n;
+    assert(laik_rangelist_trange(list, o)->task == tid);
     return laik_rangelist_taskrange(list, o);
 }
 
@@ -201,6 +312,53 @@ int trgen_cmpfrom(const void *p1, const void *p2)
     return -1;
 }
 
+// helpers for coversSpaceSI: collect runs of all tasks into an array
+typedef struct {
+    int64_t from, to;
+} SIRun;
+
+static void appendSIRun(void* ctx, int64_t from, int64_t to)
+{
+    SIRun** pos = (SIRun**) ctx;
+    (*pos)->from = from;
+    (*pos)->to = to;
+    (*pos)++;
+}
+
+static int sirun_cmp(const void *p1, const void *p2)
+{
+    const SIRun* r1 = (const SIRun*) p1;
+    const SIRun* r2 = (const SIRun*) p2;
+    if (r1->from > r2->from) return 1;
+    if (r1->from == r2->from) return 0;
+    return -1;
+}
+
+// single index format: check coverage with sorted runs of all tasks,
+// without converting into generic ranges
+static bool coversSpaceSI(Laik_RangeList* list)
+{
+    SIRun* runs = malloc(list->count * sizeof(SIRun));
+    if (!runs) {
+        laik_panic("Out of memory allocating memory for coversSpace");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    SIRun* pos = runs;
+    for(unsigned int i = 0; i < list->taskCount; i++)
+        if (list->iset[i])
+            laik_indexset_runs(list->iset[i], appendSIRun, &pos);
+    assert(pos == runs + list->count);
+    qsort(runs, list->count, sizeof(SIRun), sirun_cmp);
+
+    int64_t covered = list->space->range.from.i[0];
+    for(unsigned int i = 0; i < list->count; i++) {
+        if (runs[i].from > covered) break; // gap
+        if (runs[i].to > covered) covered = runs[i].to;
+    }
+    free(runs);
+    return (covered >= list->space->range.to.i[0]);
+}
+
 // do the ranges of this partitioning cover the full space?
 // (currently works for 1d/2d/3d spaces)
 //
@@ -215,6 +373,9 @@ int trgen_cmpfrom(const void *p1, const void *p2)
 // list (eg. in 3d, 6 smaller ranges may be created).
 bool laik_rangelist_coversSpace(Laik_RangeList* list)
 {
+    if (list->iset)
+        return coversSpaceSI(list);
+
     int dims = list->space->dims;
     notcovered_count = 0;
 
@@ -229,7 +390,8 @@ bool laik_rangelist_coversSpace(Laik_RangeList* list)
         exit(1); // not actually needed, laik_panic never returns
     }
 
-    memcpy(trlist, list->trange, list->count * sizeof(Laik_TaskRange_Gen));
+    for(unsigned int i = 0; i < list->count; i++)
+        trlist[i] = *laik_rangelist_trange(list, i);
     qsort(trlist, list->count, sizeof(Laik_TaskRange_Gen), trgen_cmpfrom);
 
     // remove each range in partitioning
@@ -310,7 +472,7 @@ void laik_rangelist_append(Laik_RangeList* list, int tid, const Laik_Range* rang
     assert(range->space == list->space);
 
     // not allowed to add ranges with different APIs
-    assert(list->tss1d == 0);
+    assert(list->iset == 0);
 
     if (list->count == list->capacity) {
         list->capacity = (list->capacity + 2) * 2;
@@ -340,26 +502,22 @@ void laik_rangelist_append_single1d(Laik_RangeList* list, int tid, int64_t idx)
 {
     // not allowed to add ranges with different APIs
     assert(list->trange == 0);
+    assert((tid >= 0) && (tid < (int) list->tid_count));
+    assert((idx >= list->space->range.from.i[0]) && (idx < list->space->range.to.i[0]));
 
-    if (list->count == list->capacity) {
-        assert(list->trange == 0);
-        list->capacity = (list->capacity + 2) * 2;
-        list->tss1d = realloc(list->tss1d,
-                            sizeof(Laik_TaskRange_Single1d) * list->capacity);
-        if (!list->tss1d) {
+    if (list->iset == 0) {
+        list->iset = calloc(list->tid_count, sizeof(Laik_IndexSet*));
+        if (!list->iset) {
             laik_panic("Out of memory allocating memory for Laik_Partitioning");
             exit(1); // not actually needed, laik_panic never returns
         }
     }
-    assert(list->tss1d);
-    assert((tid >= 0) && (tid < (int) list->tid_count));
-    assert((idx >= list->space->range.from.i[0]) && (idx < list->space->range.to.i[0]));
+    if (list->iset[tid] == 0)
+        list->iset[tid] = laik_indexset_new();
+    laik_indexset_add(list->iset[tid], idx);
 
-    Laik_TaskRange_Single1d* ts = &(list->tss1d[list->count]);
+    // until frozen, count is number of added indexes
     list->count++;
-
-    ts->task = tid;
-    ts->idx = idx;
 }
 
 // internal helpers for RangeList
@@ -382,19 +540,6 @@ static int trgen_cmp(const void *p1, const void *p2)
     return ts1->task - ts2->task;
 }
 
-static int tss1d_cmp(const void *p1, const void *p2)
-{
-    const Laik_TaskRange_Single1d* ts1 = (const Laik_TaskRange_Single1d*) p1;
-    const Laik_TaskRange_Single1d* ts2 = (const Laik_TaskRange_Single1d*) p2;
-    if (ts1->task == ts2->task) {
-        // sort ranges for same task by index
-        if (ts1->idx > ts2->idx) return 1;
-        if (ts1->idx == ts2->idx) return 0;
-        return -1;
-    }
-    return ts1->task - ts2->task;
-}
-
 static void sortRanges(Laik_RangeList* list)
 {
     // nothing to sort?
@@ -451,10 +596,18 @@ static void updateOffsets(Laik_RangeList* list)
 
     // we assume that the ranges where sorted with sortRanges()
 
-    int task, mapNo, lastTag;
-    unsigned int off = 0;
-    for(task = 0; task < (int) list->tid_count; task++) {
-        list->off[task] = off;
+    unsigned int used = 0;
+    for(unsigned int o = 0; o < list->count; o++)
+        if ((o == 0) || (list->trange[o].task != list->trange[o-1].task))
+            used++;
+    allocOffsets(list, used);
+
+    int mapNo, lastTag;
+    unsigned int i, off = 0;
+    for(i = 0; i < list->taskCount; i++) {
+        int task = list->tasks ? list->trange[off].task : (int) i;
+        if (list->tasks) list->tasks[i] = task;
+        list->off[i] = off;
         mapNo = -1; // for numbering of mappings according to tags
         lastTag = -1;
         while(off < list->count) {
@@ -469,97 +622,134 @@ static void updateOffsets(Laik_RangeList* list)
             off++;
         }
     }
-    list->off[task] = off;
+    list->off[i] = off;
     assert(off == list->count);
 }
 
-// update offset array from ranges, single index format
-// also, convert to generic format
+// set offsets from sets <iset> of tasks <task> (sorted, <used> entries),
+// single index format: index sets of each task are kept, ranges are the
+// maximal runs of indexes in a set. The sets replace the ones of <list>
+static void setOffsetsSI(Laik_RangeList* list, unsigned int used,
+                         int* task, Laik_IndexSet** iset)
+{
+    allocOffsets(list, used);
+    Laik_IndexSet** newSet = calloc(list->taskCount + 1, sizeof(Laik_IndexSet*));
+    if (!newSet) {
+        laik_panic("Out of memory allocating space for Laik_RangeList object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    for(unsigned int j = 0; j < used; j++) {
+        unsigned int i = list->tasks ? j : (unsigned int) task[j];
+        if (list->tasks) list->tasks[i] = task[j];
+        newSet[i] = iset[j];
+    }
+
+    unsigned int count = 0;
+    for(unsigned int i = 0; i < list->taskCount; i++) {
+        list->off[i] = count;
+        if (newSet[i])
+            count += laik_indexset_runs(newSet[i], 0, 0);
+    }
+    list->off[list->taskCount] = count;
+    list->count = count;
+
+    free(list->iset);
+    list->iset = newSet;
+}
+
+// update offset array from index sets added per task id
 static void updateOffsetsSI(Laik_RangeList* list)
 {
-    assert(list->tss1d);
+    assert(list->iset);
     assert(list->count > 0);
 
-    // make sure ranges are sorted according by task IDs
-    qsort(&(list->tss1d[0]), list->count,
-          sizeof(Laik_TaskRange_Single1d), tss1d_cmp);
+    unsigned int used = 0;
+    int* task = malloc(list->tid_count * sizeof(int));
+    if (!task) {
+        laik_panic("Out of memory allocating space for Laik_RangeList object");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    for(unsigned int t = 0; t < list->tid_count; t++) {
+        if (list->iset[t] == 0) continue;
+        task[used] = (int) t;
+        list->iset[used] = list->iset[t];
+        used++;
+    }
 
-    // count ranges
-    int64_t idx, idx0;
+    unsigned int added = list->count;
+    setOffsetsSI(list, used, task, list->iset);
+    free(task);
+    laik_log(1, "Merging single indexes: %d original, %d merged",
+             added, list->count);
+}
+
+// single index format: convert runs of task <task> into generic ranges
+typedef struct {
+    Laik_TaskRange_Gen* tr;
+    Laik_Space* space;
     int task;
-    unsigned int count = 1;
-    task = list->tss1d[0].task;
-    idx = list->tss1d[0].idx;
-    for(unsigned int i = 1; i < list->count; i++) {
-        if (list->tss1d[i].task == task) {
-            if (list->tss1d[i].idx == idx) continue;
-            if (list->tss1d[i].idx == idx + 1) {
-                idx++;
-                continue;
-            }
+} SIRunCtx;
+
+static void addSIRange(void* ctx, int64_t from, int64_t to)
+{
+    SIRunCtx* c = (SIRunCtx*) ctx;
+
+    Laik_TaskRange_Gen* ts = c->tr++;
+    ts->task = c->task;
+    ts->tag = 1; // all ranges go into one mapping
+    ts->mapNo = 0;
+    ts->data = 0;
+    ts->range.space = c->space;
+    ts->range.from.i[0] = from;
+    ts->range.to.i[0] = to;
+}
+
+static void convertSIRanges(Laik_RangeList* list, unsigned int i)
+{
+    int task = taskAt(list, i);
+    unsigned int count = list->off[i+1] - list->off[i];
+    if (list->siRange == 0) {
+        list->siRange = calloc(list->taskCount, sizeof(Laik_TaskRange_Gen*));
+        if (!list->siRange) {
+            laik_panic("Out of memory allocating memory for Laik_RangeList");
+            exit(1); // not actually needed, laik_panic never returns
         }
-        task = list->tss1d[i].task;
-        idx = list->tss1d[i].idx;
-        count++;
     }
-    laik_log(1, "Merging single indexes: %d original, %d merged",
-             list->count, count);
-
-    list->trange = malloc(sizeof(Laik_TaskRange_Gen) * count);
-    if (!list->trange) {
-        laik_panic("Out of memory allocating memory for Laik_Partitioning");
+    Laik_TaskRange_Gen* tr = malloc(count * sizeof(Laik_TaskRange_Gen));
+    if (!tr) {
+        laik_panic("Out of memory allocating memory for Laik_RangeList");
         exit(1); // not actually needed, laik_panic never returns
     }
+    laik_log(1, "Converting %d runs of single indexes for task %d", count, task);
+
+    SIRunCtx ctx;
+    ctx.tr = tr;
+    ctx.space = list->space;
+    ctx.task = task;
+    laik_indexset_runs(list->iset[i], addSIRange, &ctx);
+    assert(ctx.tr == tr + count);
+    list->siRange[i] = tr;
+}
 
-    // convert into generic ranges (already sorted)
-    unsigned int off = 0, j = 0;
-    task = list->tss1d[0].task;
-    idx0 = idx = list->tss1d[0].idx;
-    for(unsigned int i = 1; i <= list->count; i++) {
-        if ((i < list->count) && (list->tss1d[i].task == task)) {
-            if (list->tss1d[i].idx == idx) continue;
-            if (list->tss1d[i].idx == idx + 1) {
-                idx++;
-                continue;
-            }
-        }
-        laik_log(1, "  adding range for offsets %d - %d: task %d, [%lld;%lld[",
-                 j, i-1, task,
-                 (long long) idx0, (long long) (idx + 1) );
-
-        Laik_TaskRange_Gen* ts = &(list->trange[off]);
-        ts->task = task;
-        ts->tag = 0;
-        ts->mapNo = 0;
-        ts->data = 0;
-        ts->range.space = list->space;
-        ts->range.from.i[0] = idx0;
-        ts->range.to.i[0] = idx + 1;
-        off++;
-        if (i == list->count) break;
-
-        task = list->tss1d[i].task;
-        idx0 = idx = list->tss1d[i].idx;
-        j = i;
-    }
-    assert(count == off);
-    list->count = count;
-    free(list->tss1d);
-    list->tss1d = 0;
-
-    // update offsets
-    off = 0;
-    for(task = 0; task < (int) list->tid_count; task++) {
-        list->off[task] = off;
-        while(off < list->count) {
-            Laik_TaskRange_Gen* ts = &(list->trange[off]);
-            if (ts->task > task) break;
-            assert(ts->task == task);
-            off++;
-        }
+// internal
+Laik_TaskRange_Gen* laik_rangelist_trange(Laik_RangeList* list, unsigned int o)
+{
+    assert(list->off != 0);
+    assert(o < list->count);
+    if (list->iset == 0)
+        return &(list->trange[o]);
+
+    // binary search for task with off[i] <= o < off[i+1]
+    unsigned int lo = 0, hi = list->taskCount;
+    while(hi - lo > 1) {
+        unsigned int mid = (lo + hi) / 2;
+        if (list->off[mid] <= o) lo = mid;
+        else hi = mid;
     }
-    list->off[task] = off;
-    assert(off == list->count);
+
+    if ((list->siRange == 0) || (list->siRange[lo] == 0))
+        convertSIRanges(list, lo);
+    return &(list->siRange[lo][o - list->off[lo]]);
 }
 
 // internal
@@ -572,10 +762,10 @@ void laik_updateMapOffsets(Laik_RangeList* list, int tid)
 
     assert((tid >= 0) && (tid < (int) list->tid_count));
 
-    unsigned int firstOff = list->off[tid];
-    unsigned int lastOff = list->off[tid + 1];
+    unsigned int firstOff = laik_rangelist_off(list, tid);
+    unsigned int lastOff = laik_rangelist_off(list, tid + 1);
     if (lastOff > firstOff)
-        list->map_count = (unsigned)(list->trange[lastOff - 1].mapNo + 1);
+        list->map_count = list->iset ? 1 : (unsigned)(list->trange[lastOff - 1].mapNo + 1);
     else {
         list->map_count = 0;
         return;
@@ -587,8 +777,13 @@ void laik_updateMapOffsets(Laik_RangeList* list, int tid)
         exit(1); // not actually needed, laik_panic never returns
     }
 
-    // only works with generic task ranges (other formats converted)
-    assert(list->tss1d == 0);
+    if (list->iset) {
+        // single index format: one mapping
+        assert(list->map_count == 1);
+        list->map_off[0] = firstOff;
+        list->map_off[1] = lastOff;
+        return;
+    }
 
     int mapNo;
     unsigned int off = firstOff;
@@ -635,8 +830,8 @@ Laik_TaskRange* laik_rangelist_tidmaprange(Laik_RangeList* list, int tid, int ma
     if ((n < 0) || (n >= count)) return 0;
 
     int o = (int) list->map_off[mapNo] + n;
-    assert(list->trange[o].task == tid);
-    assert(list->trange[o].mapNo == mapNo);
+    assert(laik_rangelist_trange(list, o)->task == tid);
+    assert(laik_rangelist_trange(list, o)->mapNo == mapNo);
     return laik_rangelist_taskrange(list, o);
 }
 
@@ -647,14 +842,8 @@ void laik_rangelist_freeze(Laik_RangeList* list, bool doMerge)
     assert(list->off == 0);
 
     // set partitioning valid by allocating/updating offsets
-    list->off = malloc(sizeof(int) * (list->tid_count + 1));
-    if (list->off == 0) {
-        laik_panic("Out of memory allocating space for Laik_RangeList object");
-        exit(1); // not actually needed, laik_panic never returns
-    }
-
-    if (list->tss1d) {
-        // merge and convert to generic
+    if (list->iset) {
+        // merged runs of indexes, kept in index sets
         updateOffsetsSI(list);
     }
     else {
@@ -668,6 +857,168 @@ void laik_rangelist_freeze(Laik_RangeList* list, bool doMerge)
     }
 }
 
+
+// binary format of a range list, e.g. to distribute it among processes:
+// header followed by <count> records of task id, tag, and from/to indexes
+// (<dims> 64-bit values each). Space borders and number of task ids are
+// stored to check for validity when reading back
+#define RANGELIST_MAGIC 0x4c52414c // "LARL"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t dims;
+    uint32_t tid_count;
+    uint32_t count;
+    int64_t from[3], to[3];
+} RangeList_Header;
+
+// helper for laik_rangelist_serialize: write record for run of indexes
+typedef struct {
+    char* pos;
+    int task;
+} SISerCtx;
+
+static void serializeSIRun(void* ctx, int64_t from, int64_t to)
+{
+    SISerCtx* c = (SISerCtx*) ctx;
+    int32_t v[2] = { c->task, 1 };
+    memcpy(c->pos, v, sizeof(v));
+    memcpy(c->pos + sizeof(v), &from, sizeof(int64_t));
+    memcpy(c->pos + sizeof(v) + sizeof(int64_t), &to, sizeof(int64_t));
+    c->pos += sizeof(v) + 2 * sizeof(int64_t);
+}
+
+// serialize frozen range list into buffer, to be freed by caller
+char* laik_rangelist_serialize(Laik_RangeList* list, unsigned int* psize)
+{
+    assert(list->off != 0);
+    int dims = list->space->dims;
+    unsigned int rsize = 2 * sizeof(int32_t) + 2 * dims * sizeof(int64_t);
+    unsigned int size = sizeof(RangeList_Header) + list->count * rsize;
+
+    char* buf = malloc(size);
+    if (buf == 0) {
+        laik_panic("Out of memory serializing range list");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+
+    RangeList_Header* h = (RangeList_Header*) buf;
+    memset(h, 0, sizeof(RangeList_Header));
+    h->magic = RANGELIST_MAGIC;
+    h->dims = dims;
+    h->tid_count = list->tid_count;
+    h->count = list->count;
+    for(int d = 0; d < dims; d++) {
+        h->from[d] = list->space->range.from.i[d];
+        h->to[d] = list->space->range.to.i[d];
+    }
+
+    char* pos = buf + sizeof(RangeList_Header);
+    if (list->iset) {
+        // single index format: runs of each task, without conversion
+        SISerCtx ctx;
+        ctx.pos = pos;
+        for(unsigned int i = 0; i < list->taskCount; i++) {
+            if (list->iset[i] == 0) continue;
+            ctx.task = taskAt(list, i);
+            laik_indexset_runs(list->iset[i], serializeSIRun, &ctx);
+        }
+        pos = ctx.pos;
+    }
+    for(unsigned int i = 0; (list->iset == 0) && (i < list->count); i++) {
+        Laik_TaskRange_Gen* tr = &(list->trange[i]);
+        int32_t v[2] = { tr->task, tr->tag };
+        memcpy(pos, v, sizeof(v));
+        pos += sizeof(v);
+        memcpy(pos, tr->range.from.i, dims * sizeof(int64_t));
+        pos += dims * sizeof(int64_t);
+        memcpy(pos, tr->range.to.i, dims * sizeof(int64_t));
+        pos += dims * sizeof(int64_t);
+    }
+    assert(pos == buf + size);
+
+    if (psize) *psize = size;
+    return buf;
+}
+
+// append ranges from a serialized range list to a not-yet frozen list.
+// Returns false if format, space or task count do not match
+bool laik_rangelist_append_serialized(Laik_RangeList* list,
+                                      char* buf, unsigned int size)
+{
+    assert(list->off == 0);
+    if (size < sizeof(RangeList_Header)) return false;
+
+    RangeList_Header h;
+    memcpy(&h, buf, sizeof(RangeList_Header));
+    Laik_Space* s = list->space;
+    int dims = s->dims;
+    if ((h.magic != RANGELIST_MAGIC) || (h.dims != (uint32_t) dims) ||
+        (h.tid_count != list->tid_count)) return false;
+    for(int d = 0; d < dims; d++)
+        if ((h.from[d] != s->range.from.i[d]) || (h.to[d] != s->range.to.i[d]))
+            return false;
+
+    unsigned int rsize = 2 * sizeof(int32_t) + 2 * dims * sizeof(int64_t);
+    if (size != sizeof(RangeList_Header) + h.count * rsize) return false;
+
+    Laik_Range range;
+    laik_range_init(&range, s, &(s->range.from), &(s->range.to));
+    char* pos = buf + sizeof(RangeList_Header);
+    for(unsigned int i = 0; i < h.count; i++) {
+        int32_t v[2];
+        memcpy(v, pos, sizeof(v));
+        pos += sizeof(v);
+        memcpy(range.from.i, pos, dims * sizeof(int64_t));
+        pos += dims * sizeof(int64_t);
+        memcpy(range.to.i, pos, dims * sizeof(int64_t));
+        pos += dims * sizeof(int64_t);
+        if ((v[0] < 0) || (v[0] >= (int32_t) list->tid_count)) return false;
+        if (!laik_range_within_space(&range, s)) return false;
+        laik_rangelist_append(list, v[0], &range, v[1], 0);
+    }
+    return true;
+}
+
+// helper for laik_rangelist_migrate: move index sets to new task ids
+static void migrateSI(Laik_RangeList* list, int* idmap, unsigned int new_count)
+{
+    // new task id for each stored index set
+    Laik_IndexSet** iset = calloc(new_count + 1, sizeof(Laik_IndexSet*));
+    int* task = malloc((new_count + 1) * sizeof(int));
+    if (!iset || !task) {
+        laik_panic("Out of memory allocating space for Laik_RangeList");
+        exit(1); // not actually needed, laik_panic never returns
+    }
+    for(unsigned int i = 0; i < list->taskCount; i++) {
+        if (list->iset[i] == 0) continue;
+        int new_id = idmap[taskAt(list, i)];
+        assert((new_id >= 0) && (new_id < (int) new_count));
+        iset[new_id] = list->iset[i];
+    }
+    unsigned int used = 0;
+    for(unsigned int t = 0; t < new_count; t++) {
+        if (iset[t] == 0) continue;
+        task[used] = (int) t;
+        iset[used] = iset[t];
+        used++;
+    }
+
+    // converted ranges store old task ids
+    if (list->siRange) {
+        for(unsigned int i = 0; i < list->taskCount; i++)
+            free(list->siRange[i]);
+        free(list->siRange);
+        list->siRange = 0;
+    }
+    unsigned int count = list->count;
+    list->tid_count = new_count;
+    setOffsetsSI(list, used, task, iset);
+    assert(list->count == count);
+    free(iset);
+    free(task);
+}
+
 // translate task ids using <idmap> array: idmap[old_id] = new_id
 // if idmap[id] == -1, no range with that id is allowed to exist
 void laik_rangelist_migrate(Laik_RangeList* list, int* idmap, unsigned int new_count)
@@ -675,9 +1026,14 @@ void laik_rangelist_migrate(Laik_RangeList* list, int* idmap, unsigned int new_c
     assert(list->off != 0);
 
     // check that there are no ranges of removed task ids
-    for(unsigned int i = 0; i < list->tid_count; i++) {
-        if (idmap[i] < 0)
-            assert(list->off[i] == list->off[i+1]);
+    for(unsigned int i = 0; i < list->taskCount; i++) {
+        if (list->off[i] < list->off[i+1])
+            assert(idmap[taskAt(list, i)] >= 0);
+    }
+
+    if (list->iset) {
+        migrateSI(list, idmap, new_count);
+        return;
     }
 
     // update range task ids
@@ -689,15 +1045,7 @@ void laik_rangelist_migrate(Laik_RangeList* list, int* idmap, unsigned int new_c
         list->trange[i].task = new_id;
     }
 
-    // resize offset array if needed
-    if (new_count > list->tid_count) {
-        free(list->off);
-        list->off = malloc((new_count +1) * sizeof(int));
-        if (!list->off) {
-            laik_panic("Out of memory allocating space for Laik_RangeList");
-            exit(1); // not actually needed, laik_panic never returns
-        }
-    }
+    // offset array gets reallocated
     list->tid_count = new_count;
     sortRanges(list);
     updateOffsets(list);
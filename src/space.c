@@ -588,28 +588,14 @@ const Laik_Range* laik_taskrange_get_range(Laik_TaskRange* trange)
 
     if (!trange) return 0;
 
-    if (trange->list->trange)
-        return &(trange->list->trange[trange->no].range);
-
-    if (trange->list->tss1d) {
-        static Laik_Range range;
-        int64_t idx = trange->list->tss1d[trange->no].idx;
-        laik_range_init_1d(&range, trange->list->space, idx, idx + 1);
-        return &range;
-    }
-    return 0;
+    return &(laik_rangelist_trange(trange->list, trange->no)->range);
 }
 
 // get the process rank of an task range
 int laik_taskrange_get_task(Laik_TaskRange* trange)
 {
     assert(trange && trange->list);
-    if (trange->list->trange)
-        return trange->list->trange[trange->no].task;
-    if (trange->list->tss1d)
-        return trange->list->tss1d[trange->no].task;
-
-    return -1;
+    return laik_rangelist_trange(trange->list, trange->no)->task;
 }
 
 
@@ -617,20 +603,16 @@ int laik_taskrange_get_task(Laik_TaskRange* trange)
 int laik_taskrange_get_mapNo(Laik_TaskRange* trange)
 {
     assert(trange && trange->list);
-    // does the partitioning store ranges as single indexes? Only one map!
-    if (trange->list->tss1d) return 0;
 
-    Laik_TaskRange_Gen* tsg = &(trange->list->trange[trange->no]);
+    Laik_TaskRange_Gen* tsg = laik_rangelist_trange(trange->list, trange->no);
     return tsg->mapNo;
 }
 
 int laik_taskrange_get_tag(Laik_TaskRange* trange)
 {
     assert(trange && trange->list);
-    // does the partitioning store ranges as single indexes? Always tag 1
-    if (trange->list->tss1d) return 1;
 
-    Laik_TaskRange_Gen* tsg = &(trange->list->trange[trange->no]);
+    Laik_TaskRange_Gen* tsg = laik_rangelist_trange(trange->list, trange->no);
     return tsg->tag;
 }
 
@@ -640,20 +622,16 @@ int laik_taskrange_get_tag(Laik_TaskRange* trange)
 void* laik_taskrange_get_data(Laik_TaskRange* trange)
 {
     assert(trange && trange->list);
-    // does the partitioning store ranges as single indexes? No data!
-    if (trange->list->tss1d) return 0;
 
-    Laik_TaskRange_Gen* tsg = &(trange->list->trange[trange->no]);
+    Laik_TaskRange_Gen* tsg = laik_rangelist_trange(trange->list, trange->no);
     return tsg->data;
 }
 
 void laik_taskrange_set_data(Laik_TaskRange* trange, void* data)
 {
     assert(trange && trange->list);
-    // does the partitioning store ranges as single indexes? No data to set!
-    assert(trange->list->tss1d == 0);
 
-    Laik_TaskRange_Gen* tsg = &(trange->list->trange[trange->no]);
+    Laik_TaskRange_Gen* tsg = laik_rangelist_trange(trange->list, trange->no);
     tsg->data = data;
 }
 
@@ -1053,6 +1031,106 @@ bool oneInputIsCopy(Laik_ReductionOperation redOp)
     return (int) redOp < LAIK_RO_Custom;
 }
 
+// helpers for calcSITransition: add operations for runs of indexes.
+// Map/range numbers are the own ones of the operation kind; in single
+// index format, all ranges of a task are in mapping 0, and range numbers
+// (only used for debug output) are not tracked
+typedef enum { SI_Local, SI_Send, SI_Recv } SITOpKind;
+
+typedef struct {
+    SITOpKind kind;
+    int task; // remote task for send/recv
+    int fromRangeNo, toRangeNo;
+    int fromMapNo, toMapNo;
+    Laik_Space* space;
+} SITOpCtx;
+
+static void addSITOp(void* ctx, int64_t from, int64_t to)
+{
+    SITOpCtx* c = (SITOpCtx*) ctx;
+    Laik_Range range;
+    laik_range_init_1d(&range, c->space, from, to);
+    switch(c->kind) {
+    case SI_Local:
+        appendLocalTOp(&range, c->fromRangeNo, c->toRangeNo,
+                       c->fromMapNo, c->toMapNo);
+        break;
+    case SI_Send:
+        appendSendTOp(&range, c->fromRangeNo, c->fromMapNo, c->task);
+        break;
+    case SI_Recv:
+        appendRecvTOp(&range, c->toRangeNo, c->toMapNo, c->task);
+        break;
+    }
+}
+
+// add operations for indexes both in ranges of <fromTask> in <fromRL> and
+// of <toTask> in <toRL>, with at least one list in single index format.
+// With a generic list, runs are split at its range borders: this way,
+// sender and receiver always agree on the ranges of messages
+static void addSIIntersection(SITOpCtx* c,
+                              Laik_RangeList* fromRL, int fromTask,
+                              Laik_RangeList* toRL, int toTask)
+{
+    if (laik_rangelist_tidrangecount(fromRL, fromTask) == 0) return;
+    if (laik_rangelist_tidrangecount(toRL, toTask) == 0) return;
+
+    c->fromRangeNo = c->toRangeNo = 0;
+    c->fromMapNo = c->toMapNo = 0;
+    if (fromRL->iset && toRL->iset) {
+        laik_indexset_intersect(laik_rangelist_iset(fromRL, fromTask),
+                                laik_rangelist_iset(toRL, toTask),
+                                addSITOp, c);
+        return;
+    }
+
+    Laik_RangeList* rl = fromRL->iset ? toRL : fromRL; // generic list
+    int task = fromRL->iset ? toTask : fromTask;
+    Laik_IndexSet* iset = fromRL->iset ? laik_rangelist_iset(fromRL, fromTask)
+                                       : laik_rangelist_iset(toRL, toTask);
+    unsigned int firstOff = laik_rangelist_off(rl, task);
+    unsigned int lastOff = laik_rangelist_off(rl, task + 1);
+    for(unsigned int o = firstOff; o < lastOff; o++) {
+        Laik_TaskRange_Gen* tr = &(rl->trange[o]);
+        if (rl == fromRL) {
+            c->fromRangeNo = o - firstOff;
+            c->fromMapNo = tr->mapNo;
+        }
+        else {
+            c->toRangeNo = o - firstOff;
+            c->toMapNo = tr->mapNo;
+        }
+        laik_indexset_runs_in(iset, tr->range.from.i[0], tr->range.to.i[0],
+                              addSITOp, c);
+    }
+}
+
+// transition without reduction between 1d range lists, at least one in
+// single index format: intersect own ranges with the ones of each task
+// instead of sweeping over range borders, avoiding conversion of index
+// sets into generic ranges
+static
+void calcSITransition(Laik_Group* group,
+                      Laik_RangeList* fromRL, Laik_RangeList* toRL)
+{
+    int myid = group->myid;
+    SITOpCtx c;
+    c.space = fromRL->space;
+
+    for(int task = 0; task < group->size; task++) {
+        c.task = task;
+        if (task == myid) {
+            c.kind = SI_Local;
+            addSIIntersection(&c, fromRL, myid, toRL, myid);
+            continue;
+        }
+        c.kind = SI_Send;
+        addSIIntersection(&c, fromRL, myid, toRL, task);
+        c.kind = SI_Recv;
+        addSIIntersection(&c, fromRL, task, toRL, myid);
+    }
+}
+
 // find all ranges where this task takes part in a reduction, and add
 // them to the reduction operation list.
 // TODO: we only support one mapping in each task for reductions
@@ -1069,8 +1147,8 @@ void calcAddReductions(int tflags,
 
     Laik_RangeList *fromRL, *toRL;
     // need at least intersection of own ranges in fromP/toP to calculate transition
-    fromRL = laik_partitioning_interranges(fromP, toP);
-    toRL = laik_partitioning_interranges(toP, fromP);
+    fromRL = laik_partitioning_transranges(fromP, toP);
+    toRL = laik_partitioning_transranges(toP, fromP);
     if ((fromRL == 0) || (toRL == 0)) {
         // required ranges for transition calculation not calculated yet
         laik_panic("Transition calculation not possible without pre-calculated ranges");
@@ -1084,6 +1162,11 @@ void calcAddReductions(int tflags,
                        fromP->name, fromRL->count, toP->name, toRL->count);
     }
 
+    if (!laik_is_reduction(redOp) && (fromRL->iset || toRL->iset)) {
+        calcSITransition(group, fromRL, toRL);
+        return;
+    }
+
     // add range borders of all tasks
     cleanBorderList();
     int rangeNo, lastTask, lastMapNo;
@@ -1091,7 +1174,7 @@ void calcAddReductions(int tflags,
     lastTask = -1;
     lastMapNo = -1;
     for(unsigned int i = 0; i < fromRL->count; i++) {
-        Laik_TaskRange_Gen* ts = &(fromRL->trange[i]);
+        Laik_TaskRange_Gen* ts = laik_rangelist_trange(fromRL, i);
         // reset rangeNo to 0 on every task/mapNo change
         if ((ts->task != lastTask) || (ts->mapNo != lastMapNo)) {
             rangeNo = 0;
@@ -1105,7 +1188,7 @@ void calcAddReductions(int tflags,
     lastTask = -1;
     lastMapNo = -1;
     for(unsigned int i = 0; i < toRL->count; i++) {
-        Laik_TaskRange_Gen* tr = &(toRL->trange[i]);
+        Laik_TaskRange_Gen* tr = laik_rangelist_trange(toRL, i);
         // reset rangeNo to 0 on every task/mapNo change
         if ((tr->task != lastTask) || (tr->mapNo != lastMapNo)) {
             rangeNo = 0;
@@ -1295,7 +1378,7 @@ void calcAddReductions(int tflags,
                 int out = getTaskGroup(&outputGroup);
 
 #ifdef DEBUG_REDUCTIONRANGES
-                laik_log_begin(1);
+                (void) laik_log_begin(1);
                 laik_log_append("  adding reduction (%lu - %lu), in %d:(",
                                 range.from.i[0], range.to.i[0], in);
                 for(int i = 0; i < groupList[in].count; i++) {
@@ -1392,13 +1475,16 @@ do_calc_transition(Laik_Space* space,
             exit(1); // not actually needed, laik_panic never returns
         }
 
-        for(o = toRL->off[myid]; o < toRL->off[myid+1]; o++) {
-            if (laik_range_isEmpty(&(toRL->trange[o].range))) continue;
+        unsigned int toFirst = laik_rangelist_off(toRL, myid);
+        unsigned int toLast = laik_rangelist_off(toRL, myid + 1);
+        for(o = toFirst; o < toLast; o++) {
+            Laik_TaskRange_Gen* tr = laik_rangelist_trange(toRL, o);
+            if (laik_range_isEmpty(&(tr->range))) continue;
 
             assert(redOp != LAIK_RO_None);
-            appendInitTOp( &(toRL->trange[o].range),
-                           o - toRL->off[myid],
-                           toRL->trange[o].mapNo,
+            appendInitTOp( &(tr->range),
+                           o - toFirst,
+                           tr->mapNo,
                            redOp);
         }
     }
@@ -1414,25 +1500,31 @@ do_calc_transition(Laik_Space* space,
         }
         else {
             // we need intersection of own ranges in fromP/toP
-            Laik_RangeList* fromRL = laik_partitioning_allranges(fromP);
-            Laik_RangeList* toRL = laik_partitioning_allranges(toP);
+            Laik_RangeList* fromRL = laik_partitioning_transranges(fromP, toP);
+            Laik_RangeList* toRL = laik_partitioning_transranges(toP, fromP);
             if ((fromRL == 0) || (toRL == 0)) {
                 laik_panic("Ranges not known for transition calculation");
                 exit(1); // not actually needed, laik_panic never returns
             }
 
+            // offsets of own ranges
+            unsigned int fromFirst = laik_rangelist_off(fromRL, myid);
+            unsigned int fromLast = laik_rangelist_off(fromRL, myid + 1);
+            unsigned int toFirst = laik_rangelist_off(toRL, myid);
+            unsigned int toLast = laik_rangelist_off(toRL, myid + 1);
+
             // determine local ranges to keep
             // (may need local copy if from/to mappings are different).
             // reductions are not handled here, but by backend
-            for(o1 = fromRL->off[myid]; o1 < fromRL->off[myid+1]; o1++) {
-                for(o2 = toRL->off[myid]; o2 < toRL->off[myid+1]; o2++) {
+            for(o1 = fromFirst; o1 < fromLast; o1++) {
+                for(o2 = toFirst; o2 < toLast; o2++) {
                     range = laik_range_intersect(&(fromRL->trange[o1].range),
                                                &(toRL->trange[o2].range));
                     if (range == 0) continue;
 
                     appendLocalTOp(range,
-                                   o1 - fromRL->off[myid],
-                                   o2 - toRL->off[myid],
+                                   o1 - fromFirst,
+                                   o2 - toFirst,
                                    fromRL->trange[o1].mapNo,
                                    toRL->trange[o2].mapNo);
                 }
@@ -1444,12 +1536,13 @@ do_calc_transition(Laik_Space* space,
                 //               result to one or all?
                 bool fromAllto1OrAll = false;
                 int outputGroup = -2;
-                if (laik_partitioning_isAll(fromP)) {
+                // (ranges intersecting own ones are enough to check for this)
+                if (laik_rangelist_isAll(fromRL)) {
                     // reduction result either goes to all or master
-                    int task = laik_partitioning_isSingle(toP);
+                    int task = laik_rangelist_isSingle(toRL);
                     if (task < 0) {
                         // output is not a single task
-                        if (laik_partitioning_isAll(toP)) {
+                        if (laik_rangelist_isAll(toRL)) {
                             // output -1 is group ALL
                             outputGroup = -1;
                             fromAllto1OrAll = true;
@@ -1483,14 +1576,17 @@ do_calc_transition(Laik_Space* space,
                 // something to receive not coming from a reduction?
                 for(int task = 0; task < taskCount; task++) {
                     if (task == myid) continue;
-                    for(o1 = toRL->off[myid]; o1 < toRL->off[myid+1]; o1++) {
+                    unsigned int first = laik_rangelist_off(fromRL, task);
+                    unsigned int last = laik_rangelist_off(fromRL, task + 1);
+                    if (first == last) continue; // no partner
+                    for(o1 = toFirst; o1 < toLast; o1++) {
 
                         // everything we have local will not have been sent
                         // TODO: we only check for exact match to catch All
                         // FIXME: should print out a Warning/Error as the App
                         //        was requesting for overwriting of values!
                         range = &(toRL->trange[o1].range);
-                        for(o2 = fromRL->off[myid]; o2 < fromRL->off[myid+1]; o2++) {
+                        for(o2 = fromFirst; o2 < fromLast; o2++) {
                             if (laik_range_isEqual(range,
                                                    &(fromRL->trange[o2].range))) {
                                 range = 0;
@@ -1499,13 +1595,13 @@ do_calc_transition(Laik_Space* space,
                         }
                         if (range == 0) continue;
 
-                        for(o2 = fromRL->off[task]; o2 < fromRL->off[task+1]; o2++) {
+                        for(o2 = first; o2 < last; o2++) {
 
                             range = laik_range_intersect(&(fromRL->trange[o2].range),
                                                        &(toRL->trange[o1].range));
                             if (range == 0) continue;
 
-                            appendRecvTOp(range, o1 - toRL->off[myid],
+                            appendRecvTOp(range, o1 - toFirst,
                                           toRL->trange[o1].mapNo, task);
                         }
                     }
@@ -1515,14 +1611,19 @@ do_calc_transition(Laik_Space* space,
             // something to send?
             for(int task = 0; task < taskCount; task++) {
                 if (task == myid) continue;
-                for(o1 = fromRL->off[myid]; o1 < fromRL->off[myid+1]; o1++) {
+                unsigned int first = laik_rangelist_off(toRL, task);
+                unsigned int last = laik_rangelist_off(toRL, task + 1);
+                if (first == last) continue; // no partner
+                unsigned int fFirst = laik_rangelist_off(fromRL, task);
+                unsigned int fLast = laik_rangelist_off(fromRL, task + 1);
+                for(o1 = fromFirst; o1 < fromLast; o1++) {
 
                     // everything the receiver has local, no need to send
                     // TODO: we only check for exact match to catch All
                     // FIXME: should print out a Warning/Error as the App
                     //        requests overwriting of values!
                     range = &(fromRL->trange[o1].range);
-                    for(o2 = fromRL->off[task]; o2 < fromRL->off[task+1]; o2++) {
+                    for(o2 = fFirst; o2 < fLast; o2++) {
                         if (laik_range_isEqual(range,
                                                &(fromRL->trange[o2].range))) {
                             range = 0;
@@ -1532,13 +1633,13 @@ do_calc_transition(Laik_Space* space,
                     if (range == 0) continue;
 
                     // we may send multiple messages to same task
-                    for(o2 = toRL->off[task]; o2 < toRL->off[task+1]; o2++) {
+                    for(o2 = first; o2 < last; o2++) {
 
                         range = laik_range_intersect(&(fromRL->trange[o1].range),
                                                    &(toRL->trange[o2].range));
                         if (range == 0) continue;
 
-                        appendSendTOp(range, o1 - fromRL->off[myid],
+                        appendSendTOp(range, o1 - fromFirst,
                                       fromRL->trange[o1].mapNo, task);
                     }
                 }
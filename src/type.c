@@ -649,6 +649,9 @@ Laik_Type* laik_type_new(char* name, Laik_TypeKind kind, int size,
 
     t->kind = kind;
     t->size = size;
+    t->fieldCount = 0;
+    t->fieldCapacity = 0;
+    t->field = 0;
     t->init = init;    // if 0: reductions not supported
     t->reduce = reduce;
     t->getLength = 0; // not needed for POD type
@@ -672,6 +675,54 @@ void laik_type_set_reduce(Laik_Type* type, laik_reduce_t reduce)
     type->reduce = reduce;
 }
 
+// compound type, size is sum of field sizes
+Laik_Type* laik_type_new_compound(char* name)
+{
+    return laik_type_new(name, LAIK_TK_Compound, 0, 0, 0);
+}
+
+int laik_type_add_field(Laik_Type* t, char* name, Laik_Type* ft)
+{
+    assert(t->kind == LAIK_TK_Compound);
+    assert(ft && (ft->kind == LAIK_TK_POD));
+    if (t->fieldCount == LAIK_MAX_FIELDS) {
+        laik_log(LAIK_LL_Panic, "Type '%s': more than %d fields not supported",
+                 t->name, LAIK_MAX_FIELDS);
+        exit(1); // not actually needed, laik_log never returns
+    }
+    assert(laik_type_get_field(t, name) < 0);
+
+    if (t->fieldCount == t->fieldCapacity) {
+        t->fieldCapacity = (t->fieldCapacity == 0) ? 4 : 2 * t->fieldCapacity;
+        t->field = realloc(t->field, t->fieldCapacity * sizeof(Laik_TypeField));
+        if (!t->field) {
+            laik_panic("Out of memory allocating fields of compound type");
+            exit(1); // not actually needed, laik_panic never returns
+        }
+    }
+
+    int f = t->fieldCount++;
+    t->field[f].name = strdup(name);
+    t->field[f].type = ft;
+    t->size += ft->size;
+
+    laik_log(1, "type '%s': added field %d '%s' (type '%s', size %d)",
+             t->name, f, name, ft->name, ft->size);
+    return f;
+}
+
+int laik_type_get_fieldcount(Laik_Type* t)
+{
+    return (t->kind == LAIK_TK_Compound) ? t->fieldCount : 0;
+}
+
+int laik_type_get_field(Laik_Type* t, char* name)
+{
+    for(int f = 0; f < t->fieldCount; f++)
+        if (strcmp(t->field[f].name, name) == 0) return f;
+    return -1;
+}
+
 
 void laik_type_init()
 {
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../src/checkpointtest | LC_ALL='C' sort > test-checkpoint-mpi-4.out
+cmp test-checkpoint-mpi-4.out "$(dirname -- "${0}")/test-checkpoint-mpi-4.expected"
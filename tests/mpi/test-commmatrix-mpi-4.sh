@@ -0,0 +1,6 @@
+#!/bin/sh
+rm -f test-commmatrix-mpi-4.csv test-commmatrix-mpi-4.json
+LAIK_BACKEND=mpi LAIK_COMM_MATRIX=test-commmatrix-mpi-4 ${MPIEXEC-mpiexec} -n 4 ../../examples/vsum2 > /dev/null
+# wait time varies between runs: compare only message/byte counts
+cut -d, -f1-8 test-commmatrix-mpi-4.csv > test-commmatrix-mpi-4.out
+cmp test-commmatrix-mpi-4.out "$(dirname -- "${0}")/test-commmatrix-mpi-4.expected"
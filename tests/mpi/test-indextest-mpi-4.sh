@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../src/indextest | LC_ALL='C' sort > test-indextest-mpi-4.out
+cmp test-indextest-mpi-4.out "$(dirname -- "${0}")/test-indextest-mpi-4.expected"
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../src/iotest test-iotest-mpi-4.data | LC_ALL='C' sort > test-iotest-mpi-4.out
+cmp test-iotest-mpi-4.out "$(dirname -- "${0}")/test-iotest-mpi-4.expected"
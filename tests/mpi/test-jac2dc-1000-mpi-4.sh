@@ -0,0 +1,11 @@
+#!/bin/sh
+# run twice with persistent partitioning cache: second run loads partitionings
+export LAIK_PARTITIONING_CACHE=$(mktemp -d)
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../../examples/jac2d -s 1000 > test-jac2dc-1000-mpi-4.out
+# first run must have written cache files
+ls "$LAIK_PARTITIONING_CACHE"/*.lrl > /dev/null || { rm -rf "$LAIK_PARTITIONING_CACHE"; exit 1; }
+LAIK_LOG=1 LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../../examples/jac2d -s 1000 >> test-jac2dc-1000-mpi-4.out 2> test-jac2dc-1000-mpi-4.log
+rm -rf "$LAIK_PARTITIONING_CACHE"
+# second run must have loaded partitionings from the cache
+grep -q "partitioning cache: loaded" test-jac2dc-1000-mpi-4.log || exit 1
+cat "$(dirname -- "${0}")/test-jac2d-1000.expected" "$(dirname -- "${0}")/test-jac2d-1000.expected" | cmp test-jac2dc-1000-mpi-4.out -
@@ -0,0 +1,4 @@
+#!/bin/sh
+# test with deep halos: exchange every 4 iterations, 2 steps in last exchange
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../../examples/jac2d -s -k 4 1000 > test-jac2dk-1000-mpi-4.out
+cmp test-jac2dk-1000-mpi-4.out "$(dirname -- "${0}")/test-jac2dk-1000.expected"
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi LAIK_PARTITIONING_SCALABLE=1 ${MPIEXEC-mpiexec} -n 4 ../../examples/jac2d -s 1000 > test-jac2dp-1000-mpi-4.out
+cmp test-jac2dp-1000-mpi-4.out "$(dirname -- "${0}")/test-jac2d-1000.expected"
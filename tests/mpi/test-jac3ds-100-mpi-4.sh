@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi LAIK_MPI_ASYNC=0 ${MPIEXEC-mpiexec} -n 4 ../../examples/jac3d -s 100 > test-jac3ds-100-mpi-4.out
+cmp test-jac3ds-100-mpi-4.out "$(dirname -- "${0}")/test-jac3d-100.expected"
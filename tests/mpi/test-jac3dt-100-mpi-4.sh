@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi LAIK_LAYOUT_TILE=16x5x3 ${MPIEXEC-mpiexec} -n 4 ../../examples/jac3d -t -r -a -s 100 > test-jac3dt-100-mpi-4.out
+cmp test-jac3dt-100-mpi-4.out "$(dirname -- "${0}")/test-jac3dt-100.expected"
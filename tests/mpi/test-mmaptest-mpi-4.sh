@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../src/mmaptest | LC_ALL='C' sort > test-mmaptest-mpi-4.out
+cmp test-mmaptest-mpi-4.out "$(dirname -- "${0}")/test-mmaptest-mpi-4.expected"
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../../examples/particles > test-particles-mpi-4.out
+cmp test-particles-mpi-4.out "$(dirname -- "${0}")/test-particles.expected"
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../src/partstest > test-partstest-mpi-4.out
+cmp test-partstest-mpi-4.out "$(dirname -- "${0}")/test-partstest-mpi-4.expected"
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../src/prefetchtest | LC_ALL='C' sort > test-prefetchtest-mpi-4.out
+cmp test-prefetchtest-mpi-4.out "$(dirname -- "${0}")/test-prefetchtest-mpi-4.expected"
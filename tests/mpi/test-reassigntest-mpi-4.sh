@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../src/reassigntest | LC_ALL='C' sort > test-reassigntest-mpi-4.out
+cmp test-reassigntest-mpi-4.out "$(dirname -- "${0}")/test-reassigntest-mpi-4.expected"
@@ -0,0 +1,4 @@
+#!/bin/sh
+# test shrinking with incremental partitioner, merging into adjacent ranges
+LAIK_BACKEND=mpi ${MPIEXEC-mpiexec} -n 4 ../../examples/spmv2 -s 2 -i -a 10 3000 | LC_ALL='C' sort > test-spmv2-shrink-adj-mpi-4.out
+cmp test-spmv2-shrink-adj-mpi-4.out "$(dirname -- "${0}")/test-spmv2.expected"
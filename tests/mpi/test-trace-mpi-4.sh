@@ -0,0 +1,14 @@
+#!/bin/sh
+# trace files of all processes and merged trace must be valid JSON,
+# with transition and action events
+rm -f test-trace-mpi-4-*.json
+LAIK_BACKEND=mpi LAIK_TRACE=test-trace-mpi-4 ${MPIEXEC-mpiexec} -n 4 ../../examples/jac2d 100 > /dev/null
+"$(dirname -- "${0}")/../../tools/trace/laik-trace-merge.sh" test-trace-mpi-4-[0-3].json > test-trace-mpi-4-merged.json
+python3 - test-trace-mpi-4-[0-3].json test-trace-mpi-4-merged.json > test-trace-mpi-4.out <<'PY'
+import json, sys
+for fn in sys.argv[1:]:
+    cats = set(e.get("cat") for e in json.load(open(fn))["traceEvents"])
+    print("%s: transition %s, action %s" % (fn,
+          "transition" in cats and "yes" or "no", "action" in cats and "yes" or "no"))
+PY
+cmp test-trace-mpi-4.out "$(dirname -- "${0}")/test-trace-mpi-4.expected"
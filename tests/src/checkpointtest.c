@@ -0,0 +1,95 @@
+// Test for in-memory buddy checkpointing: checkpoint is distributed in
+// steps while values change, then restored after simulated task failures
+
+#include "laik.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// add <v> to all own values
+static void update(Laik_Data* d, double v)
+{
+    double* base;
+    uint64_t count;
+    Laik_Partitioning* p = laik_data_get_partitioning(d);
+    for(int n = 0; n < laik_my_mapcount(p); n++) {
+        laik_get_map_1d(d, n, (void**) &base, &count);
+        for(uint64_t i = 0; i < count; i++)
+            base[i] += v;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+    Laik_Group* world = laik_world(inst);
+
+    // checkpointtest [<redundancy> [<failed task> ...]]
+    int redundancy = (argc > 1) ? atoi(argv[1]) : 1;
+    int failedCount = 0;
+    int failed[4];
+    for(int i = 2; (i < argc) && (failedCount < 4); i++)
+        failed[failedCount++] = atoi(argv[i]);
+    if (failedCount == 0)
+        failed[failedCount++] = 1;
+
+    Laik_Space* space = laik_new_space_1d(inst, 100000);
+    Laik_Data* array = laik_new_data(space, laik_Double);
+    Laik_Partitioning* p = laik_new_partitioning(laik_new_block_partitioner1(),
+                                                 world, space, 0);
+    laik_switchto_partitioning(array, p, LAIK_DF_None, LAIK_RO_None);
+
+    double* base;
+    uint64_t count;
+    if (laik_get_map_1d(array, 0, (void**) &base, &count)) {
+        int64_t off = laik_maplocal2global_1d(array, 0, 0);
+        for(uint64_t i = 0; i < count; i++)
+            base[i] = (double) (off + i);
+    }
+
+    // checkpoint distributed in 4 steps, while values get changed
+    Laik_Checkpoint* c = laik_checkpoint_new(array, redundancy);
+    update(array, 1.0);
+    laik_checkpoint_start(c, 4);
+    for(int iter = 0; iter < 2; iter++) {
+        update(array, 1.0);
+        laik_checkpoint_step(c);
+    }
+    laik_checkpoint_finish(c);
+    update(array, 1.0);
+
+    // simulated failure: values of failed tasks are lost
+    for(int f = 0; f < failedCount; f++)
+        if (laik_myid(world) == failed[f])
+            update(array, -1000000.0);
+
+    Laik_Group* g = laik_checkpoint_restore(1, &c, failedCount, failed);
+    if (!g) {
+        if (laik_myid(world) == 0)
+            printf("Cannot restore\n");
+        laik_finalize(inst);
+        return 0;
+    }
+
+    if (laik_myid(g) < 0) {
+        // failed task
+        laik_finalize(inst);
+        return 0;
+    }
+
+    // restored values are from checkpoint start
+    int64_t checked = 0, wrong = 0;
+    p = laik_data_get_partitioning(array);
+    for(int n = 0; n < laik_my_mapcount(p); n++) {
+        laik_get_map_1d(array, n, (void**) &base, &count);
+        int64_t off = laik_maplocal2global_1d(array, n, 0);
+        for(uint64_t i = 0; i < count; i++, checked++)
+            if (base[i] != (double) (off + i + 1)) wrong++;
+    }
+    printf("Proc %d/%d: %lld values restored, %lld wrong\n",
+           laik_myid(g), laik_size(g), (long long) checked, (long long) wrong);
+
+    laik_checkpoint_free(c);
+    laik_finalize(inst);
+    return 0;
+}
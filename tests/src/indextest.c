@@ -0,0 +1,117 @@
+// Test for partitionings built from single 1d indexes: sparse and dense
+// index sets, unsorted and with duplicates, must result in merged ranges.
+// Data goes from block partitioning over a scattered one (each index owned
+// by one task) to the final one, with transitions between index sets
+
+#include "laik.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIZE 300000
+
+// indexes of <task>: calls <f> for each
+static void indexes(int task, void (*f)(void*, int, int64_t), void* ctx)
+{
+    // dense with duplicates, crossing chunk border at 65536
+    for(int64_t i = task; i < 100000; i += 3) {
+        f(ctx, task, i);
+        f(ctx, task, i);
+    }
+    // contiguous in reverse order, crossing chunk border at 131072
+    for(int64_t i = 140000 + 1000 * task; i > 131000 + 1000 * task; i--)
+        f(ctx, task, i - 1);
+    // scattered
+    for(int64_t i = 0; i < 500; i++)
+        f(ctx, task, (i * 7919 + task) % SIZE);
+}
+
+static void appendIndex(void* ctx, int task, int64_t idx)
+{
+    laik_append_index_1d((Laik_RangeReceiver*) ctx, task, idx);
+}
+
+static void markIndex(void* ctx, int task, int64_t idx)
+{
+    (void) task;
+    ((char*) ctx)[idx] = 1;
+}
+
+static void runIndexPartitioner(Laik_RangeReceiver* r, Laik_PartitionerParams* p)
+{
+    for(int task = 0; task < laik_size(p->group); task++)
+        indexes(task, appendIndex, r);
+}
+
+// every index owned by exactly one task, mostly scattered
+static void runScatterPartitioner(Laik_RangeReceiver* r, Laik_PartitionerParams* p)
+{
+    int size = laik_size(p->group);
+    for(int64_t i = 0; i < SIZE; i++)
+        laik_append_index_1d(r, (int) ((i / 7 + i * 13) % size), i);
+}
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+    Laik_Group* world = laik_world(inst);
+    int myid = laik_myid(world);
+
+    Laik_Space* space = laik_new_space_1d(inst, SIZE);
+    Laik_Data* data = laik_new_data(space, laik_Double);
+
+    // values set with block partitioning
+    Laik_Partitioning* pBlock;
+    pBlock = laik_new_partitioning(laik_new_block_partitioner1(), world, space, 0);
+    laik_switchto_partitioning(data, pBlock, LAIK_DF_None, LAIK_RO_None);
+    double* base;
+    uint64_t count;
+    laik_get_map_1d(data, 0, (void**) &base, &count);
+    int64_t off = laik_maplocal2global_1d(data, 0, 0);
+    for(uint64_t i = 0; i < count; i++)
+        base[i] = (double) (off + i);
+
+    Laik_Partitioner* prS = laik_new_partitioner("scatter", runScatterPartitioner, 0, 0);
+    Laik_Partitioning* pScatter = laik_new_partitioning(prS, world, space, 0);
+    laik_switchto_partitioning(data, pScatter, LAIK_DF_Preserve, LAIK_RO_None);
+
+    Laik_Partitioner* pr = laik_new_partitioner("index", runIndexPartitioner, 0,
+                                                LAIK_PF_NoFullCoverage);
+    Laik_Partitioning* pIndex = laik_new_partitioning(pr, world, space, 0);
+    laik_switchto_partitioning(data, pIndex, LAIK_DF_Preserve, LAIK_RO_None);
+
+    // expected indexes of this process
+    char* expected = calloc(SIZE, 1);
+    indexes(myid, markIndex, expected);
+    int64_t expectedCount = 0;
+    for(int i = 0; i < SIZE; i++)
+        expectedCount += expected[i];
+
+    // ranges must be ordered, not adjacent, and match expected indexes
+    int64_t covered = 0, wrong = 0, last = -1;
+    int n = laik_my_rangecount(pIndex);
+    Laik_Index idx;
+    laik_index_init(&idx, 0, 0, 0);
+    for(int r = 0; r < n; r++) {
+        Laik_TaskRange* tr = laik_my_range(pIndex, r);
+        const Laik_Range* rg = laik_taskrange_get_range(tr);
+        int mapNo = laik_taskrange_get_mapNo(tr);
+        if (rg->from.i[0] <= last) wrong++;
+        last = rg->to.i[0];
+        for(idx.i[0] = rg->from.i[0]; idx.i[0] < rg->to.i[0]; idx.i[0]++) {
+            covered++;
+            if (!expected[idx.i[0]]) wrong++;
+            double* v = (double*) laik_get_map_addr(data, mapNo, &idx);
+            if (*v != (double) idx.i[0]) wrong++;
+        }
+    }
+    if (covered != expectedCount) wrong++;
+
+    printf("Proc %d/%d: %d ranges, %lld indexes, %lld wrong\n",
+           myid, laik_size(world), n, (long long) covered, (long long) wrong);
+
+    free(expected);
+    laik_finalize(inst);
+    return 0;
+}
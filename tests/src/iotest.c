@@ -0,0 +1,93 @@
+// Test for parallel file I/O of containers: values written with one
+// partitioning are read back with different ones
+
+#include "laik.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static double value(Laik_Index* i)
+{
+    return (double) (i->i[0] + 1000 * i->i[1]);
+}
+
+// set (<check> false) or check values of own ranges, return wrong values
+static int64_t walk(Laik_Data* data, bool check, int64_t* checked)
+{
+    Laik_Partitioning* p = laik_data_get_partitioning(data);
+    int64_t wrong = 0;
+    Laik_Index idx;
+    laik_index_init(&idx, 0, 0, 0);
+    for(int r = 0; r < laik_my_rangecount(p); r++) {
+        Laik_TaskRange* tr = laik_my_range(p, r);
+        const Laik_Range* rg = laik_taskrange_get_range(tr);
+        int mapNo = laik_taskrange_get_mapNo(tr);
+        for(idx.i[1] = rg->from.i[1]; idx.i[1] < rg->to.i[1]; idx.i[1]++)
+            for(idx.i[0] = rg->from.i[0]; idx.i[0] < rg->to.i[0]; idx.i[0]++) {
+                double* v = (double*) laik_get_map_addr(data, mapNo, &idx);
+                if (!check) {
+                    *v = value(&idx);
+                    continue;
+                }
+                (*checked)++;
+                if (*v != value(&idx)) wrong++;
+            }
+    }
+    return wrong;
+}
+
+// read <path> into new container for <space> using partitioner <pr>
+static void readAndCheck(Laik_Group* world, Laik_Space* space,
+                         Laik_Partitioner* pr, Laik_Partitioning* other,
+                         const char* name, const char* path)
+{
+    Laik_Data* data = laik_new_data(space, laik_Double);
+    Laik_Partitioning* p = laik_new_partitioning(pr, world, space, other);
+    laik_switchto_partitioning(data, p, LAIK_DF_None, LAIK_RO_None);
+
+    bool ok = laik_data_read(data, path);
+    int64_t checked = 0;
+    int64_t wrong = walk(data, true, &checked);
+    printf("Proc %d/%d: read with %s %s, %lld values checked, %lld wrong\n",
+           laik_myid(world), laik_size(world), name,
+           ok ? "ok" : "failed", (long long) checked, (long long) wrong);
+    laik_free(data);
+}
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+    Laik_Group* world = laik_world(inst);
+    const char* path = (argc > 1) ? argv[1] : "iotest.data";
+
+    Laik_Space* space = laik_new_space_2d(inst, 100, 60);
+    Laik_Data* data = laik_new_data(space, laik_Double);
+    Laik_Partitioning* p = laik_new_partitioning(laik_new_bisection_partitioner(),
+                                                 world, space, 0);
+    laik_switchto_partitioning(data, p, LAIK_DF_None, LAIK_RO_None);
+    walk(data, false, 0);
+
+    bool ok = laik_data_write(data, path);
+    if (laik_myid(world) == 0)
+        printf("write %s\n", ok ? "ok" : "failed");
+
+    // restart with different partitionings
+    readAndCheck(world, space, laik_new_block_partitioner1(), 0, "block", path);
+    readAndCheck(world, space, laik_new_cornerhalo_partitioner(2), p,
+                 "halo", path);
+
+    // file does not match a space with other size
+    Laik_Space* space2 = laik_new_space_1d(inst, 6000);
+    Laik_Data* data2 = laik_new_data(space2, laik_Double);
+    laik_switchto_new_partitioning(data2, world, laik_new_block_partitioner1(),
+                                   LAIK_DF_None, LAIK_RO_None);
+    ok = laik_data_read(data2, path);
+    if (laik_myid(world) == 0) {
+        printf("read into 1d space %s\n", ok ? "ok" : "rejected");
+        unlink(path);
+    }
+
+    laik_finalize(inst);
+    return 0;
+}
@@ -1,12 +1,74 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "laik.h"
 
+// micro-benchmark: each process sets <n> own entries, then sync,
+// then lookup of all entries, update of own entries, sync and sort
+static void bench(Laik_Instance* inst, int n)
+{
+    Laik_Group* world = laik_world(inst);
+    int myid = laik_myid(world);
+    int size = laik_size(world);
+    char key[50], data[50];
+    double t0, t1, t2, t3, t4, t5, t6;
+
+    Laik_KVStore* kvs = laik_kvs_new("bench", inst);
+
+    t0 = laik_wtime();
+    for(int i = 0; i < n; i++) {
+        sprintf(key, "key-%d-%d", myid, i);
+        sprintf(data, "value %d", i);
+        laik_kvs_sets(kvs, key, data);
+    }
+    t1 = laik_wtime();
+    laik_kvs_sync(kvs);
+    t2 = laik_wtime();
+    int found = 0;
+    for(int t = 0; t < size; t++) {
+        for(int i = 0; i < n; i++) {
+            sprintf(key, "key-%d-%d", t, i);
+            if (laik_kvs_entry(kvs, key)) found++;
+        }
+    }
+    t3 = laik_wtime();
+    for(int i = 0; i < n; i++) {
+        sprintf(key, "key-%d-%d", myid, i);
+        sprintf(data, "new %d", i);
+        laik_kvs_sets(kvs, key, data);
+    }
+    t4 = laik_wtime();
+    laik_kvs_sync(kvs);
+    t5 = laik_wtime();
+    laik_kvs_sort(kvs);
+    t6 = laik_wtime();
+
+    if (myid == 0) {
+        printf("KVS bench: %d procs x %d entries (%d found)\n",
+               size, n, found);
+        printf("  set:    %8.3f ms\n", 1000.0 * (t1 - t0));
+        printf("  sync:   %8.3f ms\n", 1000.0 * (t2 - t1));
+        printf("  lookup: %8.3f ms\n", 1000.0 * (t3 - t2));
+        printf("  update: %8.3f ms\n", 1000.0 * (t4 - t3));
+        printf("  sync:   %8.3f ms\n", 1000.0 * (t5 - t4));
+        printf("  sort:   %8.3f ms\n", 1000.0 * (t6 - t5));
+    }
+    laik_kvs_free(kvs);
+}
+
 int main(int argc, char* argv[])
 {
     Laik_Instance* inst = laik_init (&argc, &argv);
     Laik_Group* world = laik_world(inst);
     int myid = laik_myid(world);
 
+    if ((argc > 1) && (strcmp(argv[1], "-b") == 0)) {
+        // benchmark mode: kvstest -b [<entries per process>]
+        bench(inst, (argc > 2) ? atoi(argv[2]) : 100000);
+        laik_finalize(inst);
+        return 0;
+    }
+
     Laik_KVStore* kvs = laik_kvs_new("test", inst);
 
     // set some values, then sync
@@ -29,9 +91,13 @@ int main(int argc, char* argv[])
         laik_kvs_set(kvs, key, laik_kvs_size(e), laik_kvs_data(e,0));
     }
 
-    laik_kvs_sync(kvs);
+    // same as laik_kvs_sync, but could overlap with computation
+    laik_kvs_sync_start(kvs);
+    laik_kvs_sync_wait(kvs);
 
     if (myid == 0) {
+        // order of entries is only defined after sorting
+        laik_kvs_sort(kvs);
         unsigned int n = laik_kvs_count(kvs);
         printf("Entries: %d\n", n);
         for(unsigned int i = 0; i < n; i++) {
@@ -0,0 +1,43 @@
+// Test for logging: levels below LAIK_LOG_MINLEVEL must be removed at
+// compile time, and binary mode (LAIK_LOG=b...) must print the same
+// messages as text mode. All messages printed contain "logtest"
+
+// remove logging of level 1 (LAIK_LL_Debug) from this file
+#define LAIK_LOG_MINLEVEL 2
+#include "laik.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+    int n = (argc > 1) ? atoi(argv[1]) : 200;
+    int evaluated = 0;
+
+    for(int i = 0; i < n; i++) {
+        // removed: arguments not evaluated
+        laik_log(1, "logtest: removed %d", evaluated++);
+        if (laik_log_begin(1))
+            laik_log_flush("logtest: removed %d", evaluated++);
+
+        laik_log(2, "logtest: message %d, %s %5.2f %c %lld %x %%",
+                 i, "str", i * 0.5, 'a' + (i % 26), (long long) i << 40, i);
+
+        // message built in parts, interleaved with writer thread
+        if (laik_log_begin(2)) {
+            laik_log_append("logtest: parts %d:", i);
+            for(int j = 0; j < i % 5; j++)
+                laik_log_append(" %.*s", j + 1, "abcdef");
+            laik_log_flush("\nlogtest: parts %d done", i);
+        }
+    }
+
+    printf("Shown: level 1 %s, level 2 %s\n",
+           laik_log_shown(1) ? "yes" : "no",
+           laik_log_shown(2) ? "yes" : "no");
+    printf("Arguments of removed messages evaluated: %d\n", evaluated);
+
+    laik_finalize(inst);
+    return 0;
+}
@@ -0,0 +1,63 @@
+// Test for the file-backed mmap allocator: values must survive switches
+// which move data between mappings in scratch files
+
+#include "laik.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// set (<check> false) or check values of own mappings, return wrong values
+static int64_t walk(Laik_Data* d, bool check, int64_t* checked)
+{
+    double* base;
+    uint64_t count;
+    int64_t wrong = 0;
+    Laik_Partitioning* p = laik_data_get_partitioning(d);
+    for(int n = 0; n < laik_my_mapcount(p); n++) {
+        laik_get_map_1d(d, n, (void**) &base, &count);
+        int64_t off = laik_maplocal2global_1d(d, n, 0);
+        for(uint64_t i = 0; i < count; i++) {
+            if (!check) {
+                base[i] = (double) (off + i);
+                continue;
+            }
+            (*checked)++;
+            if (base[i] != (double) (off + i)) wrong++;
+        }
+    }
+    return wrong;
+}
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+    Laik_Group* world = laik_world(inst);
+
+    Laik_Space* space = laik_new_space_1d(inst, 1000000);
+    Laik_Data* array = laik_new_data(space, laik_Double);
+    laik_set_allocator(array, laik_new_allocator_mmap(0));
+
+    Laik_Partitioning* pBlock = laik_new_partitioning(laik_new_block_partitioner1(),
+                                                      world, space, 0);
+    Laik_Partitioning* pMaster = laik_new_partitioning(laik_Master,
+                                                       world, space, 0);
+    laik_switchto_partitioning(array, pBlock, LAIK_DF_None, LAIK_RO_None);
+    walk(array, false, 0);
+
+    // gather at master, and distribute again
+    laik_switchto_partitioning(array, pMaster, LAIK_DF_Preserve, LAIK_RO_None);
+    int64_t checked = 0;
+    int64_t wrong = walk(array, true, &checked);
+    if (laik_myid(world) == 0)
+        printf("master: %lld values checked, %lld wrong\n",
+               (long long) checked, (long long) wrong);
+
+    laik_switchto_partitioning(array, pBlock, LAIK_DF_Preserve, LAIK_RO_None);
+    checked = 0;
+    wrong = walk(array, true, &checked);
+    printf("Proc %d/%d: %lld values checked, %lld wrong\n",
+           laik_myid(world), laik_size(world), (long long) checked, (long long) wrong);
+
+    laik_finalize(inst);
+    return 0;
+}
@@ -0,0 +1,70 @@
+// Test for shared partitionings: calculated once, distributed via backend
+
+#include "laik.h"
+
+#include <stdio.h>
+#include <assert.h>
+
+static int wcalls = 0;
+
+static double getIdxW(Laik_Index* i, const void* d)
+{
+    (void) d;
+    wcalls++;
+    return (double) (1 + (i->i[0] % 7));
+}
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+    Laik_Group* world = laik_world(inst);
+    int myid = laik_myid(world);
+    Laik_Partitioning *pRef, *p1, *p2;
+
+    // weighted 1d block partitioning, calculated only on process 0
+    Laik_Space* s1 = laik_new_space_1d(inst, 100000);
+    Laik_Partitioner* pr1 = laik_new_block_partitioner_iw1(getIdxW, 0);
+    pRef = laik_new_partitioning(pr1, world, s1, 0);
+
+    wcalls = 0;
+    p1 = laik_new_shared_partitioning(pr1, world, s1, 0, "weighted", 0);
+    assert(laik_partitioning_isEqual(pRef, p1));
+    assert((myid == 0) || (wcalls == 0));
+    if (myid == 0)
+        printf("weighted: %d ranges, equal\n", laik_partitioning_rangecount(p1));
+
+    // second request with same name: reuse without recalculation
+    wcalls = 0;
+    p2 = laik_new_shared_partitioning(pr1, world, s1, 0, "weighted", 0);
+    assert(laik_partitioning_isEqual(pRef, p2));
+    assert(wcalls == 0);
+    if (myid == 0)
+        printf("weighted: reused, equal\n");
+
+    // same name with other partitioner: recalculated, replacing cached ranges
+    Laik_Partitioner* pr2 = laik_new_block_partitioner1();
+    Laik_Partitioning* pRefB = laik_new_partitioning(pr2, world, s1, 0);
+    p2 = laik_new_shared_partitioning(pr2, world, s1, 0, "weighted", 0);
+    assert(laik_partitioning_isEqual(pRefB, p2));
+    if (myid == 0)
+        printf("weighted: replaced by block, equal\n");
+
+    // 2d bisection with halo, each process calculating own ranges
+    Laik_Space* s2 = laik_new_space_2d(inst, 300, 200);
+    Laik_Partitioning *pRef2, *pHalo2, *p3, *p4;
+    pRef2 = laik_new_partitioning(laik_new_bisection_partitioner(), world, s2, 0);
+    pHalo2 = laik_new_partitioning(laik_new_cornerhalo_partitioner(1),
+                                   world, s2, pRef2);
+    p3 = laik_new_shared_partitioning(laik_new_bisection_partitioner(),
+                                      world, s2, 0, "bisection", -1);
+    p4 = laik_new_shared_partitioning(laik_new_cornerhalo_partitioner(1),
+                                      world, s2, p3, "halo", -1);
+    assert(laik_partitioning_isEqual(pRef2, p3));
+    assert(laik_partitioning_isEqual(pHalo2, p4));
+    if (myid == 0)
+        printf("bisection/halo: %d/%d ranges, equal\n",
+               laik_partitioning_rangecount(p3), laik_partitioning_rangecount(p4));
+
+    laik_finalize(inst);
+    return 0;
+}
@@ -0,0 +1,77 @@
+// Test for prefetching data for a later switch, to allow processes joining
+// in a world resize to get their data while old processes go on working
+
+#include "laik.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+    Laik_Group* world = laik_world(inst);
+    int wait = (argc > 1) ? atoi(argv[1]) : 0;
+
+    Laik_Space* space = laik_new_space_1d(inst, 100000);
+    Laik_Data* array = laik_new_data(space, laik_Double);
+    Laik_Partitioner* pr1 = laik_new_block_partitioner1();
+    // 2 blocks per process: data moves even if world does not change
+    Laik_Partitioner* pr2 = laik_new_block_partitioner(0, 2, 0, 0, 0);
+
+    double* base;
+    uint64_t count;
+    Laik_Partitioning* p1;
+    bool joined = (laik_phase(inst) > 0);
+    if (!joined) {
+        p1 = laik_new_partitioning(pr1, world, space, 0);
+        laik_switchto_partitioning(array, p1, LAIK_DF_None, LAIK_RO_None);
+        if (laik_get_map_1d(array, 0, (void**) &base, &count)) {
+            int64_t off = laik_maplocal2global_1d(array, 0, 0);
+            for(uint64_t i = 0; i < count; i++)
+                base[i] = (double) (off + i);
+        }
+        // give processes time to join
+        if (wait > 0) sleep(wait);
+        world = laik_allow_world_resize(inst, 1);
+    }
+    else {
+        // joining
+        p1 = laik_new_partitioning(pr1, laik_group_parent(world), space, 0);
+        laik_set_initial_partitioning(array, p1);
+    }
+
+    // prefetch in 4 steps, only do 2 before switching
+    Laik_Partitioning* p2 = laik_new_partitioning(pr2, world, space, 0);
+    laik_data_prefetch_start(array, p2, 4);
+    laik_data_prefetch_step(array);
+    laik_data_prefetch_step(array);
+
+    // change own values in slabs already sent, these must be sent again
+    if (!joined && laik_get_map_1d(array, 0, (void**) &base, &count)) {
+        int64_t off = laik_maplocal2global_1d(array, 0, 0);
+        for(uint64_t i = 0; i < count; i++)
+            if (off + (int64_t) i < 50000) base[i] *= 2;
+    }
+    Laik_Range changed;
+    laik_range_init_1d(&changed, space, 0, 50000);
+    laik_data_prefetch_invalidate(array, &changed);
+
+    laik_switchto_partitioning(array, p2, LAIK_DF_Preserve, LAIK_RO_None);
+
+    int64_t checked = 0, wrong = 0;
+    for(int n = 0; n < laik_my_mapcount(p2); n++) {
+        laik_get_map_1d(array, n, (void**) &base, &count);
+        int64_t off = laik_maplocal2global_1d(array, n, 0);
+        for(uint64_t i = 0; i < count; i++, checked++)
+            if (base[i] != (double) ((off + i < 50000) ? 2 * (off + i) : off + i))
+                wrong++;
+    }
+    printf("Proc %d/%d: %lld values checked, %lld wrong\n",
+           laik_myid(world), laik_size(world),
+           (long long) checked, (long long) wrong);
+
+    laik_finalize(inst);
+    return 0;
+}
@@ -0,0 +1,100 @@
+// Test for the reassign partitioner in adjacent mode: on shrinking,
+// indexes of a removed task get merged into ranges of neighbor tasks
+
+#include "laik-internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+static double value(Laik_Index* i)
+{
+    return (double) (i->i[0] + 1000 * i->i[1] + 1000000 * i->i[2]);
+}
+
+// set (<check> false) or check values of own ranges, return wrong values
+static int64_t walk(Laik_Data* data, Laik_Partitioning* p, bool check,
+                    int64_t* checked)
+{
+    int dims = laik_partitioning_get_space(p)->dims;
+    int64_t wrong = 0;
+    Laik_Index idx;
+    laik_index_init(&idx, 0, 0, 0);
+    for(int r = 0; r < laik_my_rangecount(p); r++) {
+        Laik_TaskRange* tr = laik_my_range(p, r);
+        const Laik_Range* rg = laik_taskrange_get_range(tr);
+        int mapNo = laik_taskrange_get_mapNo(tr);
+        int64_t zfrom = (dims > 2) ? rg->from.i[2] : 0;
+        int64_t zto   = (dims > 2) ? rg->to.i[2] : 1;
+        int64_t yfrom = (dims > 1) ? rg->from.i[1] : 0;
+        int64_t yto   = (dims > 1) ? rg->to.i[1] : 1;
+        for(idx.i[2] = zfrom; idx.i[2] < zto; idx.i[2]++)
+            for(idx.i[1] = yfrom; idx.i[1] < yto; idx.i[1]++)
+                for(idx.i[0] = rg->from.i[0]; idx.i[0] < rg->to.i[0]; idx.i[0]++) {
+                    double* v = (double*) laik_get_map_addr(data, mapNo, &idx);
+                    if (!check) {
+                        *v = value(&idx);
+                        continue;
+                    }
+                    (*checked)++;
+                    if (*v != value(&idx)) wrong++;
+                }
+    }
+    return wrong;
+}
+
+static void run(Laik_Instance* inst, int dims, int removeTask)
+{
+    Laik_Group* world = laik_world(inst);
+    Laik_Space* space;
+    Laik_Partitioner* pr;
+    if (dims == 1) {
+        space = laik_new_space_1d(inst, 1000);
+        pr = laik_new_block_partitioner1();
+    }
+    else {
+        if (dims == 2)
+            space = laik_new_space_2d(inst, 100, 60);
+        else
+            space = laik_new_space_3d(inst, 20, 30, 16);
+        pr = laik_new_bisection_partitioner();
+    }
+    Laik_Data* data = laik_new_data(space, laik_Double);
+    Laik_Partitioning* p1 = laik_new_partitioning(pr, world, space, 0);
+    laik_switchto_partitioning(data, p1, LAIK_DF_None, LAIK_RO_None);
+
+    walk(data, p1, false, 0);
+
+    int removeList[1] = { removeTask };
+    Laik_Group* g2 = laik_new_shrinked_group(world, 1, removeList);
+    Laik_Partitioner* pr2 = laik_new_reassign_partitioner(g2, 0, 0);
+    laik_set_reassign_adjacent(pr2, true);
+    Laik_Partitioning* p2 = laik_new_partitioning(pr2, world, space, p1);
+    laik_partitioning_migrate(p2, g2);
+    assert(laik_partitioning_coversSpace(p2));
+    laik_switchto_partitioning(data, p2, LAIK_DF_Preserve, LAIK_RO_None);
+
+    if (laik_myid(g2) < 0) return;
+
+    int64_t checked = 0;
+    int64_t wrong = walk(data, p2, true, &checked);
+    printf("%dd, proc %d/%d: %d ranges (%d before), migrated %llu B, "
+           "%lld values checked, %lld wrong\n",
+           dims, laik_myid(g2), laik_size(g2),
+           laik_my_rangecount(p2), laik_partitioning_rangecount(p1),
+           (unsigned long long) data->stat->migratedBytes,
+           (long long) checked, (long long) wrong);
+}
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+    int removeTask = (argc > 1) ? atoi(argv[1]) : 1;
+
+    if (laik_size(laik_world(inst)) > 1)
+        for(int dims = 1; dims <= 3; dims++)
+            run(inst, dims, removeTask);
+
+    laik_finalize(inst);
+    return 0;
+}
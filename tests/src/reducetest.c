@@ -0,0 +1,73 @@
+// Test for reductions on 2d/3d spaces: all-reduce, reduce to master, and
+// switching to the active partitioning (no-op)
+
+#include "laik.h"
+
+#include <stdio.h>
+#include <stdbool.h>
+
+// set (if <doSet>) or check values of own mapping as multiple of
+// <factor>, returns number of mismatches
+static int visit(Laik_Data* d, double factor, bool doSet)
+{
+    Laik_Mapping* m = laik_get_map(d, 0);
+    if (m == 0) return 0;
+    const Laik_Range* r = laik_map_get_range(m);
+    int dims = laik_space_getdimensions(laik_data_get_space(d));
+    int64_t zfrom = (dims > 2) ? r->from.i[2] : 0;
+    int64_t zto   = (dims > 2) ? r->to.i[2] : 1;
+    int errors = 0;
+    Laik_Index i;
+    for(int64_t z = zfrom; z < zto; z++)
+        for(int64_t y = r->from.i[1]; y < r->to.i[1]; y++)
+            for(int64_t x = r->from.i[0]; x < r->to.i[0]; x++) {
+                laik_index_init(&i, x, y, z);
+                double* v = (double*) laik_get_map_addr(d, 0, &i);
+                double expected = factor * (double) (x + 2 * y + 3 * z);
+                if (doSet)
+                    *v = expected;
+                else if (*v != expected)
+                    errors++;
+            }
+    return errors;
+}
+
+static void run(Laik_Instance* inst, int dims)
+{
+    Laik_Group* world = laik_world(inst);
+    int size = laik_size(world);
+    Laik_Space* s;
+    if (dims == 2)
+        s = laik_new_space_2d(inst, 30, 20);
+    else
+        s = laik_new_space_3d(inst, 10, 8, 6);
+    Laik_Partitioning* pAll = laik_new_partitioning(laik_All, world, s, 0);
+    Laik_Partitioning* pMaster = laik_new_partitioning(laik_Master, world, s, 0);
+    Laik_Data* d = laik_new_data(s, laik_Double);
+
+    laik_switchto_partitioning(d, pAll, LAIK_DF_None, LAIK_RO_None);
+    visit(d, 1.0, true);
+    laik_switchto_flow(d, LAIK_DF_Preserve, LAIK_RO_Sum);
+    int e1 = visit(d, size, false);
+
+    // no-op: values stay
+    laik_switchto_partitioning(d, pAll, LAIK_DF_Preserve, LAIK_RO_None);
+    int e2 = visit(d, size, false);
+
+    laik_switchto_partitioning(d, pMaster, LAIK_DF_Preserve, LAIK_RO_Sum);
+    int e3 = visit(d, size * size, false);
+
+    if (laik_myid(world) == 0)
+        printf("%dd: allreduce %s, no-op switch %s, reduce to master %s\n", dims,
+               e1 ? "FAILED" : "ok", e2 ? "FAILED" : "ok", e3 ? "FAILED" : "ok");
+    laik_free(d);
+}
+
+int main(int argc, char* argv[])
+{
+    Laik_Instance* inst = laik_init(&argc, &argv);
+    run(inst, 2);
+    run(inst, 3);
+    laik_finalize(inst);
+    return 0;
+}
@@ -0,0 +1,5 @@
+#!/bin/sh
+# two buddies, two failed processes
+timeout() { perl -e 'alarm shift; exec @ARGV' "$@"; }
+timeout 10 ./tcp2run -n 4 ../src/checkpointtest 2 1 2 | LC_ALL='C' sort > test-checkpoint-4.out
+cmp test-checkpoint-4.out "$(dirname -- "${0}")/test-checkpoint-4.expected"
@@ -0,0 +1,4 @@
+#!/bin/sh
+# same as jac3d test, with compressed binary data
+LAIK_TCP2_COMPRESS=1 ./tcp2run -n 4 ../../examples/jac3d -s 100 10 > test-jac3d-zip-4.out
+cmp test-jac3d-zip-4.out "$(dirname -- "${0}")/../common/test-jac3d-4.expected"
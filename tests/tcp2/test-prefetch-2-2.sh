@@ -0,0 +1,4 @@
+#!/bin/sh
+timeout() { perl -e 'alarm shift; exec @ARGV' "$@"; }
+timeout 4 ./tcp2run -n 2 -s 2 ../src/prefetchtest 1 | LC_ALL='C' sort > test-prefetch-2-2.out
+cmp test-prefetch-2-2.out "$(dirname -- "${0}")/test-prefetch-2-2.expected"
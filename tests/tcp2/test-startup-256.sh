@@ -0,0 +1,8 @@
+#!/bin/sh
+# startup of 256 processes via bootstrap tree, also reporting startup time
+timeout() { perl -e 'alarm shift; exec @ARGV' "$@"; }
+start=$(date +%s.%N)
+timeout 60 ./tcp2run -n 256 ../../examples/min | grep -c "(from 256)" > test-startup-256.out
+end=$(date +%s.%N)
+echo "TCP2 startup of 256 processes: $(echo "$start $end" | awk '{ printf "%.2f", $2 - $1 }') s"
+cmp test-startup-256.out "$(dirname -- "${0}")/test-startup-256.expected"
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=single src/indextest > test-indextest-single.out
+cmp test-indextest-single.out "$(dirname -- "${0}")/test-indextest.expected"
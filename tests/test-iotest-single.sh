@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=single src/iotest test-iotest-single.data > test-iotest-single.out
+cmp test-iotest-single.out "$(dirname -- "${0}")/test-iotest.expected"
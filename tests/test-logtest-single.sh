@@ -0,0 +1,7 @@
+#!/bin/sh
+# binary log mode (small buffer: formatting in writer thread while
+# recording) must print the same messages as text mode
+LAIK_LOG=n1 LAIK_BACKEND=single src/logtest 2>&1 > test-logtest-single.out | grep logtest > test-logtest-text.out
+LAIK_LOG=bn1 LAIK_LOG_BUFSIZE=1024 LAIK_BACKEND=single src/logtest 2>&1 > /dev/null | grep logtest > test-logtest-binary.out
+cmp test-logtest-text.out test-logtest-binary.out || exit 1
+cmp test-logtest-single.out "$(dirname -- "${0}")/test-logtest.expected"
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=single src/mmaptest > test-mmaptest-single.out
+cmp test-mmaptest-single.out "$(dirname -- "${0}")/test-mmaptest.expected"
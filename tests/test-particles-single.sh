@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=single ../examples/particles > test-particles-single.out
+cmp test-particles-single.out "$(dirname -- "${0}")/test-particles.expected"
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=single src/partstest > test-partstest-single.out
+cmp test-partstest-single.out "$(dirname -- "${0}")/test-partstest.expected"
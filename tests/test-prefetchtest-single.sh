@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=single src/prefetchtest > test-prefetchtest-single.out
+cmp test-prefetchtest-single.out "$(dirname -- "${0}")/test-prefetchtest.expected"
@@ -0,0 +1,3 @@
+#!/bin/sh
+LAIK_BACKEND=single src/reducetest > test-reducetest-single.out
+cmp test-reducetest-single.out "$(dirname -- "${0}")/test-reducetest.expected"
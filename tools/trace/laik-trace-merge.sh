@@ -0,0 +1,22 @@
+#!/bin/sh -eu
+#
+# Merge per-process trace files written with LAIK_TRACE=<prefix> into one
+# Chrome trace JSON file, printed to stdout. Open the result with
+# chrome://tracing or https://ui.perfetto.dev
+#
+# Usage: laik-trace-merge.sh <prefix>-*.json > trace.json
+
+if [ $# -eq 0 ]; then
+    echo "Usage: $0 <trace files> > merged.json" >&2
+    exit 1
+fi
+
+echo '{"traceEvents":['
+sep=''
+for f in "$@"; do
+    # skip first and last line: begin/end of traceEvents array
+    printf '%s' "$sep"
+    sed '1d;$d' "$f"
+    sep=','
+done
+echo '],"displayTimeUnit":"ns"}'